@@ -0,0 +1,17 @@
+#!/bin/sh
+# Archivo grande para medir la latencia de --watch por edición:
+# sh bench/incremental/gen.sh <funciones>
+# Cada función ocupa 15 líneas y llama a la anterior; la línea "seed" es la
+# que edita bench/incremental/run.sh.
+awk -v functions="${1:-2500}" 'BEGIN {
+    for (f = 0; f < functions; f++) {
+        printf "int f%d(int a, int b)\n{\n    int seed = 7;\n    int x = a + seed;\n", f
+        printf "    int y = b * 3;\n    if (x)\n    {\n        x = x - y;\n    }\n"
+        if (f > 0)
+            printf "    x = x + f%d(y, b);\n", f - 1
+        else
+            printf "    x = x + y;\n"
+        printf "    int z = x * y + seed;\n    z = z - a;\n    return z + x;\n}\n\n"
+    }
+    printf "int main()\n{\n    return f%d(1, 2);\n}\n", functions - 1
+}'
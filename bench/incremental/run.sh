@@ -0,0 +1,83 @@
+#!/bin/sh
+# Latencia del análisis semántico por edición en --watch, sobre el archivo
+# de bench/incremental/gen.sh (unas 37k líneas): análisis completo (primera
+# comprobación de una sesión nueva) frente a la actualización de una sesión
+# que ya tenía la versión anterior. Mediana de varias repeticiones. Se
+# ejecuta desde la raíz del repositorio (data/ es relativo):
+# sh bench/incremental/run.sh [funciones] [repeticiones]
+# Si cjamz deja de responder, el benchmark termina con error.
+work=${TMPDIR:-/tmp}/jamz-incremental
+functions=${1:-2500}
+repeats=${2:-7}
+target=f$((functions / 2))
+mkdir -p "$work" || exit 1
+sh bench/incremental/gen.sh "$functions" >"$work/base.c" || exit 1
+
+# Las tres ediciones, aplicadas a la versión base
+edit() {
+    case $1 in
+    literal) sed "/^int $target(/,/^}/ s/seed = 7;/seed = 8;/" "$work/base.c" ;;
+    top) { echo; cat "$work/base.c"; } ;;
+    signature) sed "s/^int $target(int a, int b)/int $target(int a, int b, int c)/" "$work/base.c" ;;
+    esac
+}
+
+# Espera a que el vigilante de $1 (registro $2) llegue a $3 comprobaciones y
+# deja en $semantic el tiempo del análisis de la última
+wait_check() {
+    tries=0
+    while [ "$(grep -a -c "Checked in" "$2")" -lt "$3" ]; do
+        tries=$((tries + 1))
+        if [ "$tries" -gt 600 ] || ! kill -0 "$1" 2>/dev/null; then
+            echo "cjamz --watch did not check the file" >&2
+            exit 1
+        fi
+        sleep 0.05
+    done
+    semantic=$(grep -a "Checked in" "$2" | sed -n "$3p" | sed 's/.*semantic analysis \([0-9.]*\) ms.*/\1/')
+}
+
+median() {
+    sort -n | awk '{ v[NR] = $1 } END { print v[int((NR + 1) / 2)] }'
+}
+
+# Se escribe aparte y se mueve: el vigilante nunca lee un archivo a medias.
+# La pausa deja que el sondeo de 200 ms vea cada versión como un cambio.
+replace() {
+    cat >"$work/next.c" && mv "$work/next.c" "$1"
+    sleep 0.3
+}
+
+replace "$work/session.c" <"$work/base.c"
+./bin/cjamz --watch "$work/session.c" >"$work/session.out" 2>&1 &
+session=$!
+trap 'kill "$session" 2>/dev/null' EXIT
+checks=1
+wait_check "$session" "$work/session.out" "$checks"
+
+printf '%-12s %14s %16s\n' "edit" "full analysis" "session update"
+for kind in literal top signature; do
+    : >"$work/full.times"
+    : >"$work/session.times"
+    for r in $(seq "$repeats"); do
+        # Análisis completo: una sesión nueva sobre la versión editada
+        edit "$kind" | replace "$work/full.c"
+        ./bin/cjamz --watch "$work/full.c" >"$work/full.out" 2>&1 &
+        full=$!
+        wait_check "$full" "$work/full.out" 1
+        kill "$full" 2>/dev/null
+        wait "$full" 2>/dev/null
+        echo "$semantic" >>"$work/full.times"
+
+        # Actualización: la sesión ya tenía la base; después se restaura
+        edit "$kind" | replace "$work/session.c"
+        checks=$((checks + 1))
+        wait_check "$session" "$work/session.out" "$checks"
+        echo "$semantic" >>"$work/session.times"
+        replace "$work/session.c" <"$work/base.c"
+        checks=$((checks + 1))
+        wait_check "$session" "$work/session.out" "$checks"
+    done
+    printf '%-12s %11s ms %13s ms\n' "$kind" "$(median <"$work/full.times")" "$(median <"$work/session.times")"
+done
+rm -f "$work"/*.c "$work"/*.out "$work"/*.times
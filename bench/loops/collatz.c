@@ -0,0 +1,27 @@
+int collatz(int n)
+{
+    int steps = 0;
+    while (n != 1)
+    {
+        if (n % 2 == 0)
+        {
+            n = n / 2;
+        }
+        else
+        {
+            n = 3 * n + 1;
+        }
+        steps = steps + 1;
+    }
+    return steps;
+}
+
+int main()
+{
+    int total = 0;
+    for (int i = 1; i < 100000; i = i + 1)
+    {
+        total = total + collatz(i);
+    }
+    return total;
+}
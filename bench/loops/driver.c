@@ -0,0 +1,15 @@
+// Mide el main de un programa de bench/loops compilado con cc (run.sh lo
+// renombra a jamz_main) e imprime una línea como la de --jit
+#include <stdio.h>
+#include <time.h>
+
+int jamz_main(void);
+
+int main(void)
+{
+    clock_t start = clock();
+    int result = jamz_main();
+    double ms = (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+    printf("cc: main returned %d (ran in %.3f ms)\n", result, ms);
+    return 0;
+}
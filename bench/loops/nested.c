@@ -0,0 +1,19 @@
+int kernel(int n)
+{
+    int s = 0;
+    for (int i = 0; i < n; i = i + 1)
+    {
+        for (int j = 0; j < n; j = j + 1)
+        {
+            int scale = n * 3 + 1;
+            s = s + i * 7 + j * 5 + scale;
+        }
+    }
+    return s;
+}
+
+int main()
+{
+    int r = kernel(6000);
+    return r;
+}
@@ -0,0 +1,46 @@
+#!/bin/sh
+# Bucles con invariantes, productos de la variable de inducción, división
+# por prueba y Collatz: --jit frente al mismo fuente compilado con cc -O0
+# (con -fwrapv, para que el desbordamiento dé lo mismo que en jamz). Mejor
+# de tres ejecuciones. Se ejecuta desde la raíz del repositorio (data/ es
+# relativo): sh bench/loops/run.sh
+# Si algún paso falla, o los resultados no coinciden, termina con error.
+work=${TMPDIR:-/tmp}/jamz-loops
+cc=${CC:-cc}
+mkdir -p "$work" || exit 1
+
+best() {
+    grep -a -o "ran in [0-9.]*" | sed 's/ran in //' | sort -n | head -n 1
+}
+
+result() {
+    grep -a -o "main returned -*[0-9]*" | head -n 1 | sed 's/main returned //'
+}
+
+for program in bench/loops/nested.c bench/loops/primes.c bench/loops/collatz.c; do
+    jit=""
+    for r in 1 2 3; do
+        output=$(./bin/cjamz --jit "$program" 2>&1) || {
+            echo "cjamz --jit $program failed" >&2
+            exit 1
+        }
+        jit="$jit$(printf '%s\n' "$output" | grep -a "JIT: main returned")
+"
+    done
+
+    sed 's/^int main()/int jamz_main()/' "$program" >"$work/program.c"
+    "$cc" -O0 -fwrapv -w -o "$work/program" "$work/program.c" bench/loops/driver.c || exit 1
+    native=""
+    for r in 1 2 3; do
+        native="$native$("$work/program")
+"
+    done
+
+    if [ "$(printf '%s' "$jit" | result)" != "$(printf '%s' "$native" | result)" ]; then
+        echo "$program: --jit returned $(printf '%s' "$jit" | result), cc $(printf '%s' "$native" | result)" >&2
+        exit 1
+    fi
+    printf '%-24s --jit %8s ms   cc -O0 %8s ms   (main returned %s)\n' "$program" \
+        "$(printf '%s' "$jit" | best)" "$(printf '%s' "$native" | best)" "$(printf '%s' "$jit" | result)"
+done
+rm -f "$work/program" "$work/program.c" bench/loops/*.asm
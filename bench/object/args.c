@@ -0,0 +1,30 @@
+int mix(int a, int b, int c, int d, int e, int f, int g, int h)
+{
+    return a - b * 2 + c * 3 - d * 4 + e * 5 - f * 6 + g * 7 - h * 8;
+}
+
+int seven(int a, int b, int c, int d, int e, int f, int g)
+{
+    return mix(g, f, e, d, c, b, a, a + g);
+}
+
+int depth(int n, int acc)
+{
+    if (n == 0)
+    {
+        return acc;
+    }
+    return depth(n - 1, acc * 3 + n % 7);
+}
+
+int main()
+{
+    int sum = 0;
+    for (int i = 0; i < 100; i = i + 1)
+    {
+        sum = sum + seven(i, i + 1, i * 2, 5, i / 3, 9, i % 4);
+        sum = sum - mix(1, 2, 3, 4, 5, 6, 7, i);
+        sum = sum + (i - 50) / 3 + (i - 50) % 7 - (i - 50) / 16;
+    }
+    return sum + depth(50, 1);
+}
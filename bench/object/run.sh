@@ -0,0 +1,43 @@
+#!/bin/sh
+# Objetos ELF64 de --obj: cada programa se compila a un .o, se enlaza con cc
+# y su código de salida se compara con lo que devuelve main en la máquina
+# virtual (módulo 256, como lo ve el sistema). Por defecto recorre
+# bench/object/*.c y los programas de los demás benchmarks; también acepta
+# archivos como argumentos. Se ejecuta desde la raíz del repositorio (data/
+# es relativo): sh bench/object/run.sh [programa.c...]
+# Termina con error si algún paso falla o algún código no coincide.
+work=${TMPDIR:-/tmp}/jamz-object
+cc=${CC:-cc}
+mkdir -p "$work" || exit 1
+if [ $# -eq 0 ]; then
+    set -- bench/object/*.c bench/loops/nested.c bench/loops/primes.c bench/loops/collatz.c \
+        bench/vector/*.c bench/vm/fib.c bench/pgo/branchy.c
+fi
+
+failures=0
+for program in "$@"; do
+    output=$(./bin/cjamz --vm "$program" 2>&1) || {
+        echo "cjamz --vm $program failed" >&2
+        exit 1
+    }
+    expected=$(printf '%s\n' "$output" | grep -a -o "VM: main returned -*[0-9]*" | sed 's/.* //')
+    object=${program%.c}.o
+    rm -f "$object"
+    ./bin/cjamz --obj "$program" >"$work/cjamz.log" 2>&1 || {
+        cat "$work/cjamz.log" >&2
+        echo "cjamz --obj $program failed" >&2
+        exit 1
+    }
+    "$cc" -o "$work/program" "$object" || exit 1
+    rm -f "$object"
+    "$work/program"
+    status=$?
+    if [ "$status" -eq $(((expected % 256 + 256) % 256)) ]; then
+        printf '%-28s ok (exit %d, vm %d)\n' "$program" "$status" "$expected"
+    else
+        printf '%-28s MISMATCH (exit %d, vm %d)\n' "$program" "$status" "$expected"
+        failures=$((failures + 1))
+    fi
+done
+rm -f "$work/program" "$work/cjamz.log"
+[ "$failures" -eq 0 ]
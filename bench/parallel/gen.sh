@@ -0,0 +1,24 @@
+#!/bin/sh
+# Corpus de muchas funciones para el análisis semántico en paralelo:
+# sh bench/parallel/gen.sh <funciones> <sentencias por función>
+# Cada función declara, asigna, llama a la anterior y anida if y while; una
+# de cada 50 lleva un error de tipos para que haya diagnósticos que comparar
+# entre distintos números de hilos.
+awk -v functions="${1:-2000}" -v statements="${2:-400}" 'BEGIN {
+    for (f = 0; f < functions; f++) {
+        printf "int f%d(int a, int b)\n{\n    int x = a;\n", f
+        for (s = 0; s < statements; s += 4) {
+            printf "    int v%d = x * %d + b;\n", s, s % 17 + 1
+            printf "    if (v%d > a)\n    {\n        x = v%d - %d;\n    }\n", s, s, s % 5
+            printf "    while (x > %d)\n    {\n        x = x / 2;\n    }\n", 1000 + s
+            if (f > 0)
+                printf "    x = x + f%d(v%d, b);\n", f - 1, s
+            else
+                printf "    x = x + v%d;\n", s
+        }
+        if (f % 50 == 49)
+            printf "    x = y%d;\n", f
+        printf "    return x;\n}\n\n"
+    }
+    printf "int main()\n{\n    return f%d(1, 2);\n}\n", functions - 1
+}'
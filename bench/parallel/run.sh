@@ -0,0 +1,53 @@
+#!/bin/sh
+# Análisis semántico en paralelo sobre el corpus de bench/parallel/gen.sh:
+# tiempo de la fase con JAMZ_JOBS=1, 2, 4 y 8, y los diagnósticos de cada
+# ejecución comparados con los de un solo hilo. Se ejecuta desde la raíz del
+# repositorio (data/ es relativo):
+# sh bench/parallel/run.sh [funciones] [sentencias por función]
+# El corpus tiene errores a propósito, así que cjamz termina con 1; si no
+# llega a imprimir el tiempo del análisis, el benchmark termina con error.
+#
+# El tiempo de pared solo baja con tantos núcleos como hilos. Para verlo
+# también en una máquina con menos, cada ejecución lee de program.log la CPU
+# de la fase paralela y la del hilo más cargado, y proyecta el análisis con
+# un núcleo por hilo: lo secuencial (pared menos CPU de los hilos) más el
+# hilo más cargado. Es una cota: no cuenta la memoria ni el reloj compartidos.
+corpus=${TMPDIR:-/tmp}/jamz-parallel.c
+sh bench/parallel/gen.sh "${1:-500}" "${2:-200}" >"$corpus" || exit 1
+
+for jobs in 1 2 4 8; do
+    output=$(JAMZ_JOBS=$jobs ./bin/cjamz "$corpus" 2>&1)
+    line=$(printf '%s\n' "$output" | grep -a "Semantic analysis:")
+    if [ -z "$line" ]; then
+        echo "JAMZ_JOBS=$jobs: cjamz did not finish the semantic analysis" >&2
+        exit 1
+    fi
+    diagnostics=$(printf '%s\n' "$output" | grep -a "Compiler error")
+    if [ "$jobs" = 1 ]; then
+        reference=$diagnostics
+        same="$(printf '%s\n' "$diagnostics" | wc -l) diagnostics"
+    elif [ "$diagnostics" = "$reference" ]; then
+        same="same diagnostics"
+    else
+        echo "JAMZ_JOBS=$jobs: diagnostics differ from JAMZ_JOBS=1" >&2
+        exit 1
+    fi
+    printf 'JAMZ_JOBS=%s %s (%s)\n' "$jobs" "${line#*: }" "$same"
+
+    phase=$(grep -a "Fase paralela" program.log 2>/dev/null | tail -n 1)
+    if [ -z "$phase" ]; then
+        echo "JAMZ_JOBS=$jobs: program.log has no parallel phase line" >&2
+        exit 1
+    fi
+    wall=$(printf '%s\n' "$line" | sed 's/.* in \([0-9.]*\) ms.*/\1/')
+    cpu=$(printf '%s\n' "$phase" | sed 's/.*, \([0-9.]*\) ms de CPU.*/\1/')
+    busiest=$(printf '%s\n' "$phase" | sed 's/.*CPU, \([0-9.]*\) ms el hilo.*/\1/')
+    if [ "$jobs" = 1 ]; then
+        single=$wall
+    fi
+    awk -v w="$wall" -v c="$cpu" -v b="$busiest" -v s="$single" -v j="$jobs" 'BEGIN {
+        p = w - c + b
+        printf "    threads %.3f ms CPU, busiest %.3f ms: projected %.3f ms on %d core(s), %.2fx\n", c, b, p, j, s / p
+    }'
+done
+rm -f "$corpus"
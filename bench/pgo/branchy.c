@@ -0,0 +1,62 @@
+int rare(int x)
+{
+    int s = 0;
+    for (int k = 0; k < 6; k = k + 1)
+    {
+        s = s * 3 + x % 1000 + k;
+    }
+    return s % 1000;
+}
+
+int step(int x)
+{
+    int r = x % 7;
+    if (r == 6)
+    {
+        r = r * 5 - x % 3;
+    }
+    else
+    {
+        r = r + 1;
+    }
+    return r;
+}
+
+int recover(int total, int i)
+{
+    int t = total;
+    for (int k = 0; k < 4; k = k + 1)
+    {
+        t = t / 2 + i % (k + 3);
+    }
+    return t - 1;
+}
+
+int main()
+{
+    int total = 0;
+    for (int i = 0; i < 20000000; i = i + 1)
+    {
+        int v = i % 100;
+        if (v == 0)
+        {
+            total = total + rare(i);
+        }
+        else
+        {
+            if (v < 97)
+            {
+                total = total + step(i);
+            }
+            else
+            {
+                total = total - v;
+            }
+        }
+        if (total < 0)
+        {
+            total = recover(total, i);
+        }
+    }
+    return total % 256;
+}
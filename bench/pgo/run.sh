@@ -0,0 +1,38 @@
+#!/bin/sh
+# Compilación guiada por perfil de bench/pgo/branchy.c de principio a fin:
+# ejecución instrumentada, diferencias de colocación de bloques en el
+# ensamblador y tiempos con y sin perfil. Se ejecuta desde la raíz del
+# repositorio (data/ es relativo): sh bench/pgo/run.sh
+# Si el compilador falla o aborta, el benchmark termina con error.
+source=bench/pgo/branchy.c
+plain=${TMPDIR:-/tmp}/branchy.plain.asm
+guided=${TMPDIR:-/tmp}/branchy.pgo.asm
+
+cjamz() {
+    output=$(./bin/cjamz "$@" "$source" 2>&1) || {
+        echo "cjamz $* $source failed" >&2
+        exit 1
+    }
+}
+
+cjamz --instrument
+printf '%s\n' "$output" | grep -a -A 20 "Instrumented run"
+
+cjamz
+cp "${source%.c}.asm" "$plain"
+cjamz --profile-use
+printf '%s\n' "$output" | grep -a "Profile-guided layout"
+cp "${source%.c}.asm" "$guided"
+echo
+echo "Layout (labels and jumps), without and with the profile:"
+skeleton() { grep -a -E "^[A-Za-z_.][A-Za-z0-9_.]*:|^ +j[a-z]+ " "$1" | sed 's/^ */    /'; }
+skeleton "$plain" >"$plain.cfg"
+skeleton "$guided" >"$guided.cfg"
+diff -y -W 72 "$plain.cfg" "$guided.cfg"
+rm -f "$plain" "$guided" "$plain.cfg" "$guided.cfg"
+
+echo
+for mode in "--jit" "--profile-use --jit"; do
+    cjamz $mode
+    printf '%-20s %s\n' "$mode" "$(printf '%s\n' "$output" | grep -a "JIT: main returned")"
+done
@@ -0,0 +1,72 @@
+// Llama a work(i, suma) del ensamblador de cjamz ITERATIONS veces y mide el
+// bucle con clock_gettime. Se enlaza sin libc (i386 Linux): escribe con
+// write y sale con exit.
+#ifndef ITERATIONS
+#define ITERATIONS 3000000
+#endif
+
+int work(int a, int b);
+
+struct timespec32
+{
+    long tv_sec;
+    long tv_nsec;
+};
+
+static long syscall3(long number, long a, long b, long c)
+{
+    long result;
+    __asm__ volatile("int $0x80" : "=a"(result) : "a"(number), "b"(a), "c"(b), "d"(c) : "memory");
+    return result;
+}
+
+static double now_ms(void)
+{
+    struct timespec32 now;
+    syscall3(265, 1, (long)&now, 0); // clock_gettime(CLOCK_MONOTONIC)
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1e6;
+}
+
+static void write_text(const char *text)
+{
+    long length = 0;
+    while (text[length])
+        length++;
+    syscall3(4, 1, (long)text, length);
+}
+
+static void write_number(long value)
+{
+    char buffer[24];
+    char *p = buffer + sizeof(buffer) - 1;
+    unsigned long magnitude = value < 0 ? 0ul - (unsigned long)value : (unsigned long)value;
+    *p = '\0';
+    do
+        *--p = (char)('0' + magnitude % 10);
+    while (magnitude /= 10);
+    if (value < 0)
+        *--p = '-';
+    write_text(p);
+}
+
+void _start(void)
+{
+    int sum = 0;
+    double start = now_ms();
+    for (int i = 0; i < ITERATIONS; i++)
+        sum = sum + work(i, sum);
+    long elapsed = (long)((now_ms() - start) * 1000.0);
+
+    write_text("work x ");
+    write_number(ITERATIONS);
+    write_text(": ");
+    write_number(elapsed / 1000);
+    write_text(".");
+    write_number(elapsed / 100 % 10);
+    write_number(elapsed / 10 % 10);
+    write_number(elapsed % 10);
+    write_text(" ms (sum ");
+    write_number(sum);
+    write_text(")\n");
+    syscall3(1, 0, 0, 0);
+}
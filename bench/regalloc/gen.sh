@@ -0,0 +1,17 @@
+#!/bin/sh
+# Función aritmética con muchas variables vivas a la vez para el asignador
+# de registros: sh bench/regalloc/gen.sh <variables>
+# Cada variable lee la anterior y la de siete más atrás, y el resultado suma
+# una de cada cinco, así que muchas siguen vivas hasta el final.
+awk -v count="${1:-60}" 'BEGIN {
+    printf "int work(int a, int b)\n{\n    int v0 = a + b;\n"
+    for (i = 1; i < count; i++) {
+        back = i >= 7 ? "v" (i - 7) : "b"
+        printf "    int v%d = v%d * %d + %s - a;\n", i, i - 1, i % 9 + 2, back
+    }
+    printf "    return v0"
+    for (i = 5; i < count; i += 5)
+        printf " + v%d", i
+    printf ";\n}\n\n"
+    printf "int main()\n{\n    return work(1, 2);\n}\n"
+}'
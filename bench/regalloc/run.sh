@@ -0,0 +1,39 @@
+#!/bin/sh
+# Asignación de registros sobre la función de bench/regalloc/gen.sh:
+# instrucciones y accesos a memoria de work en el ensamblador y, si hay
+# nasm, el tiempo de muchas llamadas desde bench/regalloc/driver.c (necesita
+# un cc que genere código i386). Se ejecuta desde la raíz del repositorio
+# (data/ es relativo):
+# sh bench/regalloc/run.sh [variables] [iteraciones]
+# Si algún paso falla, el benchmark termina con error.
+work=${TMPDIR:-/tmp}/jamz-regalloc
+cc=${CC:-cc}
+mkdir -p "$work" || exit 1
+
+step() {
+    "$@" >"$work/step.log" 2>&1 || {
+        cat "$work/step.log" >&2
+        echo "$* failed" >&2
+        exit 1
+    }
+}
+
+sh bench/regalloc/gen.sh "${1:-60}" >"$work/regalloc.c" || exit 1
+rm -f "$work/regalloc.asm"
+step ./bin/cjamz "$work/regalloc.c"
+awk '/^work:/ { inside = 1; next }
+     /^[A-Za-z_][A-Za-z0-9_]*:/ { inside = 0 }
+     inside && /^    [a-z]/ { instructions++; if (/dword \[/) memory++ }
+     END { printf "work: %d instructions, %d memory operands\n", instructions, memory }' "$work/regalloc.asm"
+
+if ! command -v nasm >/dev/null 2>&1; then
+    echo "nasm not found, no timed run"
+    exit 0
+fi
+echo "global work" >"$work/globals.inc"
+step nasm -f elf32 -P "$work/globals.inc" -o "$work/regalloc.o" "$work/regalloc.asm"
+step "$cc" -m32 -O1 -ffreestanding -fno-pic -fno-stack-protector -nostdlib -static \
+    -DITERATIONS="${2:-3000000}" -o "$work/driver" bench/regalloc/driver.c "$work/regalloc.o"
+for run in 1 2 3; do
+    "$work/driver" || exit 1
+done
@@ -0,0 +1,98 @@
+// Comprueba las funciones de ops.c contra la operación sin reducir: todos los
+// x de 16 bits (y un bit más), los extremos de int y valores aleatorios de
+// 32 bits. Se enlaza sin libc (i386 Linux): imprime los primeros fallos con
+// write y devuelve su número como código de salida.
+#include "table.h"
+
+#define CASES (int)(sizeof(cases) / sizeof(cases[0]))
+#define RANDOM_PER_CASE 200000
+#define REPORTED 10
+
+static unsigned state = 2463534242u;
+static int fails;
+
+static unsigned next_random(void)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static void write_text(const char *text)
+{
+    int length = 0;
+    while (text[length])
+        length++;
+    int result;
+    __asm__ volatile("int $0x80" : "=a"(result) : "a"(4), "b"(1), "c"(text), "d"(length) : "memory");
+    (void)result;
+}
+
+static void write_number(int value)
+{
+    char buffer[16];
+    char *p = buffer + sizeof(buffer) - 1;
+    unsigned magnitude = value < 0 ? 0u - (unsigned)value : (unsigned)value;
+    *p = '\0';
+    do
+        *--p = (char)('0' + magnitude % 10);
+    while (magnitude /= 10);
+    if (value < 0)
+        *--p = '-';
+    write_text(p);
+}
+
+// La referencia en C: INT_MIN / -1 desborda, jamz (como idiv con envoltura)
+// da INT_MIN y resto 0
+static int expected(char op, int x, int c)
+{
+    if (op == 'p')
+        return (int)((unsigned)x * (unsigned)c);
+    if (c == -1)
+        return op == 'd' ? (int)(0u - (unsigned)x) : 0;
+    return op == 'd' ? x / c : x % c;
+}
+
+static void check(int t, int x)
+{
+    int got = cases[t].f(x);
+    int want = expected(cases[t].op, x, cases[t].c);
+    if (got == want || fails++ >= REPORTED)
+        return;
+    write_text(cases[t].op == 'p' ? "x * " : cases[t].op == 'd' ? "x / " : "x % ");
+    write_number(cases[t].c);
+    write_text(" with x = ");
+    write_number(x);
+    write_text(": got ");
+    write_number(got);
+    write_text(", expected ");
+    write_number(want);
+    write_text("\n");
+}
+
+int run(void)
+{
+    for (int t = 0; t < CASES; t++)
+    {
+        for (int x = -65536; x <= 65535; x++)
+            check(t, x);
+        check(t, 2147483647);
+        check(t, -2147483647);
+        check(t, -2147483647 - 1);
+        for (int r = 0; r < RANDOM_PER_CASE; r++)
+            check(t, (int)next_random());
+    }
+    write_number(CASES);
+    write_text(" functions checked, ");
+    write_number(fails);
+    write_text(" failures\n");
+    return fails > 255 ? 255 : fails;
+}
+
+__asm__(".globl _start\n"
+        "_start:\n"
+        "    call run\n"
+        "    mov %eax, %ebx\n"
+        "    mov $1, %eax\n"
+        "    int $0x80\n");
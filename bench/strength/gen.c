@@ -0,0 +1,120 @@
+// Genera el programa de prueba de la reducción de fuerza: una función por
+// constante y operación (x * c, x / c, x % c) en ops.c, la tabla que usa
+// check.c en table.h y las directivas global que necesita nasm en
+// globals.inc. Uso: gen <directorio>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_CONSTANTS 512
+
+static long long constants[MAX_CONSTANTS];
+static int constant_count;
+
+static void add(long long c)
+{
+    for (int i = 0; i < constant_count; i++)
+        if (constants[i] == c)
+            return;
+    constants[constant_count++] = c;
+}
+
+static int compare(const void *a, const void *b)
+{
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+// jamz no tiene literales negativos: el signo se escribe como una resta
+static void literal(FILE *file, long long c)
+{
+    if (c == -2147483648LL)
+        fprintf(file, "0 - 2147483647 - 1");
+    else if (c < 0)
+        fprintf(file, "0 - %lld", -c);
+    else
+        fprintf(file, "%lld", c);
+}
+
+static FILE *open_output(const char *directory, const char *name)
+{
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", directory, name);
+    FILE *file = fopen(path, "w");
+    if (!file)
+    {
+        perror(path);
+        exit(1);
+    }
+    return file;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s <directory>\n", argv[0]);
+        return 1;
+    }
+
+    // Pequeñas, potencias de dos y sus vecinas, y las que tienen multiplicador
+    // mágico con suma (7, 641, 2^31 - 1...)
+    for (int c = 1; c <= 40; c++)
+        add(c);
+    static const long long others[] = {45, 81, 25, 27, 15, 31, 63, 127, 255, 257, 1025, 100,
+                                       641, 1000, 12345, 65535, 65536, 3 << 20, 5 << 10,
+                                       9 << 7, 2147483647};
+    for (size_t i = 0; i < sizeof(others) / sizeof(others[0]); i++)
+        add(others[i]);
+    for (int k = 1; k <= 30; k++)
+    {
+        add(1LL << k);
+        add((1LL << k) + 1);
+        add((1LL << k) - 1);
+    }
+    int positive = constant_count;
+    for (int i = 0; i < positive; i++)
+        add(-constants[i]);
+    add(-2147483648LL);
+    qsort(constants, constant_count, sizeof(constants[0]), compare);
+
+    static const struct
+    {
+        char tag;
+        const char *op;
+    } ops[] = {{'p', "*"}, {'d', "/"}, {'m', "%"}};
+
+    FILE *source = open_output(argv[1], "ops.c");
+    FILE *table = open_output(argv[1], "table.h");
+    FILE *globals = open_output(argv[1], "globals.inc");
+
+    fprintf(table, "typedef int (*Operation)(int);\n");
+    for (int i = 0; i < constant_count; i++)
+        for (int o = 0; o < 3; o++)
+        {
+            fprintf(source, "int %c%d(int x)\n{\n    int c = ", ops[o].tag, i);
+            literal(source, constants[i]);
+            fprintf(source, ";\n    return x %s c;\n}\n\n", ops[o].op);
+            fprintf(table, "int %c%d(int);\n", ops[o].tag, i);
+            fprintf(globals, "global %c%d\n", ops[o].tag, i);
+        }
+    fprintf(source, "int main()\n{\n    return 0;\n}\n");
+
+    fprintf(table, "static const struct { Operation f; char op; int c; } cases[] = {\n");
+    for (int i = 0; i < constant_count; i++)
+        for (int o = 0; o < 3; o++)
+        {
+            fprintf(table, "    {%c%d, '%c', ", ops[o].tag, i, ops[o].tag);
+            if (constants[i] == -2147483648LL)
+                fprintf(table, "-2147483647 - 1},\n");
+            else
+                fprintf(table, "%lld},\n", constants[i]);
+        }
+    fprintf(table, "};\n");
+
+    fclose(source);
+    fclose(table);
+    fclose(globals);
+    printf("%d constants, %d functions\n", constant_count, constant_count * 3);
+    return 0;
+}
@@ -0,0 +1,29 @@
+#!/bin/sh
+# Multiplicación, división y módulo por constante contra la operación sin
+# reducir: bench/strength/gen.c escribe una función jamz por constante
+# (positivas, negativas e INT_MIN), cjamz las traduce a ensamblador y
+# bench/strength/check.c las prueba con todos los x de 16 bits y valores
+# aleatorios de 32. Necesita nasm y un cc que genere código i386. Se
+# ejecuta desde la raíz del repositorio (data/ es relativo):
+# sh bench/strength/run.sh
+# Si algún paso falla, o algún resultado no coincide, termina con error.
+work=${TMPDIR:-/tmp}/jamz-strength
+cc=${CC:-cc}
+mkdir -p "$work" || exit 1
+
+step() {
+    "$@" >"$work/step.log" 2>&1 || {
+        cat "$work/step.log" >&2
+        echo "$* failed" >&2
+        exit 1
+    }
+}
+
+step "$cc" -O2 -o "$work/gen" bench/strength/gen.c
+"$work/gen" "$work" || exit 1
+rm -f "$work/ops.asm"
+step ./bin/cjamz "$work/ops.c"
+step nasm -f elf32 -P "$work/globals.inc" -o "$work/ops.o" "$work/ops.asm"
+step "$cc" -m32 -O1 -ffreestanding -fno-pic -fno-stack-protector -nostdlib -static \
+    -I"$work" -o "$work/check" bench/strength/check.c "$work/ops.o"
+"$work/check"
@@ -0,0 +1,23 @@
+#!/bin/sh
+# Un ámbito con muchos nombres para la tabla de símbolos:
+# sh bench/symbols/gen.sh <variables>
+# Declara v0..v(n-1) y luego asigna a cada una en un orden disperso (un paso
+# coprimo con n), así que cada asignación busca un nombre distinto.
+awk -v count="${1:-100000}" '
+function gcd(a, b) {
+    while (b) {
+        t = a % b; a = b; b = t
+    }
+    return a
+}
+BEGIN {
+    step = 7919
+    while (gcd(step, count) != 1)
+        step++
+    printf "int main()\n{\n"
+    for (i = 0; i < count; i++)
+        printf "    int v%d = %d;\n", i, i % 1000
+    for (i = 0; i < count; i++)
+        printf "    v%d = %d;\n", (i * step) % count, i % 1000
+    printf "    return v0;\n}\n"
+}'
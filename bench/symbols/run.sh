@@ -0,0 +1,20 @@
+#!/bin/sh
+# Tabla de símbolos con muchos nombres en un ámbito: tiempo del análisis
+# semántico sobre el programa de bench/symbols/gen.sh. Se ejecuta desde la
+# raíz del repositorio (data/ es relativo):
+# sh bench/symbols/run.sh [variables]
+# Si cjamz falla o no llega a imprimir el tiempo del análisis, el benchmark
+# termina con error.
+source=${TMPDIR:-/tmp}/jamz-symbols.c
+sh bench/symbols/gen.sh "${1:-100000}" >"$source" || exit 1
+output=$(./bin/cjamz "$source" 2>&1) || {
+    echo "cjamz $source failed" >&2
+    exit 1
+}
+line=$(printf '%s\n' "$output" | grep -a "Semantic analysis:")
+if [ -z "$line" ]; then
+    echo "cjamz did not report the semantic analysis" >&2
+    exit 1
+fi
+printf '%s\n' "$line"
+rm -f "$source"
@@ -0,0 +1,25 @@
+int main()
+{
+    int n = 4000;
+    int a[4000];
+    int b[4000];
+    int c[4000];
+    for (int i = 0; i < n; i = i + 1)
+    {
+        a[i] = i * 3;
+        b[i] = 7 - i;
+    }
+    for (int r = 0; r < 5000; r = r + 1)
+    {
+        for (int i = 0; i < n; i = i + 1)
+        {
+            c[i] = a[i] + b[i];
+        }
+    }
+    int sum = 0;
+    for (int i = 0; i < n; i = i + 1)
+    {
+        sum = sum * 31 + c[i];
+    }
+    return sum;
+}
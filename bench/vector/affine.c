@@ -0,0 +1,23 @@
+int main()
+{
+    int n = 4000;
+    int a[4000];
+    int b[4000];
+    for (int i = 0; i < n; i = i + 1)
+    {
+        a[i] = i * 7 + 3;
+    }
+    for (int r = 0; r < 5000; r = r + 1)
+    {
+        for (int i = 0; i < n; i = i + 1)
+        {
+            b[i] = a[i] * 3 - 7;
+        }
+    }
+    int sum = 0;
+    for (int i = 0; i < n; i = i + 1)
+    {
+        sum = sum * 31 + b[i];
+    }
+    return sum;
+}
@@ -0,0 +1,27 @@
+int main()
+{
+    int n = 3999;
+    int a[4000];
+    int b[4000];
+    int c[4000];
+    int d[4000];
+    for (int i = 0; i < n; i = i + 1)
+    {
+        a[i] = i;
+        b[i] = i % 13;
+        c[i] = 100 - i;
+    }
+    for (int r = 0; r < 5000; r = r + 1)
+    {
+        for (int i = 0; i < n; i = i + 1)
+        {
+            d[i] = (a[i] - b[i]) * (a[i] + b[i]) + c[i];
+        }
+    }
+    int sum = 0;
+    for (int i = 0; i < n; i = i + 1)
+    {
+        sum = sum * 31 + d[i];
+    }
+    return sum;
+}
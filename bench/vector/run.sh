@@ -0,0 +1,15 @@
+#!/bin/sh
+# Núcleos elemento a elemento con y sin vectorizar. Se ejecuta desde la raíz
+# del repositorio (data/ es relativo): sh bench/vector/run.sh [--jit|--vm]
+# Si el compilador falla o aborta, el benchmark termina con error.
+mode=${1:---jit}
+for kernel in bench/vector/*.c; do
+    for isa in off sse2 avx2; do
+        output=$(JAMZ_VECTOR=$isa ./bin/cjamz "$mode" "$kernel" 2>&1) || {
+            echo "$kernel ($isa): cjamz $mode failed" >&2
+            exit 1
+        }
+        line=$(printf '%s\n' "$output" | grep -a "returned")
+        printf '%-28s %-5s %s\n' "$kernel" "$isa" "$line"
+    done
+done
@@ -0,0 +1,25 @@
+int main()
+{
+    int n = 4000;
+    int x[4000];
+    int y[4000];
+    int k = 3;
+    for (int i = 0; i < n; i = i + 1)
+    {
+        x[i] = i % 17;
+        y[i] = i;
+    }
+    for (int r = 0; r < 5000; r = r + 1)
+    {
+        for (int i = 0; i < n; i = i + 1)
+        {
+            y[i] = k * x[i] + y[i];
+        }
+    }
+    int sum = 0;
+    for (int i = 0; i < n; i = i + 1)
+    {
+        sum = sum * 31 + y[i];
+    }
+    return sum;
+}
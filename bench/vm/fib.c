@@ -0,0 +1,16 @@
+int fib(int n)
+{
+    if (n)
+    {
+        if (n - 1)
+        {
+            return fib(n - 1) + fib(n - 2);
+        }
+    }
+    return n;
+}
+
+int main()
+{
+    return fib(30);
+}
@@ -0,0 +1,40 @@
+#!/bin/sh
+# Máquina virtual de bytecode sobre bench/vm/fib.c (2.7M llamadas): la
+# despachada con goto computado, la de switch (JAMZ_VM_NO_COMPUTED_GOTO) y
+# --jit como referencia. Las dos variantes se compilan aquí con los mismos
+# CFLAGS (por defecto -O2). Se ejecuta desde la raíz del repositorio (data/
+# es relativo): sh bench/vm/run.sh
+# Si la compilación o alguna ejecución falla, el benchmark termina con error.
+source=bench/vm/fib.c
+work=${TMPDIR:-/tmp}/jamz-vm
+cc=${CC:-cc}
+flags=${CFLAGS:--O2 -std=c99 -Iinclude -pthread}
+mkdir -p "$work" || exit 1
+
+# $flags se parte en palabras a propósito; la salida del compilador solo se
+# muestra si falla
+build() {
+    $cc $flags "$@" main.c src/*.c >"$work/build.log" 2>&1 || {
+        cat "$work/build.log" >&2
+        exit 1
+    }
+}
+build -o "$work/cjamz-goto"
+build -DJAMZ_VM_NO_COMPUTED_GOTO -o "$work/cjamz-switch"
+
+run() {
+    label=$1
+    shift
+    output=$("$@" "$source" 2>&1) || {
+        echo "$* $source failed" >&2
+        exit 1
+    }
+    printf '%-14s %s\n' "$label" "$(printf '%s\n' "$output" | grep -a "main returned")"
+}
+
+for i in 1 2 3; do
+    run "computed goto" "$work/cjamz-goto" --vm
+    run "switch" "$work/cjamz-switch" --vm
+    run "jit" "$work/cjamz-goto" --jit
+done
+rm -f "$work/cjamz-goto" "$work/cjamz-switch" "$work/build.log" bench/vm/fib.asm
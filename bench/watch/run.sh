@@ -0,0 +1,203 @@
+#!/bin/sh
+# Sesión incremental de --watch: edita un archivo vigilado y comprueba, en
+# cada versión, cuántas funciones se vuelven a analizar y qué diagnósticos
+# salen (con su línea). Cubre un desplazamiento de líneas, que reutiliza
+# todo y mueve los diagnósticos, y un cambio de firma, que obliga a volver a
+# analizar a quien llama. Se ejecuta desde la raíz del repositorio (data/ es
+# relativo): sh bench/watch/run.sh
+# Termina con error en cuanto una versión no da lo esperado.
+work=${TMPDIR:-/tmp}/jamz-watch
+source=$work/watched.c
+log=$work/watch.out
+mkdir -p "$work" || exit 1
+
+# Cada versión se escribe aparte y se mueve: cjamz nunca lee una a medias
+version() {
+    cat >"$work/next.c" && mv "$work/next.c" "$source"
+}
+
+checks=0
+# expect "<analizadas> analyzed, <reutilizadas> reused" [diagnóstico...]
+expect() {
+    checks=$((checks + 1))
+    tries=0
+    while [ "$(grep -a -c "Checked in" "$log")" -lt "$checks" ]; do
+        tries=$((tries + 1))
+        if [ "$tries" -gt 100 ] || ! kill -0 "$watcher" 2>/dev/null; then
+            echo "version $checks: cjamz --watch did not check it" >&2
+            exit 1
+        fi
+        sleep 0.1
+    done
+    # Salida de esta versión: desde el "Checked in" anterior hasta el suyo
+    segment=$(awk -v n="$checks" '/Checked in/ { seen++; if (seen == n) { print; exit } next } seen == n - 1' "$log")
+    counts=$1
+    shift
+    if ! printf '%s\n' "$segment" | grep -a -q "function(s) analyzed, .*reused" ||
+        ! printf '%s\n' "$segment" | grep -a -q "($counts)"; then
+        echo "version $checks: expected ($counts), got: $(printf '%s\n' "$segment" | grep -a "Checked in")" >&2
+        exit 1
+    fi
+    found=$(printf '%s\n' "$segment" | grep -a -c "Compiler error [0-9]*:")
+    if [ "$found" -ne $# ]; then
+        echo "version $checks: expected $# diagnostic(s), got $found" >&2
+        printf '%s\n' "$segment" | grep -a "Compiler error" >&2
+        exit 1
+    fi
+    for diagnostic in "$@"; do
+        if ! printf '%s\n' "$segment" | grep -a -q -F "$diagnostic"; then
+            echo "version $checks: missing diagnostic: $diagnostic" >&2
+            exit 1
+        fi
+    done
+    echo "version $checks: $counts, $# diagnostic(s) as expected"
+    # El reloj de vigilancia ve la siguiente escritura como un cambio
+    sleep 0.3
+}
+
+version <<'JAMZ'
+int twice(int x)
+{
+    return x * 2;
+}
+
+int quad(int x)
+{
+    return twice(twice(x));
+}
+
+int broken()
+{
+    return y;
+}
+
+int main()
+{
+    return quad(3) + broken();
+}
+JAMZ
+
+./bin/cjamz --watch "$source" >"$log" 2>&1 &
+watcher=$!
+trap 'kill "$watcher" 2>/dev/null' EXIT
+
+expect "4 function(s) analyzed, 0 reused" "Variable 'y' no declarada (línea 13,"
+
+# Tres líneas más arriba: nada cambia de texto, todo se reutiliza y el
+# diagnóstico guardado baja tres líneas
+version <<'JAMZ'
+
+
+
+int twice(int x)
+{
+    return x * 2;
+}
+
+int quad(int x)
+{
+    return twice(twice(x));
+}
+
+int broken()
+{
+    return y;
+}
+
+int main()
+{
+    return quad(3) + broken();
+}
+JAMZ
+expect "0 function(s) analyzed, 4 reused" "Variable 'y' no declarada (línea 16,"
+
+# Nueva firma de twice: su texto cambia y quad, que no cambia, la llama con
+# otra firma, así que también se vuelve a analizar
+version <<'JAMZ'
+
+
+
+int twice(int x, int y)
+{
+    return x * y;
+}
+
+int quad(int x)
+{
+    return twice(twice(x));
+}
+
+int broken()
+{
+    return y;
+}
+
+int main()
+{
+    return quad(3) + broken();
+}
+JAMZ
+expect "2 function(s) analyzed, 2 reused" \
+    "La función 'twice' espera 2 argumentos pero recibe 1 (línea 11, col 12)" \
+    "La función 'twice' espera 2 argumentos pero recibe 1 (línea 11, col 18)" \
+    "Variable 'y' no declarada (línea 16,"
+
+# Se arregla solo broken, una línea más abajo: quad conserva sus errores
+version <<'JAMZ'
+
+
+
+
+int twice(int x, int y)
+{
+    return x * y;
+}
+
+int quad(int x)
+{
+    return twice(twice(x));
+}
+
+int broken()
+{
+    return 0;
+}
+
+int main()
+{
+    return quad(3) + broken();
+}
+JAMZ
+expect "1 function(s) analyzed, 3 reused" \
+    "La función 'twice' espera 2 argumentos pero recibe 1 (línea 12, col 12)" \
+    "La función 'twice' espera 2 argumentos pero recibe 1 (línea 12, col 18)"
+
+# Vuelve la firma original: twice y quad se analizan de nuevo y no queda
+# ningún error
+version <<'JAMZ'
+
+
+
+
+int twice(int x)
+{
+    return x * 2;
+}
+
+int quad(int x)
+{
+    return twice(twice(x));
+}
+
+int broken()
+{
+    return 0;
+}
+
+int main()
+{
+    return quad(3) + broken();
+}
+JAMZ
+expect "2 function(s) analyzed, 2 reused"
+rm -f "$source" "$log"
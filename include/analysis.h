@@ -0,0 +1,13 @@
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include "parser.h"
+
+// Análisis de flujo de datos sobre el AST ya resuelto por el análisis
+// semántico: variables usadas sin inicializar, asignaciones muertas y, con
+// rangos de enteros, divisiones por cero y desbordamientos. Anota en cada
+// división si sus operandos son no negativos (binary.non_negative).
+// Imprime las advertencias ordenadas por posición y devuelve cuántas hubo.
+size_t analyze_dataflow(JAMZASTNode *program);
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef ASM_H
+#define ASM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "output.h"
+
+// Ensamblador ya separado en campos, para que las pasadas posteriores a la
+// emisión (mirilla) trabajen sobre instrucciones y no sobre texto
+typedef enum
+{
+    JAMZ_ASM_INSTRUCTION,
+    JAMZ_ASM_LABEL,
+    JAMZ_ASM_COMMENT,
+} JAMZAsmKind;
+
+#define JAMZ_ASM_MAX_OPERANDS 3 // imul dst, src, imm
+
+// Los textos son posiciones en el almacén de cadenas del búfer: así crecer
+// el almacén no invalida las líneas ya emitidas
+typedef struct
+{
+    JAMZAsmKind kind;
+    uint32_t mnemonic; // Nombre de la etiqueta o texto del comentario en su caso
+    uint32_t operands[JAMZ_ASM_MAX_OPERANDS];
+    int operand_count;
+} JAMZAsmLine;
+
+typedef struct
+{
+    JAMZAsmLine *lines;
+    size_t count;
+    size_t capacity;
+    char *text;
+    size_t text_size;
+    size_t text_capacity;
+} JAMZAsmBuffer;
+
+void asm_buffer_init(JAMZAsmBuffer *buffer);
+void asm_buffer_free(JAMZAsmBuffer *buffer);
+void asm_buffer_clear(JAMZAsmBuffer *buffer);
+void asm_append_line(JAMZAsmBuffer *buffer, const JAMZAsmLine *line);
+void asm_label(JAMZAsmBuffer *buffer, const char *name);
+void asm_comment(JAMZAsmBuffer *buffer, const char *text);
+void asm_buffer_render(const JAMZAsmBuffer *buffer, JAMZOutputBuffer *output);
+
+// Construcción de un texto por piezas: asm_text_start da su posición,
+// asm_text_append copia cada pieza y asm_text_end lo termina
+uint32_t asm_text_start(const JAMZAsmBuffer *buffer);
+void asm_text_append(JAMZAsmBuffer *buffer, const char *text, size_t length);
+uint32_t asm_text_end(JAMZAsmBuffer *buffer, uint32_t start);
+const char *asm_text(const JAMZAsmBuffer *buffer, uint32_t offset);
+
+#endif
@@ -1,7 +1,15 @@
 #ifndef COMPILE_H
 #define COMPILE_H
 
-#include "parser.h"
+#include "ir.h"
+#include "output.h"
+#include "peephole.h"
 #include "utils.h"
-void generate_asm(const JAMZASTNode *ast, const char *output_filename);
+// Compone el ensamblador de todo el programa en output; quien llama decide
+// dónde volcarlo. stats acumula las reglas de mirilla aplicadas. Con un
+// programa instrumentado (profile.h) y profile_filename, cada bloque suma
+// su contador y main registra con atexit el volcado del perfil a ese
+// archivo, enlazando con la libc.
+bool generate_asm(const JAMZIRProgram *program, JAMZOutputBuffer *output, JAMZPeepholeStats *stats,
+                  const char *profile_filename);
 #endif 
\ No newline at end of file
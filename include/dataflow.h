@@ -0,0 +1,96 @@
+#ifndef DATAFLOW_H
+#define DATAFLOW_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Conjunto de bits denso; las operaciones recorren palabras de 64 bits
+typedef uint64_t JAMZBitWord;
+
+typedef struct
+{
+    JAMZBitWord *words;
+    size_t word_count;
+} JAMZBitset;
+
+#define JAMZ_BITSET_WORDS(bits) (((bits) + 63) / 64)
+
+void jamz_bitset_set(JAMZBitset set, size_t bit);
+void jamz_bitset_clear(JAMZBitset set, size_t bit);
+bool jamz_bitset_test(JAMZBitset set, size_t bit);
+void jamz_bitset_fill(JAMZBitset set, bool value);
+void jamz_bitset_copy(JAMZBitset dst, JAMZBitset src);
+void jamz_bitset_union(JAMZBitset dst, JAMZBitset src);
+void jamz_bitset_intersect(JAMZBitset dst, JAMZBitset src);
+void jamz_bitset_subtract(JAMZBitset dst, JAMZBitset src);
+bool jamz_bitset_equal(JAMZBitset a, JAMZBitset b);
+
+// Grafo de flujo en formato CSR. Los nodos son bloques básicos de cualquier
+// representación (AST o IR); el orden postorden inverso se calcula al crearlo.
+typedef struct
+{
+    size_t node_count;
+    size_t entry;
+    size_t *succ_start; // Sucesores de n: succs[succ_start[n] .. succ_start[n + 1])
+    size_t *succs;
+    size_t *pred_start;
+    size_t *preds;
+    size_t *rpo;       // Nodos alcanzables en postorden inverso
+    size_t rpo_count;
+    size_t *rpo_index; // Posición de cada nodo en rpo, o SIZE_MAX si es inalcanzable
+} JAMZFlowGraph;
+
+typedef struct
+{
+    size_t from;
+    size_t to;
+} JAMZFlowEdge;
+
+void jamz_flow_graph_init(JAMZFlowGraph *graph, size_t node_count, size_t entry,
+                          const JAMZFlowEdge *edges, size_t edge_count);
+void jamz_flow_graph_free(JAMZFlowGraph *graph);
+
+// Dominador inmediato de cada nodo (algoritmo de Cooper, Harvey y Kennedy).
+// El de la entrada es ella misma y el de los nodos inalcanzables SIZE_MAX.
+size_t *jamz_flow_graph_dominators(const JAMZFlowGraph *graph);
+// Frontera de dominancia de cada nodo en CSR: list[start[n] .. start[n + 1]).
+// Sobre el grafo invertido da la frontera de postdominancia.
+void jamz_dominance_frontier(const JAMZFlowGraph *graph, const size_t *idom,
+                             size_t **out_start, size_t **out_list);
+
+typedef enum
+{
+    JAMZ_DATAFLOW_FORWARD,
+    JAMZ_DATAFLOW_BACKWARD,
+} JAMZDataflowDirection;
+
+typedef enum
+{
+    JAMZ_DATAFLOW_UNION,        // "puede": algún camino
+    JAMZ_DATAFLOW_INTERSECTION, // "debe": todos los caminos
+} JAMZDataflowMeet;
+
+// Problema de tipo gen/kill: salida = gen ∪ (entrada − kill). Para un problema
+// hacia atrás "in" es el valor al inicio del bloque y "out" al final, igual
+// que hacia delante; boundary es el valor en la entrada (o en las salidas).
+typedef struct
+{
+    JAMZDataflowDirection direction;
+    JAMZDataflowMeet meet;
+    size_t bit_count;
+    size_t node_count;
+    JAMZBitset *gen;
+    JAMZBitset *kill;
+    JAMZBitset *in;
+    JAMZBitset *out;
+    JAMZBitset boundary;
+    JAMZBitWord *storage; // Todos los conjuntos en un único bloque contiguo
+} JAMZDataflowProblem;
+
+void jamz_dataflow_init(JAMZDataflowProblem *problem, const JAMZFlowGraph *graph,
+                        JAMZDataflowDirection direction, JAMZDataflowMeet meet, size_t bit_count);
+size_t jamz_dataflow_solve(JAMZDataflowProblem *problem, const JAMZFlowGraph *graph);
+void jamz_dataflow_free(JAMZDataflowProblem *problem);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef INLINE_H
+#define INLINE_H
+
+#include "ir.h"
+#include <stdio.h>
+
+// Resultado de la integración de funciones
+typedef struct
+{
+    size_t inlined; // Llamadas sustituidas por el cuerpo de la función
+    size_t kept;    // Llamadas que se quedan como están
+    size_t removed; // Funciones a las que ya no llama nadie
+    size_t instructions_before;
+    size_t instructions_after;
+} JAMZInlineStats;
+
+// Umbral por defecto: coste (tamaño menos lo que ahorra la llamada) que
+// admite una llamada fuera de bucles; dentro de un bucle se dobla. Con un
+// perfil leído (profile.h) se dobla en las llamadas calientes y las que no
+// se ejecutaron solo se integran si no cuestan nada.
+#define JAMZ_INLINE_DEFAULT_THRESHOLD 16
+
+// Integra en sus llamadas las funciones cuyo coste no pasa de threshold
+// (0 no integra nada). Recorre el grafo de llamadas de abajo arriba: cada
+// función recibe lo suyo antes de medirse para sus llamadores, y las
+// llamadas dentro de un ciclo (recursión) no se integran. Trabaja sobre la
+// IR recién generada, antes de SSA, para que las constantes de los
+// argumentos se propaguen por el cuerpo; la asignación de registros de cada
+// función se hace después sobre el código ya integrado. Si hay main, las
+// funciones que quedan sin llamadas se eliminan. Si report no es NULL
+// escribe allí la decisión tomada en cada llamada.
+JAMZInlineStats inline_functions(JAMZIRProgram *program, size_t threshold, FILE *report);
+
+#endif
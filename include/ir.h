@@ -0,0 +1,156 @@
+#ifndef IR_H
+#define IR_H
+
+#include "parser.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Representación intermedia lineal de tres direcciones. Cada función es un
+// arreglo contiguo de instrucciones sobre registros virtuales ilimitados;
+// las variables locales tienen un registro fijo y los temporales uno nuevo.
+typedef enum
+{
+    JAMZ_IR_CONST,  // dst = imm
+    JAMZ_IR_STRING, // dst = dirección de la cadena imm del programa
+    JAMZ_IR_PARAM,  // dst = parámetro número imm
+    JAMZ_IR_COPY,   // dst = a
+    JAMZ_IR_ADD,    // dst = a + b
+    JAMZ_IR_SUB,    // dst = a - b
+    JAMZ_IR_MUL,    // dst = a * b
+    JAMZ_IR_DIV,    // dst = a / b con signo
+    JAMZ_IR_UDIV,   // dst = a / b, operandos demostrados no negativos
+    JAMZ_IR_MOD,    // dst = a % b con signo (el resto toma el signo de a)
+    JAMZ_IR_UMOD,   // dst = a % b, operandos demostrados no negativos
+    JAMZ_IR_EQ,     // dst = a == b (0 o 1); las comparaciones son con signo
+    JAMZ_IR_NE,     // dst = a != b
+    JAMZ_IR_LT,     // dst = a < b
+    JAMZ_IR_LE,     // dst = a <= b
+    JAMZ_IR_GT,     // dst = a > b
+    JAMZ_IR_GE,     // dst = a >= b
+    JAMZ_IR_ARG,    // Apila a como argumento (de derecha a izquierda)
+    JAMZ_IR_CALL,   // dst = función imm del programa con los ARG previos
+    JAMZ_IR_LABEL,  // Etiqueta imm
+    JAMZ_IR_JUMP,   // Salta a la etiqueta imm
+    JAMZ_IR_BRANCH, // Si a == 0 salta a la etiqueta imm
+    JAMZ_IR_RET,    // Devuelve a (o nada si es JAMZ_IR_NONE)
+    JAMZ_IR_LOAD,   // dst = elemento a del arreglo imm de la función
+    JAMZ_IR_STORE,  // Elemento a del arreglo imm = b
+    JAMZ_IR_VLOOP,  // dst = índice en que se detiene el núcleo vectorial imm, recorrido desde a con b de límite
+    JAMZ_IR_COUNT,  // Pasada por el bloque imm del perfil (solo cuenta en un programa instrumentado)
+} JAMZIROp;
+
+#define JAMZ_IR_NONE (-1)
+
+typedef struct
+{
+    JAMZIROp op;
+    int32_t dst; // Registros virtuales, o JAMZ_IR_NONE
+    int32_t a;
+    int32_t b;
+    int32_t imm;
+    int line; // Línea del fuente, para diagnósticos y volcados
+} JAMZIRInstr;
+
+// Núcleo de un bucle vectorizado: una vuelta del cuerpo como operaciones por
+// carriles. Cada instrucción define el valor con su mismo número; los
+// invariantes van primero y se cargan una vez antes del bucle.
+typedef enum
+{
+    JAMZ_VEC_LOAD,  // Elemento i + imm del arreglo array
+    JAMZ_VEC_SPLAT, // Elemento 0 del arreglo array (un escalar invariante) en todos los carriles
+    JAMZ_VEC_CONST, // imm en todos los carriles
+    JAMZ_VEC_ADD,   // a + b
+    JAMZ_VEC_SUB,   // a - b
+    JAMZ_VEC_MUL,   // a * b (los 32 bits bajos)
+    JAMZ_VEC_STORE, // Elemento i + imm del arreglo array = a
+} JAMZVectorOp;
+
+typedef struct
+{
+    JAMZVectorOp op;
+    int32_t a;
+    int32_t b;
+    int32_t array;
+    int32_t imm;
+    int32_t reg; // Registro vectorial del valor (0..JAMZ_VECTOR_REGISTERS-1), o JAMZ_IR_NONE
+} JAMZVectorInstr;
+
+// Registros vectoriales para los valores del núcleo; los dos siguientes
+// quedan de temporales para la multiplicación
+#define JAMZ_VECTOR_REGISTERS 6
+// Instrucciones como mucho en un núcleo
+#define JAMZ_VECTOR_MAX_KERNEL 32
+
+typedef struct
+{
+    JAMZVectorInstr *code;
+    size_t count;
+    size_t invariant_count;
+    int32_t reference; // Arreglo cuya alineación decide cuántas vueltas se pelan
+} JAMZVectorKernel;
+
+typedef struct
+{
+    char *name;
+    JAMZIRInstr *code;
+    size_t count;
+    size_t capacity;
+    int32_t vreg_count;
+    int32_t label_count;
+    size_t param_count;
+    char **vreg_names; // Nombre de la variable de cada registro, o NULL si es temporal
+    int32_t *array_lengths; // Elementos de cada arreglo del marco
+    size_t array_count;
+    JAMZVectorKernel *kernels; // Los que leen las instrucciones VLOOP
+    size_t kernel_count;
+} JAMZIRFunction;
+
+// Bloques del perfil de una función, numerados desde first en todo el programa
+typedef struct
+{
+    char *function;
+    size_t first;
+    size_t blocks;
+} JAMZIRProfileRange;
+
+// Perfil de ejecución por bloques básicos (ver profile.h)
+typedef struct
+{
+    uint64_t *counts; // Pasadas por cada bloque, el índice es el imm de su COUNT
+    size_t count;
+    JAMZIRProfileRange *ranges; // Una por función, en el orden del AST
+    size_t range_count;
+    bool instrumented; // Los COUNT incrementan su contador al ejecutarse
+} JAMZIRProfile;
+
+typedef struct
+{
+    JAMZIRFunction *functions; // En el mismo orden que en el AST
+    size_t function_count;
+    char **strings; // Literales de cadena, sin comillas
+    size_t string_count;
+    size_t string_capacity;
+    JAMZIRProfile *profile; // NULL si no se instrumenta ni se usa un perfil
+} JAMZIRProgram;
+
+// Traduce el AST anotado por el análisis semántico a IR. Los operadores se
+// eligen con los hechos ya calculados (binary.non_negative para la división).
+JAMZIRProgram *lower_to_ir(const JAMZASTNode *program);
+// Comparación que da el resultado contrario (LT <-> GE, EQ <-> NE...), o la
+// que vale lo mismo con los operandos cambiados de lado (LT <-> GT)
+JAMZIROp jamz_ir_negate_comparison(JAMZIROp op);
+JAMZIROp jamz_ir_swap_comparison(JAMZIROp op);
+bool jamz_ir_is_comparison(JAMZIROp op);
+// Añade una instrucción al final de la función y devuelve su posición
+size_t ir_emit(JAMZIRFunction *function, JAMZIROp op, int32_t dst, int32_t a, int32_t b, int32_t imm, int line);
+// Nuevo registro virtual; name (copiado) es la variable que representa, o NULL
+int32_t ir_new_vreg(JAMZIRFunction *function, const char *name);
+// Nuevo arreglo de length elementos en el marco de la función; devuelve su número
+int32_t ir_new_array(JAMZIRFunction *function, int32_t length);
+void print_ir(const JAMZIRProgram *program, FILE *out);
+// Libera lo que cuelga de una función (no la propia estructura)
+void ir_free_function(JAMZIRFunction *function);
+void free_ir(JAMZIRProgram *program);
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include "ir.h"
+#include <stdbool.h>
+
+typedef struct
+{
+    bool ok;
+    int result;        // Valor devuelto por main
+    double compile_ms; // Codificación y colocación en memoria ejecutable
+    double run_ms;
+} JAMZJitResult;
+
+// Codifica el programa con el mismo generador que --obj, lo copia a memoria
+// propia (escritura y luego solo lectura y ejecución, nunca ambas) y llama a
+// main en el mismo proceso. Solo en anfitriones x86-64. Si el programa está
+// instrumentado, sus contadores quedan en program->profile al terminar.
+JAMZJitResult jit_run_main(const JAMZIRProgram *program);
+// El anfitrión puede ejecutar lo que genera jit_run_main
+bool jit_available(void);
+
+#endif
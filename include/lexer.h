@@ -21,7 +21,16 @@ typedef enum
     JAMZ_TOKEN_MAIN,
     JAMZ_TOKEN_UNKNOWN,
     JAMZ_TOKEN_CHAR,
-    JAMZ_TOKEN_FLOAT
+    JAMZ_TOKEN_FLOAT,
+    JAMZ_TOKEN_COMMA,
+    JAMZ_TOKEN_IF,
+    JAMZ_TOKEN_ELSE,
+    JAMZ_TOKEN_WHILE,
+    JAMZ_TOKEN_FOR,
+    JAMZ_TOKEN_BREAK,
+    JAMZ_TOKEN_CONTINUE,
+    JAMZ_TOKEN_LBRACKET,
+    JAMZ_TOKEN_RBRACKET
 } JAMZTokenType;
 
 typedef struct
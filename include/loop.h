@@ -0,0 +1,43 @@
+#ifndef LOOP_H
+#define LOOP_H
+
+#include "ssa.h"
+
+// Bucle natural: la cabecera y los bloques que llegan a una de sus aristas
+// de retroceso sin pasar por ella
+typedef struct
+{
+    size_t header;
+    size_t preheader; // Único predecesor de fuera, que solo salta a la cabecera, o SIZE_MAX
+    bool *body;       // Uno por bloque
+    size_t size;
+} JAMZLoop;
+
+// Variable de inducción básica: fase de la cabecera que vale init al entrar
+// y next = fase + step en cada vuelta (el mismo next en todas las aristas
+// de retroceso)
+typedef struct
+{
+    int32_t phi;
+    int32_t next;
+    int32_t init;
+    int32_t step;
+    size_t next_block;
+    size_t next_index;
+} JAMZInduction;
+
+// Bucles de la función, de los más internos (menos bloques) a los externos
+JAMZLoop *find_loops(const JAMZSSAFunction *ssa, size_t *out_count);
+void free_loops(JAMZLoop *loops, size_t count);
+
+// Reconoce phi (una fase de la cabecera) como variable de inducción básica;
+// el bucle necesita preheader
+bool find_basic_induction(const JAMZSSAFunction *ssa, const JAMZLoop *loop, const JAMZSSADefSites *defs,
+                          const JAMZSSAPhi *phi, JAMZInduction *iv);
+
+// Bucles: preheaders, código invariante fuera y reducción de fuerza de las
+// variables de inducción, de los bucles internos a los externos (lo que sale
+// de uno interno puede seguir saliendo del que lo contiene)
+void optimize_loops(JAMZSSAFunction *ssa);
+
+#endif
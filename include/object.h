@@ -0,0 +1,53 @@
+#ifndef OBJECT_H
+#define OBJECT_H
+
+#include "ir.h"
+#include "output.h"
+#include <stdbool.h>
+
+// Hueco rel32 de .text por resolver: etiqueta, función o cadena
+typedef struct
+{
+    size_t at;
+    int32_t target;
+} JAMZFixup;
+
+typedef struct
+{
+    JAMZFixup *items;
+    size_t count;
+    size_t capacity;
+} JAMZFixupList;
+
+// Código máquina de todo el programa antes de empaquetarlo; lo comparten el
+// objeto ELF y el modo --jit. Las llamadas ya están resueltas; las cadenas
+// (lea [rip + rel32] hacia data) las resuelve quien coloque data, y los
+// contadores de un programa instrumentado (inc [rip + rel32], solo con host)
+// quien coloque los del perfil.
+typedef struct
+{
+    const JAMZIRProgram *program;
+    JAMZOutputBuffer text;
+    JAMZOutputBuffer data; // Literales ya decodificados, terminados en '\0'
+    size_t *function_offsets;
+    size_t *function_sizes;
+    size_t *string_offsets; // Posición de cada cadena en data
+    JAMZFixupList calls;    // target: índice de la función
+    JAMZFixupList strings;  // target: índice de la cadena
+    JAMZFixupList counters; // target: contador del perfil
+    bool avx2;              // Núcleos vectoriales con ymm en lugar de xmm
+    bool host;              // Va a correr en este proceso (--jit)
+} JAMZMachineCode;
+
+// host: el código va a correr en este proceso (--jit), así que puede usar
+// AVX2 si el procesador lo tiene (ver jamz_vector_isa)
+void generate_machine_code(const JAMZIRProgram *program, JAMZMachineCode *code, bool host);
+void free_machine_code(JAMZMachineCode *code);
+
+// Traduce la IR directamente a código x86-64 y compone en output un objeto
+// ELF64 reubicable (.text, .data, tabla de símbolos y reubicaciones) que se
+// enlaza con ld/cc del sistema. Sigue la convención System V: los seis
+// primeros argumentos van en registros y el resultado en eax.
+bool generate_object(const JAMZIRProgram *program, JAMZOutputBuffer *output);
+
+#endif
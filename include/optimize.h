@@ -0,0 +1,18 @@
+#ifndef OPTIMIZE_H
+#define OPTIMIZE_H
+
+#include "parser.h"
+
+// Resultado de las pasadas de optimización sobre el AST
+typedef struct
+{
+    size_t folded;     // Operaciones aritméticas calculadas en compilación
+    size_t propagated; // Lecturas de variables sustituidas por su constante
+} JAMZOptimizeStats;
+
+// Pliega la aritmética entre literales enteros y propaga las constantes de
+// variables int que solo se asignan en su declaración. Requiere el AST ya
+// anotado por el análisis semántico y lo modifica en el sitio.
+JAMZOptimizeStats optimize_constants(JAMZASTNode *program);
+
+#endif
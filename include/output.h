@@ -0,0 +1,33 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Búfer de salida que crece según hace falta. El generador compone ahí el
+// .asm completo y lo vuelca con una sola escritura al final.
+typedef struct
+{
+    char *data;
+    size_t size;
+    size_t capacity;
+} JAMZOutputBuffer;
+
+void output_init(JAMZOutputBuffer *output);
+void output_free(JAMZOutputBuffer *output);
+void output_append(JAMZOutputBuffer *output, const char *text, size_t length);
+void output_string(JAMZOutputBuffer *output, const char *text);
+void output_char(JAMZOutputBuffer *output, char c);
+void output_int(JAMZOutputBuffer *output, long long value);
+// Escribe todo el contenido en el descriptor (reintenta las escrituras parciales)
+bool output_write_fd(const JAMZOutputBuffer *output, int fd);
+// Crea o sobrescribe el archivo con el contenido
+bool output_write_file(const JAMZOutputBuffer *output, const char *path);
+// Nombre de salida para un fuente: "dir/a.c" con ".asm" da "dir/a.asm"
+void output_filename(const char *input_filename, const char *extension, char *buffer, size_t size);
+// Para --stdout: reserva la salida estándar real y manda stdout a stderr,
+// de modo que solo el ensamblador llegue a la tubería. Devuelve el
+// descriptor reservado o -1.
+int output_detach_stdout(void);
+
+#endif
@@ -1,7 +1,9 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <stdint.h>
 #include "lexer.h"
+#include "types.h"
 
 typedef enum
 {
@@ -16,12 +18,18 @@ typedef enum
     JAMZ_AST_LITERAL,
     JAMZ_AST_VARIABLE,
     JAMZ_AST_PRINT,
+    JAMZ_AST_FUNCTION,
+    JAMZ_AST_CALL,
+    JAMZ_AST_WHILE,
+    JAMZ_AST_BREAK,
+    JAMZ_AST_CONTINUE,
+    JAMZ_AST_INDEX,
 } JAMZASTNodeType;
 
 // Declaración de variable
 typedef struct
 {
-    char *type_name; // "int", "char", etc.
+    JAMZTypeId type_id; // Tipo canónico internado ("int", "char*", etc.)
     char *var_name;
     struct JAMZASTNode *initializer; // Puede ser NULL
 } JAMZDeclaration;
@@ -30,6 +38,7 @@ typedef struct
 typedef struct
 {
     char *var_name;
+    struct JAMZASTNode *index; // Elemento de un arreglo (nombre[index] = value), o NULL
     struct JAMZASTNode *value;
 } JAMZAssignment;
 
@@ -39,6 +48,7 @@ typedef struct
     struct JAMZASTNode *left;
     char *op; // "+", "-", "*", "/"
     struct JAMZASTNode *right;
+    bool non_negative; // Ambos operandos >= 0 en toda ejecución (análisis de rangos)
 } JAMZBinaryExpr;
 
 // Variable
@@ -47,6 +57,13 @@ typedef struct
     char *var_name;
 } JAMZVariable;
 
+// Lectura de un elemento de arreglo: nombre[index]
+typedef struct
+{
+    char *var_name;
+    struct JAMZASTNode *index;
+} JAMZIndex;
+
 // Literal
 typedef struct
 {
@@ -54,6 +71,25 @@ typedef struct
     JAMZTokenType token_type; // <--- Añadido: tipo de token original (JAMZ_TOKEN_NUMBER, JAMZ_TOKEN_STRING, etc)
 } JAMZLiteral;
 
+// Definición de función
+typedef struct
+{
+    JAMZTypeId return_type;
+    char *name;
+    struct JAMZASTNode **params; // Nodos JAMZ_AST_DECLARATION sin inicializador
+    size_t param_count;
+    struct JAMZASTNode *body; // JAMZ_AST_BLOCK
+    uint64_t fingerprint;     // Huella de sus tokens, para el análisis incremental
+} JAMZFunction;
+
+// Llamada a función
+typedef struct
+{
+    char *name;
+    struct JAMZASTNode **args;
+    size_t arg_count;
+} JAMZCall;
+
 // Nodo principal del AST
 typedef struct JAMZASTNode
 {
@@ -64,7 +100,10 @@ typedef struct JAMZASTNode
         JAMZAssignment assignment;
         JAMZBinaryExpr binary;
         JAMZVariable variable;
+        JAMZIndex index;
         JAMZLiteral literal;
+        JAMZFunction function;
+        JAMZCall call;
         struct
         {
             struct JAMZASTNode **statements;
@@ -80,9 +119,21 @@ typedef struct JAMZASTNode
             struct JAMZASTNode *then_branch;
             struct JAMZASTNode *else_branch;
         } if_stmt;
+        // while y for: un for se reescribe como un bloque con su
+        // inicialización seguido del bucle, cuyo paso corre tras cada
+        // vuelta (también tras un continue)
+        struct
+        {
+            struct JAMZASTNode *condition; // NULL: el bucle no termina por sí solo
+            struct JAMZASTNode *body;
+            struct JAMZASTNode *step; // NULL en un while
+        } while_stmt;
     };
     int line;
     int column;
+    // Resultado del análisis semántico, calculado una sola vez por nodo
+    JAMZTypeId inferred_type;
+    struct Symbol *symbol; // Declaración resuelta (variables, asignaciones, declaraciones)
 } JAMZASTNode;
 
 typedef struct
@@ -0,0 +1,31 @@
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+
+#include "asm.h"
+
+typedef enum
+{
+    JAMZ_PEEPHOLE_SELF_MOVE,    // mov X, X
+    JAMZ_PEEPHOLE_STORE_RELOAD, // mov A, B seguido de mov B, A
+    JAMZ_PEEPHOLE_DEAD_MOVE,    // mov D, X seguido de mov D, Y que no lee D
+    JAMZ_PEEPHOLE_IDENTITY,     // add/sub X, 0 e imul X, 1
+    JAMZ_PEEPHOLE_JUMP_TO_NEXT, // jmp a la etiqueta que viene justo después
+    JAMZ_PEEPHOLE_UNREACHABLE,  // Código tras jmp o ret hasta la siguiente etiqueta
+    JAMZ_PEEPHOLE_RULE_COUNT,
+} JAMZPeepholeRule;
+
+// Veces que se aplicó cada regla e instrucciones que quedan; se acumula
+// entre llamadas
+typedef struct
+{
+    size_t fired[JAMZ_PEEPHOLE_RULE_COUNT];
+    size_t instructions;
+} JAMZPeepholeStats;
+
+// Optimización de mirilla sobre el código de una función. Las reglas miran
+// una ventana al final de la salida ya optimizada; cuando una se aplica se
+// vuelven a probar todas, así que un cambio puede habilitar el siguiente.
+void peephole_optimize(JAMZAsmBuffer *buffer, JAMZPeepholeStats *stats);
+const char *jamz_peephole_rule_name(JAMZPeepholeRule rule);
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "ir.h"
+#include "ssa.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+// Primera línea del archivo de perfil
+#define JAMZ_PROFILE_HEADER "# jamz profile: function, blocks, passes per block"
+
+// Pone un COUNT al principio de cada bloque básico de la IR recién generada
+// (antes de integrar y optimizar) y crea program->profile con un contador
+// por bloque. Con instrumented los backends incrementan el contador en cada
+// pasada; si no, COUNT no genera nada y solo dice a las fases siguientes de
+// qué bloque del fuente viene cada instrucción. Como la numeración depende
+// únicamente del fuente, la compilación instrumentada y la que lee el
+// perfil dan a cada bloque el mismo contador.
+void profile_insert_counters(JAMZIRProgram *program, bool instrumented);
+
+// Texto, una línea por función: nombre, número de bloques y pasadas por
+// cada bloque en orden
+bool profile_write(const JAMZIRProgram *program, const char *filename);
+
+// Carga los contadores de un perfil escrito por profile_write. Una función
+// que no aparece o cuyo número de bloques no coincide (el fuente cambió) se
+// queda a 0, y así se compila como sin perfil; si report no es NULL se
+// avisa allí. Devuelve false si el archivo no se puede leer.
+bool profile_read(JAMZIRProgram *program, const char *filename, size_t *matched, FILE *report);
+
+// Pasadas por bloque para guiar la compilación, o NULL si no hay un perfil
+// leído (sin COUNT o con el programa instrumentado)
+const uint64_t *profile_weights(const JAMZIRProgram *program);
+
+// Resumen por función: entradas, bloque más caliente y bloques sin ejecutar
+void profile_print(const JAMZIRProgram *program, FILE *out);
+
+// Pasadas de cada bloque SSA según el perfil leído (ssa->weights), o NULL si
+// el perfil no dice nada de la función
+uint64_t *profile_block_weights(const JAMZSSAFunction *ssa);
+
+// Invierte los saltos condicionales cuyo destino es más caliente que la
+// caída, para que la colocación pueda poner detrás la rama caliente
+void profile_invert_branches(JAMZSSAFunction *ssa, const uint64_t *weight, const size_t *use_start);
+
+// Orden de emisión de los bloques según el perfil (Pettis y Hansen); sustituye
+// a ssa_block_layout cuando hay pesos
+size_t *profile_layout(JAMZSSAFunction *ssa, const uint64_t *weight);
+
+#endif
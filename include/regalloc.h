@@ -0,0 +1,47 @@
+#ifndef REGALLOC_H
+#define REGALLOC_H
+
+#include "ir.h"
+#include <stdbool.h>
+
+// Registros que reparte el asignador. eax queda fuera: es el acumulador de
+// las plantillas y el valor de retorno. ecx y edx los pisan las llamadas
+// (cdecl) y la división, así que solo reciben valores que no las cruzan.
+typedef enum
+{
+    JAMZ_REG_ECX,
+    JAMZ_REG_EDX,
+    JAMZ_REG_EBX, // Desde aquí los preserva el llamado: hay que guardarlos
+    JAMZ_REG_ESI,
+    JAMZ_REG_EDI,
+    JAMZ_REG_COUNT,
+} JAMZRegister;
+
+#define JAMZ_REG_CALLEE_SAVED(reg) ((reg) >= JAMZ_REG_EBX)
+
+typedef struct
+{
+    int32_t *reg;  // Registro de cada registro virtual, o JAMZ_IR_NONE si está en la pila
+    int32_t *slot; // Ranura de pila de los derramados, o JAMZ_IR_NONE
+    int32_t slot_count;
+    bool used[JAMZ_REG_COUNT];
+} JAMZRegisterAllocation;
+
+// Hojas que puede leer como mucho la raíz de un árbol plegado
+#define JAMZ_REGALLOC_MAX_READS 16
+
+// Asignación por barrido lineal (Poletto y Sarkar) sobre intervalos de vida
+// calculados con liveness por bloques. Al faltar registros se derrama el
+// intervalo que termina más tarde. folded (opcional) marca las instrucciones
+// que la selección plegó en el árbol de su único uso: no reciben registro y
+// sus operandos viven hasta la raíz. immediate (opcional, dos por
+// instrucción) marca los operandos que se escriben como el inmediato de su
+// constante: no la mantienen viva. profile (opcional, ver profile_weights)
+// da las pasadas de cada COUNT: entonces se derrama el intervalo cuyos usos
+// se ejecutaron menos veces.
+JAMZRegisterAllocation allocate_registers(const JAMZIRFunction *function, const bool *folded, const bool *immediate,
+                                          const uint64_t *profile);
+const char *jamz_register_name(JAMZRegister reg);
+void free_register_allocation(JAMZRegisterAllocation *allocation);
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef SELECT_H
+#define SELECT_H
+
+#include "ir.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Selección de instrucciones por cobertura de árboles de coste mínimo (al
+// estilo BURS). Los valores puros de un solo uso dentro de un bloque se
+// pliegan en el árbol de quien los usa; cada nodo se etiqueta con el coste
+// mínimo de reducirlo a cada no terminal y la raíz elige la cobertura.
+typedef enum
+{
+    JAMZ_NT_REG,   // Valor en un registro (o en su ranura si se derramó)
+    JAMZ_NT_IMM,   // Inmediato: constante o dirección de una cadena
+    JAMZ_NT_MEM,   // Operando de memoria: parámetro en [ebp+8+4k]
+    JAMZ_NT_INDEX, // índice*escala con escala 1, 2, 4 u 8
+    JAMZ_NT_PAIR,  // base + índice*escala
+    JAMZ_NT_ADDR,  // Dirección completa base + índice*escala + desplazamiento
+    JAMZ_NT_FLAGS, // Comparación que solo deja los flags para el salto siguiente
+    JAMZ_NT_COUNT,
+} JAMZNonterminal;
+
+// Qué instrucción sale de cada regla al reducir
+typedef enum
+{
+    JAMZ_EMIT_LEAF,       // Hoja: el operando es el propio valor
+    JAMZ_EMIT_CHAIN,      // Regla en cadena: nt <- otro nt
+    JAMZ_EMIT_ADDRESS,    // Parte de una dirección; solo se escribe con lea
+    JAMZ_EMIT_TWO_ADDR,   // mov dst, a; op dst, b
+    JAMZ_EMIT_MUL_IMM,    // imul dst, a, imm (tres operandos)
+    JAMZ_EMIT_SHIFT,      // mov dst, a; shl dst, log2(imm)
+    JAMZ_EMIT_MUL_PLAN,   // Cadena de lea, shl, add o sub (jamz_mul_plan)
+    JAMZ_EMIT_COMPARE,    // cmp a, b (con la condición invertida si casó al revés)
+    JAMZ_EMIT_SET,        // reg <- flags: setcc al; movzx
+} JAMZEmitKind;
+
+typedef enum
+{
+    JAMZ_COND_NONE,
+    JAMZ_COND_SCALE,      // Inmediato 1, 2, 4 u 8
+    JAMZ_COND_SCALE_PLUS, // Inmediato 3, 5 o 9: x + x*(imm-1)
+    JAMZ_COND_NEGATABLE,  // Inmediato que se puede negar (no INT_MIN)
+    JAMZ_COND_POWER_OF_TWO,
+    JAMZ_COND_MUL_PLAN,   // Producto que jamz_mul_plan descompone
+} JAMZRuleCondition;
+
+typedef struct
+{
+    JAMZNonterminal lhs;
+    int op; // JAMZIROp del nodo, -1 en las reglas en cadena o JAMZ_RULE_COMPARE
+    JAMZNonterminal kids[2];
+    uint8_t cost;
+    JAMZRuleCondition condition;
+    bool commutative;
+    JAMZEmitKind emit;
+    const char *name;
+} JAMZRule;
+
+#define JAMZ_RULE_NONE 0xFF
+// op de las reglas que casan con cualquiera de las seis comparaciones
+#define JAMZ_RULE_COMPARE (-2)
+
+typedef struct
+{
+    uint16_t cost[JAMZ_NT_COUNT];
+    uint8_t rule[JAMZ_NT_COUNT]; // Regla de menor coste para cada no terminal
+    uint8_t swapped;             // Bit nt: la regla casó con los operandos al revés
+} JAMZSelectLabel;
+
+typedef struct
+{
+    JAMZSelectLabel *labels; // Uno por instrucción
+    int32_t *children;       // Dos por instrucción: candidata a plegarse en cada operando, o -1
+    int32_t *constants;      // Dos por instrucción: CONST que define el operando (aunque no se pliegue), o -1
+    bool *immediate;         // Dos por instrucción: el operando se escribe como inmediato de su constante compartida
+    bool *folded;            // La instrucción forma parte del árbol de otra (o es una constante que solo se usa como inmediato)
+    uint8_t *goal;           // No terminal al que se reduce cada instrucción
+    size_t folded_count;
+} JAMZSelection;
+
+JAMZSelection select_instructions(const JAMZIRFunction *function);
+void free_selection(JAMZSelection *selection);
+
+// Regla con la que se reduce la instrucción a nt (NULL si no hay ninguna);
+// swapped indica si casó con los operandos a y b al revés
+const JAMZRule *jamz_select_rule(const JAMZSelection *selection, size_t instr, JAMZNonterminal nt, bool *swapped);
+// Instrucción plegada en el operando k (0 = a, 1 = b), o -1 si el operando
+// llega en un registro
+int32_t jamz_select_operand(const JAMZSelection *selection, size_t instr, int k);
+// CONST de una sola definición que da el valor del operando k, o -1
+int32_t jamz_select_constant(const JAMZSelection *selection, size_t instr, int k);
+// El operando k se escribe como el inmediato de su constante compartida: no
+// lee el registro que la guarda
+bool jamz_select_immediate(const JAMZSelection *selection, size_t instr, int k);
+
+#endif
@@ -3,27 +3,69 @@
 
 #include "parser.h"
 
+// Clase de símbolo; el tipo de dato concreto vive en la tabla de tipos
 typedef enum
 {
-    SYMBOL_INT,
-    SYMBOL_FLOAT,
-    SYMBOL_STRING,
+    SYMBOL_VARIABLE,
     SYMBOL_TYPE,    // Nuevo: para tipos como "int", "float", etc.
     SYMBOL_FUNCTION // Nuevo: para funciones
 } SymbolType;
 
 typedef struct Symbol
 {
-    char *name;
+    const char *name;        // Apunta a la clave de su ranura en la tabla
     SymbolType type;
-    struct Symbol *next;
+    JAMZTypeId type_id;      // Tipo de la variable, o el propio tipo si es SYMBOL_TYPE
+    size_t depth;            // Profundidad del ámbito que lo declaró
+    size_t id;               // Índice denso dentro de su tabla (variables de una función)
+    struct Symbol *shadowed; // Declaración exterior que este símbolo oculta
 } Symbol;
 
+// Entrada del mapa de nombres. Las claves nunca se eliminan (no hay lápidas):
+// al salir de un ámbito solo se restaura el enlace anterior, que puede ser NULL.
+typedef struct
+{
+    char *name;        // NULL marca una ranura vacía
+    unsigned int hash; // Hash precalculado del nombre
+    Symbol *binding;   // Declaración visible más interna
+} SymbolSlot;
+
+#define SYMBOL_CHUNK_SIZE 256
+
+// Los símbolos se reservan por bloques y viven hasta free_symbol_table, de
+// modo que los nodos del AST pueden guardar punteros a ellos.
+typedef struct SymbolChunk
+{
+    Symbol symbols[SYMBOL_CHUNK_SIZE];
+    size_t used;
+    struct SymbolChunk *next;
+} SymbolChunk;
+
+// Mapa global único (direccionamiento abierto, capacidad potencia de dos)
+// más una pila de ámbitos: cada declaración se anota en el registro de
+// deshacer y al cerrar el ámbito se restauran los enlaces ocultados.
 typedef struct SymbolTable
 {
-    Symbol *symbols;
-    struct SymbolTable *parent;
-    bool is_freed; // Nuevo campo para rastrear si la tabla ya fue liberada
+    SymbolSlot *slots;
+    size_t capacity;
+    size_t count;
+
+    Symbol **undo_log;
+    size_t undo_count;
+    size_t undo_capacity;
+
+    size_t *scope_marks; // Tamaño del registro al entrar en cada ámbito
+    size_t depth;
+    size_t scope_capacity;
+
+    SymbolChunk *chunks;
+    size_t symbol_count; // Siguiente id de símbolo
+
+    // Ámbito global congelado que se consulta si el nombre no es local; permite
+    // analizar cada función en su propio hilo con su propia pila de ámbitos
+    const struct SymbolTable *parent;
+    struct SymbolTable **function_tables; // Tablas de cada función (solo en la global)
+    size_t function_table_count;
 } SymbolTable;
 
 typedef struct
@@ -33,6 +75,68 @@ typedef struct
     char *category;
 } Keyword;
 
-void analyze_semantics(JAMZASTNode *ast, Keyword *keywords, int keyword_count);
+// Categorías de keyword como máscara de bits (un nombre puede tener varias)
+typedef enum
+{
+    KEYWORD_CATEGORY_NONE = 0,
+    KEYWORD_CATEGORY_TYPE = 1 << 0,
+    KEYWORD_CATEGORY_CONTROL = 1 << 1,
+    KEYWORD_CATEGORY_FUNCTION = 1 << 2,
+} KeywordCategory;
+
+typedef struct
+{
+    char *name; // NULL marca una ranura vacía
+    unsigned int hash;
+    unsigned int categories; // Máscara de KeywordCategory
+} KeywordEntry;
+
+// Índice hash de keywords, construido una sola vez tras load_keywords y
+// reutilizable para analizar cualquier número de archivos.
+typedef struct
+{
+    KeywordEntry *entries;
+    size_t capacity;
+    size_t count;
+} KeywordIndex;
+
+KeywordIndex *build_keyword_index(const Keyword *keywords, int keyword_count);
+unsigned int keyword_categories(const KeywordIndex *index, const char *name);
+void free_keyword_index(KeywordIndex *index);
+
+// Deja en cada nodo su tipo inferido y su símbolo resuelto. La tabla devuelta
+// es dueña de esos símbolos: liberarla con free_symbol_table tras generar código.
+SymbolTable *analyze_semantics(JAMZASTNode *ast, const KeywordIndex *index);
+void free_symbol_table(SymbolTable *table);
+
+// Sesión de análisis incremental (modo --watch). Entre una versión del
+// archivo y la siguiente conserva, por función, el AST anotado, su tabla
+// local, sus diagnósticos y las llamadas que hace junto con la firma que
+// resolvieron. Solo se vuelven a analizar las funciones cuyo texto cambió o
+// alguna de cuyas llamadas resuelve ahora a otra firma.
+// La unidad es la función entera, no la sentencia: lo que una función expone
+// a las demás es solo su firma, que está en el ámbito global, mientras que
+// dentro del cuerpo cada sentencia depende de todas las declaraciones
+// anteriores de sus ámbitos. Reutilizar sentencias obligaría a guardar ese
+// estado en cada punto; volver a recorrer el cuerpo es lineal y cuesta menos
+// que el léxico y el análisis sintáctico, que ya se repiten sobre todo el
+// archivo.
+typedef struct SemanticSession SemanticSession;
+
+typedef struct
+{
+    size_t analyzed; // Funciones analizadas de nuevo
+    size_t reused;   // Funciones cuyo resultado se reutilizó
+} SemanticUpdateStats;
+
+SemanticSession *create_semantic_session(const KeywordIndex *index);
+// La sesión toma posesión de program y libera la versión anterior; las
+// funciones reutilizadas sustituyen a las nuevas dentro de program. Los
+// errores se dejan en la pila de errores igual que analyze_semantics.
+SemanticUpdateStats semantic_session_update(SemanticSession *session, JAMZASTNode *program);
+// Libera los nodos descartados en la última actualización; pensado para
+// llamarse tras mostrar los diagnósticos (update también lo hace al empezar)
+void semantic_session_collect(SemanticSession *session);
+void free_semantic_session(SemanticSession *session);
 
 #endif
\ No newline at end of file
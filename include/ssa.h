@@ -0,0 +1,111 @@
+#ifndef SSA_H
+#define SSA_H
+
+#include "dataflow.h"
+#include "ir.h"
+
+// Resultado de las optimizaciones en forma SSA
+typedef struct
+{
+    size_t constants;  // Valores calculados por la propagación de constantes
+    size_t redundant;  // Valores ya disponibles según la numeración de valores
+    size_t hoisted;    // Operaciones invariantes sacadas de un bucle
+    size_t reduced;    // Productos por variables de inducción convertidos en sumas
+    size_t vectorized; // Bucles con un núcleo vectorial delante
+    size_t removed;    // Instrucciones eliminadas por código muerto
+    size_t inverted;   // Saltos invertidos para que la rama caliente del perfil caiga
+    size_t moved;      // Bloques que el perfil coloca en otra posición
+    size_t instructions_before;
+    size_t instructions_after;
+} JAMZSSAStats;
+
+typedef struct
+{
+    int32_t dst;
+    int32_t var;   // Registro de la IR lineal que versiona
+    int32_t *args; // Uno por predecesor, en el orden de graph.preds
+    int line;
+    bool live;
+} JAMZSSAPhi;
+
+// Bloque básico en forma SSA. Las etiquetas y saltos de la IR lineal se
+// sustituyen por succs; al volver a la forma lineal se emiten de nuevo.
+typedef struct
+{
+    JAMZIRInstr *code;
+    size_t count;
+    size_t capacity;
+    JAMZSSAPhi *phis;
+    size_t phi_count;
+    size_t phi_capacity;
+    int32_t condition; // Registro que decide el salto final, o JAMZ_IR_NONE
+    size_t succs[2];   // [0] caída o destino del salto; [1] destino si condition == 0
+    size_t succ_count;
+    int line;          // Línea del salto final
+    size_t before;     // Bloque ante el que se coloca al volver a la IR lineal, o SIZE_MAX (orden de creación)
+} JAMZSSABlock;
+
+typedef struct
+{
+    JAMZIRFunction *function;
+    JAMZSSABlock *blocks;
+    size_t block_count;
+    JAMZFlowGraph graph;
+    size_t *idom;
+    JAMZSSAStats stats;
+    const uint64_t *weights; // Pasadas por bloque del perfil leído (índice: imm de COUNT), o NULL
+    bool counting;           // Programa instrumentado: cada COUNT es un efecto visible
+} JAMZSSAFunction;
+
+// Posición del uso: fases, instrucciones y por último la condición del bloque
+typedef struct
+{
+    size_t block;
+    size_t slot;
+} JAMZSSAUse;
+
+// Dónde se define cada registro: bloque y slot (las fases primero, como en
+// JAMZSSAUse); block es SIZE_MAX para los que no define nadie
+typedef struct
+{
+    size_t *block;
+    size_t *slot;
+    size_t count;
+} JAMZSSADefSites;
+
+
+// Utilidades sobre la forma SSA para las fases de otros módulos (loop.c,
+// vectorize.c y la colocación guiada por perfil de profile.c)
+bool ssa_is_reachable(const JAMZSSAFunction *ssa, size_t block);
+void ssa_block_append(JAMZSSABlock *block, const JAMZIRInstr *instr);
+size_t ssa_add_block(JAMZSSAFunction *ssa, size_t *capacity);
+// Registros que lee la instrucción; devuelve cuántos
+int ssa_instr_reads(JAMZIRInstr *instr, int32_t **regs);
+size_t ssa_pred_index(const JAMZFlowGraph *graph, size_t block, size_t pred);
+size_t ssa_pred_count(const JAMZFlowGraph *graph, size_t block);
+// Índice de la arista p -> block entre los sucesores de p
+size_t ssa_succ_slot(const JAMZSSABlock *pred, size_t block);
+// Recalcula el grafo tras quitar aristas o redirigir saltos. Cada fase
+// conserva los argumentos de los predecesores que sigue teniendo.
+void ssa_rebuild_graph(JAMZSSAFunction *ssa);
+bool ssa_dominates(const JAMZSSAFunction *ssa, size_t a, size_t b);
+void ssa_add_phi(JAMZSSABlock *block, int32_t var, size_t args, int line);
+void ssa_locate_definitions(const JAMZSSAFunction *ssa, JAMZSSADefSites *defs);
+// Instrucción que define v, o NULL si es una fase o no la define nadie
+const JAMZIRInstr *ssa_defining_instr(const JAMZSSAFunction *ssa, const JAMZSSADefSites *defs, int32_t v);
+bool ssa_constant_value(const JAMZSSAFunction *ssa, const JAMZSSADefSites *defs, int32_t v, int32_t *value);
+// Orden en que se emiten los bloques: el de creación, salvo los que piden
+// ir justo antes de otro (los preheaders, ante la cabecera de su bucle)
+size_t *ssa_block_layout(const JAMZSSAFunction *ssa);
+
+// Lleva cada función a SSA (fronteras de dominancia y funciones phi), aplica
+// propagación de constantes condicional dispersa, numeración global de
+// valores, movimiento de código invariante, reducción de fuerza y
+// vectorización en los bucles y eliminación agresiva de código muerto, y la
+// devuelve a la IR lineal con copias en las aristas. Modifica la IR en el
+// sitio; con JAMZ_VECTOR=off no vectoriza. Con un perfil leído los bloques
+// se colocan por frecuencia; un programa instrumentado no se vectoriza y
+// conserva cada bloque con contador que pueda ejecutarse.
+JAMZSSAStats optimize_ir(JAMZIRProgram *program);
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef STRENGTH_H
+#define STRENGTH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Reducción de fuerza de la multiplicación y la división por constantes:
+// qué instrucciones baratas sustituyen a imul e idiv
+
+typedef enum
+{
+    JAMZ_MUL_SHIFT,      // t <<= amount
+    JAMZ_MUL_LEA,        // t = t + t*(amount-1), amount 3, 5 o 9
+    JAMZ_MUL_ADD_SOURCE, // t += x
+    JAMZ_MUL_SUB_SOURCE, // t -= x
+} JAMZMulStepKind;
+
+typedef struct
+{
+    JAMZMulStepKind kind;
+    int32_t amount;
+} JAMZMulStep;
+
+typedef struct
+{
+    JAMZMulStep steps[2];
+    int count;
+} JAMZMulPlan;
+
+// Constante mágica de la división con signo entre d (Hacker's Delight,
+// 10-1): n / d = hi(n * multiplier) [+/- n] >> shift, más 1 si es negativo
+typedef struct
+{
+    int32_t multiplier;
+    int shift;
+    bool add_dividend;      // d > 0 y multiplier < 0
+    bool subtract_dividend; // d < 0 y multiplier > 0
+} JAMZDivMagic;
+
+bool jamz_is_power_of_two(int32_t value);
+// Exponente de una potencia de dos
+int jamz_log2(uint32_t value);
+// x*c con a lo sumo dos pasos de desplazamiento, lea, suma o resta. Las
+// potencias de dos no pasan por aquí: les basta un shl.
+bool jamz_mul_plan(int32_t value, JAMZMulPlan *plan);
+// Solo para |d| >= 2 que no sea potencia de dos
+JAMZDivMagic jamz_div_magic(int32_t divisor);
+
+#endif
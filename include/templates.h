@@ -0,0 +1,74 @@
+#ifndef TEMPLATES_H
+#define TEMPLATES_H
+
+#include "asm.h"
+#include <stdbool.h>
+
+// Plantillas de data/dictionary.json, en el orden de template_keys
+typedef enum
+{
+    JAMZ_TEMPLATE_PROLOGUE,
+    JAMZ_TEMPLATE_EPILOGUE,
+    JAMZ_TEMPLATE_RESERVE_STACK,
+    JAMZ_TEMPLATE_SAVE_REGISTER,
+    JAMZ_TEMPLATE_RESTORE_REGISTER,
+    JAMZ_TEMPLATE_MOVE,
+    JAMZ_TEMPLATE_BINARY_ADD,
+    JAMZ_TEMPLATE_BINARY_SUB,
+    JAMZ_TEMPLATE_BINARY_MUL,
+    JAMZ_TEMPLATE_MULTIPLY_IMMEDIATE,
+    JAMZ_TEMPLATE_LOAD_ADDRESS,
+    JAMZ_TEMPLATE_SHIFT_LEFT,
+    JAMZ_TEMPLATE_SHIFT_RIGHT,
+    JAMZ_TEMPLATE_SHIFT_RIGHT_ARITHMETIC,
+    JAMZ_TEMPLATE_MULTIPLY_WIDE,
+    JAMZ_TEMPLATE_SIGN_EXTEND,
+    JAMZ_TEMPLATE_NEGATE,
+    JAMZ_TEMPLATE_MASK,
+    JAMZ_TEMPLATE_BINARY_DIV,
+    JAMZ_TEMPLATE_BINARY_IDIV,
+    JAMZ_TEMPLATE_BRANCH_ZERO,
+    JAMZ_TEMPLATE_COMPARE,
+    JAMZ_TEMPLATE_SET_CONDITION,
+    JAMZ_TEMPLATE_BRANCH_CONDITION,
+    JAMZ_TEMPLATE_JUMP,
+    JAMZ_TEMPLATE_PUSH_ARG,
+    JAMZ_TEMPLATE_CALL,
+    JAMZ_TEMPLATE_DROP_ARGS,
+    JAMZ_TEMPLATE_ZERO_FRAME,
+    JAMZ_TEMPLATE_BRANCH_ALIGNED,
+    // Contadores de bloque de un programa instrumentado (profile.h)
+    JAMZ_TEMPLATE_COUNT_BLOCK,
+    JAMZ_TEMPLATE_COUNTER_DATA,
+    // Núcleos vectoriales: SSE2 y, con sufijo AVX, AVX2
+    JAMZ_TEMPLATE_VECTOR_MOVE,
+    JAMZ_TEMPLATE_VECTOR_MOVE_UNALIGNED,
+    JAMZ_TEMPLATE_VECTOR_MOVE_SCALAR,
+    JAMZ_TEMPLATE_VECTOR_BROADCAST,
+    JAMZ_TEMPLATE_VECTOR_ADD,
+    JAMZ_TEMPLATE_VECTOR_SUB,
+    JAMZ_TEMPLATE_VECTOR_MUL,
+    JAMZ_TEMPLATE_VECTOR_MOVE_AVX,
+    JAMZ_TEMPLATE_VECTOR_MOVE_UNALIGNED_AVX,
+    JAMZ_TEMPLATE_VECTOR_MOVE_SCALAR_AVX,
+    JAMZ_TEMPLATE_VECTOR_BROADCAST_AVX,
+    JAMZ_TEMPLATE_VECTOR_ADD_AVX,
+    JAMZ_TEMPLATE_VECTOR_SUB_AVX,
+    JAMZ_TEMPLATE_VECTOR_MUL_AVX,
+    JAMZ_TEMPLATE_VECTOR_CLEAR_UPPER,
+    JAMZ_TEMPLATE_STRING_DATA,
+    JAMZ_TEMPLATE_COUNT,
+} JAMZTemplateKind;
+
+// Carga y precompila el diccionario la primera vez; las siguientes llamadas
+// del proceso reutilizan la tabla. Devuelve false si no se pudo cargar.
+bool jamz_templates_ready(void);
+// Añade las líneas de la plantilla al búfer sustituyendo sus huecos (%s o
+// %d) por arguments, en orden. Las plantillas ya están partidas en texto
+// fijo y huecos, así que aquí no se interpreta ninguna cadena de formato.
+void jamz_template_emit(JAMZAsmBuffer *buffer, JAMZTemplateKind kind, const char *const *arguments);
+// Igual, pero copia el texto tal cual (para la sección de datos)
+void jamz_template_render(JAMZOutputBuffer *output, JAMZTemplateKind kind, const char *const *arguments);
+void free_template_table(void);
+
+#endif
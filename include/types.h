@@ -0,0 +1,59 @@
+#ifndef TYPES_H
+#define TYPES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Identificador canónico de un tipo. Dos tipos son iguales si y solo si sus
+// identificadores lo son: los tipos derivados se internan en la tabla.
+typedef int JAMZTypeId;
+
+// Los arreglos viven en el marco de pila de su función: su longitud se acota
+#define JAMZ_MAX_ARRAY_LENGTH (1 << 18)
+
+// Los primitivos ocupan posiciones fijas al inicio de la tabla
+enum
+{
+    JAMZ_TYPE_INVALID = -1,
+    JAMZ_TYPE_VOID = 0,
+    JAMZ_TYPE_INT,
+    JAMZ_TYPE_FLOAT,
+    JAMZ_TYPE_CHAR,
+    JAMZ_TYPE_PRIMITIVE_COUNT
+};
+
+typedef enum
+{
+    JAMZ_TYPE_KIND_PRIMITIVE,
+    JAMZ_TYPE_KIND_POINTER,
+    JAMZ_TYPE_KIND_FUNCTION,
+    JAMZ_TYPE_KIND_ARRAY,
+} JAMZTypeKind;
+
+typedef struct
+{
+    JAMZTypeKind kind;
+    JAMZTypeId base;       // Tipo apuntado (POINTER), de retorno (FUNCTION) o de los elementos (ARRAY)
+    JAMZTypeId pointer_to; // Caché del tipo "puntero a este", o JAMZ_TYPE_INVALID
+    JAMZTypeId *params;    // Tipos de los parámetros (FUNCTION)
+    size_t param_count;
+    size_t length;         // Número de elementos (ARRAY)
+    char *name;            // Nombre legible, p. ej. "char*" o "int(int, char*)"
+} JAMZTypeInfo;
+
+JAMZTypeId jamz_type_from_name(const char *name);
+JAMZTypeId jamz_type_pointer_to(JAMZTypeId base);
+JAMZTypeId jamz_type_function(JAMZTypeId return_type, const JAMZTypeId *params, size_t param_count);
+JAMZTypeId jamz_type_array_of(JAMZTypeId base, size_t length);
+const JAMZTypeInfo *jamz_type_info(JAMZTypeId id);
+const char *jamz_type_name(JAMZTypeId id);
+
+bool jamz_type_is_pointer(JAMZTypeId id);
+bool jamz_type_is_function(JAMZTypeId id);
+bool jamz_type_is_array(JAMZTypeId id);
+bool jamz_type_is_arithmetic(JAMZTypeId id);
+bool jamz_type_is_assignable(JAMZTypeId target, JAMZTypeId value);
+
+void free_type_table(void);
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include "lexer.h"
 #include "parser.h"
@@ -59,12 +60,19 @@ char *strndup_impl(const char *src, size_t length);
 char *read_file(const char *filename);
 
 void print_error(const char *format, ...);
+void print_warning(const char *format, ...);
 void set_console_color(WORD color);
 void reset_console_color();
 void print_color(const char *text, Color color, bool newline);
 
 const char *get_filename_ext(const char *filename);
 
+// Hashing utils (FNV-1a, usado por las tablas hash del compilador)
+unsigned int jamz_hash_string(const char *text);
+// FNV-1a de 64 bits encadenable: hash = jamz_hash64(hash, datos, tamaño)
+#define JAMZ_HASH64_SEED 14695981039346656037ull
+uint64_t jamz_hash64(uint64_t hash, const void *data, size_t size);
+
 // Memory management utils
 void *safe_malloc(size_t size);
 void *safe_realloc(void *ptr, size_t size);
@@ -75,11 +83,47 @@ void print_tokens(const JAMZTokenList *list);
 
 // Parser utils
 void print_ast(const JAMZASTNode *node, int indent);
+// Operador binario de comparación (<, <=, >, >=, ==, !=): vale 0 o 1
+bool jamz_is_comparison(const char *op);
 
 // Semantic utils
 Keyword *load_keywords(const char *path, int *out_count);
 
+// Reloj monotónico en ms, para medir las fases del compilador
+double jamz_now_ms(void);
+
+// Tiempo de CPU del hilo que llama, en ms: lo que ha trabajado él, aunque
+// comparta procesador con otros
+double jamz_thread_cpu_ms(void);
+
+// Hilos de trabajo: JAMZ_JOBS si está definida, si no el número de CPUs
+size_t jamz_worker_count(void);
+
+// Juego de instrucciones de los bucles vectorizados
+typedef enum
+{
+    JAMZ_VECTOR_OFF,  // Sin vectorizar
+    JAMZ_VECTOR_SSE2, // xmm, 4 carriles de int
+    JAMZ_VECTOR_AVX2, // ymm, 8 carriles
+} JAMZVectorISA;
+
+// JAMZ_VECTOR (off, sse2 o avx2) si está definida; si no, SSE2. Con host el
+// código corre en este proceso: sin variable se elige AVX2 si el procesador
+// lo tiene, y nunca se pide algo que no tenga.
+JAMZVectorISA jamz_vector_isa(bool host);
+
+// Umbral del inliner: JAMZ_INLINE si está definida (off o 0 lo desactivan),
+// si no fallback
+size_t jamz_inline_threshold(size_t fallback);
+
+// Modo --watch: fecha de modificación (-1 si no existe) y pausa
+long long jamz_file_mtime(const char *filename);
+void jamz_sleep_ms(unsigned int milliseconds);
+
 // Debugging utils
+// Abre program.log si aún no lo está. log_debug lo abre en su primer uso sin
+// sincronizar, así que hay que llamarla antes de lanzar hilos que registren.
+bool log_open(void);
 void log_debug(const char *format, ...);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,22 @@
+#ifndef VECTORIZE_H
+#define VECTORIZE_H
+
+#include "ssa.h"
+
+// Vectorización de bucles internos sin control de flujo: el cuerpo es una
+// cadena de bloques desde la cabecera hasta el salto de vuelta, la única fase
+// es una variable de inducción i de paso 1 y se sale con next >= n, n
+// invariante. Cada vuelta solo lee y escribe elementos i + c de arreglos y
+// opera con +, - y * sobre ellos e invariantes; un arreglo que se escribe se
+// toca siempre en la misma posición relativa, así que ninguna vuelta depende
+// de otra.
+//
+// El bucle escalar se queda como está: en el preheader, VLOOP hace las
+// vueltas que caben en vectores enteros (nunca la última) y la fase arranca
+// donde se detuvo, así que el propio bucle es el epílogo.
+//
+// Prueba con cada bucle interno que tenga preheader; JAMZSSAStats.vectorized
+// cuenta los que reciben núcleo.
+void vectorize_loops(JAMZSSAFunction *ssa);
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef VM_H
+#define VM_H
+
+#include "ir.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Bytecode de registros compilado desde la IR, para ejecutar programas donde
+// no hay ensamblador. Cada registro virtual de una función es un registro de
+// su marco; los parámetros ocupan los registros siguientes y los elementos de
+// los arreglos, uno por registro, van detrás. Los arreglos valen 0 al entrar
+// y los índices se comprueban.
+typedef enum
+{
+    JAMZ_VM_CONST,     // r[a] = imm
+    JAMZ_VM_STRING,    // r[a] = dirección de la cadena imm
+    JAMZ_VM_MOVE,      // r[a] = r[b]
+    JAMZ_VM_ADD,       // r[a] = r[b] + r[c]
+    JAMZ_VM_SUB,       // r[a] = r[b] - r[c]
+    JAMZ_VM_MUL,       // r[a] = r[b] * r[c]
+    JAMZ_VM_DIV,       // r[a] = r[b] / r[c]
+    JAMZ_VM_UDIV,      // r[a] = r[b] / r[c] sin signo
+    JAMZ_VM_MOD,       // r[a] = r[b] % r[c]
+    JAMZ_VM_UMOD,      // r[a] = r[b] % r[c] sin signo
+    JAMZ_VM_EQ,        // r[a] = r[b] == r[c] (0 o 1), con signo como las demás
+    JAMZ_VM_NE,        // r[a] = r[b] != r[c]
+    JAMZ_VM_LT,        // r[a] = r[b] < r[c]
+    JAMZ_VM_LE,        // r[a] = r[b] <= r[c]
+    JAMZ_VM_GT,        // r[a] = r[b] > r[c]
+    JAMZ_VM_GE,        // r[a] = r[b] >= r[c]
+    JAMZ_VM_ARG,       // Apila r[a] como argumento
+    JAMZ_VM_CALL,      // r[a] = función imm con los c últimos argumentos
+    JAMZ_VM_JUMP,      // Salta a la instrucción imm
+    JAMZ_VM_JUMP_ZERO, // Si r[a] == 0 salta a la instrucción imm
+    JAMZ_VM_RET,       // Devuelve r[a]
+    JAMZ_VM_RET_VOID,
+    JAMZ_VM_LOAD,      // r[a] = elemento r[b] del arreglo que empieza en r[c], de imm elementos
+    JAMZ_VM_STORE,     // Elemento r[a] del arreglo que empieza en r[c], de imm elementos = r[b]
+    JAMZ_VM_VLOOP,     // r[a] = fin del núcleo vectorial imm ejecutado desde r[b] con límite r[c]
+    JAMZ_VM_COUNT,     // Suma una pasada al contador imm del perfil (programa instrumentado)
+    // Superinstrucciones: pares frecuentes fusionados en un solo despacho
+    JAMZ_VM_ADD_CONST, // CONST + ADD: r[a] = r[b] + imm
+    JAMZ_VM_SUB_CONST, // CONST + SUB: r[a] = r[b] - imm
+    JAMZ_VM_MUL_CONST, // CONST + MUL: r[a] = r[b] * imm
+    JAMZ_VM_MOVE_JUMP, // MOVE + JUMP (copias de salida de SSA): r[a] = r[b]; salta a imm
+    // Comparación + BRANCH: si r[a] cc r[b] salta a imm (cc ya negada)
+    JAMZ_VM_JUMP_EQ,
+    JAMZ_VM_JUMP_NE,
+    JAMZ_VM_JUMP_LT,
+    JAMZ_VM_JUMP_LE,
+    JAMZ_VM_JUMP_GT,
+    JAMZ_VM_JUMP_GE,
+    JAMZ_VM_OPCODE_COUNT,
+} JAMZVMOpcode;
+
+typedef struct
+{
+    uint32_t op;
+    int32_t a;
+    int32_t b;
+    int32_t c;
+    int32_t imm;
+} JAMZVMInstr;
+
+typedef struct
+{
+    const char *name;
+    JAMZVMInstr *code;
+    int *lines; // Línea del fuente de cada instrucción, para los errores
+    size_t count;
+    int32_t register_count; // Registros virtuales, parámetros y elementos de los arreglos
+    int32_t first_param;
+    int32_t first_array;
+    int32_t *array_base; // Primer registro de cada arreglo
+    const JAMZIRFunction *ir; // Núcleos de los bucles vectorizados
+} JAMZVMFunction;
+
+typedef struct
+{
+    JAMZVMFunction *functions;
+    size_t function_count;
+    const JAMZIRProgram *ir; // Dueño de los nombres y las cadenas
+    size_t fused;            // Pares convertidos en superinstrucciones
+    size_t instructions;
+} JAMZVMProgram;
+
+JAMZVMProgram *compile_bytecode(const JAMZIRProgram *ir);
+// Ejecuta main; devuelve false y avisa por stderr ante un error de ejecución
+// (división por cero, índice fuera de rango, función desconocida). Los COUNT
+// de un programa instrumentado suman en program->ir->profile.
+bool vm_run_main(const JAMZVMProgram *program, int *result);
+void free_bytecode(JAMZVMProgram *program);
+
+#endif
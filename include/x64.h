@@ -0,0 +1,145 @@
+#ifndef X64_H
+#define X64_H
+
+#include "output.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Codificador de x86-64: escribe instrucciones ya en binario en un
+// JAMZOutputBuffer. Solo cubre las formas que usa el generador de objetos.
+typedef enum
+{
+    JAMZ_X64_RAX,
+    JAMZ_X64_RCX,
+    JAMZ_X64_RDX,
+    JAMZ_X64_RBX,
+    JAMZ_X64_RSP,
+    JAMZ_X64_RBP,
+    JAMZ_X64_RSI,
+    JAMZ_X64_RDI,
+    JAMZ_X64_R8,
+    JAMZ_X64_R9,
+    JAMZ_X64_R10,
+    JAMZ_X64_R11,
+    JAMZ_X64_R12,
+    JAMZ_X64_R13,
+    JAMZ_X64_R14,
+    JAMZ_X64_R15,
+} JAMZX64Register;
+
+// Un registro o la posición [rbp + disp] del marco, o [rbp + rax*scale +
+// disp] para los elementos de los arreglos. En las instrucciones vectoriales
+// reg es el número de xmm/ymm.
+typedef struct
+{
+    bool memory;
+    JAMZX64Register reg;
+    int32_t disp;
+    int scale; // 0 si no hay índice
+} JAMZX64Operand;
+
+// Operaciones de dos operandos "reg, r/m" (el código es el de esa forma)
+typedef enum
+{
+    JAMZ_X64_ADD = 0x03,
+    JAMZ_X64_SUB = 0x2B,
+    JAMZ_X64_XOR = 0x33,
+    JAMZ_X64_CMP = 0x3B,
+    JAMZ_X64_TEST = 0x85,
+    JAMZ_X64_IMUL = 0x0FAF,
+} JAMZX64Arith;
+
+// Desplazamientos por un inmediato (la extensión /n de C1)
+typedef enum
+{
+    JAMZ_X64_SHL = 4,
+    JAMZ_X64_SHR = 5,
+    JAMZ_X64_SAR = 7,
+} JAMZX64Shift;
+
+// Instrucciones vectoriales sobre enteros de 32 bits: prefijo obligatorio,
+// mapa (1 = 0F, 2 = 0F 38, como en VEX) y código
+typedef enum
+{
+    JAMZ_X64_MOVD_TO = 0x66016E,       // xmm <- r/m32
+    JAMZ_X64_MOVD_FROM = 0x66017E,     // r/m32 <- xmm
+    JAMZ_X64_MOVDQA_LOAD = 0x66016F,
+    JAMZ_X64_MOVDQA_STORE = 0x66017F,
+    JAMZ_X64_MOVDQU_LOAD = 0xF3016F,
+    JAMZ_X64_MOVDQU_STORE = 0xF3017F,
+    JAMZ_X64_PSHUFD = 0x660170,        // Lleva un imm8
+    JAMZ_X64_PADDD = 0x6601FE,
+    JAMZ_X64_PSUBD = 0x6601FA,
+    JAMZ_X64_PMULUDQ = 0x6601F4,
+    JAMZ_X64_PUNPCKLDQ = 0x660162,
+    JAMZ_X64_PMULLD = 0x660240,        // Solo con VEX (AVX2)
+    JAMZ_X64_PBROADCASTD = 0x660258,   // Solo con VEX (AVX2)
+} JAMZX64VectorOp;
+
+// Condiciones con signo de jcc y setcc (los cuatro bits bajos del código)
+typedef enum
+{
+    JAMZ_X64_CC_E = 0x4,
+    JAMZ_X64_CC_NE = 0x5,
+    JAMZ_X64_CC_L = 0xC,
+    JAMZ_X64_CC_GE = 0xD,
+    JAMZ_X64_CC_LE = 0xE,
+    JAMZ_X64_CC_G = 0xF,
+} JAMZX64Condition;
+
+JAMZX64Operand x64_register(JAMZX64Register reg);
+JAMZX64Operand x64_frame(int32_t disp);
+// [rbp + rax*scale + disp]
+JAMZX64Operand x64_indexed(int32_t disp, int scale);
+
+// mov entre registros y memoria; wide elige 64 bits en lugar de 32
+void x64_mov(JAMZOutputBuffer *out, JAMZX64Operand dst, JAMZX64Operand src, bool wide);
+void x64_mov_imm(JAMZOutputBuffer *out, JAMZX64Operand dst, int32_t imm);
+// dst (32 bits) op= src
+void x64_arith(JAMZOutputBuffer *out, JAMZX64Arith op, JAMZX64Register dst, JAMZX64Operand src);
+// dst &= imm (32 bits)
+void x64_and_imm(JAMZOutputBuffer *out, JAMZX64Register dst, int32_t imm);
+// lea dst, [base + index*scale] (32 bits), scale 1, 2, 4 u 8
+void x64_lea_scaled(JAMZOutputBuffer *out, JAMZX64Register dst, JAMZX64Register base, JAMZX64Register index, int scale);
+// dst += imm; wide elige 64 bits
+void x64_add_imm(JAMZOutputBuffer *out, JAMZX64Register dst, int32_t imm, bool wide);
+// test dst, imm (32 bits)
+void x64_test_imm(JAMZOutputBuffer *out, JAMZX64Register dst, int32_t imm);
+// movsxd dst, src: 32 bits extendidos con signo a 64
+void x64_movsxd(JAMZOutputBuffer *out, JAMZX64Register dst, JAMZX64Operand src);
+void x64_lea(JAMZOutputBuffer *out, JAMZX64Register dst, JAMZX64Operand src);
+// div/idiv de edx:eax entre src (32 bits)
+void x64_divide(JAMZOutputBuffer *out, JAMZX64Operand src, bool is_signed);
+void x64_cdq(JAMZOutputBuffer *out);
+// edx:eax = eax * src con signo (imul de un operando, 32 bits)
+void x64_multiply_wide(JAMZOutputBuffer *out, JAMZX64Operand src);
+// dst = src * imm (32 bits)
+void x64_multiply_imm(JAMZOutputBuffer *out, JAMZX64Register dst, JAMZX64Operand src, int32_t imm);
+void x64_shift(JAMZOutputBuffer *out, JAMZX64Shift kind, JAMZX64Register dst, int amount);
+void x64_negate(JAMZOutputBuffer *out, JAMZX64Register dst);
+// eax = 1 si se cumple la condición y 0 si no (setcc al; movzx eax, al)
+void x64_set_condition(JAMZOutputBuffer *out, JAMZX64Condition condition);
+void x64_push(JAMZOutputBuffer *out, JAMZX64Operand src);
+void x64_pop(JAMZOutputBuffer *out, JAMZX64Register dst);
+// rsp += delta
+void x64_adjust_stack(JAMZOutputBuffer *out, int32_t delta);
+void x64_leave(JAMZOutputBuffer *out);
+// SSE2 (mapa 0F): op xmm(reg), rm; imm solo se escribe en PSHUFD
+void x64_sse(JAMZOutputBuffer *out, JAMZX64VectorOp op, unsigned reg, JAMZX64Operand rm, uint8_t imm);
+// La misma operación con VEX (AVX2): wide elige ymm y source es el primer
+// operando fuente de las de tres operandos (0 en las demás)
+void x64_vex(JAMZOutputBuffer *out, JAMZX64VectorOp op, bool wide, unsigned reg, unsigned source, JAMZX64Operand rm);
+void x64_vzeroupper(JAMZOutputBuffer *out);
+void x64_ret(JAMZOutputBuffer *out);
+
+// Las siguientes dejan un rel32 por resolver y devuelven su posición
+size_t x64_lea_rip(JAMZOutputBuffer *out, JAMZX64Register dst);
+size_t x64_inc_rip(JAMZOutputBuffer *out); // inc qword [rip + rel32]
+size_t x64_jmp(JAMZOutputBuffer *out);
+size_t x64_jz(JAMZOutputBuffer *out);
+size_t x64_jcc(JAMZOutputBuffer *out, JAMZX64Condition condition);
+size_t x64_call(JAMZOutputBuffer *out);
+// Apunta el rel32 en at hacia target (ambos posiciones en out)
+void x64_patch_rel32(JAMZOutputBuffer *out, size_t at, size_t target);
+
+#endif
@@ -3,10 +3,95 @@
 #include "include/lexer.h"
 #include "include/parser.h"
 #include "include/semantic.h"
+#include "include/analysis.h"
+#include "include/optimize.h"
 #include "include/utils.h"
+#include "include/ir.h"
+#include "include/ssa.h"
+#include "include/inline.h"
+#include "include/profile.h"
 #include "compile.h"
+#include "include/templates.h"
+#include "include/output.h"
+#include "include/object.h"
+#include "include/jit.h"
+#include "include/vm.h"
 #include <locale.h>
 
+#define JAMZ_WATCH_INTERVAL_MS 200
+
+// Lee, analiza y comprueba una versión del archivo dentro de la sesión
+static void check_source(const char *filename, SemanticSession *session)
+{
+    double start = jamz_now_ms();
+    char *source_code = read_file(filename);
+    if (!source_code)
+    {
+        check_for_errors();
+        return;
+    }
+
+    JAMZTokenList *tokens = lexer_analyze(source_code);
+    free(source_code);
+    if (!tokens)
+        return;
+
+    if (tokens->has_error)
+    {
+        for (size_t i = 0; i < tokens->error_count; ++i)
+        {
+            JAMZLexerError err = tokens->errors[i];
+            push_error("Line %d, Column %d] Unexpected character '%c': %s\n",
+                       err.line, err.column, err.character, err.message);
+        }
+        free_tokens(tokens);
+        check_for_errors();
+        return;
+    }
+
+    JAMZASTNode *ast = parser_parse(tokens);
+    free_tokens(tokens);
+    if (!ast || get_error_count() > 0)
+    {
+        free_ast(ast);
+        check_for_errors();
+        return;
+    }
+
+    double semantic_start = jamz_now_ms();
+    SemanticUpdateStats stats = semantic_session_update(session, ast);
+    double semantic_ms = jamz_now_ms() - semantic_start;
+    double elapsed = jamz_now_ms() - start;
+
+    if (get_error_count() == 0)
+        print_color("No errors found.", JAMZ_COLOR_GREEN, true);
+    check_for_errors();
+    printf("Checked in %.2f ms, semantic analysis %.2f ms (%zu function(s) analyzed, %zu reused)\n", elapsed,
+           semantic_ms, stats.analyzed, stats.reused);
+    fflush(stdout);
+    semantic_session_collect(session);
+}
+
+// Modo --watch: vuelve a comprobar el archivo cada vez que cambia en disco
+static void watch_source(const char *filename, const KeywordIndex *index)
+{
+    SemanticSession *session = create_semantic_session(index);
+    long long last_mtime = -2;
+
+    printf("\nWatching %s for changes (Ctrl+C to stop)...\n", filename);
+    for (;;)
+    {
+        long long mtime = jamz_file_mtime(filename);
+        if (mtime != last_mtime)
+        {
+            last_mtime = mtime;
+            printf("\n");
+            check_source(filename, session);
+        }
+        jamz_sleep_ms(JAMZ_WATCH_INTERVAL_MS);
+    }
+}
+
 int main(int argc, char *argv[])
 {
     setlocale(LC_ALL, "");
@@ -15,30 +100,88 @@ int main(int argc, char *argv[])
 
     int keyword_count = 0;
     Keyword *keywords = NULL;
+    KeywordIndex *keyword_index = NULL;
+    SymbolTable *symbols = NULL;
 
     char *source_code = NULL;
     JAMZTokenList *tokens = NULL;
+    JAMZASTNode *ast = NULL;
     int exit_code = EXIT_SUCCESS;
+    bool watch = false;
+    bool object = false;
+    bool jit = false;
+    bool vm = false;
+    bool instrument = false;
+    bool profile_use = false;
+    int assembly_fd = -1;
+
+    // Con --stdout el ensamblador sale por la salida estándar; todo lo demás,
+    // banner incluido, pasa a stderr para no mezclarse en la tubería
+    if (argc == 3 && strcmp(argv[1], "--stdout") == 0)
+        assembly_fd = output_detach_stdout();
 
     print_color("\nJAMZ C Compiler v0.0.1\n", JAMZ_COLOR_CYAN, true);
 
-    if (argc != 2)
+    if (argc == 3 && strcmp(argv[1], "--watch") == 0)
+        watch = true;
+    else if (argc == 3 && strcmp(argv[1], "--obj") == 0)
+        object = true;
+    else if (argc == 3 && strcmp(argv[1], "--jit") == 0)
+        jit = true;
+    else if (argc == 3 && strcmp(argv[1], "--vm") == 0)
+        vm = true;
+    else if (argc == 3 && strcmp(argv[1], "--instrument") == 0)
+        instrument = true;
+    else if (argc == 4 && strcmp(argv[1], "--instrument") == 0 && strcmp(argv[2], "--obj") == 0)
+    {
+        // El objeto ELF64 no lleva contadores ni el volcado del perfil
+        push_error("--instrument cannot write an ELF object: use --instrument alone, which profiles in-process and "
+                   "writes an instrumented .asm\n");
+        exit_code = EXIT_FAILURE;
+        goto cleanup;
+    }
+    else if (argc == 3 && strcmp(argv[1], "--profile-use") == 0)
+        profile_use = true;
+    else if (argc == 4 && strcmp(argv[1], "--profile-use") == 0 && strcmp(argv[2], "--jit") == 0)
+        profile_use = jit = true;
+    else if (argc == 3 && strcmp(argv[1], "--stdout") == 0)
+    {
+        if (assembly_fd < 0)
+        {
+            push_error("Could not redirect standard output\n");
+            exit_code = EXIT_FAILURE;
+            goto cleanup;
+        }
+    }
+    else if (argc != 2)
     {
-        push_error("Usage: %s <source_file.c>\n", argv[0]);
+        push_error("Usage: %s [--watch|--stdout|--obj|--jit|--vm|--instrument|--profile-use [--jit]] <source_file.c>\n",
+                   argv[0]);
         exit_code = EXIT_FAILURE;
         goto cleanup;
     }
 
-    const char *extension = get_filename_ext(argv[1]);
+    const char *filename = argv[argc - 1];
+    const char *extension = get_filename_ext(filename);
 
     if (strcmp(extension, "c") != 0)
     {
-        push_error("The file type you provided is not a valid C language type\nFilname: %s\n", argv[1]);
+        push_error("The file type you provided is not a valid C language type\nFilname: %s\n", filename);
         exit_code = EXIT_FAILURE;
         goto cleanup;
     }
 
-    const char *filename = argv[1];
+    if (watch)
+    {
+        keywords = load_keywords("data/keywords.json", &keyword_count);
+        if (!keywords)
+        {
+            exit_code = EXIT_FAILURE;
+            goto cleanup;
+        }
+        keyword_index = build_keyword_index(keywords, keyword_count);
+        watch_source(filename, keyword_index);
+    }
 
     source_code = read_file(filename);
 
@@ -79,7 +222,7 @@ int main(int argc, char *argv[])
 
     print_color("\nThe parser has the following AST:\n\n", JAMZ_COLOR_MAGENTA, true);
 
-    JAMZASTNode *ast = parser_parse(tokens);
+    ast = parser_parse(tokens);
 
     if (!ast)
     {
@@ -113,7 +256,11 @@ int main(int argc, char *argv[])
         print_color(keywords[i].category, JAMZ_COLOR_YELLOW, true);
     }
 
-    analyze_semantics(ast, keywords, keyword_count);
+    keyword_index = build_keyword_index(keywords, keyword_count);
+
+    double semantic_start = jamz_now_ms();
+    symbols = analyze_semantics(ast, keyword_index);
+    printf("\nSemantic analysis: %zu function(s) in %.3f ms\n", ast->block.count, jamz_now_ms() - semantic_start);
 
     if (get_error_count() > 0)
     {
@@ -124,21 +271,200 @@ int main(int argc, char *argv[])
         goto cleanup;
     }
 
-    generate_asm(ast, filename);
+    print_color("\nThe dataflow analysis: \n", JAMZ_COLOR_YELLOW, true);
 
-cleanup:
-    if (tokens != NULL)
+    size_t warning_count = analyze_dataflow(ast);
+    printf("\nDataflow analysis finished with %zu warning(s).\n", warning_count);
+
+    JAMZOptimizeStats optimization = optimize_constants(ast);
+    printf("\nOptimization report for %s: %zu operation(s) folded, %zu constant use(s) propagated.\n",
+           filename, optimization.folded, optimization.propagated);
+
+    JAMZIRProgram *ir = lower_to_ir(ast);
+    char profile_filename[1024];
+    output_filename(filename, ".profile", profile_filename, sizeof(profile_filename));
+    if (instrument || profile_use)
+        profile_insert_counters(ir, instrument);
+    if (profile_use)
     {
-        log_debug("[LOG] Liberando memoria de tokens...\n");
+        printf("\nProfile for %s:\n", filename);
+        size_t matched = 0;
+        if (!profile_read(ir, profile_filename, &matched, stdout))
+        {
+            push_error("Could not read the profile %s (run with --instrument first)\n", profile_filename);
+            free_ir(ir);
+            exit_code = EXIT_FAILURE;
+            goto cleanup;
+        }
+        profile_print(ir, stdout);
+        printf("%zu function(s) matched in %s.\n", matched, profile_filename);
+    }
 
-        for (size_t i = 0; i < tokens->count; i++)
+    // Los contadores describen los bloques del fuente: el programa
+    // instrumentado no se integra y --profile-use decide sobre esos bloques
+    printf("\nInlining report for %s:\n", filename);
+    size_t threshold = instrument ? 0 : jamz_inline_threshold(JAMZ_INLINE_DEFAULT_THRESHOLD);
+    JAMZInlineStats inlining = inline_functions(ir, threshold, stdout);
+    printf("%zu call(s) inlined, %zu kept, %zu function(s) removed; %zu -> %zu IR instructions.\n", inlining.inlined,
+           inlining.kept, inlining.removed, inlining.instructions_before, inlining.instructions_after);
+    JAMZSSAStats ssa = optimize_ir(ir);
+    printf("\nSSA optimization for %s: %zu constant(s), %zu redundant value(s), %zu loop-invariant value(s) hoisted, "
+           "%zu induction multiply(ies) reduced, %zu loop(s) vectorized, %zu dead instruction(s) removed; "
+           "%zu -> %zu IR instructions.\n",
+           filename, ssa.constants, ssa.redundant, ssa.hoisted, ssa.reduced, ssa.vectorized, ssa.removed,
+           ssa.instructions_before, ssa.instructions_after);
+    if (profile_use)
+        printf("Profile-guided layout: %zu branch(es) inverted, %zu block(s) placed differently.\n", ssa.inverted,
+               ssa.moved);
+    print_color("\nThe intermediate representation: \n", JAMZ_COLOR_YELLOW, true);
+    print_ir(ir, stdout);
+
+    if (instrument)
+    {
+        // El programa corre aquí mismo (JIT o, fuera de x86-64, la VM) y
+        // sus contadores acaban en el perfil; luego se escribe también el
+        // .asm instrumentado, que vuelca el mismo perfil al salir
+        int result = 0;
+        bool ran = false;
+        double start = jamz_now_ms();
+        if (jit_available())
+        {
+            JAMZJitResult run = jit_run_main(ir);
+            ran = run.ok;
+            result = run.result;
+        }
+        else
         {
-            log_debug("[LOG] Liberando lexema del token %d: %s\n", i, tokens->tokens[i].lexeme);
-            free(tokens->tokens[i].lexeme);
+            JAMZVMProgram *bytecode = compile_bytecode(ir);
+            ran = vm_run_main(bytecode, &result);
+            free_bytecode(bytecode);
         }
+        if (ran)
+        {
+            printf("\nInstrumented run: main returned %d (%.3f ms)\n", result, jamz_now_ms() - start);
+            profile_print(ir, stdout);
+            if (profile_write(ir, profile_filename))
+                printf("Profile written to %s (%zu block counter(s))\n", profile_filename, ir->profile->count);
+            else
+            {
+                push_error("Error writing the profile %s\n", profile_filename);
+                exit_code = EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            push_error("Could not run the instrumented %s\n", filename);
+            free_ir(ir);
+            exit_code = EXIT_FAILURE;
+            goto cleanup;
+        }
+    }
 
-        log_debug("[LOG] Memoria de tokens liberada.\n");
+    if (vm)
+    {
+        // Portátil: no necesita ensamblador ni un anfitrión x86
+        JAMZVMProgram *bytecode = compile_bytecode(ir);
+        int result = 0;
+        double start = jamz_now_ms();
+        if (vm_run_main(bytecode, &result))
+            printf("\nVM: main returned %d (%zu bytecode instruction(s), %zu superinstruction(s), ran in %.3f ms)\n",
+                   result, bytecode->instructions, bytecode->fused, jamz_now_ms() - start);
+        else
+        {
+            push_error("Could not run %s in the bytecode VM\n", filename);
+            exit_code = EXIT_FAILURE;
+        }
+        free_bytecode(bytecode);
+        free_ir(ir);
+        goto cleanup;
+    }
+
+    if (jit)
+    {
+        // Mismo código que --obj, ejecutado en el propio proceso
+        JAMZJitResult run = jit_run_main(ir);
+        if (run.ok)
+            printf("\nJIT: main returned %d (encoded in %.3f ms, ran in %.3f ms)\n", run.result, run.compile_ms,
+                   run.run_ms);
+        else
+        {
+            push_error("Could not run %s in JIT mode\n", filename);
+            exit_code = EXIT_FAILURE;
+        }
+        free_ir(ir);
+        goto cleanup;
+    }
+
+    if (object)
+    {
+        // Código máquina directo: sin ensamblador externo de por medio
+        JAMZOutputBuffer object_code;
+        output_init(&object_code);
+        char object_filename[1024];
+        output_filename(filename, ".o", object_filename, sizeof(object_filename));
+        if (generate_object(ir, &object_code) && output_write_file(&object_code, object_filename))
+            printf("\nObject file written to %s (%zu bytes)\n", object_filename, object_code.size);
+        else
+        {
+            push_error("Error writing the object file %s\n", object_filename);
+            exit_code = EXIT_FAILURE;
+        }
+        output_free(&object_code);
+        free_ir(ir);
+        goto cleanup;
+    }
+
+    JAMZPeepholeStats peephole = {{0}, 0};
+    JAMZOutputBuffer assembly;
+    output_init(&assembly);
+    if (generate_asm(ir, &assembly, &peephole, instrument ? profile_filename : NULL))
+    {
+        printf("\nPeephole rules fired:");
+        for (int rule = 0; rule < JAMZ_PEEPHOLE_RULE_COUNT; rule++)
+            printf(" %s=%zu", jamz_peephole_rule_name((JAMZPeepholeRule)rule), peephole.fired[rule]);
+        printf("\n%zu instruction(s) emitted.\n", peephole.instructions);
+
+        // Todo el archivo sale de una sola escritura
+        if (assembly_fd >= 0)
+        {
+            if (!output_write_fd(&assembly, assembly_fd))
+            {
+                push_error("Error writing the assembly to standard output\n");
+                exit_code = EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            char asm_filename[1024];
+            output_filename(filename, ".asm", asm_filename, sizeof(asm_filename));
+            if (output_write_file(&assembly, asm_filename))
+            {
+                printf("Assembly written to %s (%zu bytes)\n", asm_filename, assembly.size);
+                if (instrument)
+                    printf("Linked against libc, it writes %s at exit.\n", profile_filename);
+            }
+            else
+            {
+                push_error("Error writing the assembly file %s\n", asm_filename);
+                exit_code = EXIT_FAILURE;
+            }
+        }
+    }
+    else
+    {
+        push_error("Could not generate the assembly for %s\n", filename);
+        exit_code = EXIT_FAILURE;
+    }
+    output_free(&assembly);
+    free_ir(ir);
+
+cleanup:
+    if (tokens != NULL)
+    {
+        // free_tokens ya libera cada lexema
+        log_debug("[LOG] Liberando memoria de tokens...\n");
         free_tokens(tokens);
+        log_debug("[LOG] Memoria de tokens liberada.\n");
     }
 
     if (source_code != NULL)
@@ -150,6 +476,8 @@ cleanup:
     if (ast != NULL)
         free_ast(ast);
 
+    free_symbol_table(symbols);
+
     if (get_error_count() > 0)
     {
         print_error_stack();
@@ -157,6 +485,10 @@ cleanup:
         clear_error_stack();
     }
 
+    free_keyword_index(keyword_index);
+    free_type_table();
+    free_template_table();
+
     if (keywords != NULL && keyword_count > 0)
     {
         for (int i = 0; i < keyword_count; i++)
@@ -0,0 +1,1082 @@
+#include "analysis.h"
+#include "dataflow.h"
+#include "semantic.h"
+#include "utils.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+
+// Un elemento es una sentencia simple dentro de un bloque básico
+typedef enum
+{
+    ITEM_PARAM,     // Parámetro: definido al entrar en la función
+    ITEM_STATEMENT, // Declaración, asignación, return o llamada
+    ITEM_CONDITION, // Condición de un if o un bucle (termina su bloque)
+} ItemKind;
+
+typedef struct
+{
+    ItemKind kind;
+    JAMZASTNode *node;
+} FlowItem;
+
+// Los elementos de cada bloque son contiguos: un bloque solo recibe
+// sentencias mientras es el bloque actual de la construcción
+typedef struct
+{
+    size_t first;
+    size_t count;
+} FlowBlock;
+
+typedef struct
+{
+    FlowItem *items;
+    size_t item_count;
+    size_t item_capacity;
+
+    FlowBlock *blocks;
+    size_t block_count;
+    size_t block_capacity;
+
+    JAMZFlowEdge *edges;
+    size_t edge_count;
+    size_t edge_capacity;
+
+    size_t current; // Bloque que recibe las sentencias
+    size_t exit;
+    size_t break_target;    // Bloques a los que saltan break y continue en
+    size_t continue_target; // el bucle más interno, o SIZE_MAX fuera de bucles
+} FlowBuilder;
+
+// Definición de una variable; las "pseudo" representan el valor basura de
+// una declaración sin inicializador
+typedef struct
+{
+    size_t var;
+    size_t item;
+    bool pseudo;
+} FlowDef;
+
+typedef struct
+{
+    int line;
+    int column;
+    char message[MAX_ERROR_LEN];
+} FlowWarning;
+
+typedef struct
+{
+    FlowWarning *items;
+    size_t count;
+    size_t capacity;
+} WarningList;
+
+static size_t new_block(FlowBuilder *builder)
+{
+    if (builder->block_count == builder->block_capacity)
+    {
+        builder->block_capacity = builder->block_capacity ? builder->block_capacity * 2 : 16;
+        builder->blocks = safe_realloc(builder->blocks, builder->block_capacity * sizeof(FlowBlock));
+    }
+    builder->blocks[builder->block_count].first = builder->item_count;
+    builder->blocks[builder->block_count].count = 0;
+    return builder->block_count++;
+}
+
+// Hace actual un bloque creado antes y aún vacío (destino de break o
+// continue): sus elementos empiezan donde va ahora la lista
+static void enter_block(FlowBuilder *builder, size_t block)
+{
+    builder->blocks[block].first = builder->item_count;
+    builder->current = block;
+}
+
+static void add_edge(FlowBuilder *builder, size_t from, size_t to)
+{
+    if (builder->edge_count == builder->edge_capacity)
+    {
+        builder->edge_capacity = builder->edge_capacity ? builder->edge_capacity * 2 : 16;
+        builder->edges = safe_realloc(builder->edges, builder->edge_capacity * sizeof(JAMZFlowEdge));
+    }
+    builder->edges[builder->edge_count].from = from;
+    builder->edges[builder->edge_count].to = to;
+    builder->edge_count++;
+}
+
+static void add_item(FlowBuilder *builder, ItemKind kind, JAMZASTNode *node)
+{
+    if (builder->item_count == builder->item_capacity)
+    {
+        builder->item_capacity = builder->item_capacity ? builder->item_capacity * 2 : 64;
+        builder->items = safe_realloc(builder->items, builder->item_capacity * sizeof(FlowItem));
+    }
+    builder->items[builder->item_count].kind = kind;
+    builder->items[builder->item_count].node = node;
+    builder->item_count++;
+    builder->blocks[builder->current].count++;
+}
+
+static void build_statement(FlowBuilder *builder, JAMZASTNode *node)
+{
+    if (!node)
+        return;
+
+    switch (node->type)
+    {
+    case JAMZ_AST_BLOCK:
+        for (size_t i = 0; i < node->block.count; i++)
+            build_statement(builder, node->block.statements[i]);
+        break;
+    case JAMZ_AST_IF:
+    {
+        add_item(builder, ITEM_CONDITION, node);
+        size_t condition_block = builder->current;
+
+        builder->current = new_block(builder);
+        add_edge(builder, condition_block, builder->current);
+        build_statement(builder, node->if_stmt.then_branch);
+        size_t then_end = builder->current;
+
+        size_t else_end = condition_block;
+        if (node->if_stmt.else_branch)
+        {
+            builder->current = new_block(builder);
+            add_edge(builder, condition_block, builder->current);
+            build_statement(builder, node->if_stmt.else_branch);
+            else_end = builder->current;
+        }
+
+        builder->current = new_block(builder);
+        add_edge(builder, then_end, builder->current);
+        add_edge(builder, else_end, builder->current);
+        break;
+    }
+    case JAMZ_AST_WHILE:
+    {
+        // cabecera (condición) -> cuerpo -> continue (paso) -> cabecera; la
+        // arista al cuerpo es la primera, como la rama then de un if
+        size_t header = new_block(builder);
+        add_edge(builder, builder->current, header);
+        builder->current = header;
+        if (node->while_stmt.condition)
+            add_item(builder, ITEM_CONDITION, node);
+
+        size_t saved_break = builder->break_target;
+        size_t saved_continue = builder->continue_target;
+        builder->current = new_block(builder);
+        add_edge(builder, header, builder->current);
+        builder->break_target = new_block(builder);
+        builder->continue_target = new_block(builder);
+        build_statement(builder, node->while_stmt.body);
+
+        add_edge(builder, builder->current, builder->continue_target);
+        enter_block(builder, builder->continue_target);
+        build_statement(builder, node->while_stmt.step);
+        add_edge(builder, builder->current, header);
+
+        if (node->while_stmt.condition)
+            add_edge(builder, header, builder->break_target);
+        enter_block(builder, builder->break_target);
+        builder->break_target = saved_break;
+        builder->continue_target = saved_continue;
+        break;
+    }
+    case JAMZ_AST_BREAK:
+    case JAMZ_AST_CONTINUE:
+        add_edge(builder, builder->current,
+                 node->type == JAMZ_AST_BREAK ? builder->break_target : builder->continue_target);
+        builder->current = new_block(builder);
+        break;
+    case JAMZ_AST_RETURN:
+        add_item(builder, ITEM_STATEMENT, node);
+        add_edge(builder, builder->current, builder->exit);
+        // Lo que siga al return queda en un bloque sin predecesores
+        builder->current = new_block(builder);
+        break;
+    default:
+        add_item(builder, ITEM_STATEMENT, node);
+        break;
+    }
+}
+
+// Expresión que decide un elemento ITEM_CONDITION
+static JAMZASTNode *condition_of(const JAMZASTNode *node)
+{
+    return node->type == JAMZ_AST_WHILE ? node->while_stmt.condition : node->if_stmt.condition;
+}
+
+// Variable local resuelta por el análisis semántico, o NULL
+static const Symbol *variable_symbol(const JAMZASTNode *node)
+{
+    if (!node || !node->symbol || node->symbol->type != SYMBOL_VARIABLE)
+        return NULL;
+    return node->symbol;
+}
+
+// Expresión que lee el elemento (las lecturas ocurren antes que la escritura)
+static const JAMZASTNode *item_uses(const FlowItem *item)
+{
+    const JAMZASTNode *node = item->node;
+    if (item->kind == ITEM_PARAM)
+        return NULL;
+    if (item->kind == ITEM_CONDITION)
+        return condition_of(node);
+
+    switch (node->type)
+    {
+    case JAMZ_AST_DECLARATION:
+        return node->declaration.initializer;
+    case JAMZ_AST_ASSIGNMENT:
+        // Un elemento de arreglo también lee su índice
+        return node->assignment.index ? node : node->assignment.value;
+    case JAMZ_AST_RETURN:
+        return node->return_stmt.value;
+    default:
+        return node;
+    }
+}
+
+// Variable que escribe el elemento, o NULL. Los arreglos quedan fuera: sus
+// elementos no se siguen uno a uno.
+static const Symbol *item_def(const FlowItem *item, bool *pseudo)
+{
+    const JAMZASTNode *node = item->node;
+    *pseudo = false;
+    if (item->kind == ITEM_CONDITION)
+        return NULL;
+    if (node->type == JAMZ_AST_DECLARATION && !jamz_type_is_array(node->declaration.type_id))
+    {
+        *pseudo = item->kind != ITEM_PARAM && node->declaration.initializer == NULL;
+        return variable_symbol(node);
+    }
+    if (node->type == JAMZ_AST_ASSIGNMENT && !node->assignment.index)
+        return variable_symbol(node);
+    return NULL;
+}
+
+typedef void (*UseVisitor)(const JAMZASTNode *variable, void *data);
+
+static void visit_uses(const JAMZASTNode *expr, UseVisitor visit, void *data)
+{
+    if (!expr)
+        return;
+
+    switch (expr->type)
+    {
+    case JAMZ_AST_VARIABLE:
+        if (variable_symbol(expr))
+            visit(expr, data);
+        break;
+    case JAMZ_AST_BINARY:
+        visit_uses(expr->binary.left, visit, data);
+        visit_uses(expr->binary.right, visit, data);
+        break;
+    case JAMZ_AST_CALL:
+        for (size_t i = 0; i < expr->call.arg_count; i++)
+            visit_uses(expr->call.args[i], visit, data);
+        break;
+    case JAMZ_AST_INDEX:
+        visit_uses(expr->index.index, visit, data);
+        break;
+    case JAMZ_AST_ASSIGNMENT:
+        visit_uses(expr->assignment.index, visit, data);
+        visit_uses(expr->assignment.value, visit, data);
+        break;
+    default:
+        break;
+    }
+}
+
+static void push_warning(WarningList *list, const JAMZASTNode *node, const char *format, ...)
+{
+    if (list->count == list->capacity)
+    {
+        list->capacity = list->capacity ? list->capacity * 2 : 16;
+        list->items = safe_realloc(list->items, list->capacity * sizeof(FlowWarning));
+    }
+
+    FlowWarning *warning = &list->items[list->count++];
+    warning->line = node->line;
+    warning->column = node->column;
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(warning->message, sizeof(warning->message), format, args);
+    va_end(args);
+}
+
+typedef struct
+{
+    size_t var_count;
+    FlowDef *defs;
+    size_t def_count;
+    size_t *var_def_start; // Definiciones de v: var_defs[var_def_start[v] .. var_def_start[v + 1])
+    size_t *var_defs;
+    size_t *item_def;      // Definición de cada elemento, o SIZE_MAX
+} DefIndex;
+
+static void index_definitions(DefIndex *index, const FlowBuilder *builder)
+{
+    index->var_count = 0;
+    index->def_count = 0;
+    index->defs = safe_malloc((builder->item_count ? builder->item_count : 1) * sizeof(FlowDef));
+    index->item_def = safe_malloc((builder->item_count ? builder->item_count : 1) * sizeof(size_t));
+
+    for (size_t i = 0; i < builder->item_count; i++)
+    {
+        bool pseudo;
+        const Symbol *sym = item_def(&builder->items[i], &pseudo);
+        index->item_def[i] = SIZE_MAX;
+        if (!sym)
+            continue;
+        index->item_def[i] = index->def_count;
+        index->defs[index->def_count].var = sym->id;
+        index->defs[index->def_count].item = i;
+        index->defs[index->def_count].pseudo = pseudo;
+        index->def_count++;
+        if (sym->id + 1 > index->var_count)
+            index->var_count = sym->id + 1;
+    }
+
+    index->var_def_start = calloc(index->var_count + 1, sizeof(size_t));
+    index->var_defs = safe_malloc((index->def_count ? index->def_count : 1) * sizeof(size_t));
+    if (!index->var_def_start)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for definition index\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t d = 0; d < index->def_count; d++)
+        index->var_def_start[index->defs[d].var + 1]++;
+    for (size_t v = 0; v < index->var_count; v++)
+        index->var_def_start[v + 1] += index->var_def_start[v];
+
+    size_t *fill = safe_malloc((index->var_count ? index->var_count : 1) * sizeof(size_t));
+    memcpy(fill, index->var_def_start, index->var_count * sizeof(size_t));
+    for (size_t d = 0; d < index->def_count; d++)
+        index->var_defs[fill[index->defs[d].var]++] = d;
+    free(fill);
+}
+
+static void free_def_index(DefIndex *index)
+{
+    free(index->defs);
+    free(index->var_def_start);
+    free(index->var_defs);
+    free(index->item_def);
+}
+
+// Definiciones alcanzables: hacia delante, unión, un bit por definición
+typedef struct
+{
+    const DefIndex *index;
+    JAMZBitset reaching;
+    WarningList *warnings;
+} UninitCheck;
+
+static void check_uninitialized_use(const JAMZASTNode *variable, void *data)
+{
+    UninitCheck *check = data;
+    const DefIndex *index = check->index;
+    size_t var = variable->symbol->id;
+    if (var >= index->var_count)
+        return; // Nunca se definió: ya lo reporta el análisis semántico
+
+    bool real = false;
+    bool pseudo = false;
+    for (size_t k = index->var_def_start[var]; k < index->var_def_start[var + 1]; k++)
+    {
+        size_t d = index->var_defs[k];
+        if (!jamz_bitset_test(check->reaching, d))
+            continue;
+        if (index->defs[d].pseudo)
+            pseudo = true;
+        else
+            real = true;
+    }
+
+    if (pseudo && !real)
+        push_warning(check->warnings, variable, "Variable '%s' usada sin inicializar (línea %d, col %d)\n",
+                     variable->variable.var_name, variable->line, variable->column);
+    else if (pseudo)
+        push_warning(check->warnings, variable, "Variable '%s' puede usarse sin inicializar (línea %d, col %d)\n",
+                     variable->variable.var_name, variable->line, variable->column);
+}
+
+static void reaching_definitions(const FlowBuilder *builder, const JAMZFlowGraph *graph,
+                                 const DefIndex *index, WarningList *warnings)
+{
+    JAMZDataflowProblem problem;
+    jamz_dataflow_init(&problem, graph, JAMZ_DATAFLOW_FORWARD, JAMZ_DATAFLOW_UNION, index->def_count);
+
+    for (size_t b = 0; b < builder->block_count; b++)
+    {
+        const FlowBlock *block = &builder->blocks[b];
+        for (size_t i = block->first; i < block->first + block->count; i++)
+        {
+            size_t d = index->item_def[i];
+            if (d == SIZE_MAX)
+                continue;
+            // Cada definición mata a todas las de su variable, incluidas las
+            // anteriores del bloque, y se genera a sí misma
+            size_t var = index->defs[d].var;
+            for (size_t k = index->var_def_start[var]; k < index->var_def_start[var + 1]; k++)
+            {
+                jamz_bitset_set(problem.kill[b], index->var_defs[k]);
+                jamz_bitset_clear(problem.gen[b], index->var_defs[k]);
+            }
+            jamz_bitset_set(problem.gen[b], d);
+        }
+    }
+
+    size_t visits = jamz_dataflow_solve(&problem, graph);
+    log_debug("Definiciones alcanzables: %zu definiciones, %zu visitas de bloque\n", index->def_count, visits);
+
+    // Recorre cada bloque con el conjunto en vivo para comprobar cada lectura
+    JAMZBitset reaching = {safe_malloc((problem.boundary.word_count + 1) * sizeof(JAMZBitWord)), problem.boundary.word_count};
+    UninitCheck check = {index, reaching, warnings};
+    for (size_t b = 0; b < builder->block_count; b++)
+    {
+        if (graph->rpo_index[b] == SIZE_MAX)
+            continue;
+        jamz_bitset_copy(reaching, problem.in[b]);
+
+        const FlowBlock *block = &builder->blocks[b];
+        for (size_t i = block->first; i < block->first + block->count; i++)
+        {
+            visit_uses(item_uses(&builder->items[i]), check_uninitialized_use, &check);
+
+            size_t d = index->item_def[i];
+            if (d == SIZE_MAX)
+                continue;
+            size_t var = index->defs[d].var;
+            for (size_t k = index->var_def_start[var]; k < index->var_def_start[var + 1]; k++)
+                jamz_bitset_clear(reaching, index->var_defs[k]);
+            jamz_bitset_set(reaching, d);
+        }
+    }
+
+    free(reaching.words);
+    jamz_dataflow_free(&problem);
+}
+
+// Variables vivas: hacia atrás, unión, un bit por variable
+typedef struct
+{
+    JAMZBitset set;
+    size_t var_count;
+} LiveUpdate;
+
+static void mark_live(const JAMZASTNode *variable, void *data)
+{
+    LiveUpdate *update = data;
+    if (variable->symbol->id < update->var_count)
+        jamz_bitset_set(update->set, variable->symbol->id);
+}
+
+// Lectura antes de cualquier escritura en el bloque: gen = uso, kill = definición
+typedef struct
+{
+    JAMZBitset gen;
+    JAMZBitset kill;
+    size_t var_count;
+} LiveSummary;
+
+static void summarize_use(const JAMZASTNode *variable, void *data)
+{
+    LiveSummary *summary = data;
+    size_t var = variable->symbol->id;
+    if (var < summary->var_count && !jamz_bitset_test(summary->kill, var))
+        jamz_bitset_set(summary->gen, var);
+}
+
+static void dead_stores(const FlowBuilder *builder, const JAMZFlowGraph *graph,
+                        const DefIndex *index, WarningList *warnings)
+{
+    JAMZDataflowProblem problem;
+    jamz_dataflow_init(&problem, graph, JAMZ_DATAFLOW_BACKWARD, JAMZ_DATAFLOW_UNION, index->var_count);
+
+    for (size_t b = 0; b < builder->block_count; b++)
+    {
+        const FlowBlock *block = &builder->blocks[b];
+        LiveSummary summary = {problem.gen[b], problem.kill[b], index->var_count};
+        for (size_t i = block->first; i < block->first + block->count; i++)
+        {
+            visit_uses(item_uses(&builder->items[i]), summarize_use, &summary);
+            size_t d = index->item_def[i];
+            if (d != SIZE_MAX)
+                jamz_bitset_set(problem.kill[b], index->defs[d].var);
+        }
+    }
+
+    size_t visits = jamz_dataflow_solve(&problem, graph);
+    log_debug("Variables vivas: %zu variables, %zu visitas de bloque\n", index->var_count, visits);
+
+    JAMZBitset live = {safe_malloc((problem.boundary.word_count + 1) * sizeof(JAMZBitWord)), problem.boundary.word_count};
+    LiveUpdate update = {live, index->var_count};
+    for (size_t b = 0; b < builder->block_count; b++)
+    {
+        if (graph->rpo_index[b] == SIZE_MAX)
+            continue;
+        jamz_bitset_copy(live, problem.out[b]);
+
+        const FlowBlock *block = &builder->blocks[b];
+        for (size_t i = block->first + block->count; i-- > block->first;)
+        {
+            const FlowItem *item = &builder->items[i];
+            size_t d = index->item_def[i];
+            if (d != SIZE_MAX)
+            {
+                size_t var = index->defs[d].var;
+                if (!index->defs[d].pseudo && item->kind != ITEM_PARAM && !jamz_bitset_test(live, var))
+                {
+                    const JAMZASTNode *node = item->node;
+                    if (node->type == JAMZ_AST_DECLARATION)
+                        push_warning(warnings, node, "El valor inicial de '%s' nunca se usa (línea %d, col %d)\n",
+                                     node->declaration.var_name, node->line, node->column);
+                    else
+                        push_warning(warnings, node, "El valor asignado a '%s' nunca se usa (línea %d, col %d)\n",
+                                     node->assignment.var_name, node->line, node->column);
+                }
+                jamz_bitset_clear(live, var);
+            }
+            visit_uses(item_uses(item), mark_live, &update);
+        }
+    }
+
+    free(live.words);
+    jamz_dataflow_free(&problem);
+}
+
+// Rangos de enteros: intervalo [lo, hi] de valores int de 32 bits. Un
+// intervalo con lo > hi es vacío (bloque aún no alcanzado).
+typedef struct
+{
+    int32_t lo;
+    int32_t hi;
+} Interval;
+
+#define RANGE_TOP ((Interval){INT32_MIN, INT32_MAX})
+// Visitas a una cabecera de bucle antes de ensanchar sus rangos
+#define RANGE_WIDEN_DELAY 2
+
+static bool interval_is_top(Interval value)
+{
+    return value.lo == INT32_MIN && value.hi == INT32_MAX;
+}
+
+static Interval interval_join(Interval a, Interval b)
+{
+    Interval result = {a.lo < b.lo ? a.lo : b.lo, a.hi > b.hi ? a.hi : b.hi};
+    return result;
+}
+
+// Ensanchamiento: el límite que sigue creciendo salta al extremo de int
+static Interval interval_widen(Interval old, Interval value)
+{
+    Interval result = {value.lo < old.lo ? INT32_MIN : old.lo, value.hi > old.hi ? INT32_MAX : old.hi};
+    return result;
+}
+
+typedef struct
+{
+    Interval *state; // Rango de cada variable, indexado por Symbol.id
+    size_t var_count;
+    WarningList *warnings; // NULL mientras se busca el punto fijo
+} RangeEval;
+
+static bool literal_number(const JAMZASTNode *node, int32_t *value)
+{
+    if (node->literal.token_type != JAMZ_TOKEN_NUMBER)
+        return false;
+
+    char *end;
+    errno = 0;
+    long long parsed = strtoll(node->literal.value, &end, 10);
+    if (errno != 0 || *end != '\0' || end == node->literal.value || parsed < INT32_MIN || parsed > INT32_MAX)
+        return false;
+    *value = (int32_t)parsed;
+    return true;
+}
+
+// Extremos de a op b para divisores de un solo signo (sin el cero)
+static void divide_corners(Interval left, int64_t low, int64_t high, int64_t *min, int64_t *max)
+{
+    int64_t corners[4] = {left.lo / low, left.lo / high, left.hi / low, left.hi / high};
+    for (int k = 0; k < 4; k++)
+    {
+        if (corners[k] < *min)
+            *min = corners[k];
+        if (corners[k] > *max)
+            *max = corners[k];
+    }
+}
+
+// |a % b| < |b| y el resto lleva el signo de a (truncamiento hacia cero)
+static Interval remainder_range(Interval left, Interval right)
+{
+    int64_t divisor = -(int64_t)right.lo > right.hi ? -(int64_t)right.lo : right.hi;
+    int64_t bound = divisor - 1;
+    int64_t low = left.lo < 0 ? (left.lo > -bound ? left.lo : -bound) : 0;
+    int64_t high = left.hi > 0 ? (left.hi < bound ? left.hi : bound) : 0;
+    return (Interval){(int32_t)low, (int32_t)high};
+}
+
+static Interval evaluate_range(RangeEval *eval, JAMZASTNode *node);
+
+static Interval evaluate_binary(RangeEval *eval, JAMZASTNode *node)
+{
+    Interval left = evaluate_range(eval, node->binary.left);
+    Interval right = evaluate_range(eval, node->binary.right);
+    const char *op = node->binary.op;
+
+    bool division = strcmp(op, "/") == 0 || strcmp(op, "%") == 0;
+    if (eval->warnings && division)
+        node->binary.non_negative = left.lo >= 0 && right.lo >= 0;
+    // Las comparaciones valen 0 o 1 y no desbordan
+    if (jamz_is_comparison(op))
+        return (Interval){0, 1};
+
+    // Los límites se calculan en 64 bits: el producto de dos int32 cabe
+    int64_t min = INT64_MAX;
+    int64_t max = INT64_MIN;
+    if (strcmp(op, "+") == 0)
+    {
+        min = (int64_t)left.lo + right.lo;
+        max = (int64_t)left.hi + right.hi;
+    }
+    else if (strcmp(op, "-") == 0)
+    {
+        min = (int64_t)left.lo - right.hi;
+        max = (int64_t)left.hi - right.lo;
+    }
+    else if (strcmp(op, "*") == 0)
+    {
+        int64_t corners[4] = {(int64_t)left.lo * right.lo, (int64_t)left.lo * right.hi,
+                              (int64_t)left.hi * right.lo, (int64_t)left.hi * right.hi};
+        min = max = corners[0];
+        for (int k = 1; k < 4; k++)
+        {
+            if (corners[k] < min)
+                min = corners[k];
+            if (corners[k] > max)
+                max = corners[k];
+        }
+    }
+    else if (division)
+    {
+        bool zero = right.lo <= 0 && right.hi >= 0;
+        // Sin información del divisor (parámetros, llamadas) avisar de cada
+        // división solo añadiría ruido: se exige un rango acotado
+        if (eval->warnings && right.lo == 0 && right.hi == 0)
+            push_warning(eval->warnings, node, "División por cero (línea %d, col %d)\n", node->line, node->column);
+        else if (eval->warnings && zero && !interval_is_top(right))
+            push_warning(eval->warnings, node, "Posible división por cero (línea %d, col %d)\n", node->line, node->column);
+
+        if (strcmp(op, "%") == 0)
+        {
+            if (right.lo == 0 && right.hi == 0)
+                return RANGE_TOP;
+            return remainder_range(left, right);
+        }
+        if (right.lo < 0)
+            divide_corners(left, right.lo, right.hi < 0 ? right.hi : -1, &min, &max);
+        if (right.hi > 0)
+            divide_corners(left, right.lo > 0 ? right.lo : 1, right.hi, &min, &max);
+        if (min > max)
+            return RANGE_TOP; // Solo puede dividir por cero: la ejecución no sigue
+        if (zero)
+            return (min < INT32_MIN || max > INT32_MAX) ? RANGE_TOP : (Interval){(int32_t)min, (int32_t)max};
+    }
+    else
+        return RANGE_TOP;
+
+    if (min >= INT32_MIN && max <= INT32_MAX)
+        return (Interval){(int32_t)min, (int32_t)max};
+
+    if (eval->warnings && (max < INT32_MIN || min > INT32_MAX))
+        push_warning(eval->warnings, node, "La operación '%s' desborda int (línea %d, col %d)\n", op, node->line, node->column);
+    else if (eval->warnings && !interval_is_top(left) && !interval_is_top(right))
+        push_warning(eval->warnings, node, "La operación '%s' puede desbordar int (línea %d, col %d)\n", op, node->line, node->column);
+
+    // El código generado da la vuelta en 32 bits: un único valor se conserva
+    if (min == max)
+    {
+        int32_t wrapped = (int32_t)(uint32_t)(uint64_t)min;
+        return (Interval){wrapped, wrapped};
+    }
+    return RANGE_TOP;
+}
+
+// Acceso a un elemento de arreglo: avisa si el rango del índice se sale de
+// [0, longitud) entero o en parte. Un índice sin información no avisa.
+static void check_bounds(RangeEval *eval, const JAMZASTNode *access, const char *name, JAMZASTNode *index)
+{
+    Interval range = evaluate_range(eval, index);
+    const Symbol *sym = variable_symbol(access);
+    if (!eval->warnings || !sym || !jamz_type_is_array(sym->type_id) || interval_is_top(range))
+        return;
+    int64_t length = (int64_t)jamz_type_info(sym->type_id)->length;
+    if (range.hi < 0 || range.lo >= length)
+        push_warning(eval->warnings, access, "Índice fuera de rango en '%s' (línea %d, col %d)\n", name, access->line,
+                     access->column);
+    else if (range.lo < 0 || range.hi >= length)
+        push_warning(eval->warnings, access, "Posible índice fuera de rango en '%s' (línea %d, col %d)\n", name,
+                     access->line, access->column);
+}
+
+static Interval evaluate_range(RangeEval *eval, JAMZASTNode *node)
+{
+    if (!node)
+        return RANGE_TOP;
+
+    switch (node->type)
+    {
+    case JAMZ_AST_LITERAL:
+    {
+        int32_t value;
+        if (literal_number(node, &value))
+            return (Interval){value, value};
+        return RANGE_TOP;
+    }
+    case JAMZ_AST_VARIABLE:
+    {
+        const Symbol *sym = variable_symbol(node);
+        if (!sym || sym->id >= eval->var_count)
+            return RANGE_TOP;
+        return eval->state[sym->id];
+    }
+    case JAMZ_AST_BINARY:
+        return evaluate_binary(eval, node);
+    case JAMZ_AST_INDEX:
+        // Los elementos no se siguen: valen cualquier int
+        check_bounds(eval, node, node->index.var_name, node->index.index);
+        return RANGE_TOP;
+    case JAMZ_AST_CALL:
+        for (size_t i = 0; i < node->call.arg_count; i++)
+            evaluate_range(eval, node->call.args[i]);
+        return RANGE_TOP;
+    default:
+        return RANGE_TOP;
+    }
+}
+
+// Transferencia de un elemento: evalúa lo que lee y actualiza lo que escribe
+static void range_transfer(RangeEval *eval, const FlowItem *item)
+{
+    JAMZASTNode *node = item->node;
+    if (item->kind == ITEM_PARAM)
+        return; // Los parámetros valen cualquier int desde la entrada
+
+    if (item->kind == ITEM_CONDITION)
+    {
+        evaluate_range(eval, condition_of(node));
+        return;
+    }
+
+    Interval value = RANGE_TOP;
+    switch (node->type)
+    {
+    case JAMZ_AST_DECLARATION:
+        if (node->declaration.initializer)
+            value = evaluate_range(eval, node->declaration.initializer);
+        break;
+    case JAMZ_AST_ASSIGNMENT:
+        if (node->assignment.index)
+        {
+            check_bounds(eval, node, node->assignment.var_name, node->assignment.index);
+            evaluate_range(eval, node->assignment.value);
+            return;
+        }
+        value = evaluate_range(eval, node->assignment.value);
+        break;
+    case JAMZ_AST_RETURN:
+        evaluate_range(eval, node->return_stmt.value);
+        return;
+    default:
+        evaluate_range(eval, node);
+        return;
+    }
+
+    const Symbol *sym = variable_symbol(node);
+    if (sym && sym->id < eval->var_count)
+        eval->state[sym->id] = value;
+}
+
+// Restringe v a los valores que cumplen "v op other"; false si no queda ninguno
+static bool restrict_range(Interval *value, const char *op, Interval other)
+{
+    int64_t lo = value->lo;
+    int64_t hi = value->hi;
+    if (strcmp(op, "<") == 0)
+        hi = hi < (int64_t)other.hi - 1 ? hi : (int64_t)other.hi - 1;
+    else if (strcmp(op, "<=") == 0)
+        hi = hi < other.hi ? hi : other.hi;
+    else if (strcmp(op, ">") == 0)
+        lo = lo > (int64_t)other.lo + 1 ? lo : (int64_t)other.lo + 1;
+    else if (strcmp(op, ">=") == 0)
+        lo = lo > other.lo ? lo : other.lo;
+    else if (strcmp(op, "==") == 0)
+    {
+        lo = lo > other.lo ? lo : other.lo;
+        hi = hi < other.hi ? hi : other.hi;
+    }
+    else if (other.lo == other.hi) // "!=" con un único valor: recorta un extremo
+    {
+        if (lo == other.lo)
+            lo++;
+        if (hi == other.hi)
+            hi--;
+    }
+    if (lo > hi)
+        return false;
+    value->lo = (int32_t)lo;
+    value->hi = (int32_t)hi;
+    return true;
+}
+
+// Comparación que se cumple al cambiar de lado los operandos (a < b es b > a)
+// o al negarla (a < b falso es a >= b)
+static const char *mirror_comparison(const char *op, bool negate)
+{
+    static const char *const ops[][3] = {
+        {"<", ">", ">="}, {"<=", ">=", ">"}, {">", "<", "<="}, {">=", "<=", "<"}, {"==", "==", "!="}, {"!=", "!=", "=="},
+    };
+    for (size_t k = 0; k < sizeof(ops) / sizeof(ops[0]); k++)
+    {
+        if (strcmp(op, ops[k][0]) == 0)
+            return ops[k][negate ? 2 : 1];
+    }
+    return op;
+}
+
+// Refina el estado en la arista que sale de una condición: "v" es distinto
+// de cero en la rama tomada (primer sucesor) y cero en la otra; "v op e" y
+// "e op v" acotan v con el rango de e. Devuelve false si la arista es
+// imposible con los rangos conocidos.
+static bool refine_condition(Interval *state, size_t var_count, const FlowItem *last, bool taken)
+{
+    if (!last || last->kind != ITEM_CONDITION)
+        return true;
+    JAMZASTNode *condition = condition_of(last->node);
+    if (condition && condition->type == JAMZ_AST_BINARY && jamz_is_comparison(condition->binary.op))
+    {
+        RangeEval eval = {state, var_count, NULL};
+        const char *op = taken ? condition->binary.op : mirror_comparison(condition->binary.op, true);
+        const Symbol *left = variable_symbol(condition->binary.left);
+        const Symbol *right = variable_symbol(condition->binary.right);
+        Interval left_range = evaluate_range(&eval, condition->binary.left);
+        Interval right_range = evaluate_range(&eval, condition->binary.right);
+        if (left && left->id < var_count && !restrict_range(&state[left->id], op, right_range))
+            return false;
+        if (right && right->id < var_count &&
+            !restrict_range(&state[right->id], mirror_comparison(op, false), left_range))
+            return false;
+        return true;
+    }
+    const Symbol *sym = variable_symbol(condition);
+    if (!sym || sym->id >= var_count)
+        return true;
+
+    Interval *value = &state[sym->id];
+    if (!taken)
+    {
+        if (value->lo > 0 || value->hi < 0)
+            return false;
+        value->lo = value->hi = 0;
+        return true;
+    }
+    if (value->lo == 0 && value->hi == 0)
+        return false;
+    if (value->lo == 0)
+        value->lo = 1;
+    else if (value->hi == 0)
+        value->hi = -1;
+    return true;
+}
+
+static void range_analysis(const FlowBuilder *builder, const JAMZFlowGraph *graph,
+                           size_t var_count, WarningList *warnings)
+{
+    size_t blocks = builder->block_count;
+    size_t width = var_count ? var_count : 1;
+    Interval *in = safe_malloc(blocks * width * sizeof(Interval));
+    Interval *out = safe_malloc(blocks * width * sizeof(Interval));
+    Interval *scratch = safe_malloc(width * sizeof(Interval));
+    Interval *refined = safe_malloc(width * sizeof(Interval));
+    bool *reached = calloc(blocks ? blocks : 1, sizeof(bool));
+    size_t *visits = calloc(blocks ? blocks : 1, sizeof(size_t));
+    if (!reached || !visits)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for range analysis\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Sin aristas de retroceso una pasada en postorden inverso ya es el punto fijo
+    bool cyclic = false;
+    for (size_t r = 0; r < graph->rpo_count && !cyclic; r++)
+    {
+        size_t b = graph->rpo[r];
+        for (size_t e = graph->succ_start[b]; e < graph->succ_start[b + 1]; e++)
+            cyclic |= graph->rpo_index[graph->succs[e]] <= r;
+    }
+
+    // Iteración en postorden inverso hasta el punto fijo; en las cabeceras
+    // de bucle (con un predecesor posterior en el orden) se ensancha para
+    // garantizar que termina
+    size_t rounds = 0;
+    bool changed = true;
+    while (changed && (cyclic || rounds == 0))
+    {
+        changed = false;
+        rounds++;
+        for (size_t r = 0; r < graph->rpo_count; r++)
+        {
+            size_t b = graph->rpo[r];
+            bool any = b == graph->entry;
+            bool loop_head = false;
+            for (size_t v = 0; v < var_count; v++)
+                scratch[v] = RANGE_TOP;
+
+            if (b != graph->entry)
+            {
+                for (size_t e = graph->pred_start[b]; e < graph->pred_start[b + 1]; e++)
+                {
+                    size_t p = graph->preds[e];
+                    if (graph->rpo_index[p] != SIZE_MAX && graph->rpo_index[p] >= r)
+                        loop_head = true;
+                    if (!reached[p])
+                        continue;
+
+                    // Estado al final de p, refinado por la condición de la arista
+                    Interval *edge = out + p * width;
+                    const FlowBlock *pred = &builder->blocks[p];
+                    const FlowItem *last = pred->count ? &builder->items[pred->first + pred->count - 1] : NULL;
+                    if (last && last->kind == ITEM_CONDITION)
+                    {
+                        bool taken = graph->succs[graph->succ_start[p]] == b;
+                        memcpy(refined, edge, var_count * sizeof(Interval));
+                        if (!refine_condition(refined, var_count, last, taken))
+                            continue;
+                        edge = refined;
+                    }
+
+                    for (size_t v = 0; v < var_count; v++)
+                        scratch[v] = any ? interval_join(scratch[v], edge[v]) : edge[v];
+                    any = true;
+                }
+            }
+            if (!any)
+                continue;
+
+            Interval *block_in = in + b * width;
+            if (reached[b] && loop_head && ++visits[b] > RANGE_WIDEN_DELAY)
+            {
+                for (size_t v = 0; v < var_count; v++)
+                    scratch[v] = interval_widen(block_in[v], interval_join(block_in[v], scratch[v]));
+            }
+            if (reached[b] && memcmp(block_in, scratch, var_count * sizeof(Interval)) == 0)
+                continue;
+
+            memcpy(block_in, scratch, var_count * sizeof(Interval));
+            Interval *block_out = out + b * width;
+            memcpy(block_out, scratch, var_count * sizeof(Interval));
+            RangeEval eval = {block_out, var_count, NULL};
+            const FlowBlock *block = &builder->blocks[b];
+            for (size_t i = block->first; i < block->first + block->count; i++)
+                range_transfer(&eval, &builder->items[i]);
+            reached[b] = true;
+            changed = true;
+        }
+    }
+    log_debug("Rangos: %zu variables, %zu rondas\n", var_count, rounds);
+
+    // Con el punto fijo, una pasada más por bloque emite avisos y anota hechos
+    for (size_t b = 0; b < blocks; b++)
+    {
+        if (!reached[b])
+            continue;
+        memcpy(scratch, in + b * width, var_count * sizeof(Interval));
+        RangeEval eval = {scratch, var_count, warnings};
+        const FlowBlock *block = &builder->blocks[b];
+        for (size_t i = block->first; i < block->first + block->count; i++)
+            range_transfer(&eval, &builder->items[i]);
+    }
+
+    free(visits);
+    free(reached);
+    free(refined);
+    free(scratch);
+    free(out);
+    free(in);
+}
+
+static void analyze_function_flow(JAMZASTNode *function, WarningList *warnings)
+{
+    FlowBuilder builder = {0};
+    builder.break_target = builder.continue_target = SIZE_MAX;
+    size_t entry = new_block(&builder);
+    builder.exit = new_block(&builder);
+    builder.current = entry;
+
+    for (size_t i = 0; i < function->function.param_count; i++)
+        add_item(&builder, ITEM_PARAM, function->function.params[i]);
+    // El bloque de salida queda vacío; el cuerpo empieza en su propio bloque
+    builder.current = new_block(&builder);
+    add_edge(&builder, entry, builder.current);
+    build_statement(&builder, function->function.body);
+    add_edge(&builder, builder.current, builder.exit);
+
+    JAMZFlowGraph graph;
+    jamz_flow_graph_init(&graph, builder.block_count, entry, builder.edges, builder.edge_count);
+
+    DefIndex index;
+    index_definitions(&index, &builder);
+    log_debug("Flujo de %s: %zu bloques, %zu aristas, %zu variables\n", function->function.name,
+              builder.block_count, builder.edge_count, index.var_count);
+
+    reaching_definitions(&builder, &graph, &index, warnings);
+    dead_stores(&builder, &graph, &index, warnings);
+    range_analysis(&builder, &graph, index.var_count, warnings);
+
+    free_def_index(&index);
+    jamz_flow_graph_free(&graph);
+    free(builder.items);
+    free(builder.blocks);
+    free(builder.edges);
+}
+
+static int compare_warnings(const void *a, const void *b)
+{
+    const FlowWarning *left = a;
+    const FlowWarning *right = b;
+
+    if (left->line != right->line)
+        return left->line < right->line ? -1 : 1;
+    if (left->column != right->column)
+        return left->column < right->column ? -1 : 1;
+    return 0;
+}
+
+size_t analyze_dataflow(JAMZASTNode *program)
+{
+    if (!program || program->type != JAMZ_AST_PROGRAM)
+        return 0;
+
+    WarningList warnings = {0};
+    for (size_t i = 0; i < program->block.count; i++)
+        analyze_function_flow(program->block.statements[i], &warnings);
+
+    // Cada nodo genera como mucho una advertencia, así que la posición basta
+    if (warnings.count > 1)
+        qsort(warnings.items, warnings.count, sizeof(FlowWarning), compare_warnings);
+
+    for (size_t i = 0; i < warnings.count; i++)
+        print_warning("Compiler warning %zu: %s", i + 1, warnings.items[i].message);
+
+    size_t count = warnings.count;
+    free(warnings.items);
+    return count;
+}
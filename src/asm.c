@@ -0,0 +1,121 @@
+#include "asm.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+void asm_buffer_init(JAMZAsmBuffer *buffer)
+{
+    buffer->lines = NULL;
+    buffer->count = 0;
+    buffer->capacity = 0;
+    buffer->text = NULL;
+    buffer->text_size = 0;
+    buffer->text_capacity = 0;
+}
+
+void asm_buffer_free(JAMZAsmBuffer *buffer)
+{
+    free(buffer->lines);
+    free(buffer->text);
+    asm_buffer_init(buffer);
+}
+
+// Vacía el búfer conservando la memoria para la siguiente función
+void asm_buffer_clear(JAMZAsmBuffer *buffer)
+{
+    buffer->count = 0;
+    buffer->text_size = 0;
+}
+
+const char *asm_text(const JAMZAsmBuffer *buffer, uint32_t offset)
+{
+    return buffer->text + offset;
+}
+
+uint32_t asm_text_start(const JAMZAsmBuffer *buffer)
+{
+    return (uint32_t)buffer->text_size;
+}
+
+void asm_text_append(JAMZAsmBuffer *buffer, const char *text, size_t length)
+{
+    // Siempre queda sitio para el terminador de asm_text_end
+    if (buffer->text_size + length + 1 > buffer->text_capacity)
+    {
+        size_t capacity = buffer->text_capacity ? buffer->text_capacity * 2 : 4096;
+        while (capacity < buffer->text_size + length + 1)
+            capacity *= 2;
+        buffer->text = safe_realloc(buffer->text, capacity);
+        buffer->text_capacity = capacity;
+    }
+    memcpy(buffer->text + buffer->text_size, text, length);
+    buffer->text_size += length;
+}
+
+uint32_t asm_text_end(JAMZAsmBuffer *buffer, uint32_t start)
+{
+    asm_text_append(buffer, "", 1);
+    return start;
+}
+
+static uint32_t intern(JAMZAsmBuffer *buffer, const char *text)
+{
+    uint32_t start = asm_text_start(buffer);
+    asm_text_append(buffer, text, strlen(text));
+    return asm_text_end(buffer, start);
+}
+
+void asm_append_line(JAMZAsmBuffer *buffer, const JAMZAsmLine *line)
+{
+    if (buffer->count == buffer->capacity)
+    {
+        buffer->capacity = buffer->capacity ? buffer->capacity * 2 : 256;
+        buffer->lines = safe_realloc(buffer->lines, buffer->capacity * sizeof(JAMZAsmLine));
+    }
+    buffer->lines[buffer->count++] = *line;
+}
+
+void asm_label(JAMZAsmBuffer *buffer, const char *name)
+{
+    JAMZAsmLine line = {JAMZ_ASM_LABEL, intern(buffer, name), {0}, 0};
+    asm_append_line(buffer, &line);
+}
+
+void asm_comment(JAMZAsmBuffer *buffer, const char *text)
+{
+    JAMZAsmLine line = {JAMZ_ASM_COMMENT, intern(buffer, text), {0}, 0};
+    asm_append_line(buffer, &line);
+}
+
+void asm_buffer_render(const JAMZAsmBuffer *buffer, JAMZOutputBuffer *output)
+{
+    for (size_t i = 0; i < buffer->count; i++)
+    {
+        const JAMZAsmLine *line = &buffer->lines[i];
+        switch (line->kind)
+        {
+        case JAMZ_ASM_LABEL:
+            output_string(output, asm_text(buffer, line->mnemonic));
+            output_append(output, ":\n", 2);
+            break;
+        case JAMZ_ASM_COMMENT:
+            output_append(output, "    ; ", 6);
+            output_string(output, asm_text(buffer, line->mnemonic));
+            output_char(output, '\n');
+            break;
+        case JAMZ_ASM_INSTRUCTION:
+            output_append(output, "    ", 4);
+            output_string(output, asm_text(buffer, line->mnemonic));
+            for (int k = 0; k < line->operand_count; k++)
+            {
+                if (k == 0)
+                    output_char(output, ' ');
+                else
+                    output_append(output, ", ", 2);
+                output_string(output, asm_text(buffer, line->operands[k]));
+            }
+            output_char(output, '\n');
+            break;
+        }
+    }
+}
@@ -1,108 +1,1185 @@
 #include "compile.h"
-#include "cJSON.h"
+#include "asm.h"
+#include "profile.h"
+#include "regalloc.h"
+#include "select.h"
+#include "strength.h"
+#include "templates.h"
+#include "utils.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-void generate_asm(const JAMZASTNode *ast, const char *input_filename)
+// Operando de un registro virtual: su registro de máquina o su ranura de la
+// pila si el asignador lo derramó
+static const char *vreg_operand(const JAMZRegisterAllocation *allocation, int32_t vreg, char *buffer, size_t size)
 {
-    // Cambiar la extensión del archivo de entrada a .asm
-    char output_filename[256];
-    snprintf(output_filename, sizeof(output_filename), "%s.asm", strtok((char *)input_filename, "."));
+    if (allocation->reg[vreg] != JAMZ_IR_NONE)
+        return jamz_register_name((JAMZRegister)allocation->reg[vreg]);
+    snprintf(buffer, size, "dword [ebp-%d]", 4 * (allocation->slot[vreg] + 1));
+    return buffer;
+}
+
+static bool in_register(const JAMZRegisterAllocation *allocation, int32_t vreg)
+{
+    return allocation->reg[vreg] != JAMZ_IR_NONE;
+}
+
+// Los movimientos de un registro a sí mismo los quita la mirilla
+static void emit_move(JAMZAsmBuffer *out, const char *dst, const char *src)
+{
+    jamz_template_emit(out, JAMZ_TEMPLATE_MOVE, (const char *[]){dst, src});
+}
+
+// Escribe source (registro, inmediato o memoria) en el registro virtual. x86
+// no tiene mov de memoria a memoria, así que ese caso pasa por eax.
+static void emit_define(JAMZAsmBuffer *out, const JAMZRegisterAllocation *allocation, int32_t vreg,
+                        const char *source, bool source_in_memory)
+{
+    char operand[32];
+    if (vreg == JAMZ_IR_NONE)
+        return;
+    const char *dst = vreg_operand(allocation, vreg, operand, sizeof(operand));
+    if (source_in_memory && !in_register(allocation, vreg))
+    {
+        emit_move(out, "eax", source);
+        source = "eax";
+    }
+    emit_move(out, dst, source);
+}
+
+// La división con signo (cdq + idiv) solo se cambia por la sin signo cuando
+// el análisis de rangos demostró que ambos operandos son no negativos
+static JAMZTemplateKind binary_template(JAMZIROp op)
+{
+    switch (op)
+    {
+    case JAMZ_IR_ADD:
+        return JAMZ_TEMPLATE_BINARY_ADD;
+    case JAMZ_IR_SUB:
+        return JAMZ_TEMPLATE_BINARY_SUB;
+    case JAMZ_IR_MUL:
+        return JAMZ_TEMPLATE_BINARY_MUL;
+    case JAMZ_IR_UDIV:
+    case JAMZ_IR_UMOD:
+        return JAMZ_TEMPLATE_BINARY_DIV;
+    default:
+        return JAMZ_TEMPLATE_BINARY_IDIV;
+    }
+}
+
+// Sufijo de setcc y jcc para la comparación con signo
+static const char *condition_suffix(JAMZIROp op)
+{
+    switch (op)
+    {
+    case JAMZ_IR_EQ:
+        return "e";
+    case JAMZ_IR_NE:
+        return "ne";
+    case JAMZ_IR_LT:
+        return "l";
+    case JAMZ_IR_LE:
+        return "le";
+    case JAMZ_IR_GT:
+        return "g";
+    default:
+        return "ge";
+    }
+}
+
+// Instrucciones de un juego vectorial. Con SSE2 las operaciones son de dos
+// operandos (dst op= src); con AVX2 de tres.
+typedef struct
+{
+    int width;         // Carriles de 32 bits
+    const char *prefix; // Nombre de sus registros: xmm o ymm
+    bool three_operand;
+    JAMZTemplateKind move;
+    JAMZTemplateKind move_unaligned;
+    JAMZTemplateKind move_scalar;
+    JAMZTemplateKind broadcast;
+    JAMZTemplateKind add;
+    JAMZTemplateKind sub;
+    JAMZTemplateKind mul;
+} VectorISA;
+
+static const VectorISA vector_isas[] = {
+    [JAMZ_VECTOR_SSE2] = {4, "xmm", false, JAMZ_TEMPLATE_VECTOR_MOVE, JAMZ_TEMPLATE_VECTOR_MOVE_UNALIGNED,
+                          JAMZ_TEMPLATE_VECTOR_MOVE_SCALAR, JAMZ_TEMPLATE_VECTOR_BROADCAST, JAMZ_TEMPLATE_VECTOR_ADD,
+                          JAMZ_TEMPLATE_VECTOR_SUB, JAMZ_TEMPLATE_VECTOR_MUL},
+    [JAMZ_VECTOR_AVX2] = {8, "ymm", true, JAMZ_TEMPLATE_VECTOR_MOVE_AVX, JAMZ_TEMPLATE_VECTOR_MOVE_UNALIGNED_AVX,
+                          JAMZ_TEMPLATE_VECTOR_MOVE_SCALAR_AVX, JAMZ_TEMPLATE_VECTOR_BROADCAST_AVX,
+                          JAMZ_TEMPLATE_VECTOR_ADD_AVX, JAMZ_TEMPLATE_VECTOR_SUB_AVX, JAMZ_TEMPLATE_VECTOR_MUL_AVX},
+};
+
+// Estado de la emisión de una función: dónde quedó cada registro virtual y
+// qué árboles plegó la selección de instrucciones
+typedef struct
+{
+    JAMZAsmBuffer *out;
+    const JAMZIRFunction *function;
+    const JAMZRegisterAllocation *allocation;
+    const JAMZSelection *selection;
+    const int32_t *array_offset; // Distancia de ebp al elemento 0 de cada arreglo
+    const VectorISA *vector;
+} Emitter;
+
+// Valor que recibe una instrucción: el registro virtual vreg, o el árbol
+// plegado de la instrucción node reducido al no terminal nt
+typedef struct
+{
+    int32_t node;
+    int32_t vreg;
+    JAMZNonterminal nt;
+} Value;
+
+// base + index*scale + disp (+ cadena string); JAMZ_IR_NONE en lo que falte
+typedef struct
+{
+    int32_t base;
+    int32_t index;
+    int32_t scale;
+    int32_t disp;
+    int32_t string;
+} Address;
+
+// Valor del operando k: el árbol plegado, el inmediato de una constante
+// compartida o el registro virtual
+static Value operand_value(const Emitter *emitter, size_t instr, int k)
+{
+    const JAMZIRInstr *code = &emitter->function->code[instr];
+    int32_t node = jamz_select_operand(emitter->selection, instr, k);
+    JAMZNonterminal nt = node >= 0 ? (JAMZNonterminal)emitter->selection->goal[node] : JAMZ_NT_REG;
+    if (node < 0 && jamz_select_immediate(emitter->selection, instr, k))
+    {
+        node = jamz_select_constant(emitter->selection, instr, k);
+        nt = JAMZ_NT_IMM;
+    }
+    return (Value){node, k == 0 ? code->a : code->b, nt};
+}
+
+// Hijo k de la regla con la que se redujo la instrucción. Un inmediato que
+// no se plegó es una constante compartida: se lee de su única definición.
+static Value rule_kid(const Emitter *emitter, size_t instr, const JAMZRule *rule, bool swapped, int k)
+{
+    int slot = swapped ? 1 - k : k;
+    Value value = operand_value(emitter, instr, slot);
+    value.nt = rule->kids[k];
+    if (value.node < 0 && value.nt == JAMZ_NT_IMM)
+        value.node = jamz_select_constant(emitter->selection, instr, slot);
+    return value;
+}
+
+// Valor del divisor si es una constante, plegada o compartida
+static bool constant_operand(const Emitter *emitter, size_t instr, int k, int32_t *value)
+{
+    Value operand = operand_value(emitter, instr, k);
+    int32_t node = operand.nt == JAMZ_NT_IMM ? operand.node : jamz_select_constant(emitter->selection, instr, k);
+    if (node < 0 || emitter->function->code[node].op != JAMZ_IR_CONST)
+        return false;
+    *value = emitter->function->code[node].imm;
+    return true;
+}
+
+// Texto de un valor que cabe en un operando: registro, inmediato o memoria
+static const char *value_operand(const Emitter *emitter, Value value, char *buffer, size_t size)
+{
+    if (value.nt == JAMZ_NT_REG)
+        return vreg_operand(emitter->allocation, value.vreg, buffer, size);
+    const JAMZIRInstr *leaf = &emitter->function->code[value.node];
+    if (leaf->op == JAMZ_IR_CONST)
+        snprintf(buffer, size, "%d", leaf->imm);
+    else if (leaf->op == JAMZ_IR_STRING)
+        snprintf(buffer, size, "str%d", leaf->imm);
+    else
+    {
+        // Tras el ebp guardado y la dirección de retorno
+        snprintf(buffer, size, "dword [ebp+%d]", 8 + 4 * leaf->imm);
+    }
+    return buffer;
+}
+
+static bool value_in_memory(const Emitter *emitter, Value value)
+{
+    return value.nt == JAMZ_NT_MEM || (value.nt == JAMZ_NT_REG && !in_register(emitter->allocation, value.vreg));
+}
 
-    FILE *file = fopen(output_filename, "w"); // Cambiado de "rw" a "w" para sobrescribir el contenido si el archivo ya existe.
-    if (!file)
+static void collect_address(const Emitter *emitter, size_t node, JAMZNonterminal nt, Address *address)
+{
+    bool swapped = false;
+    const JAMZRule *rule = jamz_select_rule(emitter->selection, node, nt, &swapped);
+    if (rule->emit == JAMZ_EMIT_CHAIN)
     {
-        fprintf(stderr, "Error: No se pudo crear el archivo %s\n", output_filename);
+        collect_address(emitter, node, rule->kids[0], address);
         return;
     }
+    const JAMZIRInstr *instr = &emitter->function->code[node];
+    Value first = rule_kid(emitter, node, rule, swapped, 0);
+    Value second = rule_kid(emitter, node, rule, swapped, 1);
+    const JAMZIRInstr *imm = second.node >= 0 ? &emitter->function->code[second.node] : NULL;
+    switch (rule->lhs)
+    {
+    case JAMZ_NT_INDEX:
+        address->index = first.vreg;
+        address->scale = imm->imm;
+        break;
+    case JAMZ_NT_PAIR:
+        address->base = first.vreg;
+        if (instr->op == JAMZ_IR_MUL)
+        {
+            // x*3, x*5, x*9 = x + x*2, x*4, x*8
+            address->index = first.vreg;
+            address->scale = imm->imm - 1;
+        }
+        else if (second.nt == JAMZ_NT_INDEX)
+            collect_address(emitter, (size_t)second.node, JAMZ_NT_INDEX, address);
+        else
+        {
+            address->index = second.vreg;
+            address->scale = 1;
+        }
+        break;
+    default:
+        if (first.nt == JAMZ_NT_REG)
+            address->base = first.vreg;
+        else
+            collect_address(emitter, (size_t)first.node, first.nt, address);
+        if (imm->op == JAMZ_IR_STRING)
+            address->string = imm->imm;
+        else
+            address->disp = instr->op == JAMZ_IR_SUB ? -imm->imm : imm->imm;
+        break;
+    }
+}
 
-    // Cargar el diccionario desde un archivo JSON
-    FILE *dict_file = fopen("data/dictionary.json", "r");
-    if (!dict_file)
+// Calcula la dirección en el registro de máquina target: con un lea si todas
+// sus partes están en registros, o paso a paso en eax si alguna se derramó
+static void emit_address(const Emitter *emitter, const Address *address, const char *target)
+{
+    const JAMZRegisterAllocation *allocation = emitter->allocation;
+    char text[96], base[32], index[32], part[32];
+    bool registers = (address->base == JAMZ_IR_NONE || in_register(allocation, address->base)) &&
+                     (address->index == JAMZ_IR_NONE || in_register(allocation, address->index));
+    bool single = address->disp == 0 && address->string == JAMZ_IR_NONE &&
+                  (address->base == JAMZ_IR_NONE) != (address->index == JAMZ_IR_NONE) &&
+                  (address->index == JAMZ_IR_NONE || address->scale == 1);
+    if (registers && single)
     {
-        fprintf(stderr, "Error: No se pudo abrir el archivo dictionary.json\n");
-        fclose(file);
+        // x*1 o x + 0: basta un mov, que la mirilla puede quitar
+        int32_t vreg = address->base != JAMZ_IR_NONE ? address->base : address->index;
+        emit_move(emitter->out, target, vreg_operand(allocation, vreg, base, sizeof(base)));
+        return;
+    }
+    if (registers)
+    {
+        size_t length = 0;
+        text[0] = '\0';
+        if (address->base != JAMZ_IR_NONE)
+            length += (size_t)snprintf(text, sizeof(text), "%s", vreg_operand(allocation, address->base, base, sizeof(base)));
+        if (address->index != JAMZ_IR_NONE)
+        {
+            const char *name = vreg_operand(allocation, address->index, index, sizeof(index));
+            length += (size_t)(address->scale == 1
+                                   ? snprintf(text + length, sizeof(text) - length, "%s%s", length ? "+" : "", name)
+                                   : snprintf(text + length, sizeof(text) - length, "%s%s*%d", length ? "+" : "", name,
+                                              address->scale));
+        }
+        if (address->disp != 0)
+            length += (size_t)snprintf(text + length, sizeof(text) - length, "%+d", address->disp);
+        if (address->string != JAMZ_IR_NONE)
+            snprintf(text + length, sizeof(text) - length, "+str%d", address->string);
+        jamz_template_emit(emitter->out, JAMZ_TEMPLATE_LOAD_ADDRESS, (const char *[]){target, text});
         return;
     }
 
-    fseek(dict_file, 0, SEEK_END);
-    long length = ftell(dict_file);
-    fseek(dict_file, 0, SEEK_SET);
+    // Sin lea se suma término a término: primero el escalado (imul de tres
+    // operandos) o el que ya está en target, así el mov inicial sobra
+    JAMZAsmBuffer *out = emitter->out;
+    int32_t terms[2] = {address->base, address->index};
+    int32_t scales[2] = {1, address->scale};
+    int count = address->base != JAMZ_IR_NONE ? 1 : 0;
+    if (address->index != JAMZ_IR_NONE)
+    {
+        terms[count] = address->index;
+        scales[count++] = address->scale;
+    }
+    if (count == 2 && (scales[1] != 1 || strcmp(vreg_operand(allocation, terms[1], index, sizeof(index)), target) == 0))
+    {
+        int32_t term = terms[0], scale = scales[0];
+        terms[0] = terms[1];
+        scales[0] = scales[1];
+        terms[1] = term;
+        scales[1] = scale;
+    }
+    const char *accumulator = target;
+    if (count == 2 && strcmp(vreg_operand(allocation, terms[1], index, sizeof(index)), target) == 0)
+        accumulator = "eax";
 
-    char *dict_content = safe_malloc(length + 1);
-    fread(dict_content, 1, length, dict_file);
-    dict_content[length] = '\0';
-    fclose(dict_file);
+    const char *first = vreg_operand(allocation, terms[0], base, sizeof(base));
+    if (scales[0] == 1)
+        emit_move(out, accumulator, first);
+    else
+    {
+        snprintf(part, sizeof(part), "%d", scales[0]);
+        jamz_template_emit(out, JAMZ_TEMPLATE_MULTIPLY_IMMEDIATE, (const char *[]){accumulator, first, part});
+    }
+    if (count == 2)
+        jamz_template_emit(out, JAMZ_TEMPLATE_BINARY_ADD,
+                           (const char *[]){accumulator, vreg_operand(allocation, terms[1], index, sizeof(index))});
+    if (address->disp != 0)
+    {
+        snprintf(part, sizeof(part), "%d", address->disp);
+        jamz_template_emit(out, JAMZ_TEMPLATE_BINARY_ADD, (const char *[]){accumulator, part});
+    }
+    if (address->string != JAMZ_IR_NONE)
+    {
+        snprintf(part, sizeof(part), "str%d", address->string);
+        jamz_template_emit(out, JAMZ_TEMPLATE_BINARY_ADD, (const char *[]){accumulator, part});
+    }
+    emit_move(out, target, accumulator);
+}
 
-    cJSON *dictionary = cJSON_Parse(dict_content);
-    free(dict_content);
+// Lleva el valor al registro de máquina target
+static void emit_load(const Emitter *emitter, Value value, const char *target)
+{
+    char buffer[32];
+    if (value.nt == JAMZ_NT_REG || value.nt == JAMZ_NT_IMM || value.nt == JAMZ_NT_MEM)
+    {
+        emit_move(emitter->out, target, value_operand(emitter, value, buffer, sizeof(buffer)));
+        return;
+    }
+    Address address = {JAMZ_IR_NONE, JAMZ_IR_NONE, 1, 0, JAMZ_IR_NONE};
+    collect_address(emitter, (size_t)value.node, value.nt, &address);
+    emit_address(emitter, &address, target);
+}
 
-    if (!dictionary)
+// Escribe el valor en el registro virtual dst
+static void emit_value(const Emitter *emitter, Value value, int32_t dst)
+{
+    char buffer[32], operand[32];
+    if (dst == JAMZ_IR_NONE)
+        return;
+    if (value.nt == JAMZ_NT_REG || value.nt == JAMZ_NT_IMM || value.nt == JAMZ_NT_MEM)
+    {
+        emit_define(emitter->out, emitter->allocation, dst, value_operand(emitter, value, buffer, sizeof(buffer)),
+                    value_in_memory(emitter, value));
+        return;
+    }
+    if (in_register(emitter->allocation, dst))
     {
-        fprintf(stderr, "Error: No se pudo parsear el archivo dictionary.json\n");
-        fclose(file);
+        emit_load(emitter, value, vreg_operand(emitter->allocation, dst, operand, sizeof(operand)));
         return;
     }
+    emit_load(emitter, value, "eax");
+    emit_define(emitter->out, emitter->allocation, dst, "eax", false);
+}
+
+// Suma, resta, producto y desplazamiento operan directamente sobre el
+// registro destino; si el destino está en la pila o coincide con el segundo
+// operando de una operación no conmutativa, el cálculo se hace en eax
+static void emit_arithmetic(const Emitter *emitter, JAMZTemplateKind template, bool commutative, int32_t dst_vreg,
+                            const char *a, const char *b)
+{
+    char dst_buffer[32];
+    JAMZAsmBuffer *out = emitter->out;
+
+    if (in_register(emitter->allocation, dst_vreg))
+    {
+        const char *dst = vreg_operand(emitter->allocation, dst_vreg, dst_buffer, sizeof(dst_buffer));
+        if (strcmp(dst, b) == 0 && commutative)
+        {
+            jamz_template_emit(out, template, (const char *[]){dst, a});
+            return;
+        }
+        if (strcmp(dst, b) != 0)
+        {
+            emit_move(out, dst, a);
+            jamz_template_emit(out, template, (const char *[]){dst, b});
+            return;
+        }
+    }
+
+    emit_move(out, "eax", a);
+    jamz_template_emit(out, template, (const char *[]){"eax", b});
+    emit_define(out, emitter->allocation, dst_vreg, "eax", false);
+}
+
+// x*c como una cadena de lea, shl, add y sub (jamz_mul_plan). Se acumula en
+// el destino salvo que esté en la pila, o que sea el propio x y haga falta
+// volver a sumarlo o restarlo al final.
+static void emit_mul_plan(const Emitter *emitter, int32_t dst_vreg, const char *x, int32_t value)
+{
+    JAMZAsmBuffer *out = emitter->out;
+    char dst_buffer[32], text[80];
+    JAMZMulPlan plan;
+    jamz_mul_plan(value, &plan);
+    bool uses_source = plan.steps[plan.count - 1].kind == JAMZ_MUL_ADD_SOURCE ||
+                       plan.steps[plan.count - 1].kind == JAMZ_MUL_SUB_SOURCE;
+    const char *target = "eax";
+    if (in_register(emitter->allocation, dst_vreg))
+    {
+        const char *dst = vreg_operand(emitter->allocation, dst_vreg, dst_buffer, sizeof(dst_buffer));
+        if (!uses_source || strcmp(dst, x) != 0)
+            target = dst;
+    }
 
-    fprintf(file, ".text\n");
+    int first = 0;
+    bool x_in_register = strchr(x, '[') == NULL;
+    if (plan.steps[0].kind == JAMZ_MUL_LEA && x_in_register)
+    {
+        snprintf(text, sizeof(text), "%s+%s*%d", x, x, plan.steps[0].amount - 1);
+        jamz_template_emit(out, JAMZ_TEMPLATE_LOAD_ADDRESS, (const char *[]){target, text});
+        first = 1;
+    }
+    else
+        emit_move(out, target, x);
+    for (int s = first; s < plan.count; s++)
+    {
+        const JAMZMulStep *step = &plan.steps[s];
+        switch (step->kind)
+        {
+        case JAMZ_MUL_SHIFT:
+            snprintf(text, sizeof(text), "%d", step->amount);
+            jamz_template_emit(out, JAMZ_TEMPLATE_SHIFT_LEFT, (const char *[]){target, text});
+            break;
+        case JAMZ_MUL_LEA:
+            snprintf(text, sizeof(text), "%s+%s*%d", target, target, step->amount - 1);
+            jamz_template_emit(out, JAMZ_TEMPLATE_LOAD_ADDRESS, (const char *[]){target, text});
+            break;
+        case JAMZ_MUL_ADD_SOURCE:
+            jamz_template_emit(out, JAMZ_TEMPLATE_BINARY_ADD, (const char *[]){target, x});
+            break;
+        case JAMZ_MUL_SUB_SOURCE:
+            jamz_template_emit(out, JAMZ_TEMPLATE_BINARY_SUB, (const char *[]){target, x});
+            break;
+        }
+    }
+    if (strcmp(target, "eax") == 0)
+        emit_define(out, emitter->allocation, dst_vreg, "eax", false);
+}
 
-    fprintf(file, "main:\n");
-    fprintf(file, "    ; Inicio del programa mínimo\n");
+// Cociente de n / d con d una potencia de dos con signo: la división trunca
+// hacia cero, así que a un n negativo se le suma |d|-1 antes del sar. El
+// sesgo queda en edx para que el resto lo pueda deshacer.
+static void emit_signed_bias(JAMZAsmBuffer *out, int shift)
+{
+    char amount[16];
+    if (shift == 1)
+    {
+        emit_move(out, "edx", "eax");
+        jamz_template_emit(out, JAMZ_TEMPLATE_SHIFT_RIGHT, (const char *[]){"edx", "31"});
+    }
+    else
+    {
+        jamz_template_emit(out, JAMZ_TEMPLATE_SIGN_EXTEND, NULL);
+        snprintf(amount, sizeof(amount), "%d", 32 - shift);
+        jamz_template_emit(out, JAMZ_TEMPLATE_SHIFT_RIGHT, (const char *[]){"edx", amount});
+    }
+    jamz_template_emit(out, JAMZ_TEMPLATE_BINARY_ADD, (const char *[]){"eax", "edx"});
+}
+
+// División y resto entre una constante distinta de 0 e INT_MIN, sin idiv.
+// Devuelve el registro de máquina con el resultado. UDIV y UMOD solo se
+// eligen con ambos operandos no negativos, así que les sirve la constante
+// mágica con signo sin la corrección de los dividendos negativos.
+static const char *emit_constant_division(const Emitter *emitter, JAMZIROp op, Value dividend, int32_t divisor)
+{
+    JAMZAsmBuffer *out = emitter->out;
+    char text[16];
+    bool remainder = op == JAMZ_IR_MOD || op == JAMZ_IR_UMOD;
+    bool is_signed = op == JAMZ_IR_DIV || op == JAMZ_IR_MOD;
+    int32_t magnitude = divisor < 0 ? -divisor : divisor;
+
+    if (magnitude == 1)
+    {
+        if (remainder)
+        {
+            emit_move(out, "eax", "0");
+            return "eax";
+        }
+        emit_load(emitter, dividend, "eax");
+        if (divisor < 0)
+            jamz_template_emit(out, JAMZ_TEMPLATE_NEGATE, (const char *[]){"eax"});
+        return "eax";
+    }
 
-    for (size_t i = 0; i < ast->block.count; i++)
+    if (jamz_is_power_of_two(magnitude))
     {
-        JAMZASTNode *node = ast->block.statements[i];
-        if (node->type == JAMZ_AST_DECLARATION)
+        int shift = jamz_log2((uint32_t)magnitude);
+        emit_load(emitter, dividend, "eax");
+        if (is_signed)
+            emit_signed_bias(out, shift);
+        if (remainder)
         {
-            if (node->declaration.initializer)
+            // (n + sesgo) & (|d|-1) - sesgo: el resto lleva el signo de n
+            snprintf(text, sizeof(text), "%d", magnitude - 1);
+            jamz_template_emit(out, JAMZ_TEMPLATE_MASK, (const char *[]){"eax", text});
+            if (is_signed)
+                jamz_template_emit(out, JAMZ_TEMPLATE_BINARY_SUB, (const char *[]){"eax", "edx"});
+            return "eax";
+        }
+        snprintf(text, sizeof(text), "%d", shift);
+        jamz_template_emit(out, is_signed ? JAMZ_TEMPLATE_SHIFT_RIGHT_ARITHMETIC : JAMZ_TEMPLATE_SHIFT_RIGHT,
+                           (const char *[]){"eax", text});
+        if (divisor < 0)
+            jamz_template_emit(out, JAMZ_TEMPLATE_NEGATE, (const char *[]){"eax"});
+        return "eax";
+    }
+
+    // q = hi(n * M) [+/- n] >> s, más 1 si es negativo; n se queda en ecx
+    JAMZDivMagic magic = jamz_div_magic(divisor);
+    emit_load(emitter, dividend, "ecx");
+    snprintf(text, sizeof(text), "%d", magic.multiplier);
+    emit_move(out, "eax", text);
+    jamz_template_emit(out, JAMZ_TEMPLATE_MULTIPLY_WIDE, (const char *[]){"ecx"});
+    if (magic.add_dividend)
+        jamz_template_emit(out, JAMZ_TEMPLATE_BINARY_ADD, (const char *[]){"edx", "ecx"});
+    if (magic.subtract_dividend)
+        jamz_template_emit(out, JAMZ_TEMPLATE_BINARY_SUB, (const char *[]){"edx", "ecx"});
+    if (magic.shift > 0)
+    {
+        snprintf(text, sizeof(text), "%d", magic.shift);
+        jamz_template_emit(out, JAMZ_TEMPLATE_SHIFT_RIGHT_ARITHMETIC, (const char *[]){"edx", text});
+    }
+    const char *quotient = "edx";
+    if (is_signed)
+    {
+        emit_move(out, "eax", "edx");
+        jamz_template_emit(out, JAMZ_TEMPLATE_SHIFT_RIGHT, (const char *[]){"eax", "31"});
+        jamz_template_emit(out, JAMZ_TEMPLATE_BINARY_ADD, (const char *[]){"eax", "edx"});
+        quotient = "eax";
+    }
+    if (!remainder)
+        return quotient;
+    // n - q*d
+    snprintf(text, sizeof(text), "%d", divisor);
+    jamz_template_emit(out, JAMZ_TEMPLATE_MULTIPLY_IMMEDIATE, (const char *[]){"eax", quotient, text});
+    jamz_template_emit(out, JAMZ_TEMPLATE_BINARY_SUB, (const char *[]){"ecx", "eax"});
+    return "ecx";
+}
+
+// idiv y div trabajan sobre edx:eax: el cociente queda en eax y el resto en
+// edx. Con un divisor constante se cambian por desplazamientos o por la
+// multiplicación por su inversa.
+static void emit_division(const Emitter *emitter, size_t i)
+{
+    const JAMZIRInstr *instr = &emitter->function->code[i];
+    char operand[32];
+    int32_t divisor;
+    const char *result;
+    Value dividend = operand_value(emitter, i, 0);
+    if (constant_operand(emitter, i, 1, &divisor) && divisor != 0 && divisor != INT32_MIN)
+        result = emit_constant_division(emitter, instr->op, dividend, divisor);
+    else
+    {
+        // El divisor pasa por ecx
+        emit_load(emitter, dividend, "eax");
+        jamz_template_emit(emitter->out, binary_template(instr->op),
+                           (const char *[]){value_operand(emitter, operand_value(emitter, i, 1), operand, sizeof(operand))});
+        result = instr->op == JAMZ_IR_MOD || instr->op == JAMZ_IR_UMOD ? "edx" : "eax";
+    }
+    emit_define(emitter->out, emitter->allocation, instr->dst, result, false);
+}
+
+// cmp de la comparación i reducida a flags. Devuelve la condición que
+// queda en ellos: la simétrica si la regla casó con los operandos al revés.
+static JAMZIROp emit_compare(const Emitter *emitter, size_t i)
+{
+    char a_buffer[32], b_buffer[32];
+    bool swapped = false;
+    const JAMZRule *rule = jamz_select_rule(emitter->selection, i, JAMZ_NT_FLAGS, &swapped);
+    Value first = rule_kid(emitter, i, rule, swapped, 0);
+    Value second = rule_kid(emitter, i, rule, swapped, 1);
+    const char *a = value_operand(emitter, first, a_buffer, sizeof(a_buffer));
+    const char *b = value_operand(emitter, second, b_buffer, sizeof(b_buffer));
+    // Dos valores derramados: x86 no compara memoria con memoria
+    if (value_in_memory(emitter, first) && value_in_memory(emitter, second))
+    {
+        emit_move(emitter->out, "eax", a);
+        a = "eax";
+    }
+    jamz_template_emit(emitter->out, JAMZ_TEMPLATE_COMPARE, (const char *[]){a, b});
+    JAMZIROp op = emitter->function->code[i].op;
+    return swapped ? jamz_ir_swap_comparison(op) : op;
+}
+
+// Raíz de un árbol que produce un valor: se escribe según la regla que
+// cubre su nodo superior
+static void emit_tree(const Emitter *emitter, size_t i)
+{
+    const JAMZIRInstr *instr = &emitter->function->code[i];
+    char a_buffer[32], b_buffer[32], dst_buffer[32];
+    bool swapped = false;
+    const JAMZRule *rule = jamz_select_rule(emitter->selection, i, JAMZ_NT_REG, &swapped);
+    if (instr->dst == JAMZ_IR_NONE)
+        return;
+
+    if (rule->emit == JAMZ_EMIT_SET)
+    {
+        // setcc solo escribe un byte: el 0 o 1 se extiende en eax
+        JAMZIROp condition = emit_compare(emitter, i);
+        jamz_template_emit(emitter->out, JAMZ_TEMPLATE_SET_CONDITION, (const char *[]){condition_suffix(condition)});
+        emit_define(emitter->out, emitter->allocation, instr->dst, "eax", false);
+        return;
+    }
+    if (rule->emit == JAMZ_EMIT_CHAIN)
+    {
+        emit_value(emitter, (Value){(int32_t)i, instr->dst, rule->kids[0]}, instr->dst);
+        return;
+    }
+    Value first = rule_kid(emitter, i, rule, swapped, 0);
+    Value second = rule_kid(emitter, i, rule, swapped, 1);
+    const char *a = value_operand(emitter, first, a_buffer, sizeof(a_buffer));
+    const char *b = value_operand(emitter, second, b_buffer, sizeof(b_buffer));
+    if (rule->emit == JAMZ_EMIT_TWO_ADDR)
+    {
+        emit_arithmetic(emitter, binary_template(instr->op), instr->op != JAMZ_IR_SUB, instr->dst, a, b);
+        return;
+    }
+    if (rule->emit == JAMZ_EMIT_SHIFT)
+    {
+        snprintf(b_buffer, sizeof(b_buffer), "%d", jamz_log2((uint32_t)emitter->function->code[second.node].imm));
+        emit_arithmetic(emitter, JAMZ_TEMPLATE_SHIFT_LEFT, false, instr->dst, a, b_buffer);
+        return;
+    }
+    if (rule->emit == JAMZ_EMIT_MUL_PLAN)
+    {
+        emit_mul_plan(emitter, instr->dst, a, emitter->function->code[second.node].imm);
+        return;
+    }
+    // imul de tres operandos: el destino tiene que ser un registro
+    bool direct = in_register(emitter->allocation, instr->dst);
+    const char *dst = direct ? vreg_operand(emitter->allocation, instr->dst, dst_buffer, sizeof(dst_buffer)) : "eax";
+    jamz_template_emit(emitter->out, JAMZ_TEMPLATE_MULTIPLY_IMMEDIATE, (const char *[]){dst, a, b});
+    if (!direct)
+        emit_define(emitter->out, emitter->allocation, instr->dst, "eax", false);
+}
+
+// Los arreglos van bajo las ranuras de los derramados, cada uno en un
+// múltiplo de 32 bytes de su región: así todos comparten alineación y el
+// pelado de un bucle vectorial alinea a la vez los que se tocan en la misma
+// posición. Devuelve el tamaño de la región.
+static int32_t layout_arrays(const JAMZIRFunction *function, int32_t spill_bytes, int32_t *offset)
+{
+    int32_t region = 0;
+    for (size_t k = 0; k < function->array_count; k++)
+    {
+        offset[k] = region;
+        region += (4 * function->array_lengths[k] + 31) / 32 * 32;
+    }
+    for (size_t k = 0; k < function->array_count; k++)
+        offset[k] = spill_bytes + region - offset[k];
+    return region;
+}
+
+// Elemento index del arreglo; un índice derramado se lleva antes a eax
+static const char *element_operand(const Emitter *emitter, int32_t array, int32_t index, char *buffer, size_t size)
+{
+    char operand[32];
+    const char *reg = "eax";
+    if (in_register(emitter->allocation, index))
+        reg = jamz_register_name((JAMZRegister)emitter->allocation->reg[index]);
+    else
+        emit_move(emitter->out, "eax", vreg_operand(emitter->allocation, index, operand, sizeof(operand)));
+    snprintf(buffer, size, "dword [ebp+%s*4-%d]", reg, emitter->array_offset[array]);
+    return buffer;
+}
+
+static void emit_element(const Emitter *emitter, size_t i)
+{
+    const JAMZIRInstr *instr = &emitter->function->code[i];
+    const JAMZRegisterAllocation *allocation = emitter->allocation;
+    char element[48], value[32];
+    if (instr->op == JAMZ_IR_LOAD)
+    {
+        emit_define(emitter->out, allocation, instr->dst,
+                    element_operand(emitter, instr->imm, instr->a, element, sizeof(element)), true);
+        return;
+    }
+    const char *source = vreg_operand(allocation, instr->b, value, sizeof(value));
+    if (in_register(allocation, instr->b))
+    {
+        emit_move(emitter->out, element_operand(emitter, instr->imm, instr->a, element, sizeof(element)), source);
+        return;
+    }
+    if (in_register(allocation, instr->a))
+    {
+        emit_move(emitter->out, "eax", source);
+        emit_move(emitter->out, element_operand(emitter, instr->imm, instr->a, element, sizeof(element)), "eax");
+        return;
+    }
+    // Índice y valor en la pila: eax lleva el índice y el valor pasa por ella
+    jamz_template_emit(emitter->out, JAMZ_TEMPLATE_PUSH_ARG, (const char *[]){source});
+    jamz_template_emit(emitter->out, JAMZ_TEMPLATE_RESTORE_REGISTER,
+                       (const char *[]){element_operand(emitter, instr->imm, instr->a, element, sizeof(element))});
+}
+
+static const char *vector_register(const VectorISA *isa, bool full, int reg, char *buffer, size_t size)
+{
+    snprintf(buffer, size, "%s%d", full ? isa->prefix : "xmm", reg);
+    return buffer;
+}
+
+// Cuerpo del núcleo sobre los carriles que empiezan en el índice eax: un
+// vector entero (full) o solo el carril 0 en las vueltas de pelado. Los
+// accesos en la misma posición que el arreglo de referencia van alineados.
+static void emit_kernel_body(const Emitter *emitter, const JAMZVectorKernel *kernel, int32_t aligned_imm, bool full)
+{
+    const VectorISA *isa = emitter->vector;
+    JAMZAsmBuffer *out = emitter->out;
+    char d[8], a[8], b[8], t1[8], t2[8], memory[48];
+    vector_register(isa, full, JAMZ_VECTOR_REGISTERS, t1, sizeof(t1));
+    vector_register(isa, full, JAMZ_VECTOR_REGISTERS + 1, t2, sizeof(t2));
+    for (size_t k = kernel->invariant_count; k < kernel->count; k++)
+    {
+        const JAMZVectorInstr *v = &kernel->code[k];
+        if (v->op == JAMZ_VEC_LOAD || v->op == JAMZ_VEC_STORE)
+        {
+            snprintf(memory, sizeof(memory), "[ebp+eax*4%+d]", 4 * v->imm - emitter->array_offset[v->array]);
+            JAMZTemplateKind move = !full                                  ? isa->move_scalar
+                                    : (v->imm - aligned_imm) % isa->width == 0 ? isa->move
+                                                                               : isa->move_unaligned;
+            if (v->op == JAMZ_VEC_LOAD)
+                jamz_template_emit(out, move, (const char *[]){vector_register(isa, full, v->reg, d, sizeof(d)), memory});
+            else
+                jamz_template_emit(out, move,
+                                   (const char *[]){memory, vector_register(isa, full, kernel->code[v->a].reg, a, sizeof(a))});
+            continue;
+        }
+
+        int ra = kernel->code[v->a].reg;
+        int rb = kernel->code[v->b].reg;
+        JAMZTemplateKind op = v->op == JAMZ_VEC_ADD ? isa->add : v->op == JAMZ_VEC_SUB ? isa->sub : isa->mul;
+        vector_register(isa, full, v->reg, d, sizeof(d));
+        if (isa->three_operand)
+        {
+            jamz_template_emit(out, op, (const char *[]){d, vector_register(isa, full, ra, a, sizeof(a)),
+                                                         vector_register(isa, full, rb, b, sizeof(b))});
+            continue;
+        }
+        if (v->reg == rb && v->reg != ra)
+        {
+            if (v->op == JAMZ_VEC_SUB)
             {
-                if (node->declaration.initializer->type == JAMZ_AST_LITERAL)
-                {
-                    cJSON *declaration_with_literal = cJSON_GetObjectItem(dictionary, "declaration_with_literal");
-                    if (declaration_with_literal)
-                    {
-                        const char *template = cJSON_GetStringValue(declaration_with_literal);
-                        fprintf(file, template, node->declaration.var_name, node->declaration.initializer->literal.value);
-                    }
-                }
-                else if (node->declaration.initializer->type == JAMZ_AST_BINARY)
-                {
-                    cJSON *declaration_with_binary = cJSON_GetObjectItem(dictionary, "declaration_with_binary");
-                    if (declaration_with_binary)
-                    {
-                        const char *template = cJSON_GetStringValue(declaration_with_binary);
-                        fprintf(file, template, node->declaration.var_name, node->declaration.initializer->binary.left->literal.value, node->declaration.initializer->binary.right->literal.value);
-                    }
-                }
+                // a - b sobre el registro de b: se calcula en el temporal
+                jamz_template_emit(out, isa->move, (const char *[]){t2, vector_register(isa, full, ra, a, sizeof(a))});
+                jamz_template_emit(out, op, (const char *[]){t2, d});
+                jamz_template_emit(out, isa->move, (const char *[]){d, t2});
+                continue;
             }
+            rb = ra;
+            ra = v->reg;
         }
-        else if (node->type == JAMZ_AST_RETURN)
+        vector_register(isa, full, rb, b, sizeof(b));
+        if (v->reg != ra)
+            jamz_template_emit(out, isa->move, (const char *[]){d, vector_register(isa, full, ra, a, sizeof(a))});
+        if (v->op == JAMZ_VEC_MUL)
         {
-            cJSON *return_instr = cJSON_GetObjectItem(dictionary, "return");
-            if (return_instr)
+            // SSE2 no multiplica 32 x 32: pares e impares por separado con pmuludq
+            jamz_template_emit(out, op, (const char *[]){t1, d, t2, b, d, b, t1, t2, d, d, t1, t1, d, t1});
+            continue;
+        }
+        jamz_template_emit(out, op, (const char *[]){d, b});
+    }
+}
+
+// VLOOP: eax recorre los índices desde a. Se pelan vueltas escalares hasta
+// que el arreglo de referencia queda alineado y después se avanza de vector
+// en vector mientras quepa uno entero antes de la última vuelta, que
+// siempre queda para el bucle escalar.
+static void emit_vector_loop(const Emitter *emitter, size_t i)
+{
+    const JAMZIRInstr *instr = &emitter->function->code[i];
+    const JAMZVectorKernel *kernel = &emitter->function->kernels[instr->imm];
+    const VectorISA *isa = emitter->vector;
+    JAMZAsmBuffer *out = emitter->out;
+    char start[32], limit_buffer[32], source[32], full[8], scalar[8], address[48], step[16], mask[16];
+    char peel[32], loop[32], done[32];
+    snprintf(peel, sizeof(peel), ".V%d_peel", instr->imm);
+    snprintf(loop, sizeof(loop), ".V%d_loop", instr->imm);
+    snprintf(done, sizeof(done), ".V%d_done", instr->imm);
+
+    // ecx y edx quedan libres en VLOOP salvo por el límite
+    const char *limit = vreg_operand(emitter->allocation, instr->b, limit_buffer, sizeof(limit_buffer));
+    const char *scratch = strcmp(limit, "ecx") == 0 ? "edx" : "ecx";
+    emit_move(out, "eax", vreg_operand(emitter->allocation, instr->a, start, sizeof(start)));
+    for (size_t k = 0; k < kernel->invariant_count; k++)
+    {
+        const JAMZVectorInstr *v = &kernel->code[k];
+        if (v->op == JAMZ_VEC_CONST)
+        {
+            snprintf(source, sizeof(source), "%d", v->imm);
+            emit_move(out, scratch, source);
+            snprintf(source, sizeof(source), "%s", scratch);
+        }
+        else
+            snprintf(source, sizeof(source), "dword [ebp-%d]", emitter->array_offset[v->array]);
+        vector_register(isa, false, v->reg, scalar, sizeof(scalar));
+        jamz_template_emit(out, isa->broadcast,
+                           (const char *[]){scalar, source, vector_register(isa, true, v->reg, full, sizeof(full)), scalar});
+    }
+
+    int32_t aligned_imm = 0;
+    for (size_t k = kernel->count; k-- > kernel->invariant_count;)
+    {
+        if (kernel->code[k].op == JAMZ_VEC_STORE && kernel->code[k].array == kernel->reference)
+            aligned_imm = kernel->code[k].imm;
+    }
+    snprintf(step, sizeof(step), "%d", isa->width);
+    snprintf(mask, sizeof(mask), "%d", 4 * isa->width - 1);
+    snprintf(address, sizeof(address), "eax+%d", isa->width);
+    char aligned_address[48];
+    snprintf(aligned_address, sizeof(aligned_address), "ebp+eax*4%+d",
+             4 * aligned_imm - emitter->array_offset[kernel->reference]);
+
+    asm_label(out, peel);
+    jamz_template_emit(out, JAMZ_TEMPLATE_LOAD_ADDRESS, (const char *[]){scratch, address});
+    jamz_template_emit(out, JAMZ_TEMPLATE_COMPARE, (const char *[]){scratch, limit});
+    jamz_template_emit(out, JAMZ_TEMPLATE_BRANCH_CONDITION, (const char *[]){"ge", done});
+    jamz_template_emit(out, JAMZ_TEMPLATE_LOAD_ADDRESS, (const char *[]){scratch, aligned_address});
+    jamz_template_emit(out, JAMZ_TEMPLATE_BRANCH_ALIGNED, (const char *[]){scratch, mask, loop});
+    emit_kernel_body(emitter, kernel, aligned_imm, false);
+    jamz_template_emit(out, JAMZ_TEMPLATE_BINARY_ADD, (const char *[]){"eax", "1"});
+    jamz_template_emit(out, JAMZ_TEMPLATE_JUMP, (const char *[]){peel});
+
+    asm_label(out, loop);
+    emit_kernel_body(emitter, kernel, aligned_imm, true);
+    jamz_template_emit(out, JAMZ_TEMPLATE_BINARY_ADD, (const char *[]){"eax", step});
+    jamz_template_emit(out, JAMZ_TEMPLATE_LOAD_ADDRESS, (const char *[]){scratch, address});
+    jamz_template_emit(out, JAMZ_TEMPLATE_COMPARE, (const char *[]){scratch, limit});
+    jamz_template_emit(out, JAMZ_TEMPLATE_BRANCH_CONDITION, (const char *[]){"l", loop});
+
+    asm_label(out, done);
+    // Sin vzeroupper el código SSE de después pagaría la transición
+    if (isa->three_operand)
+        jamz_template_emit(out, JAMZ_TEMPLATE_VECTOR_CLEAR_UPPER, NULL);
+    emit_define(out, emitter->allocation, instr->dst, "eax", false);
+}
+
+// Símbolos del perfil en un programa instrumentado: un contador de 64 bits
+// por bloque y la función que los vuelca al salir
+#define PROFILE_COUNTS "jamz_profile_counts"
+#define PROFILE_DUMP "jamz_profile_dump"
+
+static void emit_function(JAMZAsmBuffer *out, const JAMZIRProgram *program, const JAMZIRFunction *function,
+                          bool counting)
+{
+    char operand[32];
+    char label[32];
+    char comment[128];
+    size_t pending_args = 0;
+
+    // Los árboles se eligen antes de asignar registros: lo plegado no ocupa
+    // ninguno y sus hojas viven hasta la raíz
+    JAMZSelection selection = select_instructions(function);
+    const uint64_t *profile = profile_weights(program);
+    JAMZRegisterAllocation allocation = allocate_registers(function, selection.folded, selection.immediate, profile);
+    int32_t *array_offset = safe_malloc((function->array_count ? function->array_count : 1) * sizeof(int32_t));
+    int32_t region = layout_arrays(function, 4 * allocation.slot_count, array_offset);
+    // Sin núcleos da igual; los núcleos solo existen si JAMZ_VECTOR no es off
+    JAMZVectorISA isa = jamz_vector_isa(false);
+    Emitter emitter = {out, function, &allocation, &selection, array_offset,
+                       &vector_isas[isa == JAMZ_VECTOR_AVX2 ? JAMZ_VECTOR_AVX2 : JAMZ_VECTOR_SSE2]};
+
+    asm_label(out, function->name);
+    snprintf(comment, sizeof(comment), "Inicio de %s", function->name);
+    asm_comment(out, comment);
+    jamz_template_emit(out, JAMZ_TEMPLATE_PROLOGUE, NULL);
+    // Solo los valores derramados y los arreglos necesitan sitio en la pila
+    if (allocation.slot_count > 0 || region > 0)
+    {
+        snprintf(operand, sizeof(operand), "%d", 4 * allocation.slot_count + region);
+        jamz_template_emit(out, JAMZ_TEMPLATE_RESERVE_STACK, (const char *[]){operand});
+    }
+    for (int reg = JAMZ_REG_EBX; reg < JAMZ_REG_COUNT; reg++)
+    {
+        if (allocation.used[reg])
+            jamz_template_emit(out, JAMZ_TEMPLATE_SAVE_REGISTER, (const char *[]){jamz_register_name((JAMZRegister)reg)});
+    }
+    // Los arreglos valen 0 al entrar, como en la VM
+    if (region > 0)
+    {
+        char disp[32];
+        snprintf(operand, sizeof(operand), "%d", region / 4);
+        snprintf(disp, sizeof(disp), "%d", 4 * allocation.slot_count + region + 4);
+        jamz_template_emit(out, JAMZ_TEMPLATE_ZERO_FRAME, (const char *[]){operand, disp});
+    }
+    // Antes que nada del cuerpo: atexit solo pisa eax, ecx y edx
+    if (counting && strcmp(function->name, "main") == 0)
+    {
+        jamz_template_emit(out, JAMZ_TEMPLATE_PUSH_ARG, (const char *[]){PROFILE_DUMP});
+        jamz_template_emit(out, JAMZ_TEMPLATE_CALL, (const char *[]){"atexit"});
+        jamz_template_emit(out, JAMZ_TEMPLATE_DROP_ARGS, (const char *[]){"4"});
+    }
+
+    for (size_t i = 0; i < function->count; i++)
+    {
+        const JAMZIRInstr *instr = &function->code[i];
+        // Lo plegado se escribe dentro del árbol de su único uso
+        if (selection.folded[i])
+            continue;
+        switch (instr->op)
+        {
+        case JAMZ_IR_CONST:
+        case JAMZ_IR_STRING:
+        case JAMZ_IR_PARAM:
+        case JAMZ_IR_ADD:
+        case JAMZ_IR_SUB:
+        case JAMZ_IR_MUL:
+        case JAMZ_IR_EQ:
+        case JAMZ_IR_NE:
+        case JAMZ_IR_LT:
+        case JAMZ_IR_LE:
+        case JAMZ_IR_GT:
+        case JAMZ_IR_GE:
+            emit_tree(&emitter, i);
+            break;
+        case JAMZ_IR_COPY:
+            emit_value(&emitter, operand_value(&emitter, i, 0), instr->dst);
+            break;
+        case JAMZ_IR_DIV:
+        case JAMZ_IR_UDIV:
+        case JAMZ_IR_MOD:
+        case JAMZ_IR_UMOD:
+            emit_division(&emitter, i);
+            break;
+        case JAMZ_IR_ARG:
+            jamz_template_emit(out, JAMZ_TEMPLATE_PUSH_ARG,
+                               (const char *[]){value_operand(&emitter, operand_value(&emitter, i, 0), operand, sizeof(operand))});
+            pending_args++;
+            break;
+        case JAMZ_IR_CALL:
+            if (instr->imm == JAMZ_IR_NONE)
             {
-                const char *template = cJSON_GetStringValue(return_instr);
-                fprintf(file, template, node->return_stmt.value->literal.value);
+                fprintf(stderr, "[ERROR] Llamada a una función desconocida en la línea %d\n", instr->line);
+                break;
             }
-        }
-        else if (node->type == JAMZ_AST_PRINT)
+            jamz_template_emit(out, JAMZ_TEMPLATE_CALL, (const char *[]){program->functions[instr->imm].name});
+            if (pending_args > 0)
+            {
+                snprintf(operand, sizeof(operand), "%zu", 4 * pending_args);
+                jamz_template_emit(out, JAMZ_TEMPLATE_DROP_ARGS, (const char *[]){operand});
+            }
+            pending_args = 0;
+            emit_define(out, &allocation, instr->dst, "eax", false);
+            break;
+        case JAMZ_IR_LOAD:
+        case JAMZ_IR_STORE:
+            emit_element(&emitter, i);
+            break;
+        case JAMZ_IR_VLOOP:
+            emit_vector_loop(&emitter, i);
+            break;
+        case JAMZ_IR_LABEL:
+            snprintf(label, sizeof(label), ".L%d", instr->imm);
+            asm_label(out, label);
+            break;
+        case JAMZ_IR_JUMP:
+            snprintf(label, sizeof(label), ".L%d", instr->imm);
+            jamz_template_emit(out, JAMZ_TEMPLATE_JUMP, (const char *[]){label});
+            break;
+        case JAMZ_IR_BRANCH:
         {
-            cJSON *print_instr = cJSON_GetObjectItem(dictionary, "print");
-            if (print_instr)
+            snprintf(label, sizeof(label), ".L%d", instr->imm);
+            // Comparación plegada: se salta si no se cumple
+            int32_t compare = jamz_select_operand(&selection, i, 0);
+            if (compare >= 0 && selection.goal[compare] == JAMZ_NT_FLAGS)
             {
-                const char *template = cJSON_GetStringValue(print_instr);
-                fprintf(file, template, node->literal.value);
+                JAMZIROp condition = jamz_ir_negate_comparison(emit_compare(&emitter, (size_t)compare));
+                jamz_template_emit(out, JAMZ_TEMPLATE_BRANCH_CONDITION, (const char *[]){condition_suffix(condition), label});
+                break;
             }
-            else
+            const char *condition = vreg_operand(&allocation, instr->a, operand, sizeof(operand));
+            if (!in_register(&allocation, instr->a))
             {
-                fprintf(stderr, "[ERROR] No se encontró la instrucción para 'print' en el diccionario.\n");
+                emit_move(out, "eax", condition);
+                condition = "eax";
             }
+            jamz_template_emit(out, JAMZ_TEMPLATE_BRANCH_ZERO, (const char *[]){condition, condition, label});
+            break;
+        }
+        case JAMZ_IR_RET:
+            if (instr->a != JAMZ_IR_NONE)
+                emit_load(&emitter, operand_value(&emitter, i, 0), "eax");
+            // Si ya está justo antes del epílogo, la mirilla quita el salto
+            jamz_template_emit(out, JAMZ_TEMPLATE_JUMP, (const char *[]){".exit"});
+            break;
+        case JAMZ_IR_COUNT:
+            // Instrumentado, suma 1 al contador del bloque (los flags no
+            // viven de un bloque a otro); con perfil se anota lo que pesa
+            if (counting)
+            {
+                char low[64];
+                char high[64];
+                snprintf(low, sizeof(low), "dword [" PROFILE_COUNTS "+%d]", 8 * instr->imm);
+                snprintf(high, sizeof(high), "dword [" PROFILE_COUNTS "+%d]", 8 * instr->imm + 4);
+                jamz_template_emit(out, JAMZ_TEMPLATE_COUNT_BLOCK, (const char *[]){low, high});
+            }
+            else if (profile)
+            {
+                snprintf(comment, sizeof(comment), "Perfil: %llu pasada(s)", (unsigned long long)profile[instr->imm]);
+                asm_comment(out, comment);
+            }
+            break;
         }
     }
 
-    fprintf(file, "    ; Fin del programa mínimo\n");
-    fprintf(file, "    ret\n");
+    asm_label(out, ".exit");
+    snprintf(comment, sizeof(comment), "Fin de %s", function->name);
+    asm_comment(out, comment);
+    for (int reg = JAMZ_REG_COUNT; reg-- > JAMZ_REG_EBX;)
+    {
+        if (allocation.used[reg])
+            jamz_template_emit(out, JAMZ_TEMPLATE_RESTORE_REGISTER, (const char *[]){jamz_register_name((JAMZRegister)reg)});
+    }
+    jamz_template_emit(out, JAMZ_TEMPLATE_EPILOGUE, NULL);
+    free(array_offset);
+    free_register_allocation(&allocation);
+    free_selection(&selection);
+}
 
-    cJSON_Delete(dictionary);
-    fclose(file);
+// Texto entre comillas invertidas de NASM, donde \\ y ` se escapan
+static void backquoted(const char *text, char *buffer, size_t size)
+{
+    size_t length = 0;
+    for (; *text && length + 3 < size; text++)
+    {
+        if (*text == '\\' || *text == '`')
+            buffer[length++] = '\\';
+        buffer[length++] = *text;
+    }
+    buffer[length] = '\0';
+}
+
+static void emit_profile_data(JAMZOutputBuffer *output, const JAMZIRProfile *profile, const char *filename)
+{
+    char text[1024];
+    backquoted(filename, text, sizeof(text));
+    const char *strings[][2] = {
+        {"jamz_profile_file", text},
+        {"jamz_profile_mode", "w"},
+        {"jamz_profile_header", JAMZ_PROFILE_HEADER "\\n"},
+        {"jamz_profile_line", "%s %u"},
+        {"jamz_profile_count", " %llu"},
+        {"jamz_profile_newline", "\\n"},
+    };
+    for (size_t i = 0; i < sizeof(strings) / sizeof(strings[0]); i++)
+        jamz_template_render(output, JAMZ_TEMPLATE_STRING_DATA, strings[i]);
+    for (size_t r = 0; r < profile->range_count; r++)
+    {
+        char label[48];
+        snprintf(label, sizeof(label), "jamz_profile_function%zu", r);
+        jamz_template_render(output, JAMZ_TEMPLATE_STRING_DATA, (const char *[]){label, profile->ranges[r].function});
+    }
+    snprintf(text, sizeof(text), "%zu", profile->count ? profile->count : 1);
+    jamz_template_render(output, JAMZ_TEMPLATE_COUNTER_DATA, (const char *[]){PROFILE_COUNTS, text});
+}
+
+static void emit_call(JAMZAsmBuffer *out, const char *function, const char *const *arguments, size_t count)
+{
+    char operand[32];
+    for (size_t i = count; i-- > 0;)
+        jamz_template_emit(out, JAMZ_TEMPLATE_PUSH_ARG, (const char *[]){arguments[i]});
+    jamz_template_emit(out, JAMZ_TEMPLATE_CALL, (const char *[]){function});
+    snprintf(operand, sizeof(operand), "%zu", 4 * count);
+    jamz_template_emit(out, JAMZ_TEMPLATE_DROP_ARGS, (const char *[]){operand});
+}
+
+// Escribe el perfil con el formato de profile_write: ebx es el archivo, esi
+// recorre los contadores de cada función y edi cuenta los que faltan
+static void emit_profile_dump(JAMZAsmBuffer *out, const JAMZIRProfile *profile)
+{
+    static const char *const saved[] = {"ebx", "esi", "edi"};
+    char operand[64];
+    char label[32];
+
+    asm_label(out, PROFILE_DUMP);
+    asm_comment(out, "Inicio de " PROFILE_DUMP);
+    jamz_template_emit(out, JAMZ_TEMPLATE_PROLOGUE, NULL);
+    for (size_t i = 0; i < 3; i++)
+        jamz_template_emit(out, JAMZ_TEMPLATE_SAVE_REGISTER, (const char *[]){saved[i]});
+    emit_call(out, "fopen", (const char *[]){"jamz_profile_file", "jamz_profile_mode"}, 2);
+    jamz_template_emit(out, JAMZ_TEMPLATE_BRANCH_ZERO, (const char *[]){"eax", "eax", ".exit"});
+    emit_move(out, "ebx", "eax");
+    emit_call(out, "fprintf", (const char *[]){"ebx", "jamz_profile_header"}, 2);
+    for (size_t r = 0; r < profile->range_count; r++)
+    {
+        const JAMZIRProfileRange *range = &profile->ranges[r];
+        char name[48];
+        char blocks[32];
+        snprintf(name, sizeof(name), "jamz_profile_function%zu", r);
+        snprintf(blocks, sizeof(blocks), "%zu", range->blocks);
+        emit_call(out, "fprintf", (const char *[]){"ebx", "jamz_profile_line", name, blocks}, 4);
+        if (range->blocks > 0)
+        {
+            snprintf(operand, sizeof(operand), PROFILE_COUNTS "+%zu", 8 * range->first);
+            jamz_template_emit(out, JAMZ_TEMPLATE_LOAD_ADDRESS, (const char *[]){"esi", operand});
+            emit_move(out, "edi", blocks);
+            snprintf(label, sizeof(label), ".L%zu", r);
+            asm_label(out, label);
+            // %llu toma el contador de 64 bits como dos palabras, la baja primero
+            emit_call(out, "fprintf", (const char *[]){"ebx", "jamz_profile_count", "dword [esi]", "dword [esi+4]"}, 4);
+            jamz_template_emit(out, JAMZ_TEMPLATE_BINARY_ADD, (const char *[]){"esi", "8"});
+            jamz_template_emit(out, JAMZ_TEMPLATE_BINARY_SUB, (const char *[]){"edi", "1"});
+            jamz_template_emit(out, JAMZ_TEMPLATE_BRANCH_CONDITION, (const char *[]){"nz", label});
+        }
+        emit_call(out, "fprintf", (const char *[]){"ebx", "jamz_profile_newline"}, 2);
+    }
+    emit_call(out, "fclose", (const char *[]){"ebx"}, 1);
+    asm_label(out, ".exit");
+    asm_comment(out, "Fin de " PROFILE_DUMP);
+    for (size_t i = 3; i-- > 0;)
+        jamz_template_emit(out, JAMZ_TEMPLATE_RESTORE_REGISTER, (const char *[]){saved[i]});
+    jamz_template_emit(out, JAMZ_TEMPLATE_EPILOGUE, NULL);
+}
+
+bool generate_asm(const JAMZIRProgram *program, JAMZOutputBuffer *output, JAMZPeepholeStats *stats,
+                  const char *profile_filename)
+{
+    // El diccionario se precompila una vez por proceso
+    if (!jamz_templates_ready())
+        return false;
+
+    const JAMZIRProfile *profile = program->profile;
+    bool counting = profile_filename && profile && profile->instrumented;
+    if (program->string_count > 0 || counting)
+    {
+        output_string(output, "section .data\n");
+        for (size_t i = 0; i < program->string_count; i++)
+        {
+            char label[32];
+            snprintf(label, sizeof(label), "str%zu", i);
+            jamz_template_render(output, JAMZ_TEMPLATE_STRING_DATA, (const char *[]){label, program->strings[i]});
+        }
+        if (counting)
+            emit_profile_data(output, profile, profile_filename);
+        output_char(output, '\n');
+    }
+
+    output_string(output, "section .text\n");
+    output_string(output, "global main\n");
+    if (counting)
+        output_string(output, "extern atexit, fopen, fprintf, fclose\n");
+    output_char(output, '\n');
+
+    // Cada función de la IR emite su etiqueta, su marco de pila y su cuerpo;
+    // la mirilla la limpia antes de pasarla a la salida
+    JAMZAsmBuffer buffer;
+    asm_buffer_init(&buffer);
+    for (size_t i = 0; i < program->function_count; i++)
+    {
+        emit_function(&buffer, program, &program->functions[i], counting);
+        peephole_optimize(&buffer, stats);
+        asm_buffer_render(&buffer, output);
+        asm_buffer_clear(&buffer);
+    }
+    if (counting)
+    {
+        emit_profile_dump(&buffer, profile);
+        peephole_optimize(&buffer, stats);
+        asm_buffer_render(&buffer, output);
+    }
+    asm_buffer_free(&buffer);
+    return true;
 }
@@ -0,0 +1,464 @@
+#include "dataflow.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+void jamz_bitset_set(JAMZBitset set, size_t bit)
+{
+    set.words[bit / 64] |= (JAMZBitWord)1 << (bit % 64);
+}
+
+void jamz_bitset_clear(JAMZBitset set, size_t bit)
+{
+    set.words[bit / 64] &= ~((JAMZBitWord)1 << (bit % 64));
+}
+
+bool jamz_bitset_test(JAMZBitset set, size_t bit)
+{
+    return (set.words[bit / 64] >> (bit % 64)) & 1;
+}
+
+void jamz_bitset_fill(JAMZBitset set, bool value)
+{
+    memset(set.words, value ? 0xFF : 0, set.word_count * sizeof(JAMZBitWord));
+}
+
+void jamz_bitset_copy(JAMZBitset dst, JAMZBitset src)
+{
+    memcpy(dst.words, src.words, dst.word_count * sizeof(JAMZBitWord));
+}
+
+void jamz_bitset_union(JAMZBitset dst, JAMZBitset src)
+{
+    for (size_t i = 0; i < dst.word_count; i++)
+        dst.words[i] |= src.words[i];
+}
+
+void jamz_bitset_intersect(JAMZBitset dst, JAMZBitset src)
+{
+    for (size_t i = 0; i < dst.word_count; i++)
+        dst.words[i] &= src.words[i];
+}
+
+void jamz_bitset_subtract(JAMZBitset dst, JAMZBitset src)
+{
+    for (size_t i = 0; i < dst.word_count; i++)
+        dst.words[i] &= ~src.words[i];
+}
+
+bool jamz_bitset_equal(JAMZBitset a, JAMZBitset b)
+{
+    return memcmp(a.words, b.words, a.word_count * sizeof(JAMZBitWord)) == 0;
+}
+
+// Convierte una lista de aristas en listas de adyacencia CSR (conteo + prefijos)
+static void build_adjacency(size_t node_count, const JAMZFlowEdge *edges, size_t edge_count,
+                            bool reverse, size_t **out_start, size_t **out_list)
+{
+    size_t *start = calloc(node_count + 1, sizeof(size_t));
+    size_t *list = safe_malloc((edge_count ? edge_count : 1) * sizeof(size_t));
+    if (!start)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for flow graph\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < edge_count; i++)
+        start[(reverse ? edges[i].to : edges[i].from) + 1]++;
+    for (size_t n = 0; n < node_count; n++)
+        start[n + 1] += start[n];
+
+    size_t *fill = safe_malloc((node_count ? node_count : 1) * sizeof(size_t));
+    memcpy(fill, start, node_count * sizeof(size_t));
+    for (size_t i = 0; i < edge_count; i++)
+    {
+        size_t from = reverse ? edges[i].to : edges[i].from;
+        list[fill[from]++] = reverse ? edges[i].from : edges[i].to;
+    }
+    free(fill);
+
+    *out_start = start;
+    *out_list = list;
+}
+
+void jamz_flow_graph_init(JAMZFlowGraph *graph, size_t node_count, size_t entry,
+                          const JAMZFlowEdge *edges, size_t edge_count)
+{
+    graph->node_count = node_count;
+    graph->entry = entry;
+    build_adjacency(node_count, edges, edge_count, false, &graph->succ_start, &graph->succs);
+    build_adjacency(node_count, edges, edge_count, true, &graph->pred_start, &graph->preds);
+
+    size_t alloc = node_count ? node_count : 1;
+    graph->rpo = safe_malloc(alloc * sizeof(size_t));
+    graph->rpo_index = safe_malloc(alloc * sizeof(size_t));
+    for (size_t n = 0; n < node_count; n++)
+        graph->rpo_index[n] = SIZE_MAX;
+    graph->rpo_count = 0;
+    if (node_count == 0)
+        return;
+
+    // DFS iterativo: la pila guarda el nodo y el siguiente sucesor a visitar
+    size_t *stack_node = safe_malloc(alloc * sizeof(size_t));
+    size_t *stack_next = safe_malloc(alloc * sizeof(size_t));
+    bool *visited = calloc(alloc, sizeof(bool));
+    size_t *postorder = safe_malloc(alloc * sizeof(size_t));
+    size_t post_count = 0;
+    size_t depth = 0;
+
+    stack_node[0] = entry;
+    stack_next[0] = graph->succ_start[entry];
+    visited[entry] = true;
+    depth = 1;
+    while (depth > 0)
+    {
+        size_t n = stack_node[depth - 1];
+        if (stack_next[depth - 1] < graph->succ_start[n + 1])
+        {
+            size_t s = graph->succs[stack_next[depth - 1]++];
+            if (!visited[s])
+            {
+                visited[s] = true;
+                stack_node[depth] = s;
+                stack_next[depth] = graph->succ_start[s];
+                depth++;
+            }
+        }
+        else
+        {
+            postorder[post_count++] = n;
+            depth--;
+        }
+    }
+
+    for (size_t i = 0; i < post_count; i++)
+    {
+        size_t n = postorder[post_count - 1 - i];
+        graph->rpo[i] = n;
+        graph->rpo_index[n] = i;
+    }
+    graph->rpo_count = post_count;
+
+    free(postorder);
+    free(visited);
+    free(stack_next);
+    free(stack_node);
+}
+
+void jamz_flow_graph_free(JAMZFlowGraph *graph)
+{
+    free(graph->succ_start);
+    free(graph->succs);
+    free(graph->pred_start);
+    free(graph->preds);
+    free(graph->rpo);
+    free(graph->rpo_index);
+}
+
+// Sube por el árbol de dominadores hasta el ancestro común, comparando
+// posiciones en postorden inverso
+static size_t intersect_dominators(const JAMZFlowGraph *graph, const size_t *idom, size_t a, size_t b)
+{
+    while (a != b)
+    {
+        while (graph->rpo_index[a] > graph->rpo_index[b])
+            a = idom[a];
+        while (graph->rpo_index[b] > graph->rpo_index[a])
+            b = idom[b];
+    }
+    return a;
+}
+
+size_t *jamz_flow_graph_dominators(const JAMZFlowGraph *graph)
+{
+    size_t *idom = safe_malloc((graph->node_count ? graph->node_count : 1) * sizeof(size_t));
+    for (size_t n = 0; n < graph->node_count; n++)
+        idom[n] = SIZE_MAX;
+    if (graph->rpo_count == 0)
+        return idom;
+
+    idom[graph->entry] = graph->entry;
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (size_t i = 1; i < graph->rpo_count; i++)
+        {
+            size_t n = graph->rpo[i];
+            size_t best = SIZE_MAX;
+            for (size_t e = graph->pred_start[n]; e < graph->pred_start[n + 1]; e++)
+            {
+                size_t p = graph->preds[e];
+                if (idom[p] == SIZE_MAX)
+                    continue; // Aún sin procesar o inalcanzable
+                best = best == SIZE_MAX ? p : intersect_dominators(graph, idom, p, best);
+            }
+            if (idom[n] != best)
+            {
+                idom[n] = best;
+                changed = true;
+            }
+        }
+    }
+    return idom;
+}
+
+void jamz_dominance_frontier(const JAMZFlowGraph *graph, const size_t *idom,
+                             size_t **out_start, size_t **out_list)
+{
+    size_t nodes = graph->node_count;
+    size_t *start = calloc(nodes + 1, sizeof(size_t));
+    if (!start)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for dominance frontier\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Dos pasadas: primero cuenta, después rellena. Cada unión con varios
+    // predecesores pertenece a la frontera de los nodos entre cada
+    // predecesor y su dominador inmediato.
+    size_t *list = NULL;
+    size_t *fill = NULL;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (size_t n = 0; n < nodes; n++)
+        {
+            if (idom[n] == SIZE_MAX || graph->pred_start[n + 1] - graph->pred_start[n] < 2)
+                continue;
+            for (size_t e = graph->pred_start[n]; e < graph->pred_start[n + 1]; e++)
+            {
+                size_t runner = graph->preds[e];
+                if (idom[runner] == SIZE_MAX)
+                    continue;
+                while (runner != idom[n])
+                {
+                    // Un nodo puede alcanzar la unión por dos predecesores
+                    size_t last = pass == 0 ? SIZE_MAX : fill[runner];
+                    if (pass == 0)
+                        start[runner + 1]++;
+                    else if (last == start[runner] || list[last - 1] != n)
+                        list[fill[runner]++] = n;
+                    runner = idom[runner];
+                }
+            }
+        }
+        if (pass == 0)
+        {
+            for (size_t n = 0; n < nodes; n++)
+                start[n + 1] += start[n];
+            list = safe_malloc((start[nodes] ? start[nodes] : 1) * sizeof(size_t));
+            fill = safe_malloc((nodes ? nodes : 1) * sizeof(size_t));
+            memcpy(fill, start, nodes * sizeof(size_t));
+        }
+    }
+
+    // Los duplicados descartados dejan huecos: se compacta el CSR
+    size_t write = 0;
+    for (size_t n = 0; n < nodes; n++)
+    {
+        size_t begin = start[n];
+        start[n] = write;
+        for (size_t k = begin; k < fill[n]; k++)
+            list[write++] = list[k];
+    }
+    start[nodes] = write;
+    free(fill);
+
+    *out_start = start;
+    *out_list = list;
+}
+
+void jamz_dataflow_init(JAMZDataflowProblem *problem, const JAMZFlowGraph *graph,
+                        JAMZDataflowDirection direction, JAMZDataflowMeet meet, size_t bit_count)
+{
+    size_t words = JAMZ_BITSET_WORDS(bit_count);
+    size_t nodes = graph->node_count;
+
+    problem->direction = direction;
+    problem->meet = meet;
+    problem->bit_count = bit_count;
+    problem->node_count = nodes;
+
+    // gen, kill, in y out de cada nodo más boundary
+    problem->storage = calloc((nodes * 4 + 1) * words + 1, sizeof(JAMZBitWord));
+    if (!problem->storage)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for dataflow sets\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t alloc = nodes ? nodes : 1;
+    problem->gen = safe_malloc(alloc * sizeof(JAMZBitset));
+    problem->kill = safe_malloc(alloc * sizeof(JAMZBitset));
+    problem->in = safe_malloc(alloc * sizeof(JAMZBitset));
+    problem->out = safe_malloc(alloc * sizeof(JAMZBitset));
+
+    JAMZBitWord *cursor = problem->storage;
+    JAMZBitset *sets[4] = {problem->gen, problem->kill, problem->in, problem->out};
+    for (int k = 0; k < 4; k++)
+    {
+        for (size_t n = 0; n < nodes; n++)
+        {
+            sets[k][n].words = cursor;
+            sets[k][n].word_count = words;
+            cursor += words;
+        }
+    }
+    problem->boundary.words = cursor;
+    problem->boundary.word_count = words;
+}
+
+void jamz_dataflow_free(JAMZDataflowProblem *problem)
+{
+    free(problem->gen);
+    free(problem->kill);
+    free(problem->in);
+    free(problem->out);
+    free(problem->storage);
+}
+
+// Cola de prioridad (montículo mínimo) por posición en el orden de recorrido
+typedef struct
+{
+    size_t *heap;
+    size_t count;
+    bool *queued;
+    const size_t *priority;
+} Worklist;
+
+static void worklist_push(Worklist *list, size_t node)
+{
+    if (list->queued[node])
+        return;
+    list->queued[node] = true;
+
+    size_t i = list->count++;
+    list->heap[i] = node;
+    while (i > 0)
+    {
+        size_t parent = (i - 1) / 2;
+        if (list->priority[list->heap[parent]] <= list->priority[list->heap[i]])
+            break;
+        size_t tmp = list->heap[parent];
+        list->heap[parent] = list->heap[i];
+        list->heap[i] = tmp;
+        i = parent;
+    }
+}
+
+static size_t worklist_pop(Worklist *list)
+{
+    size_t top = list->heap[0];
+    list->heap[0] = list->heap[--list->count];
+
+    size_t i = 0;
+    for (;;)
+    {
+        size_t smallest = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        if (left < list->count && list->priority[list->heap[left]] < list->priority[list->heap[smallest]])
+            smallest = left;
+        if (right < list->count && list->priority[list->heap[right]] < list->priority[list->heap[smallest]])
+            smallest = right;
+        if (smallest == i)
+            break;
+        size_t tmp = list->heap[smallest];
+        list->heap[smallest] = list->heap[i];
+        list->heap[i] = tmp;
+        i = smallest;
+    }
+
+    list->queued[top] = false;
+    return top;
+}
+
+// Resuelve el problema hasta el punto fijo. Los nodos se procesan en
+// postorden inverso (hacia delante) o en postorden (hacia atrás), así un
+// grafo acíclico converge en una sola pasada. Devuelve las visitas hechas.
+size_t jamz_dataflow_solve(JAMZDataflowProblem *problem, const JAMZFlowGraph *graph)
+{
+    bool forward = problem->direction == JAMZ_DATAFLOW_FORWARD;
+    bool intersect = problem->meet == JAMZ_DATAFLOW_INTERSECTION;
+    size_t nodes = graph->node_count;
+    size_t alloc = nodes ? nodes : 1;
+
+    // Valor inicial optimista: todo para "debe", nada para "puede"
+    for (size_t n = 0; n < nodes; n++)
+    {
+        jamz_bitset_fill(forward ? problem->out[n] : problem->in[n], intersect);
+        jamz_bitset_fill(forward ? problem->in[n] : problem->out[n], intersect);
+    }
+
+    size_t *priority = safe_malloc(alloc * sizeof(size_t));
+    for (size_t n = 0; n < nodes; n++)
+    {
+        size_t index = graph->rpo_index[n];
+        priority[n] = index == SIZE_MAX ? SIZE_MAX : (forward ? index : graph->rpo_count - 1 - index);
+    }
+
+    Worklist list = {safe_malloc(alloc * sizeof(size_t)), 0, calloc(alloc, sizeof(bool)), priority};
+    if (!list.queued)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for dataflow worklist\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < graph->rpo_count; i++)
+        worklist_push(&list, graph->rpo[i]);
+
+    JAMZBitset scratch = {safe_malloc((problem->boundary.word_count + 1) * sizeof(JAMZBitWord)), problem->boundary.word_count};
+    size_t visits = 0;
+
+    while (list.count > 0)
+    {
+        size_t n = worklist_pop(&list);
+        visits++;
+
+        // Confluencia: predecesores (hacia delante) o sucesores (hacia atrás)
+        const size_t *start = forward ? graph->pred_start : graph->succ_start;
+        const size_t *edges = forward ? graph->preds : graph->succs;
+        JAMZBitset meet_set = forward ? problem->in[n] : problem->out[n];
+        JAMZBitset result = forward ? problem->out[n] : problem->in[n];
+
+        bool first = true;
+        for (size_t e = start[n]; e < start[n + 1]; e++)
+        {
+            size_t other = edges[e];
+            if (graph->rpo_index[other] == SIZE_MAX)
+                continue; // Los nodos inalcanzables no aportan información
+            JAMZBitset value = forward ? problem->out[other] : problem->in[other];
+            if (first)
+                jamz_bitset_copy(meet_set, value);
+            else if (intersect)
+                jamz_bitset_intersect(meet_set, value);
+            else
+                jamz_bitset_union(meet_set, value);
+            first = false;
+        }
+        if (first || (forward && n == graph->entry))
+            jamz_bitset_copy(meet_set, problem->boundary);
+
+        // Transferencia: gen ∪ (meet − kill)
+        jamz_bitset_copy(scratch, meet_set);
+        jamz_bitset_subtract(scratch, problem->kill[n]);
+        jamz_bitset_union(scratch, problem->gen[n]);
+        if (jamz_bitset_equal(scratch, result))
+            continue;
+        jamz_bitset_copy(result, scratch);
+
+        const size_t *next_start = forward ? graph->succ_start : graph->pred_start;
+        const size_t *next_edges = forward ? graph->succs : graph->preds;
+        for (size_t e = next_start[n]; e < next_start[n + 1]; e++)
+        {
+            if (graph->rpo_index[next_edges[e]] != SIZE_MAX)
+                worklist_push(&list, next_edges[e]);
+        }
+    }
+
+    free(scratch.words);
+    free(list.heap);
+    free(list.queued);
+    free(priority);
+    return visits;
+}
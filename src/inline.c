@@ -0,0 +1,437 @@
+#include "inline.h"
+#include "profile.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Tope de instrucciones de una función que recibe cuerpos integrados
+#define JAMZ_INLINE_MAX_FUNCTION 2000
+// Lo que se espera ahorrar por cada argumento constante al propagarse
+#define JAMZ_INLINE_CONSTANT_BONUS 2
+// Una llamada cuesta sus ARG, el call, el ret y el marco del llamado
+#define JAMZ_INLINE_CALL_OVERHEAD 4
+
+// Componentes fuertemente conexas del grafo de llamadas (Tarjan). Salen en
+// orden topológico inverso: una función después de todas las que llama.
+typedef struct
+{
+    const JAMZIRProgram *program;
+    int32_t *index;
+    int32_t *lowlink;
+    bool *on_stack;
+    size_t *stack;
+    size_t depth;
+    int32_t counter;
+    int32_t *component; // Componente de cada función
+    int32_t component_count;
+    size_t *order; // Funciones de abajo arriba
+    size_t order_count;
+} CallGraph;
+
+static void visit_function(CallGraph *graph, size_t f)
+{
+    graph->index[f] = graph->lowlink[f] = graph->counter++;
+    graph->stack[graph->depth++] = f;
+    graph->on_stack[f] = true;
+
+    const JAMZIRFunction *function = &graph->program->functions[f];
+    for (size_t i = 0; i < function->count; i++)
+    {
+        const JAMZIRInstr *instr = &function->code[i];
+        if (instr->op != JAMZ_IR_CALL || instr->imm == JAMZ_IR_NONE)
+            continue;
+        size_t callee = (size_t)instr->imm;
+        if (graph->index[callee] < 0)
+        {
+            visit_function(graph, callee);
+            if (graph->lowlink[callee] < graph->lowlink[f])
+                graph->lowlink[f] = graph->lowlink[callee];
+        }
+        else if (graph->on_stack[callee] && graph->index[callee] < graph->lowlink[f])
+            graph->lowlink[f] = graph->index[callee];
+    }
+
+    if (graph->lowlink[f] != graph->index[f])
+        return;
+    size_t member;
+    do
+    {
+        member = graph->stack[--graph->depth];
+        graph->on_stack[member] = false;
+        graph->component[member] = graph->component_count;
+        graph->order[graph->order_count++] = member;
+    } while (member != f);
+    graph->component_count++;
+}
+
+static void build_call_graph(CallGraph *graph, const JAMZIRProgram *program)
+{
+    size_t count = program->function_count ? program->function_count : 1;
+    graph->program = program;
+    graph->index = safe_malloc(count * sizeof(int32_t));
+    graph->lowlink = safe_malloc(count * sizeof(int32_t));
+    graph->on_stack = calloc(count, sizeof(bool));
+    graph->stack = safe_malloc(count * sizeof(size_t));
+    graph->component = safe_malloc(count * sizeof(int32_t));
+    graph->order = safe_malloc(count * sizeof(size_t));
+    if (!graph->on_stack)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for the call graph\n");
+        exit(EXIT_FAILURE);
+    }
+    graph->depth = 0;
+    graph->counter = 0;
+    graph->component_count = 0;
+    graph->order_count = 0;
+    for (size_t f = 0; f < program->function_count; f++)
+        graph->index[f] = -1;
+    for (size_t f = 0; f < program->function_count; f++)
+    {
+        if (graph->index[f] < 0)
+            visit_function(graph, f);
+    }
+}
+
+static void free_call_graph(CallGraph *graph)
+{
+    free(graph->index);
+    free(graph->lowlink);
+    free(graph->on_stack);
+    free(graph->stack);
+    free(graph->component);
+    free(graph->order);
+}
+
+// Instrucciones que quedarán del cuerpo: las etiquetas y los contadores no
+// ocupan nada y PARAM, las copias y RET se disuelven en las del llamador
+static size_t body_size(const JAMZIRInstr *code, size_t count)
+{
+    size_t size = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        JAMZIROp op = code[i].op;
+        if (op != JAMZ_IR_LABEL && op != JAMZ_IR_PARAM && op != JAMZ_IR_COPY && op != JAMZ_IR_RET &&
+            op != JAMZ_IR_COUNT)
+            size++;
+    }
+    return size;
+}
+
+// Profundidad de bucle de cada instrucción: los bucles de la IR recién
+// generada son rotados, así que cada salto hacia atrás cierra uno
+static int32_t *loop_depths(const JAMZIRFunction *function)
+{
+    int32_t *label_at = safe_malloc((function->label_count ? (size_t)function->label_count : 1) * sizeof(int32_t));
+    int32_t *depth = calloc(function->count + 1, sizeof(int32_t));
+    if (!depth)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for inlining\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < function->count; i++)
+    {
+        if (function->code[i].op == JAMZ_IR_LABEL)
+            label_at[function->code[i].imm] = (int32_t)i;
+    }
+    // Diferencias: +1 en la etiqueta, -1 tras el salto; luego suma acumulada
+    for (size_t i = 0; i < function->count; i++)
+    {
+        const JAMZIRInstr *instr = &function->code[i];
+        if ((instr->op == JAMZ_IR_JUMP || instr->op == JAMZ_IR_BRANCH) && label_at[instr->imm] < (int32_t)i)
+        {
+            depth[label_at[instr->imm]]++;
+            depth[i + 1]--;
+        }
+    }
+    for (size_t i = 1; i < function->count; i++)
+        depth[i] += depth[i - 1];
+    free(label_at);
+    return depth;
+}
+
+// Copia el cuerpo de callee en lugar de la llamada. Cada registro y cada
+// etiqueta del llamado reciben uno nuevo en el llamador; PARAM copia el
+// argumento y cada RET copia el resultado y salta al final del cuerpo.
+static void inline_call(JAMZIRFunction *caller, const JAMZIRFunction *callee, const JAMZIRInstr *call,
+                        const int32_t *args)
+{
+    int32_t *vregs = safe_malloc((callee->vreg_count ? (size_t)callee->vreg_count : 1) * sizeof(int32_t));
+    for (int32_t v = 0; v < callee->vreg_count; v++)
+    {
+        const char *name = callee->vreg_names[v];
+        if (!name)
+        {
+            vregs[v] = ir_new_vreg(caller, NULL);
+            continue;
+        }
+        // El nombre lleva el de la función: en los volcados se ve de dónde viene
+        size_t length = strlen(callee->name) + strlen(name) + 2;
+        char *qualified = safe_malloc(length);
+        snprintf(qualified, length, "%s.%s", callee->name, name);
+        vregs[v] = ir_new_vreg(caller, qualified);
+        free(qualified);
+    }
+    int32_t label_base = caller->label_count;
+    int32_t exit_label = label_base + callee->label_count;
+    caller->label_count = exit_label + 1;
+
+#define MAP(v) ((v) == JAMZ_IR_NONE ? JAMZ_IR_NONE : vregs[v])
+    for (size_t i = 0; i < callee->count; i++)
+    {
+        const JAMZIRInstr *instr = &callee->code[i];
+        switch (instr->op)
+        {
+        case JAMZ_IR_PARAM:
+            ir_emit(caller, JAMZ_IR_COPY, MAP(instr->dst), args[instr->imm], JAMZ_IR_NONE, 0, instr->line);
+            break;
+        case JAMZ_IR_LABEL:
+        case JAMZ_IR_JUMP:
+        case JAMZ_IR_BRANCH:
+            ir_emit(caller, instr->op, JAMZ_IR_NONE, MAP(instr->a), JAMZ_IR_NONE, label_base + instr->imm, instr->line);
+            break;
+        case JAMZ_IR_RET:
+            if (call->dst != JAMZ_IR_NONE && instr->a != JAMZ_IR_NONE)
+                ir_emit(caller, JAMZ_IR_COPY, call->dst, MAP(instr->a), JAMZ_IR_NONE, 0, instr->line);
+            if (i + 1 < callee->count)
+                ir_emit(caller, JAMZ_IR_JUMP, JAMZ_IR_NONE, JAMZ_IR_NONE, JAMZ_IR_NONE, exit_label, instr->line);
+            break;
+        default:
+            ir_emit(caller, instr->op, MAP(instr->dst), MAP(instr->a), MAP(instr->b), instr->imm, instr->line);
+            break;
+        }
+    }
+#undef MAP
+    ir_emit(caller, JAMZ_IR_LABEL, JAMZ_IR_NONE, JAMZ_IR_NONE, JAMZ_IR_NONE, exit_label, call->line);
+    free(vregs);
+}
+
+// Decide cada llamada de la función f y reescribe su código con las que se
+// integran. Los ARG de una llamada van seguidos justo antes del CALL (el
+// primero el último), así que al integrar se quitan de la salida. Con un
+// perfil, el límite lo decide cuántas veces pasó la llamada en lugar de si
+// está en un bucle: se dobla si pasó más veces que las que se entró en la
+// función y es 0 si no pasó nunca.
+static void inline_into(JAMZIRProgram *program, const CallGraph *graph, size_t f, size_t threshold, FILE *report,
+                        JAMZInlineStats *stats)
+{
+    JAMZIRFunction *function = &program->functions[f];
+    bool has_calls = false;
+    for (size_t i = 0; i < function->count && !has_calls; i++)
+        has_calls = function->code[i].op == JAMZ_IR_CALL;
+    if (!has_calls)
+        return;
+
+    // Temporales definidos por una constante: un temporal se define una vez
+    bool *constant = calloc(function->vreg_count ? (size_t)function->vreg_count : 1, sizeof(bool));
+    if (!constant)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for inlining\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < function->count; i++)
+    {
+        const JAMZIRInstr *instr = &function->code[i];
+        if (instr->op == JAMZ_IR_CONST && !function->vreg_names[instr->dst])
+            constant[instr->dst] = true;
+    }
+    int32_t *depth = loop_depths(function);
+    const uint64_t *weights = profile_weights(program);
+    uint64_t entry = 0;
+    for (size_t i = 0; i < function->count && weights; i++)
+    {
+        if (function->code[i].op == JAMZ_IR_COUNT)
+        {
+            entry = weights[function->code[i].imm];
+            break;
+        }
+    }
+    int32_t counter = JAMZ_IR_NONE; // COUNT del bloque en curso
+
+    JAMZIRInstr *code = function->code;
+    size_t count = function->count;
+    function->code = NULL;
+    function->count = 0;
+    function->capacity = 0;
+    size_t size = body_size(code, count);
+    for (size_t i = 0; i < count; i++)
+    {
+        const JAMZIRInstr *call = &code[i];
+        if (call->op == JAMZ_IR_COUNT)
+            counter = call->imm;
+        if (call->op != JAMZ_IR_CALL)
+        {
+            ir_emit(function, call->op, call->dst, call->a, call->b, call->imm, call->line);
+            continue;
+        }
+
+        const char *reason = NULL;
+        char detail[96] = "";
+        const JAMZIRFunction *callee = call->imm == JAMZ_IR_NONE ? NULL : &program->functions[call->imm];
+        size_t args = 0;
+        while (args < i && code[i - 1 - args].op == JAMZ_IR_ARG)
+            args++;
+        size_t callee_size = callee ? body_size(callee->code, callee->count) : 0;
+        if (!callee)
+            reason = "unknown function";
+        else if (graph->component[call->imm] == graph->component[f])
+            reason = "recursive";
+        else if (callee->array_count > 0 || callee->kernel_count > 0)
+            reason = "local arrays"; // Habría que volver a ponerlos a 0 en cada llamada
+        else if (args != callee->param_count)
+            reason = "argument count";
+        else if (size + callee_size > JAMZ_INLINE_MAX_FUNCTION)
+            reason = "caller too large";
+        else
+        {
+            // Coste: lo que crece el llamador menos lo que se ahorra
+            long benefit = (long)(callee->param_count + JAMZ_INLINE_CALL_OVERHEAD);
+            for (size_t k = 0; k < callee->param_count; k++)
+            {
+                if (constant[code[i - 1 - k].a])
+                    benefit += JAMZ_INLINE_CONSTANT_BONUS;
+            }
+            long cost = (long)callee_size - benefit;
+            long limit = (long)threshold;
+            char where[48] = "";
+            bool cold = false;
+            if (weights && counter != JAMZ_IR_NONE)
+            {
+                uint64_t passes = weights[counter];
+                cold = passes == 0;
+                limit = cold ? 0 : passes > entry ? 2 * limit : limit;
+                snprintf(where, sizeof(where), ", %s%llu run(s)", passes > entry ? "hot, " : "",
+                         (unsigned long long)passes);
+            }
+            else if (depth[i] > 0)
+            {
+                limit *= 2;
+                snprintf(where, sizeof(where), " in loop");
+            }
+            snprintf(detail, sizeof(detail), "size %zu, cost %ld %s %ld%s", callee_size, cost,
+                     cost <= limit ? "<=" : ">", limit, where);
+            if (cost > limit)
+                reason = cold ? "cold" : "too costly";
+        }
+
+        if (report && callee)
+        {
+            if (reason)
+                fprintf(report, "  %s: kept call to %s at line %d (%s%s%s)\n", function->name, callee->name,
+                        call->line, reason, detail[0] ? ", " : "", detail);
+            else
+                fprintf(report, "  %s: inlined %s at line %d (%s)\n", function->name, callee->name, call->line,
+                        detail);
+        }
+        if (reason)
+        {
+            stats->kept++;
+            ir_emit(function, call->op, call->dst, call->a, call->b, call->imm, call->line);
+            continue;
+        }
+
+        int32_t *values = safe_malloc((callee->param_count ? callee->param_count : 1) * sizeof(int32_t));
+        for (size_t k = 0; k < callee->param_count; k++)
+            values[k] = code[i - 1 - k].a;
+        function->count -= args; // Los ARG ya copiados
+        inline_call(function, callee, call, values);
+        free(values);
+        // Los COUNT copiados son los del llamado; lo que sigue a la llamada
+        // vuelve a pesar lo del bloque del llamador
+        if (weights && counter != JAMZ_IR_NONE)
+            ir_emit(function, JAMZ_IR_COUNT, JAMZ_IR_NONE, JAMZ_IR_NONE, JAMZ_IR_NONE, counter, call->line);
+        size += callee_size;
+        stats->inlined++;
+    }
+    free(code);
+    free(depth);
+    free(constant);
+}
+
+// Con main presente el programa está completo: las funciones a las que ya
+// no llega ninguna llamada desde main (todas integradas) se eliminan y las
+// demás se renumeran en los CALL
+static void remove_unreachable(JAMZIRProgram *program, FILE *report, JAMZInlineStats *stats)
+{
+    size_t main_index = program->function_count;
+    for (size_t f = 0; f < program->function_count; f++)
+    {
+        if (strcmp(program->functions[f].name, "main") == 0)
+            main_index = f;
+    }
+    if (main_index == program->function_count)
+        return;
+
+    int32_t *renumber = safe_malloc(program->function_count * sizeof(int32_t));
+    size_t *pending = safe_malloc(program->function_count * sizeof(size_t));
+    for (size_t f = 0; f < program->function_count; f++)
+        renumber[f] = JAMZ_IR_NONE;
+    size_t depth = 0;
+    renumber[main_index] = 0;
+    pending[depth++] = main_index;
+    while (depth > 0)
+    {
+        const JAMZIRFunction *function = &program->functions[pending[--depth]];
+        for (size_t i = 0; i < function->count; i++)
+        {
+            const JAMZIRInstr *instr = &function->code[i];
+            if (instr->op == JAMZ_IR_CALL && instr->imm != JAMZ_IR_NONE && renumber[instr->imm] == JAMZ_IR_NONE)
+            {
+                renumber[instr->imm] = 0;
+                pending[depth++] = (size_t)instr->imm;
+            }
+        }
+    }
+
+    // Se conserva el orden del AST
+    size_t kept = 0;
+    for (size_t f = 0; f < program->function_count; f++)
+    {
+        if (renumber[f] == JAMZ_IR_NONE)
+        {
+            if (report)
+                fprintf(report, "  removed %s: no calls left\n", program->functions[f].name);
+            ir_free_function(&program->functions[f]);
+            stats->removed++;
+            continue;
+        }
+        renumber[f] = (int32_t)kept;
+        program->functions[kept++] = program->functions[f];
+    }
+    program->function_count = kept;
+    for (size_t f = 0; f < kept; f++)
+    {
+        JAMZIRFunction *function = &program->functions[f];
+        for (size_t i = 0; i < function->count; i++)
+        {
+            if (function->code[i].op == JAMZ_IR_CALL && function->code[i].imm != JAMZ_IR_NONE)
+                function->code[i].imm = renumber[function->code[i].imm];
+        }
+    }
+    free(pending);
+    free(renumber);
+}
+
+JAMZInlineStats inline_functions(JAMZIRProgram *program, size_t threshold, FILE *report)
+{
+    JAMZInlineStats stats = {0, 0, 0, 0, 0};
+    for (size_t f = 0; f < program->function_count; f++)
+        stats.instructions_before += program->functions[f].count;
+
+    if (threshold > 0)
+    {
+        CallGraph graph;
+        build_call_graph(&graph, program);
+        for (size_t k = 0; k < graph.order_count; k++)
+            inline_into(program, &graph, graph.order[k], threshold, report, &stats);
+        free_call_graph(&graph);
+        if (stats.inlined > 0)
+            remove_unreachable(program, report, &stats);
+    }
+
+    for (size_t f = 0; f < program->function_count; f++)
+        stats.instructions_after += program->functions[f].count;
+    log_debug("Integración: %zu llamadas integradas, %zu mantenidas, %zu funciones eliminadas, %zu -> %zu "
+              "instrucciones\n",
+              stats.inlined, stats.kept, stats.removed, stats.instructions_before, stats.instructions_after);
+    return stats;
+}
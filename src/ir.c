@@ -0,0 +1,613 @@
+#include "ir.h"
+#include "semantic.h"
+#include "utils.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct
+{
+    JAMZIRProgram *program;
+    JAMZIRFunction *function;
+    int32_t *var_vregs; // Registro de cada variable (o número de cada arreglo), indexado por Symbol.id
+    size_t var_capacity;
+    const size_t *callees; // Tabla abierta de nombre de función a índice
+    size_t callee_capacity;
+    int32_t break_label; // Destinos del bucle más interno, o JAMZ_IR_NONE
+    int32_t continue_label;
+} Lowering;
+
+size_t ir_emit(JAMZIRFunction *function, JAMZIROp op, int32_t dst, int32_t a, int32_t b, int32_t imm, int line)
+{
+    if (function->count == function->capacity)
+    {
+        function->capacity = function->capacity ? function->capacity * 2 : 64;
+        function->code = safe_realloc(function->code, function->capacity * sizeof(JAMZIRInstr));
+    }
+    JAMZIRInstr *instr = &function->code[function->count];
+    instr->op = op;
+    instr->dst = dst;
+    instr->a = a;
+    instr->b = b;
+    instr->imm = imm;
+    instr->line = line;
+    return function->count++;
+}
+
+int32_t ir_new_vreg(JAMZIRFunction *function, const char *name)
+{
+    // La capacidad se duplica al llegar a cada potencia de dos
+    int32_t count = function->vreg_count;
+    if (count == 0 || (count >= 8 && (count & (count - 1)) == 0))
+        function->vreg_names = safe_realloc(function->vreg_names, (count ? count * 2 : 8) * sizeof(char *));
+    function->vreg_names[function->vreg_count] = name ? strdup(name) : NULL;
+    return function->vreg_count++;
+}
+
+int32_t ir_new_array(JAMZIRFunction *function, int32_t length)
+{
+    function->array_lengths = safe_realloc(function->array_lengths, (function->array_count + 1) * sizeof(int32_t));
+    function->array_lengths[function->array_count] = length;
+    return (int32_t)function->array_count++;
+}
+
+static int32_t *symbol_entry(Lowering *lower, const Symbol *sym)
+{
+    if (sym->id >= lower->var_capacity)
+    {
+        size_t capacity = lower->var_capacity ? lower->var_capacity : 16;
+        while (capacity <= sym->id)
+            capacity *= 2;
+        lower->var_vregs = safe_realloc(lower->var_vregs, capacity * sizeof(int32_t));
+        for (size_t i = lower->var_capacity; i < capacity; i++)
+            lower->var_vregs[i] = JAMZ_IR_NONE;
+        lower->var_capacity = capacity;
+    }
+    return &lower->var_vregs[sym->id];
+}
+
+// Registro fijo de una variable; se crea en su primera aparición
+static int32_t variable_vreg(Lowering *lower, const JAMZASTNode *node, const char *name)
+{
+    if (!node->symbol)
+        return ir_new_vreg(lower->function, name); // Solo con errores semánticos previos
+    int32_t *entry = symbol_entry(lower, node->symbol);
+    if (*entry == JAMZ_IR_NONE)
+        *entry = ir_new_vreg(lower->function, name);
+    return *entry;
+}
+
+// Número del arreglo de una variable; un símbolo es variable o arreglo, así
+// que comparten tabla
+static int32_t variable_array(Lowering *lower, const JAMZASTNode *node)
+{
+    if (!node->symbol)
+        return ir_new_array(lower->function, 1);
+    int32_t *entry = symbol_entry(lower, node->symbol);
+    if (*entry == JAMZ_IR_NONE)
+        *entry = ir_new_array(lower->function, (int32_t)jamz_type_info(node->symbol->type_id)->length);
+    return *entry;
+}
+
+static int32_t intern_string(JAMZIRProgram *program, const char *text)
+{
+    for (size_t i = 0; i < program->string_count; i++)
+    {
+        if (strcmp(program->strings[i], text) == 0)
+            return (int32_t)i;
+    }
+    if (program->string_count == program->string_capacity)
+    {
+        program->string_capacity = program->string_capacity ? program->string_capacity * 2 : 8;
+        program->strings = safe_realloc(program->strings, program->string_capacity * sizeof(char *));
+    }
+    program->strings[program->string_count] = strdup(text);
+    return (int32_t)program->string_count++;
+}
+
+static int32_t find_callee(const Lowering *lower, const char *name)
+{
+    size_t mask = lower->callee_capacity - 1;
+    for (size_t slot = jamz_hash_string(name) & mask; lower->callees[slot] != SIZE_MAX; slot = (slot + 1) & mask)
+    {
+        size_t index = lower->callees[slot];
+        if (strcmp(lower->program->functions[index].name, name) == 0)
+            return (int32_t)index;
+    }
+    return JAMZ_IR_NONE;
+}
+
+bool jamz_ir_is_comparison(JAMZIROp op)
+{
+    return op == JAMZ_IR_EQ || op == JAMZ_IR_NE || op == JAMZ_IR_LT || op == JAMZ_IR_LE || op == JAMZ_IR_GT ||
+           op == JAMZ_IR_GE;
+}
+
+JAMZIROp jamz_ir_negate_comparison(JAMZIROp op)
+{
+    switch (op)
+    {
+    case JAMZ_IR_EQ:
+        return JAMZ_IR_NE;
+    case JAMZ_IR_NE:
+        return JAMZ_IR_EQ;
+    case JAMZ_IR_LT:
+        return JAMZ_IR_GE;
+    case JAMZ_IR_LE:
+        return JAMZ_IR_GT;
+    case JAMZ_IR_GT:
+        return JAMZ_IR_LE;
+    default:
+        return JAMZ_IR_LT;
+    }
+}
+
+JAMZIROp jamz_ir_swap_comparison(JAMZIROp op)
+{
+    switch (op)
+    {
+    case JAMZ_IR_LT:
+        return JAMZ_IR_GT;
+    case JAMZ_IR_LE:
+        return JAMZ_IR_GE;
+    case JAMZ_IR_GT:
+        return JAMZ_IR_LT;
+    case JAMZ_IR_GE:
+        return JAMZ_IR_LE;
+    default:
+        return op; // EQ y NE son simétricas
+    }
+}
+
+static JAMZIROp binary_op(const JAMZASTNode *node)
+{
+    const char *op = node->binary.op;
+    static const struct
+    {
+        const char *text;
+        JAMZIROp op;
+    } comparisons[] = {
+        {"==", JAMZ_IR_EQ}, {"!=", JAMZ_IR_NE}, {"<", JAMZ_IR_LT}, {"<=", JAMZ_IR_LE}, {">", JAMZ_IR_GT}, {">=", JAMZ_IR_GE},
+    };
+    for (size_t k = 0; k < sizeof(comparisons) / sizeof(comparisons[0]); k++)
+    {
+        if (strcmp(op, comparisons[k].text) == 0)
+            return comparisons[k].op;
+    }
+    if (strcmp(op, "+") == 0)
+        return JAMZ_IR_ADD;
+    if (strcmp(op, "-") == 0)
+        return JAMZ_IR_SUB;
+    if (strcmp(op, "*") == 0)
+        return JAMZ_IR_MUL;
+    if (strcmp(op, "%") == 0)
+        return node->binary.non_negative ? JAMZ_IR_UMOD : JAMZ_IR_MOD;
+    return node->binary.non_negative ? JAMZ_IR_UDIV : JAMZ_IR_DIV;
+}
+
+// Evalúa la expresión y devuelve el registro que guarda su valor
+static int32_t lower_expression(Lowering *lower, const JAMZASTNode *node)
+{
+    JAMZIRFunction *function = lower->function;
+    if (!node)
+        return JAMZ_IR_NONE;
+
+    switch (node->type)
+    {
+    case JAMZ_AST_LITERAL:
+    {
+        int32_t dst = ir_new_vreg(function, NULL);
+        if (node->literal.token_type == JAMZ_TOKEN_STRING)
+        {
+            ir_emit(function, JAMZ_IR_STRING, dst, JAMZ_IR_NONE, JAMZ_IR_NONE,
+                 intern_string(lower->program, node->literal.value), node->line);
+            return dst;
+        }
+        errno = 0;
+        long long value = strtoll(node->literal.value, NULL, 10);
+        if (errno != 0)
+            log_debug("Literal '%s' fuera de rango en la línea %d\n", node->literal.value, node->line);
+        ir_emit(function, JAMZ_IR_CONST, dst, JAMZ_IR_NONE, JAMZ_IR_NONE, (int32_t)value, node->line);
+        return dst;
+    }
+    case JAMZ_AST_VARIABLE:
+        return variable_vreg(lower, node, node->variable.var_name);
+    case JAMZ_AST_INDEX:
+    {
+        int32_t index = lower_expression(lower, node->index.index);
+        int32_t dst = ir_new_vreg(function, NULL);
+        ir_emit(function, JAMZ_IR_LOAD, dst, index, JAMZ_IR_NONE, variable_array(lower, node), node->line);
+        return dst;
+    }
+    case JAMZ_AST_BINARY:
+    {
+        int32_t left = lower_expression(lower, node->binary.left);
+        int32_t right = lower_expression(lower, node->binary.right);
+        int32_t dst = ir_new_vreg(function, NULL);
+        ir_emit(function, binary_op(node), dst, left, right, 0, node->line);
+        return dst;
+    }
+    case JAMZ_AST_CALL:
+    {
+        // Primero todos los argumentos: una llamada anidada no debe
+        // mezclar sus ARG con los de esta
+        int32_t *args = safe_malloc((node->call.arg_count ? node->call.arg_count : 1) * sizeof(int32_t));
+        for (size_t i = 0; i < node->call.arg_count; i++)
+            args[i] = lower_expression(lower, node->call.args[i]);
+        for (size_t i = node->call.arg_count; i-- > 0;)
+            ir_emit(function, JAMZ_IR_ARG, JAMZ_IR_NONE, args[i], JAMZ_IR_NONE, 0, node->line);
+        free(args);
+
+        int32_t dst = ir_new_vreg(function, NULL);
+        ir_emit(function, JAMZ_IR_CALL, dst, JAMZ_IR_NONE, JAMZ_IR_NONE, find_callee(lower, node->call.name), node->line);
+        return dst;
+    }
+    default:
+        log_debug("Expresión no soportada en la IR (tipo %d, línea %d)\n", node->type, node->line);
+        return JAMZ_IR_NONE;
+    }
+}
+
+// Registro que vale 0 justo cuando la condición se cumple: la comparación
+// negada, o cond == 0 para cualquier otra expresión. Con él, la prueba del
+// final de un bucle es un solo BRANCH hacia el principio del cuerpo.
+static int32_t lower_inverted_condition(Lowering *lower, const JAMZASTNode *node)
+{
+    JAMZIRFunction *function = lower->function;
+    if (node->type == JAMZ_AST_BINARY && jamz_is_comparison(node->binary.op))
+    {
+        int32_t left = lower_expression(lower, node->binary.left);
+        int32_t right = lower_expression(lower, node->binary.right);
+        int32_t dst = ir_new_vreg(function, NULL);
+        ir_emit(function, jamz_ir_negate_comparison(binary_op(node)), dst, left, right, 0, node->line);
+        return dst;
+    }
+    int32_t value = lower_expression(lower, node);
+    int32_t zero = ir_new_vreg(function, NULL);
+    ir_emit(function, JAMZ_IR_CONST, zero, JAMZ_IR_NONE, JAMZ_IR_NONE, 0, node->line);
+    int32_t dst = ir_new_vreg(function, NULL);
+    ir_emit(function, JAMZ_IR_EQ, dst, value, zero, 0, node->line);
+    return dst;
+}
+
+// Bucle rotado: la condición se comprueba una vez a la entrada y después al
+// final de cada vuelta, de modo que el cuerpo no lleva ningún salto
+// incondicional de vuelta a la cabecera.
+//
+//       BRANCH cond, salida        (falta si el bucle no tiene condición)
+//   cuerpo:
+//       ...                        break -> salida, continue -> paso
+//   paso:
+//       ...
+//       BRANCH !cond, cuerpo       (JUMP cuerpo sin condición)
+//   salida:
+static void lower_statement(Lowering *lower, const JAMZASTNode *node);
+
+static void lower_loop(Lowering *lower, const JAMZASTNode *node)
+{
+    JAMZIRFunction *function = lower->function;
+    const JAMZASTNode *condition = node->while_stmt.condition;
+    int32_t body_label = function->label_count++;
+    int32_t step_label = function->label_count++;
+    int32_t exit_label = function->label_count++;
+
+    if (condition)
+    {
+        int32_t guard = lower_expression(lower, condition);
+        ir_emit(function, JAMZ_IR_BRANCH, JAMZ_IR_NONE, guard, JAMZ_IR_NONE, exit_label, node->line);
+    }
+    ir_emit(function, JAMZ_IR_LABEL, JAMZ_IR_NONE, JAMZ_IR_NONE, JAMZ_IR_NONE, body_label, node->line);
+
+    int32_t saved_break = lower->break_label;
+    int32_t saved_continue = lower->continue_label;
+    lower->break_label = exit_label;
+    lower->continue_label = step_label;
+    lower_statement(lower, node->while_stmt.body);
+    lower->break_label = saved_break;
+    lower->continue_label = saved_continue;
+
+    ir_emit(function, JAMZ_IR_LABEL, JAMZ_IR_NONE, JAMZ_IR_NONE, JAMZ_IR_NONE, step_label, node->line);
+    lower_statement(lower, node->while_stmt.step);
+    if (condition)
+    {
+        int32_t again = lower_inverted_condition(lower, condition);
+        ir_emit(function, JAMZ_IR_BRANCH, JAMZ_IR_NONE, again, JAMZ_IR_NONE, body_label, node->line);
+    }
+    else
+        ir_emit(function, JAMZ_IR_JUMP, JAMZ_IR_NONE, JAMZ_IR_NONE, JAMZ_IR_NONE, body_label, node->line);
+    ir_emit(function, JAMZ_IR_LABEL, JAMZ_IR_NONE, JAMZ_IR_NONE, JAMZ_IR_NONE, exit_label, node->line);
+}
+
+static void lower_statement(Lowering *lower, const JAMZASTNode *node)
+{
+    JAMZIRFunction *function = lower->function;
+    if (!node)
+        return;
+
+    switch (node->type)
+    {
+    case JAMZ_AST_BLOCK:
+        for (size_t i = 0; i < node->block.count; i++)
+            lower_statement(lower, node->block.statements[i]);
+        break;
+    case JAMZ_AST_DECLARATION:
+    {
+        if (jamz_type_is_array(node->declaration.type_id))
+        {
+            variable_array(lower, node);
+            break;
+        }
+        int32_t var = variable_vreg(lower, node, node->declaration.var_name);
+        if (node->declaration.initializer)
+        {
+            int32_t value = lower_expression(lower, node->declaration.initializer);
+            ir_emit(function, JAMZ_IR_COPY, var, value, JAMZ_IR_NONE, 0, node->line);
+        }
+        break;
+    }
+    case JAMZ_AST_ASSIGNMENT:
+    {
+        if (node->assignment.index)
+        {
+            int32_t index = lower_expression(lower, node->assignment.index);
+            int32_t value = lower_expression(lower, node->assignment.value);
+            ir_emit(function, JAMZ_IR_STORE, JAMZ_IR_NONE, index, value, variable_array(lower, node), node->line);
+            break;
+        }
+        int32_t value = lower_expression(lower, node->assignment.value);
+        int32_t var = variable_vreg(lower, node, node->assignment.var_name);
+        ir_emit(function, JAMZ_IR_COPY, var, value, JAMZ_IR_NONE, 0, node->line);
+        break;
+    }
+    case JAMZ_AST_RETURN:
+    {
+        int32_t value = lower_expression(lower, node->return_stmt.value);
+        ir_emit(function, JAMZ_IR_RET, JAMZ_IR_NONE, value, JAMZ_IR_NONE, 0, node->line);
+        break;
+    }
+    case JAMZ_AST_IF:
+    {
+        int32_t condition = lower_expression(lower, node->if_stmt.condition);
+        int32_t else_label = function->label_count++;
+        ir_emit(function, JAMZ_IR_BRANCH, JAMZ_IR_NONE, condition, JAMZ_IR_NONE, else_label, node->line);
+        lower_statement(lower, node->if_stmt.then_branch);
+        if (node->if_stmt.else_branch)
+        {
+            int32_t end_label = function->label_count++;
+            ir_emit(function, JAMZ_IR_JUMP, JAMZ_IR_NONE, JAMZ_IR_NONE, JAMZ_IR_NONE, end_label, node->line);
+            ir_emit(function, JAMZ_IR_LABEL, JAMZ_IR_NONE, JAMZ_IR_NONE, JAMZ_IR_NONE, else_label, node->line);
+            lower_statement(lower, node->if_stmt.else_branch);
+            ir_emit(function, JAMZ_IR_LABEL, JAMZ_IR_NONE, JAMZ_IR_NONE, JAMZ_IR_NONE, end_label, node->line);
+        }
+        else
+            ir_emit(function, JAMZ_IR_LABEL, JAMZ_IR_NONE, JAMZ_IR_NONE, JAMZ_IR_NONE, else_label, node->line);
+        break;
+    }
+    case JAMZ_AST_WHILE:
+        lower_loop(lower, node);
+        break;
+    case JAMZ_AST_BREAK:
+    case JAMZ_AST_CONTINUE:
+        ir_emit(function, JAMZ_IR_JUMP, JAMZ_IR_NONE, JAMZ_IR_NONE, JAMZ_IR_NONE,
+                node->type == JAMZ_AST_BREAK ? lower->break_label : lower->continue_label, node->line);
+        break;
+    default:
+        // Llamada u otra expresión usada como sentencia: solo sus efectos
+        lower_expression(lower, node);
+        break;
+    }
+}
+
+JAMZIRProgram *lower_to_ir(const JAMZASTNode *program)
+{
+    JAMZIRProgram *ir = safe_malloc(sizeof(JAMZIRProgram));
+    ir->function_count = program->block.count;
+    ir->functions = calloc(ir->function_count ? ir->function_count : 1, sizeof(JAMZIRFunction));
+    ir->strings = NULL;
+    ir->string_count = 0;
+    ir->string_capacity = 0;
+    ir->profile = NULL;
+    if (!ir->functions)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for IR\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t capacity = 16;
+    while (capacity < ir->function_count * 2)
+        capacity *= 2;
+    size_t *callees = safe_malloc(capacity * sizeof(size_t));
+    for (size_t i = 0; i < capacity; i++)
+        callees[i] = SIZE_MAX;
+    for (size_t i = 0; i < ir->function_count; i++)
+    {
+        ir->functions[i].name = strdup(program->block.statements[i]->function.name);
+        size_t slot = jamz_hash_string(ir->functions[i].name) & (capacity - 1);
+        while (callees[slot] != SIZE_MAX)
+            slot = (slot + 1) & (capacity - 1);
+        callees[slot] = i;
+    }
+
+    Lowering lower = {ir, NULL, NULL, 0, callees, capacity, JAMZ_IR_NONE, JAMZ_IR_NONE};
+    for (size_t i = 0; i < ir->function_count; i++)
+    {
+        const JAMZASTNode *node = program->block.statements[i];
+        JAMZIRFunction *function = &ir->functions[i];
+        lower.function = function;
+        for (size_t v = 0; v < lower.var_capacity; v++)
+            lower.var_vregs[v] = JAMZ_IR_NONE;
+
+        function->param_count = node->function.param_count;
+        for (size_t p = 0; p < node->function.param_count; p++)
+        {
+            const JAMZASTNode *param = node->function.params[p];
+            int32_t var = variable_vreg(&lower, param, param->declaration.var_name);
+            ir_emit(function, JAMZ_IR_PARAM, var, JAMZ_IR_NONE, JAMZ_IR_NONE, (int32_t)p, param->line);
+        }
+        lower_statement(&lower, node->function.body);
+        // Salida implícita al final del cuerpo
+        if (function->count == 0 || function->code[function->count - 1].op != JAMZ_IR_RET)
+            ir_emit(function, JAMZ_IR_RET, JAMZ_IR_NONE, JAMZ_IR_NONE, JAMZ_IR_NONE, 0, node->line);
+
+        log_debug("IR de %s: %zu instrucciones, %d registros virtuales\n", function->name, function->count,
+                  function->vreg_count);
+    }
+
+    free(lower.var_vregs);
+    free(callees);
+    return ir;
+}
+
+static const char *op_names[] = {
+    "const", "string", "param", "copy", "add", "sub", "mul", "div", "udiv", "mod", "umod",
+    "eq", "ne", "lt", "le", "gt", "ge", "arg", "call", "label", "jump", "branch", "ret", "load", "store", "vloop",
+    "count",
+};
+
+static const char *vector_op_names[] = {"load", "splat", "const", "add", "sub", "mul", "store"};
+
+static void print_vreg(const JAMZIRFunction *function, int32_t vreg, FILE *out)
+{
+    if (vreg == JAMZ_IR_NONE)
+        fprintf(out, "-");
+    else if (function->vreg_names[vreg])
+        fprintf(out, "%%%d(%s)", vreg, function->vreg_names[vreg]);
+    else
+        fprintf(out, "%%%d", vreg);
+}
+
+void print_ir(const JAMZIRProgram *program, FILE *out)
+{
+    for (size_t f = 0; f < program->function_count; f++)
+    {
+        const JAMZIRFunction *function = &program->functions[f];
+        fprintf(out, "%s:\n", function->name);
+        for (size_t i = 0; i < function->count; i++)
+        {
+            const JAMZIRInstr *instr = &function->code[i];
+            if (instr->op == JAMZ_IR_LABEL)
+            {
+                fprintf(out, "  L%d:\n", instr->imm);
+                continue;
+            }
+
+            fprintf(out, "    ");
+            if (instr->dst != JAMZ_IR_NONE)
+            {
+                print_vreg(function, instr->dst, out);
+                fprintf(out, " = ");
+            }
+            fprintf(out, "%s", op_names[instr->op]);
+            switch (instr->op)
+            {
+            case JAMZ_IR_CONST:
+            case JAMZ_IR_PARAM:
+            case JAMZ_IR_COUNT:
+                fprintf(out, " %d", instr->imm);
+                break;
+            case JAMZ_IR_STRING:
+                fprintf(out, " \"%s\"", program->strings[instr->imm]);
+                break;
+            case JAMZ_IR_CALL:
+                fprintf(out, " %s", instr->imm == JAMZ_IR_NONE ? "?" : program->functions[instr->imm].name);
+                break;
+            case JAMZ_IR_JUMP:
+                fprintf(out, " L%d", instr->imm);
+                break;
+            case JAMZ_IR_BRANCH:
+                fprintf(out, " ");
+                print_vreg(function, instr->a, out);
+                fprintf(out, ", L%d", instr->imm);
+                break;
+            case JAMZ_IR_LOAD:
+            case JAMZ_IR_STORE:
+                fprintf(out, " @%d[", instr->imm);
+                print_vreg(function, instr->a, out);
+                fprintf(out, "]");
+                if (instr->op == JAMZ_IR_STORE)
+                {
+                    fprintf(out, ", ");
+                    print_vreg(function, instr->b, out);
+                }
+                break;
+            case JAMZ_IR_VLOOP:
+            {
+                fprintf(out, " ");
+                print_vreg(function, instr->a, out);
+                fprintf(out, ", ");
+                print_vreg(function, instr->b, out);
+                const JAMZVectorKernel *kernel = &function->kernels[instr->imm];
+                fprintf(out, " {");
+                for (size_t k = 0; k < kernel->count; k++)
+                {
+                    const JAMZVectorInstr *v = &kernel->code[k];
+                    fprintf(out, "%s ", k ? ";" : "");
+                    if (v->op != JAMZ_VEC_STORE)
+                        fprintf(out, "v%zu = ", k);
+                    fprintf(out, "%s", vector_op_names[v->op]);
+                    if (v->op == JAMZ_VEC_LOAD || v->op == JAMZ_VEC_STORE)
+                        fprintf(out, " @%d[i%+d]", v->array, v->imm);
+                    else if (v->op == JAMZ_VEC_SPLAT)
+                        fprintf(out, " @%d[0]", v->array);
+                    else if (v->op == JAMZ_VEC_CONST)
+                        fprintf(out, " %d", v->imm);
+                    else
+                        fprintf(out, " v%d, v%d", v->a, v->b);
+                    if (v->op == JAMZ_VEC_STORE)
+                        fprintf(out, ", v%d", v->a);
+                }
+                fprintf(out, " }");
+                break;
+            }
+            default:
+                if (instr->a != JAMZ_IR_NONE)
+                {
+                    fprintf(out, " ");
+                    print_vreg(function, instr->a, out);
+                }
+                if (instr->b != JAMZ_IR_NONE)
+                {
+                    fprintf(out, ", ");
+                    print_vreg(function, instr->b, out);
+                }
+                break;
+            }
+            fprintf(out, "\n");
+        }
+    }
+}
+
+void ir_free_function(JAMZIRFunction *function)
+{
+    for (int32_t v = 0; v < function->vreg_count; v++)
+        free(function->vreg_names[v]);
+    free(function->vreg_names);
+    for (size_t k = 0; k < function->kernel_count; k++)
+        free(function->kernels[k].code);
+    free(function->kernels);
+    free(function->array_lengths);
+    free(function->code);
+    free(function->name);
+}
+
+void free_ir(JAMZIRProgram *program)
+{
+    if (!program)
+        return;
+
+    for (size_t f = 0; f < program->function_count; f++)
+        ir_free_function(&program->functions[f]);
+    for (size_t i = 0; i < program->string_count; i++)
+        free(program->strings[i]);
+    free(program->strings);
+    free(program->functions);
+    if (program->profile)
+    {
+        for (size_t i = 0; i < program->profile->range_count; i++)
+            free(program->profile->ranges[i].function);
+        free(program->profile->ranges);
+        free(program->profile->counts);
+        free(program->profile);
+    }
+    free(program);
+}
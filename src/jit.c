@@ -0,0 +1,151 @@
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE // MAP_ANONYMOUS
+#endif
+#include "jit.h"
+#include "object.h"
+#include "utils.h"
+#include "x64.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+// El código generado sigue System V también bajo Windows
+#if defined(_WIN32) && defined(__GNUC__)
+#define JIT_ABI __attribute__((sysv_abi))
+#else
+#define JIT_ABI
+#endif
+
+typedef int(JIT_ABI *JitMain)(int argc, char **argv);
+
+// Los datos van tras el código en la misma región, alineados a 16
+#define JIT_DATA_ALIGNMENT 16
+// Los contadores del perfil van en su propia página, que sigue admitiendo
+// escritura cuando el resto pasa a ejecutable
+#define JIT_PAGE_SIZE 4096
+
+static void *map_writable(size_t size)
+{
+#ifdef _WIN32
+    return VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#else
+    void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return memory == MAP_FAILED ? NULL : memory;
+#endif
+}
+
+// W^X: la región deja de admitir escritura antes de poder ejecutarse
+static bool make_executable(void *memory, size_t size)
+{
+#ifdef _WIN32
+    DWORD previous;
+    return VirtualProtect(memory, size, PAGE_EXECUTE_READ, &previous) != 0;
+#else
+    return mprotect(memory, size, PROT_READ | PROT_EXEC) == 0;
+#endif
+}
+
+static void unmap(void *memory, size_t size)
+{
+#ifdef _WIN32
+    (void)size;
+    VirtualFree(memory, 0, MEM_RELEASE);
+#else
+    munmap(memory, size);
+#endif
+}
+
+static int find_main(const JAMZIRProgram *program)
+{
+    for (size_t i = 0; i < program->function_count; i++)
+    {
+        if (strcmp(program->functions[i].name, "main") == 0)
+            return (int)i;
+    }
+    return -1;
+}
+
+bool jit_available(void)
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    return true;
+#else
+    return false;
+#endif
+}
+
+JAMZJitResult jit_run_main(const JAMZIRProgram *program)
+{
+    JAMZJitResult result = {false, 0, 0.0, 0.0};
+#if !defined(__x86_64__) && !defined(_M_X64)
+    (void)program;
+    fprintf(stderr, "[ERROR] --jit solo está disponible en anfitriones x86-64\n");
+    return result;
+#else
+    int main_index = find_main(program);
+    if (main_index < 0)
+    {
+        fprintf(stderr, "[ERROR] El programa no define main\n");
+        return result;
+    }
+
+    double start = jamz_now_ms();
+    JAMZMachineCode code;
+    generate_machine_code(program, &code, true);
+
+    // Las cadenas quedan a una distancia fija del código: sus lea [rip]
+    // se resuelven aquí mismo, sin tabla de reubicaciones
+    size_t data_start = (code.text.size + JIT_DATA_ALIGNMENT - 1) / JIT_DATA_ALIGNMENT * JIT_DATA_ALIGNMENT;
+    for (size_t i = 0; i < code.strings.count; i++)
+        x64_patch_rel32(&code.text, code.strings.items[i].at, data_start + code.string_offsets[code.strings.items[i].target]);
+
+    size_t counters = code.counters.count > 0 ? program->profile->count : 0;
+    size_t counters_start = (data_start + code.data.size + JIT_PAGE_SIZE - 1) / JIT_PAGE_SIZE * JIT_PAGE_SIZE;
+    for (size_t i = 0; i < code.counters.count; i++)
+        x64_patch_rel32(&code.text, code.counters.items[i].at, counters_start + 8 * (size_t)code.counters.items[i].target);
+
+    size_t executable = counters > 0 ? counters_start : data_start + code.data.size;
+    size_t size = executable + 8 * counters;
+    char *memory = map_writable(size);
+    if (!memory)
+    {
+        fprintf(stderr, "[ERROR] No se pudo reservar memoria para el código JIT\n");
+        free_machine_code(&code);
+        return result;
+    }
+    memcpy(memory, code.text.data, code.text.size);
+    if (code.data.size > 0)
+        memcpy(memory + data_start, code.data.data, code.data.size);
+    size_t entry = code.function_offsets[main_index];
+    free_machine_code(&code);
+
+    if (!make_executable(memory, executable))
+    {
+        fprintf(stderr, "[ERROR] No se pudo marcar como ejecutable el código JIT\n");
+        unmap(memory, size);
+        return result;
+    }
+    result.compile_ms = jamz_now_ms() - start;
+
+    // ISO C no define la conversión de objeto a función; se copia el puntero
+    JitMain jit_main;
+    void *address = memory + entry;
+    memcpy(&jit_main, &address, sizeof(jit_main));
+    char program_name[] = "jamz-jit";
+    char *argv[] = {program_name, NULL};
+
+    start = jamz_now_ms();
+    result.result = jit_main(1, argv);
+    result.run_ms = jamz_now_ms() - start;
+    result.ok = true;
+    if (counters > 0)
+        memcpy(program->profile->counts, memory + counters_start, 8 * counters);
+
+    unmap(memory, size);
+    return result;
+#endif
+}
@@ -29,7 +29,15 @@ static void add_token(JAMZTokenList *list, JAMZToken token)
 
 static bool is_operator_char(char c)
 {
-    return c == '+' || c == '-' || c == '*' || c == '/' || c == '=';
+    return c == '+' || c == '-' || c == '*' || c == '/' || c == '%' || c == '=' || c == '<' || c == '>';
+}
+
+// <=, >=, == y != son un solo operador; '!' no existe por sí solo
+static int operator_length(const char *current)
+{
+    if ((*current == '<' || *current == '>' || *current == '=' || *current == '!') && current[1] == '=')
+        return 2;
+    return is_operator_char(*current) ? 1 : 0;
 }
 
 static bool resolve_keyword(const char *lexeme, JAMZTokenType *out_type)
@@ -54,6 +62,36 @@ static bool resolve_keyword(const char *lexeme, JAMZTokenType *out_type)
         *out_type = JAMZ_TOKEN_MAIN;
         return true;
     }
+    if (strcmp(lexeme, "if") == 0)
+    {
+        *out_type = JAMZ_TOKEN_IF;
+        return true;
+    }
+    if (strcmp(lexeme, "else") == 0)
+    {
+        *out_type = JAMZ_TOKEN_ELSE;
+        return true;
+    }
+    if (strcmp(lexeme, "while") == 0)
+    {
+        *out_type = JAMZ_TOKEN_WHILE;
+        return true;
+    }
+    if (strcmp(lexeme, "for") == 0)
+    {
+        *out_type = JAMZ_TOKEN_FOR;
+        return true;
+    }
+    if (strcmp(lexeme, "break") == 0)
+    {
+        *out_type = JAMZ_TOKEN_BREAK;
+        return true;
+    }
+    if (strcmp(lexeme, "continue") == 0)
+    {
+        *out_type = JAMZ_TOKEN_CONTINUE;
+        return true;
+    }
     return false;
 }
 
@@ -64,6 +102,9 @@ JAMZTokenList *lexer_analyze(const char *source)
     list->count = 0;
     list->capacity = INITIAL_CAPACITY;
     list->has_error = false;
+    // Los errores se apilan con push_error a medida que aparecen
+    list->errors = NULL;
+    list->error_count = 0;
 
     int line = 1;
     int col = 1;
@@ -153,12 +194,13 @@ JAMZTokenList *lexer_analyze(const char *source)
             continue;
         }
 
-        if (is_operator_char(*current))
+        int op_length = operator_length(current);
+        if (op_length > 0)
         {
-            char op[2] = {*current, '\0'};
+            char op[3] = {current[0], op_length == 2 ? current[1] : '\0', '\0'};
             add_token(list, make_token(JAMZ_TOKEN_OPERATOR, op, line, col));
-            current++;
-            col++;
+            current += op_length;
+            col += op_length;
             continue;
         }
 
@@ -169,6 +211,11 @@ JAMZTokenList *lexer_analyze(const char *source)
             current++;
             col++;
             continue;
+        case ',':
+            add_token(list, make_token(JAMZ_TOKEN_COMMA, ",", line, col));
+            current++;
+            col++;
+            continue;
         case '(':
             add_token(list, make_token(JAMZ_TOKEN_LPAREN, "(", line, col));
             current++;
@@ -189,6 +236,16 @@ JAMZTokenList *lexer_analyze(const char *source)
             current++;
             col++;
             continue;
+        case '[':
+            add_token(list, make_token(JAMZ_TOKEN_LBRACKET, "[", line, col));
+            current++;
+            col++;
+            continue;
+        case ']':
+            add_token(list, make_token(JAMZ_TOKEN_RBRACKET, "]", line, col));
+            current++;
+            col++;
+            continue;
         case '"':
         {
             current++;
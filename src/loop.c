@@ -0,0 +1,504 @@
+#include "loop.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int compare_loop_size(const void *a, const void *b)
+{
+    const JAMZLoop *left = a;
+    const JAMZLoop *right = b;
+    return (left->size > right->size) - (left->size < right->size);
+}
+
+// Bucles de la función, de los más internos (menos bloques) a los externos
+JAMZLoop *find_loops(const JAMZSSAFunction *ssa, size_t *out_count)
+{
+    JAMZLoop *loops = NULL;
+    size_t count = 0;
+    size_t *work = safe_malloc((ssa->block_count ? ssa->block_count : 1) * sizeof(size_t));
+
+    for (size_t r = 0; r < ssa->graph.rpo_count; r++)
+    {
+        size_t h = ssa->graph.rpo[r];
+        bool *body = NULL;
+        size_t size = 0;
+        size_t work_count = 0;
+        for (size_t e = ssa->graph.pred_start[h]; e < ssa->graph.pred_start[h + 1]; e++)
+        {
+            size_t p = ssa->graph.preds[e];
+            if (!ssa_is_reachable(ssa, p) || !ssa_dominates(ssa, h, p))
+                continue;
+            if (!body)
+            {
+                body = calloc(ssa->block_count, sizeof(bool));
+                if (!body)
+                {
+                    fprintf(stderr, "[ERROR] Memory allocation failed for loop detection\n");
+                    exit(EXIT_FAILURE);
+                }
+                body[h] = true;
+                size = 1;
+            }
+            if (!body[p])
+            {
+                body[p] = true;
+                size++;
+                work[work_count++] = p;
+            }
+        }
+        if (!body)
+            continue;
+        while (work_count > 0)
+        {
+            size_t b = work[--work_count];
+            for (size_t e = ssa->graph.pred_start[b]; e < ssa->graph.pred_start[b + 1]; e++)
+            {
+                size_t q = ssa->graph.preds[e];
+                if (ssa_is_reachable(ssa, q) && !body[q])
+                {
+                    body[q] = true;
+                    size++;
+                    work[work_count++] = q;
+                }
+            }
+        }
+
+        size_t preheader = SIZE_MAX;
+        size_t outside = 0;
+        for (size_t e = ssa->graph.pred_start[h]; e < ssa->graph.pred_start[h + 1]; e++)
+        {
+            size_t p = ssa->graph.preds[e];
+            if (!body[p])
+            {
+                outside++;
+                preheader = p;
+            }
+        }
+        if (outside != 1 || ssa->blocks[preheader].succ_count != 1)
+            preheader = SIZE_MAX;
+
+        loops = safe_realloc(loops, (count + 1) * sizeof(JAMZLoop));
+        loops[count++] = (JAMZLoop){h, preheader, body, size};
+    }
+    free(work);
+
+    if (count > 1)
+        qsort(loops, count, sizeof(JAMZLoop), compare_loop_size);
+    *out_count = count;
+    return loops;
+}
+
+void free_loops(JAMZLoop *loops, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        free(loops[i].body);
+    free(loops);
+}
+
+// Da a cada bucle con una sola entrada de fuera un bloque propio ante la
+// cabecera (el preheader), donde poner lo que se saca del bucle. La entrada
+// de un bucle rotado es el BRANCH de guarda, así que casi siempre hace falta.
+static void insert_preheaders(JAMZSSAFunction *ssa)
+{
+    size_t loop_count;
+    JAMZLoop *loops = find_loops(ssa, &loop_count);
+
+    typedef struct
+    {
+        size_t header;
+        size_t preheader;
+        int32_t *args; // Argumentos de las fases de la cabecera desde la entrada
+    } Split;
+    Split *splits = safe_malloc((loop_count ? loop_count : 1) * sizeof(Split));
+    size_t split_count = 0;
+    size_t capacity = ssa->block_count;
+
+    for (size_t l = 0; l < loop_count; l++)
+    {
+        size_t h = loops[l].header;
+        if (loops[l].preheader != SIZE_MAX)
+            continue;
+        size_t entry = SIZE_MAX;
+        size_t outside = 0;
+        for (size_t e = ssa->graph.pred_start[h]; e < ssa->graph.pred_start[h + 1]; e++)
+        {
+            if (!loops[l].body[ssa->graph.preds[e]])
+            {
+                outside++;
+                entry = ssa->graph.preds[e];
+            }
+        }
+        if (outside != 1)
+            continue;
+
+        size_t k = ssa_pred_index(&ssa->graph, h, entry);
+        int32_t *args = safe_malloc((ssa->blocks[h].phi_count ? ssa->blocks[h].phi_count : 1) * sizeof(int32_t));
+        for (size_t i = 0; i < ssa->blocks[h].phi_count; i++)
+            args[i] = ssa->blocks[h].phis[i].args[k];
+
+        size_t pre = ssa_add_block(ssa, &capacity);
+        JAMZSSABlock *block = &ssa->blocks[pre];
+        block->succs[0] = h;
+        block->succ_count = 1;
+        block->line = ssa->blocks[h].line;
+        block->before = h;
+        JAMZSSABlock *from = &ssa->blocks[entry];
+        from->succs[ssa_succ_slot(from, h)] = pre;
+        splits[split_count++] = (Split){h, pre, args};
+    }
+    free_loops(loops, loop_count);
+
+    if (split_count > 0)
+        ssa_rebuild_graph(ssa);
+    for (size_t i = 0; i < split_count; i++)
+    {
+        JAMZSSABlock *header = &ssa->blocks[splits[i].header];
+        size_t k = ssa_pred_index(&ssa->graph, splits[i].header, splits[i].preheader);
+        for (size_t p = 0; p < header->phi_count; p++)
+            header->phis[p].args[k] = splits[i].args[p];
+        free(splits[i].args);
+    }
+    free(splits);
+}
+
+// Operaciones puras que no pueden fallar: se pueden ejecutar en el
+// preheader aunque el bucle no llegara a ellas. La división solo con un
+// divisor constante que no sea 0 ni -1.
+static bool is_hoistable(const JAMZSSAFunction *ssa, const JAMZSSADefSites *defs, const JAMZIRInstr *instr)
+{
+    int32_t divisor;
+    switch (instr->op)
+    {
+    case JAMZ_IR_ADD:
+    case JAMZ_IR_SUB:
+    case JAMZ_IR_MUL:
+    case JAMZ_IR_EQ:
+    case JAMZ_IR_NE:
+    case JAMZ_IR_LT:
+    case JAMZ_IR_LE:
+    case JAMZ_IR_GT:
+    case JAMZ_IR_GE:
+        return true;
+    case JAMZ_IR_DIV:
+    case JAMZ_IR_MOD:
+        return ssa_constant_value(ssa, defs, instr->b, &divisor) && divisor != 0 && divisor != -1;
+    case JAMZ_IR_UDIV:
+    case JAMZ_IR_UMOD:
+        return ssa_constant_value(ssa, defs, instr->b, &divisor) && divisor != 0;
+    default:
+        return false;
+    }
+}
+
+// Movimiento de código invariante: una operación pura cuyos operandos se
+// definen fuera del bucle (o ya se sacaron) pasa al preheader. Las
+// constantes del bucle no se mueven solas, porque ocuparían un registro en
+// toda la vuelta; la que lee una operación sacada se copia junto a ella.
+static void hoist_invariants(JAMZSSAFunction *ssa, const JAMZLoop *loop, JAMZSSADefSites *defs)
+{
+    size_t pre = loop->preheader;
+    int32_t *copies = safe_malloc((defs->count ? defs->count : 1) * sizeof(int32_t));
+    for (size_t v = 0; v < defs->count; v++)
+        copies[v] = JAMZ_IR_NONE;
+
+    for (size_t r = 0; r < ssa->graph.rpo_count; r++)
+    {
+        size_t b = ssa->graph.rpo[r];
+        if (!loop->body[b])
+            continue;
+        JAMZSSABlock *block = &ssa->blocks[b];
+        size_t kept = 0;
+        for (size_t i = 0; i < block->count; i++)
+        {
+            JAMZIRInstr instr = block->code[i];
+            bool invariant = is_hoistable(ssa, defs, &instr);
+            int32_t *regs[2];
+            int reads = ssa_instr_reads(&instr, regs);
+            for (int k = 0; k < reads && invariant; k++)
+            {
+                int32_t v = *regs[k];
+                size_t def = (size_t)v < defs->count ? defs->block[v] : SIZE_MAX;
+                const JAMZIRInstr *source = ssa_defining_instr(ssa, defs, v);
+                invariant = def == SIZE_MAX || !loop->body[def] || (source && source->op == JAMZ_IR_CONST);
+            }
+            if (!invariant)
+            {
+                // Se compacta sobre la marcha: lo que se queda cambia de posición
+                block->code[kept++] = instr;
+                if (instr.dst != JAMZ_IR_NONE)
+                    defs->slot[instr.dst] = block->phi_count + kept - 1;
+                continue;
+            }
+
+            for (int k = 0; k < reads; k++)
+            {
+                int32_t v = *regs[k];
+                size_t def = (size_t)v < defs->count ? defs->block[v] : SIZE_MAX;
+                if (def == SIZE_MAX || !loop->body[def])
+                    continue;
+                if (copies[v] == JAMZ_IR_NONE)
+                {
+                    const JAMZIRInstr *source = ssa_defining_instr(ssa, defs, v);
+                    JAMZIRInstr constant = {JAMZ_IR_CONST, ir_new_vreg(ssa->function, NULL), JAMZ_IR_NONE,
+                                            JAMZ_IR_NONE, source->imm, instr.line};
+                    ssa_block_append(&ssa->blocks[pre], &constant);
+                    copies[v] = constant.dst;
+                }
+                *regs[k] = copies[v];
+            }
+            ssa_block_append(&ssa->blocks[pre], &instr);
+            defs->block[instr.dst] = pre;
+            defs->slot[instr.dst] = ssa->blocks[pre].phi_count + ssa->blocks[pre].count - 1;
+            ssa->stats.hoisted++;
+        }
+        block->count = kept;
+    }
+    free(copies);
+}
+
+static void insert_instr(JAMZSSABlock *block, size_t at, const JAMZIRInstr *instr)
+{
+    ssa_block_append(block, instr);
+    memmove(block->code + at + 1, block->code + at, (block->count - 1 - at) * sizeof(JAMZIRInstr));
+    block->code[at] = *instr;
+}
+
+bool find_basic_induction(const JAMZSSAFunction *ssa, const JAMZLoop *loop, const JAMZSSADefSites *defs,
+                          const JAMZSSAPhi *phi, JAMZInduction *iv)
+{
+    size_t h = loop->header;
+    iv->phi = phi->dst;
+    iv->next = iv->init = JAMZ_IR_NONE;
+    for (size_t k = 0; k < ssa_pred_count(&ssa->graph, h); k++)
+    {
+        size_t p = ssa->graph.preds[ssa->graph.pred_start[h] + k];
+        int32_t arg = phi->args[k];
+        if (arg == JAMZ_IR_NONE)
+            return false;
+        if (p == loop->preheader)
+            iv->init = arg;
+        else if (iv->next == JAMZ_IR_NONE || iv->next == arg)
+            iv->next = arg;
+        else
+            return false;
+    }
+    const JAMZIRInstr *update = ssa_defining_instr(ssa, defs, iv->next);
+    if (iv->init == JAMZ_IR_NONE || !update || !loop->body[defs->block[iv->next]])
+        return false;
+
+    int32_t step;
+    if (update->op == JAMZ_IR_ADD && update->a == iv->phi && ssa_constant_value(ssa, defs, update->b, &step))
+        iv->step = step;
+    else if (update->op == JAMZ_IR_ADD && update->b == iv->phi && ssa_constant_value(ssa, defs, update->a, &step))
+        iv->step = step;
+    else if (update->op == JAMZ_IR_SUB && update->a == iv->phi && ssa_constant_value(ssa, defs, update->b, &step))
+        iv->step = (int32_t)(0u - (uint32_t)step);
+    else
+        return false;
+    iv->next_block = defs->block[iv->next];
+    iv->next_index = defs->slot[iv->next] - ssa->blocks[iv->next_block].phi_count;
+    return true;
+}
+
+typedef struct
+{
+    size_t block;
+    size_t index; // Instrucción tras la que va el incremento
+    int32_t phi;
+    int32_t next;
+    int32_t stride;
+    int line;
+} Increment;
+
+static int compare_increments(const void *a, const void *b)
+{
+    const Increment *left = a;
+    const Increment *right = b;
+    return (left->index < right->index) - (left->index > right->index);
+}
+
+// Sustituye cada lectura de v por replace[v] cuando este no es NONE
+static void replace_uses(JAMZSSAFunction *ssa, const int32_t *replace, size_t count)
+{
+    for (size_t b = 0; b < ssa->block_count; b++)
+    {
+        JAMZSSABlock *block = &ssa->blocks[b];
+        for (size_t i = 0; i < block->phi_count; i++)
+        {
+            for (size_t k = 0; k < ssa_pred_count(&ssa->graph, b); k++)
+            {
+                int32_t v = block->phis[i].args[k];
+                if (v != JAMZ_IR_NONE && (size_t)v < count && replace[v] != JAMZ_IR_NONE)
+                    block->phis[i].args[k] = replace[v];
+            }
+        }
+        for (size_t i = 0; i < block->count; i++)
+        {
+            int32_t *regs[2];
+            int reads = ssa_instr_reads(&block->code[i], regs);
+            for (int k = 0; k < reads; k++)
+            {
+                if (*regs[k] != JAMZ_IR_NONE && (size_t)*regs[k] < count && replace[*regs[k]] != JAMZ_IR_NONE)
+                    *regs[k] = replace[*regs[k]];
+            }
+        }
+        int32_t c = block->condition;
+        if (c != JAMZ_IR_NONE && (size_t)c < count && replace[c] != JAMZ_IR_NONE)
+            block->condition = replace[c];
+    }
+}
+
+// Reducción de fuerza: i * k, con i variable de inducción básica y k
+// constante, pasa a ser una variable de inducción propia: j = init * k al
+// entrar y j += step * k en cada vuelta (en 32 bits con vuelta, (i + s) * k
+// es i * k + s * k). Las potencias de dos no se tocan: su desplazamiento ya
+// cuesta lo mismo que la suma y la nueva variable ocuparía otro registro.
+static void reduce_inductions(JAMZSSAFunction *ssa, const JAMZLoop *loop, const JAMZSSADefSites *defs)
+{
+    size_t h = loop->header;
+    size_t pre = loop->preheader;
+    JAMZIRFunction *function = ssa->function;
+    size_t vregs = defs->count;
+    int32_t *replace = safe_malloc((vregs ? vregs : 1) * sizeof(int32_t));
+    for (size_t v = 0; v < vregs; v++)
+        replace[v] = JAMZ_IR_NONE;
+
+    size_t phi_count = ssa->blocks[h].phi_count;
+    JAMZInduction *ivs = safe_malloc((phi_count ? phi_count : 1) * sizeof(JAMZInduction));
+    size_t iv_count = 0;
+    for (size_t p = 0; p < phi_count; p++)
+    {
+        if (find_basic_induction(ssa, loop, defs, &ssa->blocks[h].phis[p], &ivs[iv_count]))
+            iv_count++;
+    }
+
+    // Una variable nueva por cada par (i, k), aunque el producto se repita
+    typedef struct
+    {
+        size_t iv;
+        int32_t factor;
+        int32_t phi;
+        int32_t next;
+    } Derived;
+    Derived *derived = NULL;
+    size_t derived_count = 0;
+
+    for (size_t r = 0; r < ssa->graph.rpo_count && iv_count > 0; r++)
+    {
+        size_t b = ssa->graph.rpo[r];
+        if (!loop->body[b])
+            continue;
+        for (size_t i = 0; i < ssa->blocks[b].count; i++)
+        {
+            const JAMZIRInstr *instr = &ssa->blocks[b].code[i];
+            int32_t factor;
+            int32_t base;
+            if (instr->op != JAMZ_IR_MUL)
+                continue;
+            if (ssa_constant_value(ssa, defs, instr->b, &factor))
+                base = instr->a;
+            else if (ssa_constant_value(ssa, defs, instr->a, &factor))
+                base = instr->b;
+            else
+                continue;
+            uint32_t magnitude = factor < 0 ? 0u - (uint32_t)factor : (uint32_t)factor;
+            if ((magnitude & (magnitude - 1)) == 0)
+                continue;
+            size_t v = 0;
+            while (v < iv_count && ivs[v].phi != base && ivs[v].next != base)
+                v++;
+            if (v == iv_count)
+                continue;
+
+            size_t d = 0;
+            while (d < derived_count && (derived[d].iv != v || derived[d].factor != factor))
+                d++;
+            if (d == derived_count)
+            {
+                derived = safe_realloc(derived, (derived_count + 1) * sizeof(Derived));
+                derived[d] = (Derived){v, factor, ir_new_vreg(function, NULL), ir_new_vreg(function, NULL)};
+                derived_count++;
+            }
+            replace[instr->dst] = base == ivs[v].phi ? derived[d].phi : derived[d].next;
+            ssa->stats.reduced++;
+        }
+    }
+
+    Increment *increments = safe_malloc((derived_count ? derived_count : 1) * sizeof(Increment));
+    for (size_t d = 0; d < derived_count; d++)
+    {
+        const JAMZInduction *iv = &ivs[derived[d].iv];
+        int32_t factor = derived[d].factor;
+        int line = ssa->blocks[h].line;
+
+        // Valor inicial en el preheader
+        int32_t start = ir_new_vreg(function, NULL);
+        int32_t init;
+        if (ssa_constant_value(ssa, defs, iv->init, &init))
+        {
+            JAMZIRInstr product = {JAMZ_IR_CONST, start, JAMZ_IR_NONE, JAMZ_IR_NONE,
+                                   (int32_t)((uint32_t)init * (uint32_t)factor), line};
+            ssa_block_append(&ssa->blocks[pre], &product);
+        }
+        else
+        {
+            JAMZIRInstr scale = {JAMZ_IR_CONST, ir_new_vreg(function, NULL), JAMZ_IR_NONE, JAMZ_IR_NONE, factor, line};
+            JAMZIRInstr product = {JAMZ_IR_MUL, start, iv->init, scale.dst, 0, line};
+            ssa_block_append(&ssa->blocks[pre], &scale);
+            ssa_block_append(&ssa->blocks[pre], &product);
+        }
+
+        JAMZSSABlock *header = &ssa->blocks[h];
+        size_t args = ssa_pred_count(&ssa->graph, h);
+        ssa_add_phi(header, derived[d].phi, args, line);
+        JAMZSSAPhi *phi = &header->phis[header->phi_count - 1];
+        phi->dst = derived[d].phi;
+        for (size_t k = 0; k < args; k++)
+            phi->args[k] = ssa->graph.preds[ssa->graph.pred_start[h] + k] == pre ? start : derived[d].next;
+
+        increments[d] = (Increment){iv->next_block, iv->next_index, derived[d].phi, derived[d].next,
+                                    (int32_t)((uint32_t)iv->step * (uint32_t)factor), line};
+    }
+
+    // De atrás hacia delante para que las posiciones pendientes sigan valiendo
+    qsort(increments, derived_count, sizeof(Increment), compare_increments);
+    for (size_t d = 0; d < derived_count; d++)
+    {
+        const Increment *inc = &increments[d];
+        JAMZSSABlock *block = &ssa->blocks[inc->block];
+        JAMZIRInstr stride = {JAMZ_IR_CONST, ir_new_vreg(function, NULL), JAMZ_IR_NONE, JAMZ_IR_NONE, inc->stride, inc->line};
+        JAMZIRInstr add = {JAMZ_IR_ADD, inc->next, inc->phi, stride.dst, 0, inc->line};
+        insert_instr(block, inc->index + 1, &add);
+        insert_instr(block, inc->index + 1, &stride);
+    }
+    if (derived_count > 0)
+        replace_uses(ssa, replace, vregs);
+
+    free(increments);
+    free(derived);
+    free(ivs);
+    free(replace);
+}
+
+// Bucles: preheaders, código invariante fuera y reducción de fuerza de las
+// variables de inducción, de los bucles internos a los externos (lo que sale
+// de uno interno puede seguir saliendo del que lo contiene)
+void optimize_loops(JAMZSSAFunction *ssa)
+{
+    insert_preheaders(ssa);
+    size_t loop_count;
+    JAMZLoop *loops = find_loops(ssa, &loop_count);
+    JAMZSSADefSites defs = {NULL, NULL, 0};
+    for (size_t l = 0; l < loop_count; l++)
+    {
+        if (loops[l].preheader == SIZE_MAX)
+            continue;
+        ssa_locate_definitions(ssa, &defs);
+        hoist_invariants(ssa, &loops[l], &defs);
+        ssa_locate_definitions(ssa, &defs);
+        reduce_inductions(ssa, &loops[l], &defs);
+    }
+    free(defs.block);
+    free(defs.slot);
+    free_loops(loops, loop_count);
+}
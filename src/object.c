@@ -0,0 +1,1016 @@
+#include "object.h"
+#include "profile.h"
+#include "regalloc.h"
+#include "select.h"
+#include "strength.h"
+#include "utils.h"
+#include "x64.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Registros de x86-64 para cada registro del asignador. Se evitan los de
+// argumentos (así preparar una llamada no pisa ningún valor) y rax/rdx, que
+// usan la división y el resultado. Los que pueden cruzar una llamada caen en
+// registros que System V también obliga a preservar.
+static const JAMZX64Register machine_registers[JAMZ_REG_COUNT] = {
+    [JAMZ_REG_ECX] = JAMZ_X64_R10,
+    [JAMZ_REG_EDX] = JAMZ_X64_R11,
+    [JAMZ_REG_EBX] = JAMZ_X64_RBX,
+    [JAMZ_REG_ESI] = JAMZ_X64_R12,
+    [JAMZ_REG_EDI] = JAMZ_X64_R13,
+};
+
+#define ARGUMENT_REGISTER_COUNT 6
+static const JAMZX64Register argument_registers[ARGUMENT_REGISTER_COUNT] = {
+    JAMZ_X64_RDI, JAMZ_X64_RSI, JAMZ_X64_RDX, JAMZ_X64_RCX, JAMZ_X64_R8, JAMZ_X64_R9,
+};
+
+// Cada ranura de pila ocupa 8 bytes: las direcciones de cadena no caben en 4
+#define SLOT_SIZE 8
+
+static void add_fixup(JAMZFixupList *list, size_t at, int32_t target)
+{
+    if (list->count == list->capacity)
+    {
+        list->capacity = list->capacity ? list->capacity * 2 : 16;
+        list->items = safe_realloc(list->items, list->capacity * sizeof(JAMZFixup));
+    }
+    list->items[list->count++] = (JAMZFixup){at, target};
+}
+
+typedef struct
+{
+    JAMZRegisterAllocation allocation;
+    int32_t slot_base;     // Desplazamiento de la primera ranura respecto a rbp
+    int32_t *array_offset; // Desplazamiento del elemento 0 de cada arreglo
+} Frame;
+
+static JAMZX64Operand vreg_operand(const Frame *frame, int32_t vreg)
+{
+    const JAMZRegisterAllocation *allocation = &frame->allocation;
+    if (allocation->reg[vreg] != JAMZ_IR_NONE)
+        return x64_register(machine_registers[allocation->reg[vreg]]);
+    return x64_frame(frame->slot_base - SLOT_SIZE * (allocation->slot[vreg] + 1));
+}
+
+// Igual que en el ensamblador textual: no hay mov de memoria a memoria, así
+// que ese caso pasa por rax. Las copias son de 64 bits para no truncar
+// direcciones.
+static void emit_define(JAMZOutputBuffer *out, const Frame *frame, int32_t vreg, JAMZX64Operand source)
+{
+    if (vreg == JAMZ_IR_NONE)
+        return;
+    JAMZX64Operand dst = vreg_operand(frame, vreg);
+    if (source.memory && dst.memory)
+    {
+        x64_mov(out, x64_register(JAMZ_X64_RAX), source, true);
+        source = x64_register(JAMZ_X64_RAX);
+    }
+    x64_mov(out, dst, source, true);
+}
+
+static JAMZX64Arith arith_operation(JAMZIROp op)
+{
+    switch (op)
+    {
+    case JAMZ_IR_ADD:
+        return JAMZ_X64_ADD;
+    case JAMZ_IR_SUB:
+        return JAMZ_X64_SUB;
+    default:
+        return JAMZ_X64_IMUL;
+    }
+}
+
+// Misma estrategia que emit_arithmetic del generador textual
+static void emit_arithmetic(JAMZOutputBuffer *out, const Frame *frame, const JAMZIRInstr *instr)
+{
+    JAMZX64Arith op = arith_operation(instr->op);
+    JAMZX64Operand a = vreg_operand(frame, instr->a);
+    JAMZX64Operand b = vreg_operand(frame, instr->b);
+    JAMZX64Operand dst = vreg_operand(frame, instr->dst);
+    bool dst_is_b = !dst.memory && !b.memory && dst.reg == b.reg;
+
+    if (!dst.memory)
+    {
+        if (dst_is_b && instr->op != JAMZ_IR_SUB)
+        {
+            x64_arith(out, op, dst.reg, a);
+            return;
+        }
+        if (!dst_is_b)
+        {
+            x64_mov(out, dst, a, false);
+            x64_arith(out, op, dst.reg, b);
+            return;
+        }
+    }
+
+    x64_mov(out, x64_register(JAMZ_X64_RAX), a, false);
+    x64_arith(out, op, JAMZ_X64_RAX, b);
+    emit_define(out, frame, instr->dst, x64_register(JAMZ_X64_RAX));
+}
+
+static JAMZX64Condition condition_code(JAMZIROp op)
+{
+    switch (op)
+    {
+    case JAMZ_IR_EQ:
+        return JAMZ_X64_CC_E;
+    case JAMZ_IR_NE:
+        return JAMZ_X64_CC_NE;
+    case JAMZ_IR_LT:
+        return JAMZ_X64_CC_L;
+    case JAMZ_IR_LE:
+        return JAMZ_X64_CC_LE;
+    case JAMZ_IR_GT:
+        return JAMZ_X64_CC_G;
+    default:
+        return JAMZ_X64_CC_GE;
+    }
+}
+
+// cmp a, b en 32 bits; si a se derramó pasa por rax
+static void emit_compare(JAMZOutputBuffer *out, const Frame *frame, const JAMZIRInstr *instr)
+{
+    JAMZX64Operand a = vreg_operand(frame, instr->a);
+    if (a.memory)
+    {
+        x64_mov(out, x64_register(JAMZ_X64_RAX), a, false);
+        a = x64_register(JAMZ_X64_RAX);
+    }
+    x64_arith(out, JAMZ_X64_CMP, a.reg, vreg_operand(frame, instr->b));
+}
+
+// Usos de cada registro virtual, para fusionar una comparación con el BRANCH
+// que la consume
+static uint32_t *count_uses(const JAMZIRFunction *function)
+{
+    uint32_t *uses = calloc(function->vreg_count > 0 ? (size_t)function->vreg_count : 1, sizeof(uint32_t));
+    for (size_t i = 0; i < function->count; i++)
+    {
+        const JAMZIRInstr *instr = &function->code[i];
+        switch (instr->op)
+        {
+        case JAMZ_IR_CONST:
+        case JAMZ_IR_STRING:
+        case JAMZ_IR_PARAM:
+        case JAMZ_IR_CALL:
+        case JAMZ_IR_LABEL:
+        case JAMZ_IR_JUMP:
+        case JAMZ_IR_COUNT:
+            break;
+        case JAMZ_IR_COPY:
+        case JAMZ_IR_ARG:
+        case JAMZ_IR_BRANCH:
+        case JAMZ_IR_RET:
+        case JAMZ_IR_LOAD:
+            if (instr->a != JAMZ_IR_NONE)
+                uses[instr->a]++;
+            break;
+        default:
+            uses[instr->a]++;
+            uses[instr->b]++;
+            break;
+        }
+    }
+    return uses;
+}
+
+// x*c sin imul, con la misma cadena que emit_mul_plan de compile.c: un shl
+// para las potencias de dos y lea/shl/add/sub para lo que descompone
+// jamz_mul_plan. El resto de constantes usa el imul con inmediato. Se
+// acumula en el destino salvo que esté en la pila, o que sea el propio x y
+// haga falta volver a sumarlo o restarlo al final.
+static void emit_constant_multiply(JAMZOutputBuffer *out, const Frame *frame, const JAMZIRInstr *instr,
+                                   int32_t source, int32_t value)
+{
+    JAMZX64Operand x = vreg_operand(frame, source);
+    JAMZX64Operand dst = vreg_operand(frame, instr->dst);
+    JAMZMulPlan plan;
+    if (jamz_is_power_of_two(value))
+    {
+        plan.steps[0] = (JAMZMulStep){JAMZ_MUL_SHIFT, jamz_log2((uint32_t)value)};
+        plan.count = 1;
+    }
+    else if (!jamz_mul_plan(value, &plan))
+        plan.count = 0;
+
+    bool uses_source = plan.count > 0 && (plan.steps[plan.count - 1].kind == JAMZ_MUL_ADD_SOURCE ||
+                                          plan.steps[plan.count - 1].kind == JAMZ_MUL_SUB_SOURCE);
+    JAMZX64Register target = JAMZ_X64_RAX;
+    if (!dst.memory && !(uses_source && !x.memory && x.reg == dst.reg))
+        target = dst.reg;
+
+    int first = 0;
+    if (plan.count == 0)
+        x64_multiply_imm(out, target, x, value);
+    else if (plan.steps[0].kind == JAMZ_MUL_LEA && !x.memory)
+    {
+        x64_lea_scaled(out, target, x.reg, x.reg, plan.steps[0].amount - 1);
+        first = 1;
+    }
+    else
+        x64_mov(out, x64_register(target), x, false);
+    for (int s = first; s < plan.count; s++)
+    {
+        const JAMZMulStep *step = &plan.steps[s];
+        switch (step->kind)
+        {
+        case JAMZ_MUL_SHIFT:
+            x64_shift(out, JAMZ_X64_SHL, target, step->amount);
+            break;
+        case JAMZ_MUL_LEA:
+            x64_lea_scaled(out, target, target, target, step->amount - 1);
+            break;
+        case JAMZ_MUL_ADD_SOURCE:
+            x64_arith(out, JAMZ_X64_ADD, target, x);
+            break;
+        case JAMZ_MUL_SUB_SOURCE:
+            x64_arith(out, JAMZ_X64_SUB, target, x);
+            break;
+        }
+    }
+    if (target == JAMZ_X64_RAX)
+        emit_define(out, frame, instr->dst, x64_register(JAMZ_X64_RAX));
+}
+
+// División y resto entre una constante distinta de 0 e INT_MIN sin idiv, con
+// las mismas secuencias que emit_constant_division de compile.c. n se lee
+// de su sitio tantas veces como haga falta: ni rax ni rdx son del
+// asignador. Devuelve el registro con el resultado.
+static JAMZX64Register emit_constant_division(JAMZOutputBuffer *out, const Frame *frame, const JAMZIRInstr *instr,
+                                              int32_t divisor)
+{
+    JAMZX64Operand dividend = vreg_operand(frame, instr->a);
+    bool remainder = instr->op == JAMZ_IR_MOD || instr->op == JAMZ_IR_UMOD;
+    bool is_signed = instr->op == JAMZ_IR_DIV || instr->op == JAMZ_IR_MOD;
+    int32_t magnitude = divisor < 0 ? -divisor : divisor;
+
+    if (magnitude == 1)
+    {
+        if (remainder)
+        {
+            x64_mov_imm(out, x64_register(JAMZ_X64_RAX), 0);
+            return JAMZ_X64_RAX;
+        }
+        x64_mov(out, x64_register(JAMZ_X64_RAX), dividend, false);
+        if (divisor < 0)
+            x64_negate(out, JAMZ_X64_RAX);
+        return JAMZ_X64_RAX;
+    }
+
+    if (jamz_is_power_of_two(magnitude))
+    {
+        // A un n negativo se le suma |d|-1 (en edx) para truncar hacia cero
+        int shift = jamz_log2((uint32_t)magnitude);
+        x64_mov(out, x64_register(JAMZ_X64_RAX), dividend, false);
+        if (is_signed)
+        {
+            if (shift == 1)
+            {
+                x64_mov(out, x64_register(JAMZ_X64_RDX), x64_register(JAMZ_X64_RAX), false);
+                x64_shift(out, JAMZ_X64_SHR, JAMZ_X64_RDX, 31);
+            }
+            else
+            {
+                x64_cdq(out);
+                x64_shift(out, JAMZ_X64_SHR, JAMZ_X64_RDX, 32 - shift);
+            }
+            x64_arith(out, JAMZ_X64_ADD, JAMZ_X64_RAX, x64_register(JAMZ_X64_RDX));
+        }
+        if (remainder)
+        {
+            x64_and_imm(out, JAMZ_X64_RAX, magnitude - 1);
+            if (is_signed)
+                x64_arith(out, JAMZ_X64_SUB, JAMZ_X64_RAX, x64_register(JAMZ_X64_RDX));
+            return JAMZ_X64_RAX;
+        }
+        x64_shift(out, is_signed ? JAMZ_X64_SAR : JAMZ_X64_SHR, JAMZ_X64_RAX, shift);
+        if (divisor < 0)
+            x64_negate(out, JAMZ_X64_RAX);
+        return JAMZ_X64_RAX;
+    }
+
+    // q = hi(n * M) [+/- n] >> s, más 1 si es negativo
+    JAMZDivMagic magic = jamz_div_magic(divisor);
+    x64_mov_imm(out, x64_register(JAMZ_X64_RAX), magic.multiplier);
+    x64_multiply_wide(out, dividend);
+    if (magic.add_dividend)
+        x64_arith(out, JAMZ_X64_ADD, JAMZ_X64_RDX, dividend);
+    if (magic.subtract_dividend)
+        x64_arith(out, JAMZ_X64_SUB, JAMZ_X64_RDX, dividend);
+    if (magic.shift > 0)
+        x64_shift(out, JAMZ_X64_SAR, JAMZ_X64_RDX, magic.shift);
+    JAMZX64Register quotient = JAMZ_X64_RDX;
+    if (is_signed)
+    {
+        x64_mov(out, x64_register(JAMZ_X64_RAX), x64_register(JAMZ_X64_RDX), false);
+        x64_shift(out, JAMZ_X64_SHR, JAMZ_X64_RAX, 31);
+        x64_arith(out, JAMZ_X64_ADD, JAMZ_X64_RAX, x64_register(JAMZ_X64_RDX));
+        quotient = JAMZ_X64_RAX;
+    }
+    if (!remainder)
+        return quotient;
+    // n - q*d
+    x64_multiply_imm(out, JAMZ_X64_RAX, x64_register(quotient), divisor);
+    x64_mov(out, x64_register(JAMZ_X64_RDX), dividend, false);
+    x64_arith(out, JAMZ_X64_SUB, JAMZ_X64_RDX, x64_register(JAMZ_X64_RAX));
+    return JAMZ_X64_RDX;
+}
+
+// Número de ARG desde position hasta su CALL; la IR nunca intercala los de
+// dos llamadas
+static size_t count_arguments(const JAMZIRFunction *function, size_t position)
+{
+    size_t count = 0;
+    while (position < function->count && function->code[position].op == JAMZ_IR_ARG)
+    {
+        count++;
+        position++;
+    }
+    return count;
+}
+
+// Elementos de 32 bits en [rbp + rax*4 + disp]: el índice se extiende con
+// signo a rax
+static JAMZX64Operand element_operand(JAMZOutputBuffer *out, const Frame *frame, int32_t array, int32_t index)
+{
+    x64_movsxd(out, JAMZ_X64_RAX, vreg_operand(frame, index));
+    return x64_indexed(frame->array_offset[array], 4);
+}
+
+// rdx tampoco lo usa el asignador: el valor derramado pasa por él
+static void emit_element(JAMZOutputBuffer *out, const Frame *frame, const JAMZIRInstr *instr)
+{
+    if (instr->op == JAMZ_IR_LOAD)
+    {
+        JAMZX64Operand dst = vreg_operand(frame, instr->dst);
+        JAMZX64Register reg = dst.memory ? JAMZ_X64_RAX : dst.reg;
+        x64_mov(out, x64_register(reg), element_operand(out, frame, instr->imm, instr->a), false);
+        emit_define(out, frame, instr->dst, x64_register(reg));
+        return;
+    }
+    JAMZX64Operand value = vreg_operand(frame, instr->b);
+    if (value.memory)
+    {
+        x64_mov(out, x64_register(JAMZ_X64_RDX), value, false);
+        value = x64_register(JAMZ_X64_RDX);
+    }
+    x64_mov(out, element_operand(out, frame, instr->imm, instr->a), value, false);
+}
+
+static JAMZX64Operand vector_register(int reg)
+{
+    return x64_register((JAMZX64Register)reg);
+}
+
+// Cuerpo del núcleo en el índice rax, como emit_kernel_body del generador
+// textual: un vector entero (full) o solo el carril 0 al pelar
+static void emit_kernel_body(JAMZOutputBuffer *out, const Frame *frame, const JAMZVectorKernel *kernel, bool avx2,
+                             int width, int32_t aligned_imm, bool full)
+{
+    const unsigned t1 = JAMZ_VECTOR_REGISTERS, t2 = JAMZ_VECTOR_REGISTERS + 1;
+    bool wide = avx2 && full;
+    for (size_t k = kernel->invariant_count; k < kernel->count; k++)
+    {
+        const JAMZVectorInstr *v = &kernel->code[k];
+        if (v->op == JAMZ_VEC_LOAD || v->op == JAMZ_VEC_STORE)
+        {
+            JAMZX64Operand element = x64_indexed(4 * v->imm + frame->array_offset[v->array], 4);
+            bool load = v->op == JAMZ_VEC_LOAD;
+            JAMZX64VectorOp op = load ? JAMZ_X64_MOVD_TO : JAMZ_X64_MOVD_FROM;
+            if (full && (v->imm - aligned_imm) % width == 0)
+                op = load ? JAMZ_X64_MOVDQA_LOAD : JAMZ_X64_MOVDQA_STORE;
+            else if (full)
+                op = load ? JAMZ_X64_MOVDQU_LOAD : JAMZ_X64_MOVDQU_STORE;
+            unsigned reg = (unsigned)(load ? v->reg : kernel->code[v->a].reg);
+            if (avx2)
+                x64_vex(out, op, wide, reg, 0, element);
+            else
+                x64_sse(out, op, reg, element, 0);
+            continue;
+        }
+
+        unsigned d = (unsigned)v->reg;
+        unsigned ra = (unsigned)kernel->code[v->a].reg;
+        unsigned rb = (unsigned)kernel->code[v->b].reg;
+        if (avx2)
+        {
+            JAMZX64VectorOp op = v->op == JAMZ_VEC_ADD ? JAMZ_X64_PADDD : v->op == JAMZ_VEC_SUB ? JAMZ_X64_PSUBD : JAMZ_X64_PMULLD;
+            x64_vex(out, op, wide, d, ra, vector_register((int)rb));
+            continue;
+        }
+        JAMZX64VectorOp op = v->op == JAMZ_VEC_ADD ? JAMZ_X64_PADDD : JAMZ_X64_PSUBD;
+        if (d == rb && d != ra)
+        {
+            if (v->op == JAMZ_VEC_SUB)
+            {
+                x64_sse(out, JAMZ_X64_MOVDQA_LOAD, t2, vector_register((int)ra), 0);
+                x64_sse(out, op, t2, vector_register((int)d), 0);
+                x64_sse(out, JAMZ_X64_MOVDQA_LOAD, d, vector_register((int)t2), 0);
+                continue;
+            }
+            rb = ra;
+            ra = d;
+        }
+        if (d != ra)
+            x64_sse(out, JAMZ_X64_MOVDQA_LOAD, d, vector_register((int)ra), 0);
+        if (v->op != JAMZ_VEC_MUL)
+        {
+            x64_sse(out, op, d, vector_register((int)rb), 0);
+            continue;
+        }
+        // Productos de los carriles pares e impares con pmuludq
+        x64_sse(out, JAMZ_X64_PSHUFD, t1, vector_register((int)d), 0xF5);
+        x64_sse(out, JAMZ_X64_PSHUFD, t2, vector_register((int)rb), 0xF5);
+        x64_sse(out, JAMZ_X64_PMULUDQ, d, vector_register((int)rb), 0);
+        x64_sse(out, JAMZ_X64_PMULUDQ, t1, vector_register((int)t2), 0);
+        x64_sse(out, JAMZ_X64_PSHUFD, d, vector_register((int)d), 0xE8);
+        x64_sse(out, JAMZ_X64_PSHUFD, t1, vector_register((int)t1), 0xE8);
+        x64_sse(out, JAMZ_X64_PUNPCKLDQ, d, vector_register((int)t1), 0);
+    }
+}
+
+// edx = rax + width; cmp edx, limit
+static void compare_next_vector(JAMZOutputBuffer *out, JAMZX64Operand limit, int width)
+{
+    x64_mov(out, x64_register(JAMZ_X64_RDX), x64_register(JAMZ_X64_RAX), false);
+    x64_add_imm(out, JAMZ_X64_RDX, width, false);
+    x64_arith(out, JAMZ_X64_CMP, JAMZ_X64_RDX, limit);
+}
+
+// VLOOP con el mismo esquema que el generador textual: rax recorre los
+// índices, se pela hasta alinear el arreglo de referencia y se avanza de
+// vector en vector sin llegar a la última vuelta
+static void emit_vector_loop(JAMZOutputBuffer *out, const Frame *frame, const JAMZIRFunction *function,
+                             const JAMZIRInstr *instr, bool avx2)
+{
+    const JAMZVectorKernel *kernel = &function->kernels[instr->imm];
+    int width = avx2 ? 8 : 4;
+    JAMZX64Operand limit = vreg_operand(frame, instr->b);
+    x64_movsxd(out, JAMZ_X64_RAX, vreg_operand(frame, instr->a));
+    for (size_t k = 0; k < kernel->invariant_count; k++)
+    {
+        const JAMZVectorInstr *v = &kernel->code[k];
+        JAMZX64Operand source = x64_register(JAMZ_X64_RDX);
+        if (v->op == JAMZ_VEC_CONST)
+            x64_mov_imm(out, source, v->imm);
+        else
+            source = x64_frame(frame->array_offset[v->array]);
+        unsigned reg = (unsigned)v->reg;
+        if (avx2)
+        {
+            x64_vex(out, JAMZ_X64_MOVD_TO, false, reg, 0, source);
+            x64_vex(out, JAMZ_X64_PBROADCASTD, true, reg, 0, vector_register((int)reg));
+        }
+        else
+        {
+            x64_sse(out, JAMZ_X64_MOVD_TO, reg, source, 0);
+            x64_sse(out, JAMZ_X64_PSHUFD, reg, vector_register((int)reg), 0);
+        }
+    }
+
+    int32_t aligned_imm = 0;
+    for (size_t k = kernel->count; k-- > kernel->invariant_count;)
+    {
+        if (kernel->code[k].op == JAMZ_VEC_STORE && kernel->code[k].array == kernel->reference)
+            aligned_imm = kernel->code[k].imm;
+    }
+
+    size_t peel = out->size;
+    compare_next_vector(out, limit, width);
+    size_t to_done = x64_jcc(out, JAMZ_X64_CC_GE);
+    x64_lea(out, JAMZ_X64_RDX, x64_indexed(4 * aligned_imm + frame->array_offset[kernel->reference], 4));
+    x64_test_imm(out, JAMZ_X64_RDX, 4 * width - 1);
+    size_t to_loop = x64_jz(out);
+    emit_kernel_body(out, frame, kernel, avx2, width, aligned_imm, false);
+    x64_add_imm(out, JAMZ_X64_RAX, 1, true);
+    x64_patch_rel32(out, x64_jmp(out), peel);
+
+    size_t loop = out->size;
+    x64_patch_rel32(out, to_loop, loop);
+    emit_kernel_body(out, frame, kernel, avx2, width, aligned_imm, true);
+    x64_add_imm(out, JAMZ_X64_RAX, width, true);
+    compare_next_vector(out, limit, width);
+    x64_patch_rel32(out, x64_jcc(out, JAMZ_X64_CC_L), loop);
+
+    x64_patch_rel32(out, to_done, out->size);
+    if (avx2)
+        x64_vzeroupper(out);
+    emit_define(out, frame, instr->dst, x64_register(JAMZ_X64_RAX));
+}
+
+static void emit_function(JAMZMachineCode *code, size_t index)
+{
+    const JAMZIRFunction *function = &code->program->functions[index];
+    JAMZOutputBuffer *out = &code->text;
+    Frame frame = {allocate_registers(function, NULL, NULL, profile_weights(code->program)), 0, NULL};
+    const JAMZIRProfile *profile = code->program->profile;
+    bool counting = code->host && profile && profile->instrumented;
+    uint32_t *uses = count_uses(function);
+    JAMZSelection selection = select_instructions(function);
+
+    size_t labels = function->label_count > 0 ? (size_t)function->label_count : 1;
+    size_t *label_offsets = safe_malloc(labels * sizeof(size_t));
+    JAMZFixupList jumps = {0};
+    JAMZFixupList exits = {0};
+
+    code->function_offsets[index] = out->size;
+
+    // Prólogo: rbp, registros preservados y ranuras, con rsp alineado a 16
+    x64_push(out, x64_register(JAMZ_X64_RBP));
+    x64_mov(out, x64_register(JAMZ_X64_RBP), x64_register(JAMZ_X64_RSP), true);
+    int32_t saved = 0;
+    for (int reg = JAMZ_REG_EBX; reg < JAMZ_REG_COUNT; reg++)
+    {
+        if (frame.allocation.used[reg])
+        {
+            x64_push(out, x64_register(machine_registers[reg]));
+            saved++;
+        }
+    }
+    frame.slot_base = -SLOT_SIZE * saved;
+    int32_t reserve = SLOT_SIZE * frame.allocation.slot_count;
+
+    // Los arreglos, bajo las ranuras, empiezan cada uno en un múltiplo de 32
+    // bytes de su región (ver layout_arrays en compile.c) y valen 0 al entrar
+    frame.array_offset = safe_malloc((function->array_count ? function->array_count : 1) * sizeof(int32_t));
+    int32_t region = 0;
+    for (size_t k = 0; k < function->array_count; k++)
+    {
+        frame.array_offset[k] = region;
+        region += (4 * function->array_lengths[k] + 31) / 32 * 32;
+    }
+    int32_t region_base = frame.slot_base - reserve - region;
+    for (size_t k = 0; k < function->array_count; k++)
+        frame.array_offset[k] += region_base;
+    reserve += region;
+    if ((SLOT_SIZE * saved + reserve) % 16 != 0)
+        reserve += 8;
+    x64_adjust_stack(out, -reserve);
+    if (region > 0)
+    {
+        // mov eax, n; .zero: mov qword [rbp + rax*8 + base - 8], 0; sub eax, 1; jnz .zero
+        x64_mov_imm(out, x64_register(JAMZ_X64_RAX), region / 8);
+        size_t zero = out->size;
+        x64_mov_imm(out, x64_indexed(region_base - 8, 8), 0);
+        x64_add_imm(out, JAMZ_X64_RAX, -1, false);
+        x64_patch_rel32(out, x64_jcc(out, JAMZ_X64_CC_NE), zero);
+    }
+
+    size_t pending_args = 0;
+    int32_t stack_cleanup = 0;
+    for (size_t i = 0; i < function->count; i++)
+    {
+        const JAMZIRInstr *instr = &function->code[i];
+        switch (instr->op)
+        {
+        case JAMZ_IR_CONST:
+            if (instr->dst != JAMZ_IR_NONE)
+                x64_mov_imm(out, vreg_operand(&frame, instr->dst), instr->imm);
+            break;
+        case JAMZ_IR_STRING:
+        {
+            JAMZX64Operand dst = vreg_operand(&frame, instr->dst);
+            JAMZX64Register reg = dst.memory ? JAMZ_X64_RAX : dst.reg;
+            add_fixup(&code->strings, x64_lea_rip(out, reg), instr->imm);
+            emit_define(out, &frame, instr->dst, x64_register(reg));
+            break;
+        }
+        case JAMZ_IR_PARAM:
+            // Los PARAM van al principio de la función, antes de cualquier
+            // llamada o división que pudiera pisar los registros de argumentos
+            if (instr->imm < ARGUMENT_REGISTER_COUNT)
+                emit_define(out, &frame, instr->dst, x64_register(argument_registers[instr->imm]));
+            else
+                emit_define(out, &frame, instr->dst, x64_frame(16 + SLOT_SIZE * (instr->imm - ARGUMENT_REGISTER_COUNT)));
+            break;
+        case JAMZ_IR_COPY:
+            emit_define(out, &frame, instr->dst, vreg_operand(&frame, instr->a));
+            break;
+        case JAMZ_IR_MUL:
+        {
+            // Un factor constante (la CONST de una sola definición que
+            // encuentra la selección) se reduce como en el ensamblador textual
+            int32_t constant = jamz_select_constant(&selection, i, 1);
+            int32_t source = instr->a;
+            if (constant < 0)
+            {
+                constant = jamz_select_constant(&selection, i, 0);
+                source = instr->b;
+            }
+            if (constant >= 0)
+            {
+                emit_constant_multiply(out, &frame, instr, source, function->code[constant].imm);
+                break;
+            }
+            emit_arithmetic(out, &frame, instr);
+            break;
+        }
+        case JAMZ_IR_ADD:
+        case JAMZ_IR_SUB:
+            emit_arithmetic(out, &frame, instr);
+            break;
+        case JAMZ_IR_EQ:
+        case JAMZ_IR_NE:
+        case JAMZ_IR_LT:
+        case JAMZ_IR_LE:
+        case JAMZ_IR_GT:
+        case JAMZ_IR_GE:
+        {
+            const JAMZIRInstr *next = i + 1 < function->count ? &function->code[i + 1] : NULL;
+            emit_compare(out, &frame, instr);
+            // Si solo la lee el BRANCH siguiente, el salto usa los flags
+            if (next && next->op == JAMZ_IR_BRANCH && next->a == instr->dst && uses[instr->dst] == 1)
+            {
+                add_fixup(&jumps, x64_jcc(out, condition_code(jamz_ir_negate_comparison(instr->op))), next->imm);
+                i++;
+                break;
+            }
+            x64_set_condition(out, condition_code(instr->op));
+            emit_define(out, &frame, instr->dst, x64_register(JAMZ_X64_RAX));
+            break;
+        }
+        case JAMZ_IR_DIV:
+        case JAMZ_IR_UDIV:
+        case JAMZ_IR_MOD:
+        case JAMZ_IR_UMOD:
+        {
+            // Un divisor constante se reduce igual que en el ensamblador
+            // textual
+            int32_t constant = jamz_select_constant(&selection, i, 1);
+            int32_t divisor = constant >= 0 ? function->code[constant].imm : 0;
+            if (divisor != 0 && divisor != INT32_MIN)
+            {
+                emit_define(out, &frame, instr->dst, x64_register(emit_constant_division(out, &frame, instr, divisor)));
+                break;
+            }
+            // El asignador nunca usa rax ni rdx, así que el divisor sirve tal
+            // cual; el cociente queda en rax y el resto en rdx
+            bool is_signed = instr->op == JAMZ_IR_DIV || instr->op == JAMZ_IR_MOD;
+            x64_mov(out, x64_register(JAMZ_X64_RAX), vreg_operand(&frame, instr->a), false);
+            if (is_signed)
+                x64_cdq(out);
+            else
+                x64_arith(out, JAMZ_X64_XOR, JAMZ_X64_RDX, x64_register(JAMZ_X64_RDX));
+            x64_divide(out, vreg_operand(&frame, instr->b), is_signed);
+            bool remainder = instr->op == JAMZ_IR_MOD || instr->op == JAMZ_IR_UMOD;
+            emit_define(out, &frame, instr->dst, x64_register(remainder ? JAMZ_X64_RDX : JAMZ_X64_RAX));
+            break;
+        }
+        case JAMZ_IR_ARG:
+            // Los ARG se apilan en su sitio (el registro del valor puede
+            // reutilizarse antes del CALL) y el CALL saca los seis primeros a
+            // sus registros. Si quedan en la pila un número impar, un hueco
+            // previo mantiene rsp alineado a 16 en la llamada.
+            if (pending_args == 0)
+            {
+                size_t count = count_arguments(function, i);
+                size_t on_stack = count > ARGUMENT_REGISTER_COUNT ? count - ARGUMENT_REGISTER_COUNT : 0;
+                stack_cleanup = SLOT_SIZE * (int32_t)(on_stack + on_stack % 2);
+                if (on_stack % 2)
+                    x64_adjust_stack(out, -SLOT_SIZE);
+            }
+            x64_push(out, vreg_operand(&frame, instr->a));
+            pending_args++;
+            break;
+        case JAMZ_IR_CALL:
+            for (size_t k = 0; k < pending_args && k < ARGUMENT_REGISTER_COUNT; k++)
+                x64_pop(out, argument_registers[k]);
+            if (instr->imm == JAMZ_IR_NONE)
+                fprintf(stderr, "[ERROR] Llamada a una función desconocida en la línea %d\n", instr->line);
+            else
+                add_fixup(&code->calls, x64_call(out), instr->imm);
+            x64_adjust_stack(out, stack_cleanup);
+            pending_args = 0;
+            stack_cleanup = 0;
+            emit_define(out, &frame, instr->dst, x64_register(JAMZ_X64_RAX));
+            break;
+        case JAMZ_IR_LOAD:
+        case JAMZ_IR_STORE:
+            emit_element(out, &frame, instr);
+            break;
+        case JAMZ_IR_VLOOP:
+            emit_vector_loop(out, &frame, function, instr, code->avx2);
+            break;
+        case JAMZ_IR_LABEL:
+            label_offsets[instr->imm] = out->size;
+            break;
+        case JAMZ_IR_JUMP:
+            add_fixup(&jumps, x64_jmp(out), instr->imm);
+            break;
+        case JAMZ_IR_COUNT:
+            // No toca registros y deja los flags a la entrada de un bloque,
+            // donde nadie los espera
+            if (counting)
+                add_fixup(&code->counters, x64_inc_rip(out), instr->imm);
+            break;
+        case JAMZ_IR_BRANCH:
+        {
+            JAMZX64Operand condition = vreg_operand(&frame, instr->a);
+            if (condition.memory)
+            {
+                x64_mov(out, x64_register(JAMZ_X64_RAX), condition, false);
+                condition = x64_register(JAMZ_X64_RAX);
+            }
+            x64_arith(out, JAMZ_X64_TEST, condition.reg, condition);
+            add_fixup(&jumps, x64_jz(out), instr->imm);
+            break;
+        }
+        case JAMZ_IR_RET:
+            if (instr->a != JAMZ_IR_NONE)
+                x64_mov(out, x64_register(JAMZ_X64_RAX), vreg_operand(&frame, instr->a), true);
+            // El último RET cae directamente en el epílogo
+            if (i + 1 < function->count)
+                add_fixup(&exits, x64_jmp(out), 0);
+            break;
+        }
+    }
+
+    // Epílogo: se recuperan los preservados desde el marco y leave deja rsp
+    // y rbp como estaban
+    size_t exit_offset = out->size;
+    saved = 0;
+    for (int reg = JAMZ_REG_EBX; reg < JAMZ_REG_COUNT; reg++)
+    {
+        if (frame.allocation.used[reg])
+        {
+            saved++;
+            x64_mov(out, x64_register(machine_registers[reg]), x64_frame(-SLOT_SIZE * saved), true);
+        }
+    }
+    x64_leave(out);
+    x64_ret(out);
+
+    for (size_t i = 0; i < jumps.count; i++)
+        x64_patch_rel32(out, jumps.items[i].at, label_offsets[jumps.items[i].target]);
+    for (size_t i = 0; i < exits.count; i++)
+        x64_patch_rel32(out, exits.items[i].at, exit_offset);
+    code->function_sizes[index] = out->size - code->function_offsets[index];
+
+    free(jumps.items);
+    free(exits.items);
+    free(label_offsets);
+    free(uses);
+    free_selection(&selection);
+    free(frame.array_offset);
+    free_register_allocation(&frame.allocation);
+}
+
+// Los literales conservan las secuencias de escape del fuente
+static void append_string_literal(JAMZOutputBuffer *data, const char *literal)
+{
+    for (const char *c = literal; *c; c++)
+    {
+        if (*c != '\\' || c[1] == '\0')
+        {
+            output_char(data, *c);
+            continue;
+        }
+        c++;
+        switch (*c)
+        {
+        case 'n':
+            output_char(data, '\n');
+            break;
+        case 't':
+            output_char(data, '\t');
+            break;
+        case 'r':
+            output_char(data, '\r');
+            break;
+        case '0':
+            output_char(data, '\0');
+            break;
+        default: // \\, \", \' y cualquier otro se copian sin la barra
+            output_char(data, *c);
+            break;
+        }
+    }
+    output_char(data, '\0');
+}
+
+// Escritura en little endian, independiente del anfitrión
+static void write_u16(JAMZOutputBuffer *out, uint16_t value)
+{
+    output_char(out, (char)(value & 0xFF));
+    output_char(out, (char)(value >> 8));
+}
+
+static void write_u32(JAMZOutputBuffer *out, uint32_t value)
+{
+    write_u16(out, (uint16_t)(value & 0xFFFF));
+    write_u16(out, (uint16_t)(value >> 16));
+}
+
+static void write_u64(JAMZOutputBuffer *out, uint64_t value)
+{
+    write_u32(out, (uint32_t)(value & 0xFFFFFFFFu));
+    write_u32(out, (uint32_t)(value >> 32));
+}
+
+static void align_to(JAMZOutputBuffer *out, size_t alignment)
+{
+    while (out->size % alignment != 0)
+        output_char(out, '\0');
+}
+
+static uint32_t add_name(JAMZOutputBuffer *table, const char *name)
+{
+    uint32_t offset = (uint32_t)table->size;
+    output_append(table, name, strlen(name) + 1);
+    return offset;
+}
+
+enum
+{
+    SECTION_NULL,
+    SECTION_TEXT,
+    SECTION_DATA,
+    SECTION_RELA_TEXT,
+    SECTION_SYMTAB,
+    SECTION_STRTAB,
+    SECTION_SHSTRTAB,
+    SECTION_NOTE_STACK, // Marca la pila como no ejecutable
+    SECTION_COUNT,
+};
+
+#define ELF_HEADER_SIZE 64
+#define ELF_SECTION_HEADER_SIZE 64
+#define ELF_SYMBOL_SIZE 24
+#define ELF_RELA_SIZE 24
+#define ELF_R_X86_64_PC32 2
+#define ELF_FIRST_GLOBAL_SYMBOL 3 // nulo, sección .text y sección .data
+
+typedef struct
+{
+    uint32_t name;
+    uint32_t type;
+    uint64_t flags;
+    uint64_t offset;
+    uint64_t size;
+    uint32_t link;
+    uint32_t info;
+    uint64_t alignment;
+    uint64_t entry_size;
+} SectionHeader;
+
+static void write_symbol(JAMZOutputBuffer *out, uint32_t name, uint8_t info, uint16_t section, uint64_t value, uint64_t size)
+{
+    write_u32(out, name);
+    output_char(out, (char)info);
+    output_char(out, 0); // st_other: visibilidad por defecto
+    write_u16(out, section);
+    write_u64(out, value);
+    write_u64(out, size);
+}
+
+static void write_object(const JAMZMachineCode *code, JAMZOutputBuffer *output)
+{
+    const JAMZIRProgram *program = code->program;
+    const JAMZOutputBuffer *data = &code->data;
+    JAMZOutputBuffer symbols, names, relocations, section_names;
+    output_init(&symbols);
+    output_init(&names);
+    output_init(&relocations);
+    output_init(&section_names);
+    SectionHeader sections[SECTION_COUNT] = {{0}};
+
+    // Símbolos locales de sección y luego las funciones, todas globales
+    output_char(&names, '\0');
+    write_symbol(&symbols, 0, 0, 0, 0, 0);
+    write_symbol(&symbols, 0, 3, SECTION_TEXT, 0, 0); // STB_LOCAL, STT_SECTION
+    write_symbol(&symbols, 0, 3, SECTION_DATA, 0, 0);
+    for (size_t i = 0; i < program->function_count; i++)
+        write_symbol(&symbols, add_name(&names, program->functions[i].name), 0x12, SECTION_TEXT, // STB_GLOBAL, STT_FUNC
+                     code->function_offsets[i], code->function_sizes[i]);
+
+    // Las direcciones de cadena se resuelven contra el símbolo de .data
+    for (size_t i = 0; i < code->strings.count; i++)
+    {
+        const JAMZFixup *fixup = &code->strings.items[i];
+        write_u64(&relocations, fixup->at);
+        write_u64(&relocations, (uint64_t)2 << 32 | ELF_R_X86_64_PC32);
+        write_u64(&relocations, (uint64_t)((int64_t)code->string_offsets[fixup->target] - 4));
+    }
+
+    output_char(&section_names, '\0');
+    sections[SECTION_TEXT] = (SectionHeader){add_name(&section_names, ".text"), 1, 0x6, 0, code->text.size, 0, 0, 16, 0};
+    sections[SECTION_DATA] = (SectionHeader){add_name(&section_names, ".data"), 1, 0x3, 0, data->size, 0, 0, 1, 0};
+    sections[SECTION_RELA_TEXT] = (SectionHeader){add_name(&section_names, ".rela.text"), 4, 0x40, 0, relocations.size,
+                                                  SECTION_SYMTAB, SECTION_TEXT, 8, ELF_RELA_SIZE};
+    sections[SECTION_SYMTAB] = (SectionHeader){add_name(&section_names, ".symtab"), 2, 0, 0, symbols.size,
+                                               SECTION_STRTAB, ELF_FIRST_GLOBAL_SYMBOL, 8, ELF_SYMBOL_SIZE};
+    sections[SECTION_STRTAB] = (SectionHeader){add_name(&section_names, ".strtab"), 3, 0, 0, names.size, 0, 0, 1, 0};
+    sections[SECTION_NOTE_STACK] = (SectionHeader){add_name(&section_names, ".note.GNU-stack"), 1, 0, 0, 0, 0, 0, 1, 0};
+    sections[SECTION_SHSTRTAB] = (SectionHeader){add_name(&section_names, ".shstrtab"), 3, 0, 0, section_names.size, 0, 0, 1, 0};
+
+    // Cabecera, contenido de cada sección y al final la tabla de secciones
+    const JAMZOutputBuffer *contents[SECTION_COUNT] = {
+        [SECTION_TEXT] = &code->text, [SECTION_DATA] = data, [SECTION_RELA_TEXT] = &relocations,
+        [SECTION_SYMTAB] = &symbols,    [SECTION_STRTAB] = &names, [SECTION_SHSTRTAB] = &section_names,
+    };
+    size_t start = output->size;
+    output_append(output, "\x7f" "ELF", 4);
+    output_char(output, 2); // ELFCLASS64
+    output_char(output, 1); // Little endian
+    output_char(output, 1); // EV_CURRENT
+    for (int i = 7; i < 16; i++)
+        output_char(output, 0);
+    write_u16(output, 1);  // ET_REL
+    write_u16(output, 62); // EM_X86_64
+    write_u32(output, 1);
+    write_u64(output, 0); // Sin punto de entrada
+    write_u64(output, 0); // Sin cabeceras de programa
+    size_t section_table_field = output->size;
+    write_u64(output, 0);
+    write_u32(output, 0);
+    write_u16(output, ELF_HEADER_SIZE);
+    write_u16(output, 0);
+    write_u16(output, 0);
+    write_u16(output, ELF_SECTION_HEADER_SIZE);
+    write_u16(output, SECTION_COUNT);
+    write_u16(output, SECTION_SHSTRTAB);
+
+    for (int i = 1; i < SECTION_COUNT; i++)
+    {
+        if (!contents[i])
+            continue;
+        align_to(output, sections[i].alignment);
+        sections[i].offset = output->size - start;
+        output_append(output, contents[i]->data, contents[i]->size);
+    }
+    sections[SECTION_NOTE_STACK].offset = output->size - start;
+
+    align_to(output, 8);
+    uint64_t section_table = output->size - start;
+    for (int i = 0; i < 8; i++)
+        output->data[section_table_field + i] = (char)(uint8_t)(section_table >> (8 * i));
+    for (int i = 0; i < SECTION_COUNT; i++)
+    {
+        const SectionHeader *section = &sections[i];
+        write_u32(output, section->name);
+        write_u32(output, section->type);
+        write_u64(output, section->flags);
+        write_u64(output, 0); // sh_addr: sin dirección en un objeto reubicable
+        write_u64(output, section->offset);
+        write_u64(output, section->size);
+        write_u32(output, section->link);
+        write_u32(output, section->info);
+        write_u64(output, section->alignment);
+        write_u64(output, section->entry_size);
+    }
+
+    output_free(&symbols);
+    output_free(&names);
+    output_free(&relocations);
+    output_free(&section_names);
+}
+
+void generate_machine_code(const JAMZIRProgram *program, JAMZMachineCode *code, bool host)
+{
+    size_t functions = program->function_count ? program->function_count : 1;
+    *code = (JAMZMachineCode){program, {0}, {0}, NULL, NULL, NULL, {0}, {0}, {0},
+                              jamz_vector_isa(host) == JAMZ_VECTOR_AVX2, host};
+    output_init(&code->text);
+    output_init(&code->data);
+    code->function_offsets = safe_malloc(functions * sizeof(size_t));
+    code->function_sizes = safe_malloc(functions * sizeof(size_t));
+    code->string_offsets = safe_malloc((program->string_count ? program->string_count : 1) * sizeof(size_t));
+
+    for (size_t i = 0; i < program->string_count; i++)
+    {
+        code->string_offsets[i] = code->data.size;
+        append_string_literal(&code->data, program->strings[i]);
+    }
+
+    for (size_t i = 0; i < program->function_count; i++)
+        emit_function(code, i);
+    // Las llamadas son todas dentro de .text: se resuelven sin reubicación
+    for (size_t i = 0; i < code->calls.count; i++)
+        x64_patch_rel32(&code->text, code->calls.items[i].at, code->function_offsets[code->calls.items[i].target]);
+}
+
+void free_machine_code(JAMZMachineCode *code)
+{
+    output_free(&code->data);
+    output_free(&code->text);
+    free(code->string_offsets);
+    free(code->function_offsets);
+    free(code->function_sizes);
+    free(code->calls.items);
+    free(code->strings.items);
+    free(code->counters.items);
+}
+
+bool generate_object(const JAMZIRProgram *program, JAMZOutputBuffer *output)
+{
+    JAMZMachineCode code;
+    generate_machine_code(program, &code, false);
+    write_object(&code, output);
+    log_debug("Objeto ELF64: %zu bytes de código, %zu de datos, %zu reubicaciones\n", code.text.size, code.data.size,
+              code.strings.count);
+    free_machine_code(&code);
+    return true;
+}
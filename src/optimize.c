@@ -0,0 +1,266 @@
+#include "optimize.h"
+#include "semantic.h"
+#include "utils.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Estado de cada variable local, indexado por Symbol.id
+typedef struct
+{
+    size_t store_count; // Declaraciones con valor más asignaciones
+    bool constant;
+    int32_t value;
+} ConstantSlot;
+
+typedef struct
+{
+    ConstantSlot *slots;
+    size_t slot_count;
+    JAMZOptimizeStats stats;
+} FoldContext;
+
+static const Symbol *local_variable(const JAMZASTNode *node)
+{
+    if (!node->symbol || node->symbol->type != SYMBOL_VARIABLE)
+        return NULL;
+    return node->symbol;
+}
+
+static void count_stores(FoldContext *ctx, const JAMZASTNode *node)
+{
+    if (!node)
+        return;
+
+    switch (node->type)
+    {
+    case JAMZ_AST_BLOCK:
+        for (size_t i = 0; i < node->block.count; i++)
+            count_stores(ctx, node->block.statements[i]);
+        break;
+    case JAMZ_AST_IF:
+        count_stores(ctx, node->if_stmt.then_branch);
+        count_stores(ctx, node->if_stmt.else_branch);
+        break;
+    case JAMZ_AST_WHILE:
+        count_stores(ctx, node->while_stmt.body);
+        count_stores(ctx, node->while_stmt.step);
+        break;
+    case JAMZ_AST_DECLARATION:
+    case JAMZ_AST_ASSIGNMENT:
+    {
+        const Symbol *sym = local_variable(node);
+        if (!sym)
+            break;
+        if (sym->id >= ctx->slot_count)
+        {
+            size_t count = sym->id + 1;
+            ctx->slots = safe_realloc(ctx->slots, count * sizeof(ConstantSlot));
+            memset(ctx->slots + ctx->slot_count, 0, (count - ctx->slot_count) * sizeof(ConstantSlot));
+            ctx->slot_count = count;
+        }
+        if (node->type == JAMZ_AST_ASSIGNMENT || node->declaration.initializer)
+            ctx->slots[sym->id].store_count++;
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// Valor de un literal entero de 32 bits; los demás literales no se pliegan
+static bool literal_int(const JAMZASTNode *node, int32_t *value)
+{
+    if (node->type != JAMZ_AST_LITERAL || node->literal.token_type != JAMZ_TOKEN_NUMBER)
+        return false;
+
+    char *end;
+    errno = 0;
+    long long parsed = strtoll(node->literal.value, &end, 10);
+    if (errno != 0 || *end != '\0' || end == node->literal.value || parsed < INT32_MIN || parsed > INT32_MAX)
+        return false;
+
+    *value = (int32_t)parsed;
+    return true;
+}
+
+// Misma semántica que el código generado: aritmética de 32 bits con
+// desbordamiento circular. La división que fallaría en ejecución no se pliega.
+static bool evaluate(const char *op, int32_t left, int32_t right, int32_t *result)
+{
+    uint32_t l = (uint32_t)left;
+    uint32_t r = (uint32_t)right;
+
+    if (strcmp(op, "+") == 0)
+        *result = (int32_t)(l + r);
+    else if (strcmp(op, "-") == 0)
+        *result = (int32_t)(l - r);
+    else if (strcmp(op, "*") == 0)
+        *result = (int32_t)(l * r);
+    else if (strcmp(op, "/") == 0)
+    {
+        if (right == 0 || (left == INT32_MIN && right == -1))
+            return false;
+        *result = left / right;
+    }
+    else if (strcmp(op, "%") == 0)
+    {
+        if (right == 0 || (left == INT32_MIN && right == -1))
+            return false;
+        *result = left % right;
+    }
+    else if (strcmp(op, "<") == 0)
+        *result = left < right;
+    else if (strcmp(op, "<=") == 0)
+        *result = left <= right;
+    else if (strcmp(op, ">") == 0)
+        *result = left > right;
+    else if (strcmp(op, ">=") == 0)
+        *result = left >= right;
+    else if (strcmp(op, "==") == 0)
+        *result = left == right;
+    else if (strcmp(op, "!=") == 0)
+        *result = left != right;
+    else
+        return false;
+    return true;
+}
+
+// Convierte el nodo en un literal int conservando su posición en el fuente
+static void make_literal(JAMZASTNode *node, int32_t value)
+{
+    char text[16];
+    snprintf(text, sizeof(text), "%d", (int)value);
+
+    node->type = JAMZ_AST_LITERAL;
+    node->literal.value = strdup(text);
+    node->literal.token_type = JAMZ_TOKEN_NUMBER;
+    node->inferred_type = JAMZ_TYPE_INT;
+    node->symbol = NULL;
+}
+
+static void fold_expression(FoldContext *ctx, JAMZASTNode *node)
+{
+    if (!node)
+        return;
+
+    switch (node->type)
+    {
+    case JAMZ_AST_VARIABLE:
+    {
+        const Symbol *sym = local_variable(node);
+        if (!sym || sym->id >= ctx->slot_count || !ctx->slots[sym->id].constant)
+            break;
+        free(node->variable.var_name);
+        make_literal(node, ctx->slots[sym->id].value);
+        ctx->stats.propagated++;
+        break;
+    }
+    case JAMZ_AST_BINARY:
+    {
+        fold_expression(ctx, node->binary.left);
+        fold_expression(ctx, node->binary.right);
+
+        int32_t left, right, result;
+        if (!literal_int(node->binary.left, &left) || !literal_int(node->binary.right, &right) ||
+            !evaluate(node->binary.op, left, right, &result))
+            break;
+
+        log_debug("Plegado %d %s %d = %d (línea %d)\n", left, node->binary.op, right, result, node->line);
+        free_ast(node->binary.left);
+        free_ast(node->binary.right);
+        free(node->binary.op);
+        make_literal(node, result);
+        ctx->stats.folded++;
+        break;
+    }
+    case JAMZ_AST_CALL:
+        for (size_t i = 0; i < node->call.arg_count; i++)
+            fold_expression(ctx, node->call.args[i]);
+        break;
+    case JAMZ_AST_INDEX:
+        fold_expression(ctx, node->index.index);
+        break;
+    default:
+        break;
+    }
+}
+
+// Recorre las sentencias en orden de programa. Una variable con un único
+// almacenamiento en su declaración ya tiene su valor en todas las lecturas
+// que la resuelven: aparecen después en su ámbito y, dentro de un bucle, la
+// declaración se vuelve a ejecutar antes en cada vuelta.
+static void fold_statement(FoldContext *ctx, JAMZASTNode *node)
+{
+    if (!node)
+        return;
+
+    switch (node->type)
+    {
+    case JAMZ_AST_BLOCK:
+        for (size_t i = 0; i < node->block.count; i++)
+            fold_statement(ctx, node->block.statements[i]);
+        break;
+    case JAMZ_AST_IF:
+        fold_expression(ctx, node->if_stmt.condition);
+        fold_statement(ctx, node->if_stmt.then_branch);
+        fold_statement(ctx, node->if_stmt.else_branch);
+        break;
+    case JAMZ_AST_WHILE:
+        fold_expression(ctx, node->while_stmt.condition);
+        fold_statement(ctx, node->while_stmt.body);
+        fold_statement(ctx, node->while_stmt.step);
+        break;
+    case JAMZ_AST_DECLARATION:
+    {
+        fold_expression(ctx, node->declaration.initializer);
+
+        const Symbol *sym = local_variable(node);
+        int32_t value;
+        if (sym && node->declaration.type_id == JAMZ_TYPE_INT && node->declaration.initializer &&
+            ctx->slots[sym->id].store_count == 1 && literal_int(node->declaration.initializer, &value))
+        {
+            ctx->slots[sym->id].constant = true;
+            ctx->slots[sym->id].value = value;
+        }
+        break;
+    }
+    case JAMZ_AST_ASSIGNMENT:
+        fold_expression(ctx, node->assignment.index);
+        fold_expression(ctx, node->assignment.value);
+        break;
+    case JAMZ_AST_RETURN:
+        fold_expression(ctx, node->return_stmt.value);
+        break;
+    default:
+        fold_expression(ctx, node);
+        break;
+    }
+}
+
+JAMZOptimizeStats optimize_constants(JAMZASTNode *program)
+{
+    JAMZOptimizeStats total = {0, 0};
+    if (!program || program->type != JAMZ_AST_PROGRAM)
+        return total;
+
+    for (size_t i = 0; i < program->block.count; i++)
+    {
+        JAMZASTNode *function = program->block.statements[i];
+        FoldContext ctx = {NULL, 0, {0, 0}};
+
+        count_stores(&ctx, function->function.body);
+        fold_statement(&ctx, function->function.body);
+
+        log_debug("Optimización de %s: %zu plegadas, %zu propagadas\n", function->function.name,
+                  ctx.stats.folded, ctx.stats.propagated);
+        total.folded += ctx.stats.folded;
+        total.propagated += ctx.stats.propagated;
+        free(ctx.slots);
+    }
+
+    return total;
+}
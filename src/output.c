@@ -0,0 +1,133 @@
+#include "output.h"
+#include "utils.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define write _write
+#define open _open
+#define close _close
+#define dup _dup
+#define dup2 _dup2
+#define OUTPUT_OPEN_FLAGS (_O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY)
+#else
+#include <unistd.h>
+#define OUTPUT_OPEN_FLAGS (O_WRONLY | O_CREAT | O_TRUNC)
+#endif
+
+#define OUTPUT_INITIAL_CAPACITY 65536
+
+void output_init(JAMZOutputBuffer *output)
+{
+    output->data = NULL;
+    output->size = 0;
+    output->capacity = 0;
+}
+
+void output_free(JAMZOutputBuffer *output)
+{
+    free(output->data);
+    output_init(output);
+}
+
+static void reserve(JAMZOutputBuffer *output, size_t extra)
+{
+    if (output->size + extra <= output->capacity)
+        return;
+    size_t capacity = output->capacity ? output->capacity * 2 : OUTPUT_INITIAL_CAPACITY;
+    while (capacity < output->size + extra)
+        capacity *= 2;
+    output->data = safe_realloc(output->data, capacity);
+    output->capacity = capacity;
+}
+
+void output_append(JAMZOutputBuffer *output, const char *text, size_t length)
+{
+    // Una sección vacía llega con data == NULL
+    if (length == 0)
+        return;
+    reserve(output, length);
+    memcpy(output->data + output->size, text, length);
+    output->size += length;
+}
+
+void output_string(JAMZOutputBuffer *output, const char *text)
+{
+    output_append(output, text, strlen(text));
+}
+
+void output_char(JAMZOutputBuffer *output, char c)
+{
+    reserve(output, 1);
+    output->data[output->size++] = c;
+}
+
+// Dígitos escritos de atrás hacia delante, sin pasar por printf
+void output_int(JAMZOutputBuffer *output, long long value)
+{
+    char digits[24];
+    size_t length = 0;
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    do
+    {
+        digits[sizeof(digits) - 1 - length++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0)
+        digits[sizeof(digits) - 1 - length++] = '-';
+    output_append(output, digits + sizeof(digits) - length, length);
+}
+
+bool output_write_fd(const JAMZOutputBuffer *output, int fd)
+{
+    size_t written = 0;
+    while (written < output->size)
+    {
+        size_t chunk = output->size - written;
+        if (chunk > (size_t)1 << 30)
+            chunk = (size_t)1 << 30;
+        long result = (long)write(fd, output->data + written, (unsigned int)chunk);
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result <= 0)
+            return false;
+        written += (size_t)result;
+    }
+    return true;
+}
+
+bool output_write_file(const JAMZOutputBuffer *output, const char *path)
+{
+    int fd = open(path, OUTPUT_OPEN_FLAGS, 0644);
+    if (fd < 0)
+        return false;
+    bool ok = output_write_fd(output, fd);
+    return close(fd) == 0 && ok;
+}
+
+void output_filename(const char *input_filename, const char *extension, char *buffer, size_t size)
+{
+    // Se cambia solo la última extensión, no un punto de un directorio
+    const char *dot = strrchr(input_filename, '.');
+    const char *slash = strrchr(input_filename, '/');
+    size_t stem = dot && (!slash || dot > slash) ? (size_t)(dot - input_filename) : strlen(input_filename);
+    snprintf(buffer, size, "%.*s%s", (int)stem, input_filename, extension);
+}
+
+int output_detach_stdout(void)
+{
+    fflush(stdout);
+    int fd = dup(1);
+    if (fd < 0)
+        return -1;
+    fflush(stderr);
+    if (dup2(2, 1) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
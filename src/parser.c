@@ -37,6 +37,15 @@ static inline bool match(JAMZParser *parser, JAMZTokenType type)
     return false;
 }
 
+// Reserva un nodo con la información semántica aún sin calcular
+static JAMZASTNode *new_ast_node(void)
+{
+    JAMZASTNode *node = safe_malloc(sizeof(JAMZASTNode));
+    node->inferred_type = JAMZ_TYPE_INVALID;
+    node->symbol = NULL;
+    return node;
+}
+
 // Forward declarations
 static JAMZASTNode *parse_declaration(JAMZParser *parser);
 static JAMZASTNode *parse_block(JAMZParser *parser);
@@ -45,19 +54,26 @@ static JAMZASTNode *parse_expression(JAMZParser *parser);
 static JAMZASTNode *parse_assignment(JAMZParser *parser);
 static JAMZASTNode *parse_primary(JAMZParser *parser);
 static JAMZASTNode *parse_binary_expression(JAMZParser *parser, int min_prec);
+static JAMZASTNode *parse_call(JAMZParser *parser, JAMZToken name_token);
+static JAMZASTNode *parse_simple_statement(JAMZParser *parser);
+static JAMZASTNode *parse_subscript(JAMZParser *parser, JAMZToken name_token);
 
-// Tabla de precedencia simple
-static int get_precedence(JAMZTokenType type)
+// Precedencia de los operadores binarios, como en C: cuanto mayor, más
+// fuerte liga. '=' no es binario (devuelve 0) y lo trata parse_assignment.
+static int get_precedence(JAMZToken token)
 {
-    switch (type)
-    {
-    case JAMZ_TOKEN_OPERATOR:
-        // Solo + y * por ahora
-        // Puedes mejorar esto para más operadores
-        return 1;
-    default:
+    if (token.type != JAMZ_TOKEN_OPERATOR)
         return 0;
-    }
+    const char *op = token.lexeme;
+    if (strcmp(op, "*") == 0 || strcmp(op, "/") == 0 || strcmp(op, "%") == 0)
+        return 4;
+    if (strcmp(op, "+") == 0 || strcmp(op, "-") == 0)
+        return 3;
+    if (strcmp(op, "<") == 0 || strcmp(op, "<=") == 0 || strcmp(op, ">") == 0 || strcmp(op, ">=") == 0)
+        return 2;
+    if (strcmp(op, "==") == 0 || strcmp(op, "!=") == 0)
+        return 1;
+    return 0;
 }
 
 JAMZASTNode *parser_parse(JAMZTokenList *tokens)
@@ -77,61 +93,231 @@ JAMZASTNode *parser_parse(JAMZTokenList *tokens)
     return program;
 }
 
-static JAMZASTNode *parse_program_node(JAMZParser *parser)
+// Tipo base (palabra clave o identificador con nombre de tipo) seguido de '*'
+static bool check_type(JAMZParser *parser)
+{
+    return check(parser, JAMZ_TOKEN_INT) ||
+           check(parser, JAMZ_TOKEN_CHAR) ||
+           (check(parser, JAMZ_TOKEN_IDENTIFIER) && jamz_type_from_name(current_token(parser).lexeme) != JAMZ_TYPE_INVALID);
+}
+
+static JAMZTypeId parse_type(JAMZParser *parser)
 {
-    if (!match(parser, JAMZ_TOKEN_INT))
+    JAMZToken type_token = advance(parser);
+    JAMZTypeId type_id = jamz_type_from_name(type_token.lexeme);
+    // Soporte para punteros: cada '*' deriva el tipo puntero internado
+    while (check(parser, JAMZ_TOKEN_OPERATOR) && strcmp(current_token(parser).lexeme, "*") == 0)
     {
-        push_error("Expected 'int' at start of program (main declaration).\n");
+        advance(parser);
+        type_id = jamz_type_pointer_to(type_id);
+    }
+    return type_id;
+}
+
+static void free_node_array(JAMZASTNode **nodes, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        free_ast(nodes[i]);
+    free(nodes);
+}
+
+// Huella de los tokens [first, last) con líneas relativas a la primera: dos
+// funciones con la misma huella producen el mismo AST salvo el desplazamiento
+static uint64_t token_fingerprint(const JAMZTokenList *tokens, size_t first, size_t last)
+{
+    uint64_t hash = JAMZ_HASH64_SEED;
+    int base_line = tokens->tokens[first].line;
+
+    for (size_t i = first; i < last; i++)
+    {
+        const JAMZToken *token = &tokens->tokens[i];
+        int position[3] = {(int)token->type, token->line - base_line, token->column};
+        hash = jamz_hash64(hash, position, sizeof(position));
+        hash = jamz_hash64(hash, token->lexeme, strlen(token->lexeme) + 1);
+    }
+    return hash;
+}
+
+// tipo nombre '(' [tipo nombre {',' tipo nombre}] ')' bloque
+static JAMZASTNode *parse_function(JAMZParser *parser)
+{
+    size_t first_token = parser->current;
+    if (!check_type(parser))
+    {
+        push_error("Expected return type at start of function declaration (line %d, col %d).\n",
+                   current_token(parser).line, current_token(parser).column);
         return NULL;
     }
+    JAMZToken type_token = current_token(parser);
+    JAMZTypeId return_type = parse_type(parser);
 
-    if (!match(parser, JAMZ_TOKEN_MAIN))
+    if (!check(parser, JAMZ_TOKEN_MAIN) && !check(parser, JAMZ_TOKEN_IDENTIFIER))
     {
-        push_error("Expected 'main' after 'int'.\n");
+        push_error("Expected function name after '%s'.\n", type_token.lexeme);
         return NULL;
     }
+    JAMZToken name_token = advance(parser);
 
     if (!match(parser, JAMZ_TOKEN_LPAREN))
     {
-        push_error("Expected '(' after 'main'.\n");
+        push_error("Expected '(' after '%s'.\n", name_token.lexeme);
         return NULL;
     }
 
+    size_t capacity = 4;
+    size_t count = 0;
+    JAMZASTNode **params = safe_malloc(capacity * sizeof(JAMZASTNode *));
+    while (!check(parser, JAMZ_TOKEN_RPAREN) && !at_end(parser))
+    {
+        if (count > 0 && !match(parser, JAMZ_TOKEN_COMMA))
+        {
+            push_error("Expected ',' between parameters of '%s'.\n", name_token.lexeme);
+            free_node_array(params, count);
+            return NULL;
+        }
+        if (!check_type(parser))
+        {
+            push_error("Expected parameter type in '%s'.\n", name_token.lexeme);
+            free_node_array(params, count);
+            return NULL;
+        }
+        JAMZToken param_type_token = current_token(parser);
+        JAMZTypeId param_type = parse_type(parser);
+        if (!check(parser, JAMZ_TOKEN_IDENTIFIER))
+        {
+            push_error("Expected parameter name in '%s'.\n", name_token.lexeme);
+            free_node_array(params, count);
+            return NULL;
+        }
+        JAMZToken param_name = advance(parser);
+
+        JAMZASTNode *param = new_ast_node();
+        param->type = JAMZ_AST_DECLARATION;
+        param->line = param_type_token.line;
+        param->column = param_type_token.column;
+        param->declaration.type_id = param_type;
+        param->declaration.var_name = strdup(param_name.lexeme);
+        param->declaration.initializer = NULL;
+
+        if (count >= capacity)
+        {
+            capacity *= 2;
+            params = safe_realloc(params, capacity * sizeof(JAMZASTNode *));
+        }
+        params[count++] = param;
+    }
+
     if (!match(parser, JAMZ_TOKEN_RPAREN))
     {
-        push_error("Expected ')' after 'main('.\n");
+        push_error("Expected ')' after parameters of '%s'.\n", name_token.lexeme);
+        free_node_array(params, count);
         return NULL;
     }
 
-    JAMZASTNode *main_block = parse_block(parser);
-    if (!main_block)
+    JAMZASTNode *body = parse_block(parser);
+    if (!body)
     {
-        push_error("Expected '{...}' block after 'main()'.\n");
+        push_error("Expected '{...}' block after '%s()'.\n", name_token.lexeme);
+        free_node_array(params, count);
         return NULL;
     }
 
-    JAMZASTNode *program = safe_malloc(sizeof(JAMZASTNode));
-    if (!program)
+    JAMZASTNode *function = new_ast_node();
+    function->type = JAMZ_AST_FUNCTION;
+    function->line = type_token.line;
+    function->column = type_token.column;
+    function->function.return_type = return_type;
+    function->function.name = strdup(name_token.lexeme);
+    function->function.params = params;
+    function->function.param_count = count;
+    function->function.body = body;
+    function->function.fingerprint = token_fingerprint(parser->tokens, first_token, parser->current);
+    return function;
+}
+
+// Un programa es una secuencia de definiciones de función (main incluida)
+static JAMZASTNode *parse_program_node(JAMZParser *parser)
+{
+    size_t capacity = 4;
+    size_t count = 0;
+    JAMZASTNode **functions = safe_malloc(capacity * sizeof(JAMZASTNode *));
+
+    while (!at_end(parser))
+    {
+        JAMZASTNode *function = parse_function(parser);
+        if (!function)
+        {
+            free_node_array(functions, count);
+            return NULL;
+        }
+        if (count >= capacity)
+        {
+            capacity *= 2;
+            functions = safe_realloc(functions, capacity * sizeof(JAMZASTNode *));
+        }
+        functions[count++] = function;
+    }
+
+    if (count == 0)
     {
-        push_error("Out of memory creating program node.");
-        free_ast(main_block);
+        push_error("Expected at least one function declaration (main).\n");
+        free(functions);
         return NULL;
     }
 
+    JAMZASTNode *program = new_ast_node();
     program->type = JAMZ_AST_PROGRAM;
     program->line = 1; // Línea y columna fija o podrías obtener del primer token
     program->column = 1;
-    program->block.count = 1;
-    program->block.statements = safe_malloc(sizeof(JAMZASTNode *));
-    if (!program->block.statements)
+    program->block.count = count;
+    program->block.statements = functions;
+    return program;
+}
+
+// Argumentos de una llamada; el nombre y '(' ya fueron consumidos
+static JAMZASTNode *parse_call(JAMZParser *parser, JAMZToken name_token)
+{
+    size_t capacity = 4;
+    size_t count = 0;
+    JAMZASTNode **args = safe_malloc(capacity * sizeof(JAMZASTNode *));
+
+    while (!check(parser, JAMZ_TOKEN_RPAREN) && !at_end(parser))
+    {
+        if (count > 0 && !match(parser, JAMZ_TOKEN_COMMA))
+        {
+            push_error("Expected ',' between arguments of '%s'.\n", name_token.lexeme);
+            free_node_array(args, count);
+            return NULL;
+        }
+        JAMZASTNode *arg = parse_expression(parser);
+        if (!arg)
+        {
+            free_node_array(args, count);
+            return NULL;
+        }
+        if (count >= capacity)
+        {
+            capacity *= 2;
+            args = safe_realloc(args, capacity * sizeof(JAMZASTNode *));
+        }
+        args[count++] = arg;
+    }
+
+    if (!match(parser, JAMZ_TOKEN_RPAREN))
     {
-        push_error("Out of memory creating program statements array.");
-        free_ast(main_block);
-        free(program);
+        push_error("Expected ')' after arguments of '%s'.\n", name_token.lexeme);
+        free_node_array(args, count);
         return NULL;
     }
-    program->block.statements[0] = main_block;
-    return program;
+
+    JAMZASTNode *call = new_ast_node();
+    call->type = JAMZ_AST_CALL;
+    call->line = name_token.line;
+    call->column = name_token.column;
+    call->call.name = strdup(name_token.lexeme);
+    call->call.args = args;
+    call->call.arg_count = count;
+    return call;
 }
 
 static JAMZASTNode *parse_block(JAMZParser *parser)
@@ -180,7 +366,7 @@ static JAMZASTNode *parse_block(JAMZParser *parser)
         free(stmts);
         return NULL;
     }
-    JAMZASTNode *node = safe_malloc(sizeof(JAMZASTNode));
+    JAMZASTNode *node = new_ast_node();
     if (!node)
     {
         push_error("Out of memory creating block node.");
@@ -197,31 +383,174 @@ static JAMZASTNode *parse_block(JAMZParser *parser)
     return node;
 }
 
-static JAMZASTNode *parse_declaration(JAMZParser *parser)
+// '[' expr ']' tras el nombre de un arreglo; el '[' ya fue consumido
+static JAMZASTNode *parse_subscript(JAMZParser *parser, JAMZToken name_token)
 {
-    if ((check(parser, JAMZ_TOKEN_INT)) ||
-        (check(parser, JAMZ_TOKEN_CHAR)) ||
-        (check(parser, JAMZ_TOKEN_IDENTIFIER) && (strcmp(current_token(parser).lexeme, "int") == 0 ||
-                                                  strcmp(current_token(parser).lexeme, "char") == 0)))
-    {
-        JAMZToken type_token = advance(parser);
-        char *type_name = strdup(type_token.lexeme);
-        // Soporte para punteros: si hay '*', concatenar al tipo
-        if (check(parser, JAMZ_TOKEN_OPERATOR) && strcmp(current_token(parser).lexeme, "*") == 0)
+    JAMZASTNode *index = parse_expression(parser);
+    if (!index)
+        return NULL;
+    if (!match(parser, JAMZ_TOKEN_RBRACKET))
+    {
+        push_error("Expected ']' after index of '%s'.", name_token.lexeme);
+        free_ast(index);
+        return NULL;
+    }
+    return index;
+}
+
+// nombre = expr, nombre[expr] = expr o nombre(args), sin el ';': sentencias
+// y paso de un for
+static JAMZASTNode *parse_simple_statement(JAMZParser *parser)
+{
+    JAMZToken name_token = advance(parser);
+    if (match(parser, JAMZ_TOKEN_LPAREN))
+        return parse_call(parser, name_token);
+    JAMZASTNode *index = NULL;
+    if (match(parser, JAMZ_TOKEN_LBRACKET) && !(index = parse_subscript(parser, name_token)))
+        return NULL;
+    if (!check(parser, JAMZ_TOKEN_OPERATOR) || strcmp(current_token(parser).lexeme, "=") != 0)
+    {
+        push_error("Expected '=' after identifier for assignment.");
+        free_ast(index);
+        return NULL;
+    }
+    advance(parser);
+    JAMZASTNode *value = parse_expression(parser);
+    if (!value)
+    {
+        free_ast(index);
+        return NULL;
+    }
+    JAMZASTNode *assign = new_ast_node();
+    assign->type = JAMZ_AST_ASSIGNMENT;
+    assign->line = name_token.line;
+    assign->column = name_token.column;
+    assign->assignment.var_name = strdup(name_token.lexeme);
+    assign->assignment.index = index;
+    assign->assignment.value = value;
+    return assign;
+}
+
+static JAMZASTNode *new_loop_node(JAMZToken token, JAMZASTNode *condition, JAMZASTNode *body, JAMZASTNode *step)
+{
+    JAMZASTNode *node = new_ast_node();
+    node->type = JAMZ_AST_WHILE;
+    node->line = token.line;
+    node->column = token.column;
+    node->while_stmt.condition = condition;
+    node->while_stmt.body = body;
+    node->while_stmt.step = step;
+    return node;
+}
+
+// for ([init] ; [cond] ; [paso]) bloque. Se reescribe como
+// { init; while (cond) bloque } con el paso al final de cada vuelta; el
+// bloque exterior da a la variable de init el ámbito del bucle.
+static JAMZASTNode *parse_for(JAMZParser *parser)
+{
+    JAMZToken for_token = parser->tokens->tokens[parser->current - 1];
+    if (!match(parser, JAMZ_TOKEN_LPAREN))
+    {
+        push_error("Expected '(' after 'for'.");
+        return NULL;
+    }
+    JAMZASTNode *init = NULL;
+    if (!match(parser, JAMZ_TOKEN_SEMICOLON))
+    {
+        if (!check_type(parser) && !check(parser, JAMZ_TOKEN_IDENTIFIER))
         {
-            advance(parser); // Ignora el '*'
-            char *ptr_type = malloc(strlen(type_name) + 2);
-            sprintf(ptr_type, "%s*", type_name);
-            free(type_name);
-            type_name = ptr_type;
+            push_error("Expected declaration or assignment in 'for' initializer.");
+            return NULL;
+        }
+        init = parse_declaration(parser);
+        if (!init)
+            return NULL;
+    }
+    JAMZASTNode *condition = NULL;
+    if (!check(parser, JAMZ_TOKEN_SEMICOLON))
+    {
+        condition = parse_expression(parser);
+        if (!condition)
+        {
+            free_ast(init);
+            return NULL;
         }
+    }
+    if (!match(parser, JAMZ_TOKEN_SEMICOLON))
+    {
+        push_error("Expected ';' after 'for' condition.");
+        free_ast(init);
+        free_ast(condition);
+        return NULL;
+    }
+    JAMZASTNode *step = NULL;
+    if (check(parser, JAMZ_TOKEN_IDENTIFIER) && !(step = parse_simple_statement(parser)))
+    {
+        free_ast(init);
+        free_ast(condition);
+        return NULL;
+    }
+    if (!match(parser, JAMZ_TOKEN_RPAREN))
+    {
+        push_error("Expected ')' after 'for' clauses.");
+        free_ast(init);
+        free_ast(condition);
+        free_ast(step);
+        return NULL;
+    }
+    JAMZASTNode *body = parse_block(parser);
+    if (!body)
+    {
+        free_ast(init);
+        free_ast(condition);
+        free_ast(step);
+        return NULL;
+    }
+    JAMZASTNode *loop = new_loop_node(for_token, condition, body, step);
+    if (!init)
+        return loop;
+
+    JAMZASTNode *scope = new_ast_node();
+    scope->type = JAMZ_AST_BLOCK;
+    scope->line = for_token.line;
+    scope->column = for_token.column;
+    scope->block.statements = safe_malloc(2 * sizeof(JAMZASTNode *));
+    scope->block.statements[0] = init;
+    scope->block.statements[1] = loop;
+    scope->block.count = 2;
+    return scope;
+}
+
+static JAMZASTNode *parse_declaration(JAMZParser *parser)
+{
+    if (check_type(parser))
+    {
+        JAMZToken type_token = current_token(parser);
+        JAMZTypeId type_id = parse_type(parser);
         if (!check(parser, JAMZ_TOKEN_IDENTIFIER))
         {
             push_error("Expected identifier after type in declaration.");
-            free(type_name);
             return NULL;
         }
         JAMZToken name_token = advance(parser);
+        // Arreglo de longitud fija: tipo nombre '[' número ']', sin inicializador
+        if (match(parser, JAMZ_TOKEN_LBRACKET))
+        {
+            long length = check(parser, JAMZ_TOKEN_NUMBER) ? strtol(current_token(parser).lexeme, NULL, 10) : 0;
+            if (length <= 0 || length > JAMZ_MAX_ARRAY_LENGTH)
+            {
+                push_error("Expected a positive array length (at most %d) for '%s'.", JAMZ_MAX_ARRAY_LENGTH,
+                           name_token.lexeme);
+                return NULL;
+            }
+            advance(parser);
+            if (!match(parser, JAMZ_TOKEN_RBRACKET))
+            {
+                push_error("Expected ']' after length of '%s'.", name_token.lexeme);
+                return NULL;
+            }
+            type_id = jamz_type_array_of(type_id, (size_t)length);
+        }
         JAMZASTNode *initializer = NULL;
         if (check(parser, JAMZ_TOKEN_OPERATOR) && strcmp(current_token(parser).lexeme, "=") == 0)
         {
@@ -233,46 +562,120 @@ static JAMZASTNode *parse_declaration(JAMZParser *parser)
             push_error("Expected ';' after declaration.");
             if (initializer)
                 free_ast(initializer);
-            free(type_name);
             return NULL;
         }
-        JAMZASTNode *decl = safe_malloc(sizeof(JAMZASTNode));
+        JAMZASTNode *decl = new_ast_node();
         decl->type = JAMZ_AST_DECLARATION;
         decl->line = type_token.line;
         decl->column = type_token.column;
-        decl->declaration.type_name = type_name;
+        decl->declaration.type_id = type_id;
         decl->declaration.var_name = strdup(name_token.lexeme);
         decl->declaration.initializer = initializer;
         return decl;
     }
-    // Asignación: nombre = expr ;
+    // Asignación: nombre = expr ; o llamada: nombre(args) ;
     if (check(parser, JAMZ_TOKEN_IDENTIFIER))
     {
-        JAMZToken name_token = advance(parser);
-        if (check(parser, JAMZ_TOKEN_OPERATOR) && strcmp(current_token(parser).lexeme, "=") == 0)
+        JAMZASTNode *statement = parse_simple_statement(parser);
+        if (!statement)
+            return NULL;
+        if (!match(parser, JAMZ_TOKEN_SEMICOLON))
         {
-            advance(parser);
-            JAMZASTNode *value = parse_expression(parser);
-            if (!match(parser, JAMZ_TOKEN_SEMICOLON))
-            {
+            if (statement->type == JAMZ_AST_CALL)
+                push_error("Expected ';' after call to '%s'.", statement->call.name);
+            else
                 push_error("Expected ';' after assignment.");
-                if (value)
-                    free_ast(value);
+            free_ast(statement);
+            return NULL;
+        }
+        return statement;
+    }
+    // Bloque anidado con su propio ámbito
+    if (check(parser, JAMZ_TOKEN_LBRACE))
+        return parse_block(parser);
+    // if (expr) bloque [else (bloque | if ...)]
+    if (match(parser, JAMZ_TOKEN_IF))
+    {
+        JAMZToken if_token = parser->tokens->tokens[parser->current - 1];
+        if (!match(parser, JAMZ_TOKEN_LPAREN))
+        {
+            push_error("Expected '(' after 'if'.");
+            return NULL;
+        }
+        JAMZASTNode *condition = parse_expression(parser);
+        if (!condition || !match(parser, JAMZ_TOKEN_RPAREN))
+        {
+            push_error("Expected ')' after 'if' condition.");
+            if (condition)
+                free_ast(condition);
+            return NULL;
+        }
+        JAMZASTNode *then_branch = parse_block(parser);
+        if (!then_branch)
+        {
+            free_ast(condition);
+            return NULL;
+        }
+        JAMZASTNode *else_branch = NULL;
+        if (match(parser, JAMZ_TOKEN_ELSE))
+        {
+            else_branch = check(parser, JAMZ_TOKEN_IF) ? parse_declaration(parser) : parse_block(parser);
+            if (!else_branch)
+            {
+                free_ast(condition);
+                free_ast(then_branch);
                 return NULL;
             }
-            JAMZASTNode *assign = safe_malloc(sizeof(JAMZASTNode));
-            assign->type = JAMZ_AST_ASSIGNMENT;
-            assign->line = name_token.line;
-            assign->column = name_token.column;
-            assign->assignment.var_name = strdup(name_token.lexeme);
-            assign->assignment.value = value;
-            return assign;
         }
-        else
+        JAMZASTNode *node = new_ast_node();
+        node->type = JAMZ_AST_IF;
+        node->line = if_token.line;
+        node->column = if_token.column;
+        node->if_stmt.condition = condition;
+        node->if_stmt.then_branch = then_branch;
+        node->if_stmt.else_branch = else_branch;
+        return node;
+    }
+    // while (expr) bloque
+    if (match(parser, JAMZ_TOKEN_WHILE))
+    {
+        JAMZToken while_token = parser->tokens->tokens[parser->current - 1];
+        if (!match(parser, JAMZ_TOKEN_LPAREN))
+        {
+            push_error("Expected '(' after 'while'.");
+            return NULL;
+        }
+        JAMZASTNode *condition = parse_expression(parser);
+        if (!condition || !match(parser, JAMZ_TOKEN_RPAREN))
         {
-            push_error("Expected '=' after identifier for assignment.");
+            push_error("Expected ')' after 'while' condition.");
+            if (condition)
+                free_ast(condition);
             return NULL;
         }
+        JAMZASTNode *body = parse_block(parser);
+        if (!body)
+        {
+            free_ast(condition);
+            return NULL;
+        }
+        return new_loop_node(while_token, condition, body, NULL);
+    }
+    if (match(parser, JAMZ_TOKEN_FOR))
+        return parse_for(parser);
+    if (match(parser, JAMZ_TOKEN_BREAK) || match(parser, JAMZ_TOKEN_CONTINUE))
+    {
+        JAMZToken jump_token = parser->tokens->tokens[parser->current - 1];
+        if (!match(parser, JAMZ_TOKEN_SEMICOLON))
+        {
+            push_error("Expected ';' after '%s'.", jump_token.lexeme);
+            return NULL;
+        }
+        JAMZASTNode *node = new_ast_node();
+        node->type = jump_token.type == JAMZ_TOKEN_BREAK ? JAMZ_AST_BREAK : JAMZ_AST_CONTINUE;
+        node->line = jump_token.line;
+        node->column = jump_token.column;
+        return node;
     }
     // Return
     if (match(parser, JAMZ_TOKEN_RETURN))
@@ -290,7 +693,7 @@ static JAMZASTNode *parse_declaration(JAMZParser *parser)
                 free_ast(value);
             return NULL;
         }
-        JAMZASTNode *node = safe_malloc(sizeof(JAMZASTNode));
+        JAMZASTNode *node = new_ast_node();
         node->type = JAMZ_AST_RETURN;
         node->line = return_token.line;
         node->column = return_token.column;
@@ -309,14 +712,26 @@ static JAMZASTNode *parse_expression(JAMZParser *parser)
 
 static JAMZASTNode *parse_assignment(JAMZParser *parser)
 {
-    JAMZASTNode *left = parse_binary_expression(parser, 0);
+    JAMZASTNode *left = parse_binary_expression(parser, 1);
     if (left && check(parser, JAMZ_TOKEN_OPERATOR) && strcmp(current_token(parser).lexeme, "=") == 0)
     {
         advance(parser);
         JAMZASTNode *value = parse_assignment(parser);
-        JAMZASTNode *assign = safe_malloc(sizeof(JAMZASTNode));
+        JAMZASTNode *assign = new_ast_node();
         assign->type = JAMZ_AST_ASSIGNMENT;
-        assign->assignment.var_name = strdup(left->variable.var_name);
+        // nombre[i] = valor: el índice pasa de la lectura a la asignación
+        if (left->type == JAMZ_AST_INDEX)
+        {
+            assign->assignment.var_name = left->index.var_name;
+            assign->assignment.index = left->index.index;
+            left->index.var_name = NULL;
+            left->index.index = NULL;
+        }
+        else
+        {
+            assign->assignment.var_name = strdup(left->variable.var_name);
+            assign->assignment.index = NULL;
+        }
         assign->assignment.value = value;
         assign->line = left->line;
         assign->column = left->column;
@@ -326,22 +741,25 @@ static JAMZASTNode *parse_assignment(JAMZParser *parser)
     return left;
 }
 
+// Escalada de precedencias: el operando derecho solo se lleva operadores que
+// liguen más fuerte, así que todos asocian por la izquierda
 static JAMZASTNode *parse_binary_expression(JAMZParser *parser, int min_prec)
 {
     JAMZASTNode *left = parse_primary(parser);
     while (check(parser, JAMZ_TOKEN_OPERATOR))
     {
         JAMZToken op_token = current_token(parser);
-        int prec = get_precedence(op_token.type);
-        if (prec < min_prec)
+        int prec = get_precedence(op_token);
+        if (prec == 0 || prec < min_prec)
             break;
         advance(parser);
-        JAMZASTNode *right = parse_primary(parser);
-        JAMZASTNode *bin = safe_malloc(sizeof(JAMZASTNode));
+        JAMZASTNode *right = parse_binary_expression(parser, prec + 1);
+        JAMZASTNode *bin = new_ast_node();
         bin->type = JAMZ_AST_BINARY;
         bin->binary.left = left;
         bin->binary.op = strdup(op_token.lexeme);
         bin->binary.right = right;
+        bin->binary.non_negative = false;
         bin->line = op_token.line;
         bin->column = op_token.column;
         left = bin;
@@ -354,7 +772,22 @@ static JAMZASTNode *parse_primary(JAMZParser *parser)
     if (check(parser, JAMZ_TOKEN_IDENTIFIER))
     {
         JAMZToken tok = advance(parser);
-        JAMZASTNode *var = safe_malloc(sizeof(JAMZASTNode));
+        if (match(parser, JAMZ_TOKEN_LPAREN))
+            return parse_call(parser, tok);
+        if (match(parser, JAMZ_TOKEN_LBRACKET))
+        {
+            JAMZASTNode *index = parse_subscript(parser, tok);
+            if (!index)
+                return NULL;
+            JAMZASTNode *element = new_ast_node();
+            element->type = JAMZ_AST_INDEX;
+            element->index.var_name = strdup(tok.lexeme);
+            element->index.index = index;
+            element->line = tok.line;
+            element->column = tok.column;
+            return element;
+        }
+        JAMZASTNode *var = new_ast_node();
         var->type = JAMZ_AST_VARIABLE;
         var->variable.var_name = strdup(tok.lexeme);
         var->line = tok.line;
@@ -364,7 +797,7 @@ static JAMZASTNode *parse_primary(JAMZParser *parser)
     if (check(parser, JAMZ_TOKEN_NUMBER) || check(parser, JAMZ_TOKEN_STRING) || check(parser, JAMZ_TOKEN_CHAR))
     {
         JAMZToken tok = advance(parser);
-        JAMZASTNode *lit = safe_malloc(sizeof(JAMZASTNode));
+        JAMZASTNode *lit = new_ast_node();
         lit->type = JAMZ_AST_LITERAL;
         lit->literal.value = strdup(tok.lexeme);
         lit->literal.token_type = tok.type; // Guardar tipo de token original
@@ -372,6 +805,17 @@ static JAMZASTNode *parse_primary(JAMZParser *parser)
         lit->column = tok.column;
         return lit;
     }
+    if (match(parser, JAMZ_TOKEN_LPAREN))
+    {
+        JAMZASTNode *inner = parse_expression(parser);
+        if (!inner || !match(parser, JAMZ_TOKEN_RPAREN))
+        {
+            push_error("Expected ')' after parenthesized expression.");
+            free_ast(inner);
+            return NULL;
+        }
+        return inner;
+    }
     push_error("Unexpected token in expression.");
     return NULL;
 }
\ No newline at end of file
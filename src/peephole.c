@@ -0,0 +1,157 @@
+#include "peephole.h"
+#include <stdbool.h>
+#include <string.h>
+
+typedef struct
+{
+    const char *name;
+    // Intenta la regla sobre el final de out[0 .. *count); si la aplica
+    // actualiza *count y devuelve true
+    bool (*apply)(const JAMZAsmBuffer *buffer, JAMZAsmLine *out, size_t *count);
+} Rule;
+
+static bool is_instruction(const JAMZAsmLine *line, const JAMZAsmBuffer *buffer, const char *mnemonic, int operands)
+{
+    return line->kind == JAMZ_ASM_INSTRUCTION && line->operand_count == operands &&
+           strcmp(asm_text(buffer, line->mnemonic), mnemonic) == 0;
+}
+
+static const char *operand(const JAMZAsmBuffer *buffer, const JAMZAsmLine *line, int index)
+{
+    return asm_text(buffer, line->operands[index]);
+}
+
+// El operando lee el registro: es él mismo o lo usa para direccionar memoria
+static bool mentions(const char *operand, const char *reg)
+{
+    if (strcmp(operand, reg) == 0)
+        return true;
+    const char *address = strchr(operand, '[');
+    return address && strstr(address, reg) != NULL;
+}
+
+static bool self_move(const JAMZAsmBuffer *buffer, JAMZAsmLine *out, size_t *count)
+{
+    JAMZAsmLine *last = &out[*count - 1];
+    if (!is_instruction(last, buffer, "mov", 2) || strcmp(operand(buffer, last, 0), operand(buffer, last, 1)) != 0)
+        return false;
+    (*count)--;
+    return true;
+}
+
+// mov A, B deja A == B, así que un mov B, A inmediato no cambia nada
+static bool store_reload(const JAMZAsmBuffer *buffer, JAMZAsmLine *out, size_t *count)
+{
+    if (*count < 2)
+        return false;
+    JAMZAsmLine *first = &out[*count - 2];
+    JAMZAsmLine *second = &out[*count - 1];
+    if (!is_instruction(first, buffer, "mov", 2) || !is_instruction(second, buffer, "mov", 2))
+        return false;
+    const char *a = operand(buffer, first, 0);
+    const char *b = operand(buffer, first, 1);
+    if (strcmp(a, operand(buffer, second, 1)) != 0 || strcmp(b, operand(buffer, second, 0)) != 0 || mentions(b, a))
+        return false;
+    (*count)--;
+    return true;
+}
+
+static bool dead_move(const JAMZAsmBuffer *buffer, JAMZAsmLine *out, size_t *count)
+{
+    if (*count < 2)
+        return false;
+    JAMZAsmLine *first = &out[*count - 2];
+    JAMZAsmLine *second = &out[*count - 1];
+    if (!is_instruction(first, buffer, "mov", 2) || !is_instruction(second, buffer, "mov", 2))
+        return false;
+    const char *dst = operand(buffer, first, 0);
+    if (strcmp(dst, operand(buffer, second, 0)) != 0 || mentions(operand(buffer, second, 1), dst))
+        return false;
+    *first = *second;
+    (*count)--;
+    return true;
+}
+
+// Los flags que cambian no importan: cada salto condicional lleva justo
+// delante su test o su cmp
+static bool identity(const JAMZAsmBuffer *buffer, JAMZAsmLine *out, size_t *count)
+{
+    JAMZAsmLine *last = &out[*count - 1];
+    bool neutral_zero = (is_instruction(last, buffer, "add", 2) || is_instruction(last, buffer, "sub", 2)) &&
+                        strcmp(operand(buffer, last, 1), "0") == 0;
+    bool neutral_one = is_instruction(last, buffer, "imul", 2) && strcmp(operand(buffer, last, 1), "1") == 0;
+    if (!neutral_zero && !neutral_one)
+        return false;
+    (*count)--;
+    return true;
+}
+
+static bool jump_to_next(const JAMZAsmBuffer *buffer, JAMZAsmLine *out, size_t *count)
+{
+    if (*count < 2)
+        return false;
+    JAMZAsmLine *jump = &out[*count - 2];
+    JAMZAsmLine *label = &out[*count - 1];
+    if (label->kind != JAMZ_ASM_LABEL || !is_instruction(jump, buffer, "jmp", 1) ||
+        strcmp(operand(buffer, jump, 0), asm_text(buffer, label->mnemonic)) != 0)
+        return false;
+    *jump = *label;
+    (*count)--;
+    return true;
+}
+
+// Hasta la siguiente etiqueta nadie puede llegar a lo que sigue a un salto
+// incondicional o a un ret
+static bool unreachable(const JAMZAsmBuffer *buffer, JAMZAsmLine *out, size_t *count)
+{
+    if (*count < 2 || out[*count - 1].kind != JAMZ_ASM_INSTRUCTION)
+        return false;
+    JAMZAsmLine *previous = &out[*count - 2];
+    if (!is_instruction(previous, buffer, "jmp", 1) && !is_instruction(previous, buffer, "ret", 0))
+        return false;
+    (*count)--;
+    return true;
+}
+
+static const Rule rules[JAMZ_PEEPHOLE_RULE_COUNT] = {
+    [JAMZ_PEEPHOLE_SELF_MOVE] = {"self_move", self_move},
+    [JAMZ_PEEPHOLE_STORE_RELOAD] = {"store_reload", store_reload},
+    [JAMZ_PEEPHOLE_DEAD_MOVE] = {"dead_move", dead_move},
+    [JAMZ_PEEPHOLE_IDENTITY] = {"identity", identity},
+    [JAMZ_PEEPHOLE_JUMP_TO_NEXT] = {"jump_to_next", jump_to_next},
+    [JAMZ_PEEPHOLE_UNREACHABLE] = {"unreachable", unreachable},
+};
+
+const char *jamz_peephole_rule_name(JAMZPeepholeRule rule)
+{
+    return rules[rule].name;
+}
+
+void peephole_optimize(JAMZAsmBuffer *buffer, JAMZPeepholeStats *stats)
+{
+    // La salida se compacta sobre el propio arreglo: nunca adelanta a la entrada
+    size_t count = 0;
+    for (size_t i = 0; i < buffer->count; i++)
+    {
+        buffer->lines[count++] = buffer->lines[i];
+        bool changed = true;
+        while (changed && count > 0)
+        {
+            changed = false;
+            for (int r = 0; r < JAMZ_PEEPHOLE_RULE_COUNT && !changed; r++)
+            {
+                if (rules[r].apply(buffer, buffer->lines, &count))
+                {
+                    stats->fired[r]++;
+                    changed = true;
+                }
+            }
+        }
+    }
+    buffer->count = count;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (buffer->lines[i].kind == JAMZ_ASM_INSTRUCTION)
+            stats->instructions++;
+    }
+}
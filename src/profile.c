@@ -0,0 +1,335 @@
+#include "profile.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Nombres de función más largos no caben en el lector
+#define PROFILE_MAX_NAME 256
+
+static void add_counters(JAMZIRFunction *function, JAMZIRProfileRange *range, size_t *next)
+{
+    JAMZIRInstr *code = function->code;
+    size_t count = function->count;
+    function->code = NULL;
+    function->count = 0;
+    function->capacity = 0;
+
+    size_t length = strlen(function->name) + 1;
+    range->function = safe_malloc(length);
+    memcpy(range->function, function->name, length);
+    range->first = *next;
+
+    // Un bloque empieza tras las etiquetas que lo abren (una tras otra
+    // siguen siendo el mismo bloque) y tras cada salto o return, como en
+    // build_blocks de ssa.c; el COUNT va en su primera instrucción
+    bool leader = true;
+    for (size_t i = 0; i < count; i++)
+    {
+        const JAMZIRInstr *instr = &code[i];
+        if (instr->op == JAMZ_IR_LABEL)
+            leader = true;
+        else if (leader)
+        {
+            ir_emit(function, JAMZ_IR_COUNT, JAMZ_IR_NONE, JAMZ_IR_NONE, JAMZ_IR_NONE, (int32_t)(*next)++, instr->line);
+            leader = false;
+        }
+        ir_emit(function, instr->op, instr->dst, instr->a, instr->b, instr->imm, instr->line);
+        if (instr->op == JAMZ_IR_JUMP || instr->op == JAMZ_IR_BRANCH || instr->op == JAMZ_IR_RET)
+            leader = true;
+    }
+    // Una etiqueta al final abre un bloque vacío que cae fuera de la función
+    if (count > 0 && code[count - 1].op == JAMZ_IR_LABEL)
+        ir_emit(function, JAMZ_IR_COUNT, JAMZ_IR_NONE, JAMZ_IR_NONE, JAMZ_IR_NONE, (int32_t)(*next)++,
+                code[count - 1].line);
+    range->blocks = *next - range->first;
+    free(code);
+}
+
+void profile_insert_counters(JAMZIRProgram *program, bool instrumented)
+{
+    JAMZIRProfile *profile = safe_malloc(sizeof(JAMZIRProfile));
+    profile->range_count = program->function_count;
+    profile->ranges = safe_malloc((program->function_count ? program->function_count : 1) * sizeof(JAMZIRProfileRange));
+    profile->instrumented = instrumented;
+    size_t next = 0;
+    for (size_t f = 0; f < program->function_count; f++)
+        add_counters(&program->functions[f], &profile->ranges[f], &next);
+    profile->count = next;
+    profile->counts = calloc(next ? next : 1, sizeof(uint64_t));
+    if (!profile->counts)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for the profile\n");
+        exit(EXIT_FAILURE);
+    }
+    program->profile = profile;
+    log_debug("Perfil: %zu contadores en %zu funciones%s\n", next, profile->range_count,
+              instrumented ? " (instrumentado)" : "");
+}
+
+bool profile_write(const JAMZIRProgram *program, const char *filename)
+{
+    const JAMZIRProfile *profile = program->profile;
+    FILE *file = profile ? fopen(filename, "w") : NULL;
+    if (!file)
+        return false;
+    fprintf(file, "%s\n", JAMZ_PROFILE_HEADER);
+    for (size_t r = 0; r < profile->range_count; r++)
+    {
+        const JAMZIRProfileRange *range = &profile->ranges[r];
+        fprintf(file, "%s %zu", range->function, range->blocks);
+        for (size_t b = 0; b < range->blocks; b++)
+            fprintf(file, " %llu", (unsigned long long)profile->counts[range->first + b]);
+        fprintf(file, "\n");
+    }
+    return fclose(file) == 0;
+}
+
+static JAMZIRProfileRange *find_range(JAMZIRProfile *profile, const char *name)
+{
+    for (size_t r = 0; r < profile->range_count; r++)
+    {
+        if (strcmp(profile->ranges[r].function, name) == 0)
+            return &profile->ranges[r];
+    }
+    return NULL;
+}
+
+bool profile_read(JAMZIRProgram *program, const char *filename, size_t *matched, FILE *report)
+{
+    JAMZIRProfile *profile = program->profile;
+    *matched = 0;
+    FILE *file = profile ? fopen(filename, "r") : NULL;
+    if (!file)
+        return false;
+
+    bool *seen = calloc(profile->range_count ? profile->range_count : 1, sizeof(bool));
+    if (!seen)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for the profile\n");
+        exit(EXIT_FAILURE);
+    }
+    bool ok = true;
+    char name[PROFILE_MAX_NAME];
+    while (ok && fscanf(file, "%255s", name) == 1)
+    {
+        if (name[0] == '#')
+        {
+            int c;
+            while ((c = fgetc(file)) != EOF && c != '\n')
+                ;
+            continue;
+        }
+        size_t blocks;
+        if (fscanf(file, "%zu", &blocks) != 1)
+        {
+            ok = false;
+            break;
+        }
+        JAMZIRProfileRange *range = find_range(profile, name);
+        bool use = range && range->blocks == blocks && !seen[range - profile->ranges];
+        if (report && !range)
+            fprintf(report, "  %s: in the profile but not in the program\n", name);
+        else if (report && !use)
+            fprintf(report, "  %s: profile has %zu block(s), expected %zu; ignored\n", name, blocks, range->blocks);
+        for (size_t b = 0; b < blocks && ok; b++)
+        {
+            unsigned long long passes;
+            ok = fscanf(file, "%llu", &passes) == 1;
+            if (ok && use)
+                profile->counts[range->first + b] = (uint64_t)passes;
+        }
+        if (use)
+        {
+            seen[range - profile->ranges] = true;
+            (*matched)++;
+        }
+    }
+    fclose(file);
+
+    for (size_t r = 0; r < profile->range_count && report && ok; r++)
+    {
+        if (!seen[r])
+            fprintf(report, "  %s: no profile data\n", profile->ranges[r].function);
+    }
+    free(seen);
+    return ok;
+}
+
+const uint64_t *profile_weights(const JAMZIRProgram *program)
+{
+    return program->profile && !program->profile->instrumented ? program->profile->counts : NULL;
+}
+
+void profile_print(const JAMZIRProgram *program, FILE *out)
+{
+    const JAMZIRProfile *profile = program->profile;
+    if (!profile)
+        return;
+    for (size_t r = 0; r < profile->range_count; r++)
+    {
+        const JAMZIRProfileRange *range = &profile->ranges[r];
+        if (range->blocks == 0)
+            continue;
+        const uint64_t *counts = &profile->counts[range->first];
+        size_t hottest = 0;
+        size_t never = 0;
+        for (size_t b = 0; b < range->blocks; b++)
+        {
+            if (counts[b] > counts[hottest])
+                hottest = b;
+            never += counts[b] == 0;
+        }
+        fprintf(out, "  %s: entered %llu time(s), %zu block(s), hottest #%zu with %llu pass(es), %zu never run\n",
+                range->function, (unsigned long long)counts[0], range->blocks, hottest,
+                (unsigned long long)counts[hottest], never);
+    }
+}
+
+// Pasadas de cada bloque según el perfil: las del primer COUNT del bloque
+// (el de su bloque del fuente; un cuerpo integrado trae detrás los del
+// llamado) o, si no tiene (preheaders), las del predecesor más caliente.
+// NULL si el perfil no dice nada de la función.
+uint64_t *profile_block_weights(const JAMZSSAFunction *ssa)
+{
+    size_t nodes = ssa->block_count;
+    uint64_t *weight = calloc(nodes ? nodes : 1, sizeof(uint64_t));
+    bool *counted = calloc(nodes ? nodes : 1, sizeof(bool));
+    if (!weight || !counted)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for the block profile\n");
+        exit(EXIT_FAILURE);
+    }
+    bool any = false;
+    for (size_t b = 0; b < nodes; b++)
+    {
+        const JAMZSSABlock *block = &ssa->blocks[b];
+        for (size_t i = 0; i < block->count && !counted[b]; i++)
+        {
+            if (block->code[i].op != JAMZ_IR_COUNT)
+                continue;
+            weight[b] = ssa->weights[block->code[i].imm];
+            counted[b] = true;
+            any = any || weight[b] > 0;
+        }
+    }
+    for (size_t r = 0; r < ssa->graph.rpo_count; r++)
+    {
+        size_t b = ssa->graph.rpo[r];
+        for (size_t k = ssa->graph.pred_start[b]; k < ssa->graph.pred_start[b + 1] && !counted[b]; k++)
+        {
+            if (weight[ssa->graph.preds[k]] > weight[b])
+                weight[b] = weight[ssa->graph.preds[k]];
+        }
+    }
+    free(counted);
+    if (!any)
+    {
+        free(weight);
+        return NULL;
+    }
+    return weight;
+}
+
+// Un salto condicional cuyo destino pasa más veces que la caída se invierte
+// si la condición es una comparación que solo lee él: se niega y se cambian
+// los sucesores, y así la colocación puede poner la rama caliente detrás.
+// La vuelta de un bucle no se toca: su cabecera ya está colocada antes.
+void profile_invert_branches(JAMZSSAFunction *ssa, const uint64_t *weight, const size_t *use_start)
+{
+    for (size_t b = 0; b < ssa->block_count; b++)
+    {
+        JAMZSSABlock *block = &ssa->blocks[b];
+        if (!ssa_is_reachable(ssa, b) || block->condition == JAMZ_IR_NONE || block->succ_count != 2 ||
+            weight[block->succs[1]] <= weight[block->succs[0]] || ssa_dominates(ssa, block->succs[1], b) ||
+            use_start[block->condition + 1] - use_start[block->condition] != 1)
+            continue;
+        for (size_t i = 0; i < block->count; i++)
+        {
+            JAMZIRInstr *instr = &block->code[i];
+            if (instr->dst != block->condition || !jamz_ir_is_comparison(instr->op))
+                continue;
+            instr->op = jamz_ir_negate_comparison(instr->op);
+            size_t taken = block->succs[1];
+            block->succs[1] = block->succs[0];
+            block->succs[0] = taken;
+            ssa->stats.inverted++;
+            break;
+        }
+    }
+}
+
+// Colocación guiada por el perfil (Pettis y Hansen, de arriba abajo): tras
+// cada bloque va su sucesor más caliente aún sin colocar y, si no queda
+// ninguno, el bloque más caliente pendiente; los que no se ejecutaron
+// quedan al final en orden de creación. Los preheaders siguen justo delante
+// de su cabecera.
+size_t *profile_layout(JAMZSSAFunction *ssa, const uint64_t *weight)
+{
+    size_t nodes = ssa->block_count;
+    size_t *order = safe_malloc((nodes ? nodes : 1) * sizeof(size_t));
+    size_t *first = safe_malloc((nodes ? nodes : 1) * sizeof(size_t));
+    size_t *chain = safe_malloc((nodes ? nodes : 1) * sizeof(size_t));
+    bool *placed = calloc(nodes ? nodes : 1, sizeof(bool));
+    if (!placed)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for the block layout\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t b = 0; b < nodes; b++)
+        first[b] = SIZE_MAX;
+    for (size_t b = nodes; b-- > 0;)
+    {
+        size_t target = ssa->blocks[b].before;
+        if (target == SIZE_MAX)
+            continue;
+        chain[b] = first[target];
+        first[target] = b;
+    }
+
+    size_t count = 0;
+    size_t next = 0;
+    while (next != SIZE_MAX)
+    {
+        for (size_t x = first[next]; x != SIZE_MAX; x = chain[x])
+        {
+            order[count++] = x;
+            placed[x] = true;
+        }
+        order[count++] = next;
+        placed[next] = true;
+
+        const JAMZSSABlock *block = &ssa->blocks[next];
+        next = SIZE_MAX;
+        uint64_t hottest = 0;
+        for (size_t s = 0; s < block->succ_count; s++)
+        {
+            size_t succ = block->succs[s];
+            size_t unit = ssa->blocks[succ].before == SIZE_MAX ? succ : ssa->blocks[succ].before;
+            if (!placed[unit] && (next == SIZE_MAX || weight[succ] > hottest))
+            {
+                next = unit;
+                hottest = weight[succ];
+            }
+        }
+        for (size_t b = 0; b < nodes && next == SIZE_MAX; b++)
+        {
+            if (placed[b] || ssa->blocks[b].before != SIZE_MAX)
+                continue;
+            next = b;
+            for (size_t c = b + 1; c < nodes; c++)
+            {
+                if (!placed[c] && ssa->blocks[c].before == SIZE_MAX && weight[c] > weight[next])
+                    next = c;
+            }
+        }
+    }
+
+    size_t *plain = ssa_block_layout(ssa);
+    for (size_t r = 0; r < nodes; r++)
+        ssa->stats.moved += order[r] != plain[r] && ssa_is_reachable(ssa, order[r]);
+    free(plain);
+    free(placed);
+    free(chain);
+    free(first);
+    return order;
+}
@@ -0,0 +1,445 @@
+#include "regalloc.h"
+#include "dataflow.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *register_names[JAMZ_REG_COUNT] = {"ecx", "edx", "ebx", "esi", "edi"};
+
+// Orden de preferencia: los volátiles primero, así no hay que guardar nada
+// en el prólogo; los que cruzan una llamada solo pueden usar los preservados
+static const JAMZRegister any_order[] = {JAMZ_REG_ECX, JAMZ_REG_EDX, JAMZ_REG_EBX, JAMZ_REG_ESI, JAMZ_REG_EDI};
+static const JAMZRegister preserved_order[] = {JAMZ_REG_EBX, JAMZ_REG_ESI, JAMZ_REG_EDI};
+
+const char *jamz_register_name(JAMZRegister reg)
+{
+    return register_names[reg];
+}
+
+typedef struct
+{
+    int32_t vreg;
+    size_t start; // Posición de la primera y la última instrucción en que vive
+    size_t end;
+    bool crosses_call;
+    uint64_t weight; // Lecturas y escrituras por las pasadas de su bloque según el perfil
+} Interval;
+
+// Registros que lee la instrucción, incluida la condición de los saltos
+static int instr_reads(const JAMZIRInstr *instr, int32_t *regs)
+{
+    switch (instr->op)
+    {
+    case JAMZ_IR_COPY:
+    case JAMZ_IR_ARG:
+    case JAMZ_IR_RET:
+    case JAMZ_IR_BRANCH:
+    case JAMZ_IR_LOAD:
+        regs[0] = instr->a;
+        return instr->a != JAMZ_IR_NONE;
+    case JAMZ_IR_STORE:
+    case JAMZ_IR_VLOOP:
+    case JAMZ_IR_ADD:
+    case JAMZ_IR_SUB:
+    case JAMZ_IR_MUL:
+    case JAMZ_IR_DIV:
+    case JAMZ_IR_UDIV:
+    case JAMZ_IR_MOD:
+    case JAMZ_IR_UMOD:
+    case JAMZ_IR_EQ:
+    case JAMZ_IR_NE:
+    case JAMZ_IR_LT:
+    case JAMZ_IR_LE:
+    case JAMZ_IR_GT:
+    case JAMZ_IR_GE:
+        regs[0] = instr->a;
+        regs[1] = instr->b;
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+// Vista de la función para el asignador. Con selección de instrucciones, las
+// instrucciones plegadas en el árbol de otra no definen ni leen nada: sus
+// hojas se leen en la raíz del árbol.
+typedef struct
+{
+    const JAMZIRFunction *function;
+    const bool *folded;    // NULL si no hay árboles
+    const bool *immediate; // Dos por instrucción, o NULL
+    int32_t *folded_def;   // Instrucción plegada que define cada registro, o JAMZ_IR_NONE
+} Reads;
+
+static int collect_reads(const Reads *view, size_t i, int32_t *regs, int count)
+{
+    int32_t operands[2];
+    int reads = instr_reads(&view->function->code[i], operands);
+    for (int k = 0; k < reads; k++)
+    {
+        // Una constante escrita como inmediato no se lee de su registro
+        if (view->immediate && view->immediate[2 * i + (size_t)k])
+            continue;
+        int32_t def = view->folded ? view->folded_def[operands[k]] : JAMZ_IR_NONE;
+        if (def != JAMZ_IR_NONE)
+            count = collect_reads(view, (size_t)def, regs, count);
+        else if (count < JAMZ_REGALLOC_MAX_READS)
+            regs[count++] = operands[k];
+    }
+    return count;
+}
+
+static int effective_reads(const Reads *view, size_t i, int32_t *regs)
+{
+    if (view->folded && view->folded[i])
+        return 0;
+    return collect_reads(view, i, regs, 0);
+}
+
+static int32_t effective_def(const Reads *view, size_t i)
+{
+    if (view->folded && view->folded[i])
+        return JAMZ_IR_NONE;
+    return view->function->code[i].dst;
+}
+
+// Las llamadas, la división y los bucles vectoriales pisan ecx y edx
+// (además de eax)
+static bool clobbers_scratch(JAMZIROp op)
+{
+    return op == JAMZ_IR_CALL || op == JAMZ_IR_DIV || op == JAMZ_IR_UDIV || op == JAMZ_IR_MOD || op == JAMZ_IR_UMOD ||
+           op == JAMZ_IR_VLOOP;
+}
+
+static void extend(Interval *interval, size_t position)
+{
+    if (interval->start > position)
+        interval->start = position;
+    if (interval->end < position || interval->end == SIZE_MAX)
+        interval->end = position;
+}
+
+// Intervalos sin huecos: de la primera a la última posición en que el valor
+// está vivo, contando los bloques que lo reciben o lo dejan vivo
+static void build_intervals(const Reads *view, Interval *intervals)
+{
+    const JAMZIRFunction *function = view->function;
+    size_t count = function->count;
+    size_t vregs = (size_t)function->vreg_count;
+    size_t labels = function->label_count ? (size_t)function->label_count : 1;
+
+    // Bloques básicos: empiezan en cada etiqueta y tras cada salto o return
+    size_t *block_start = safe_malloc((count + 2) * sizeof(size_t));
+    size_t *label_block = safe_malloc(labels * sizeof(size_t));
+    size_t block_count = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        JAMZIROp op = function->code[i].op;
+        bool leader = i == 0 || op == JAMZ_IR_LABEL;
+        if (i > 0)
+        {
+            JAMZIROp previous = function->code[i - 1].op;
+            leader = leader || previous == JAMZ_IR_JUMP || previous == JAMZ_IR_BRANCH || previous == JAMZ_IR_RET;
+        }
+        if (leader)
+            block_start[block_count++] = i;
+        if (op == JAMZ_IR_LABEL)
+            label_block[function->code[i].imm] = block_count - 1;
+    }
+    block_start[block_count] = count;
+
+    JAMZFlowEdge *edges = safe_malloc((2 * block_count + 1) * sizeof(JAMZFlowEdge));
+    size_t edge_count = 0;
+    for (size_t b = 0; b < block_count; b++)
+    {
+        const JAMZIRInstr *last = &function->code[block_start[b + 1] - 1];
+        if (last->op == JAMZ_IR_JUMP || last->op == JAMZ_IR_BRANCH)
+            edges[edge_count++] = (JAMZFlowEdge){b, label_block[last->imm]};
+        if (last->op != JAMZ_IR_JUMP && last->op != JAMZ_IR_RET && b + 1 < block_count)
+            edges[edge_count++] = (JAMZFlowEdge){b, b + 1};
+    }
+    JAMZFlowGraph graph;
+    jamz_flow_graph_init(&graph, block_count, 0, edges, edge_count);
+    free(edges);
+
+    // Solo los valores que se leen en un bloque sin haberse escrito antes en
+    // él pueden vivir entre bloques; los temporales locales no ocupan bits
+    int32_t *global = safe_malloc((vregs ? vregs : 1) * sizeof(int32_t));
+    size_t *stamp = safe_malloc((vregs ? vregs : 1) * sizeof(size_t));
+    for (size_t v = 0; v < vregs; v++)
+    {
+        global[v] = JAMZ_IR_NONE;
+        stamp[v] = SIZE_MAX;
+    }
+    size_t global_count = 0;
+    for (size_t b = 0; b < block_count; b++)
+    {
+        for (size_t i = block_start[b]; i < block_start[b + 1]; i++)
+        {
+            int32_t regs[JAMZ_REGALLOC_MAX_READS];
+            int reads = effective_reads(view, i, regs);
+            for (int k = 0; k < reads; k++)
+            {
+                if (stamp[regs[k]] != b && global[regs[k]] == JAMZ_IR_NONE)
+                    global[regs[k]] = (int32_t)global_count++;
+            }
+            int32_t dst = effective_def(view, i);
+            if (dst != JAMZ_IR_NONE)
+                stamp[dst] = b;
+        }
+    }
+    size_t *global_vreg = safe_malloc((global_count ? global_count : 1) * sizeof(size_t));
+    for (size_t v = 0; v < vregs; v++)
+    {
+        if (global[v] != JAMZ_IR_NONE)
+            global_vreg[global[v]] = v;
+    }
+
+    // Liveness: gen = leídos antes de escribirse en el bloque, kill = escritos
+    JAMZDataflowProblem live;
+    jamz_dataflow_init(&live, &graph, JAMZ_DATAFLOW_BACKWARD, JAMZ_DATAFLOW_UNION, global_count);
+    for (size_t b = 0; b < block_count; b++)
+    {
+        for (size_t i = block_start[b]; i < block_start[b + 1]; i++)
+        {
+            int32_t regs[JAMZ_REGALLOC_MAX_READS];
+            int reads = effective_reads(view, i, regs);
+            for (int k = 0; k < reads; k++)
+            {
+                int32_t bit = global[regs[k]];
+                if (bit != JAMZ_IR_NONE && !jamz_bitset_test(live.kill[b], (size_t)bit))
+                    jamz_bitset_set(live.gen[b], (size_t)bit);
+            }
+            int32_t dst = effective_def(view, i);
+            if (dst != JAMZ_IR_NONE && global[dst] != JAMZ_IR_NONE)
+                jamz_bitset_set(live.kill[b], (size_t)global[dst]);
+        }
+    }
+    jamz_dataflow_solve(&live, &graph);
+
+    for (size_t v = 0; v < vregs; v++)
+        intervals[v] = (Interval){(int32_t)v, SIZE_MAX, SIZE_MAX, false, 0};
+    for (size_t b = 0; b < block_count; b++)
+    {
+        if (graph.rpo_index[b] == SIZE_MAX)
+            continue;
+        for (size_t w = 0; w < live.in[b].word_count; w++)
+        {
+            JAMZBitWord in = live.in[b].words[w];
+            JAMZBitWord out = live.out[b].words[w];
+            for (size_t bit = 0; bit < 64 && (in | out); bit++)
+            {
+                JAMZBitWord mask = (JAMZBitWord)1 << bit;
+                if (in & mask)
+                    extend(&intervals[global_vreg[w * 64 + bit]], block_start[b]);
+                if (out & mask)
+                    extend(&intervals[global_vreg[w * 64 + bit]], block_start[b + 1] - 1);
+                in &= ~mask;
+                out &= ~mask;
+            }
+        }
+        for (size_t i = block_start[b]; i < block_start[b + 1]; i++)
+        {
+            int32_t regs[JAMZ_REGALLOC_MAX_READS];
+            int reads = effective_reads(view, i, regs);
+            for (int k = 0; k < reads; k++)
+                extend(&intervals[regs[k]], i);
+            int32_t dst = effective_def(view, i);
+            if (dst != JAMZ_IR_NONE)
+                extend(&intervals[dst], i);
+        }
+    }
+
+    // Un valor cruza una llamada si vive antes y después de ella
+    size_t *clobbers_before = safe_malloc((count + 1) * sizeof(size_t));
+    clobbers_before[0] = 0;
+    for (size_t i = 0; i < count; i++)
+        clobbers_before[i + 1] = clobbers_before[i] + clobbers_scratch(function->code[i].op);
+    for (size_t v = 0; v < vregs; v++)
+    {
+        Interval *interval = &intervals[v];
+        if (interval->start != SIZE_MAX && interval->end > interval->start + 1)
+            interval->crosses_call = clobbers_before[interval->end] > clobbers_before[interval->start + 1];
+    }
+
+    free(clobbers_before);
+    free(global_vreg);
+    free(stamp);
+    free(global);
+    jamz_dataflow_free(&live);
+    jamz_flow_graph_free(&graph);
+    free(label_block);
+    free(block_start);
+}
+
+// Cada lectura o escritura pesa las pasadas del bloque en que está, las del
+// último COUNT visto (un bloque sin él sigue al anterior)
+static void weigh_intervals(const Reads *view, const uint64_t *profile, Interval *intervals)
+{
+    uint64_t passes = 0;
+    for (size_t i = 0; i < view->function->count; i++)
+    {
+        if (view->function->code[i].op == JAMZ_IR_COUNT)
+            passes = profile[view->function->code[i].imm];
+        int32_t regs[JAMZ_REGALLOC_MAX_READS];
+        int reads = effective_reads(view, i, regs);
+        for (int k = 0; k < reads; k++)
+            intervals[regs[k]].weight += passes;
+        int32_t dst = effective_def(view, i);
+        if (dst != JAMZ_IR_NONE)
+            intervals[dst].weight += passes;
+    }
+}
+
+static void spill(JAMZRegisterAllocation *allocation, int32_t vreg)
+{
+    allocation->reg[vreg] = JAMZ_IR_NONE;
+    allocation->slot[vreg] = allocation->slot_count++;
+}
+
+JAMZRegisterAllocation allocate_registers(const JAMZIRFunction *function, const bool *folded, const bool *immediate,
+                                          const uint64_t *profile)
+{
+    size_t vregs = (size_t)function->vreg_count;
+    size_t alloc = vregs ? vregs : 1;
+    JAMZRegisterAllocation allocation = {safe_malloc(alloc * sizeof(int32_t)), safe_malloc(alloc * sizeof(int32_t)), 0, {false}};
+    for (size_t v = 0; v < vregs; v++)
+    {
+        allocation.reg[v] = JAMZ_IR_NONE;
+        allocation.slot[v] = JAMZ_IR_NONE;
+    }
+    if (vregs == 0)
+        return allocation;
+
+    Reads view = {function, folded, immediate, NULL};
+    if (folded)
+    {
+        view.folded_def = safe_malloc(alloc * sizeof(int32_t));
+        for (size_t v = 0; v < vregs; v++)
+            view.folded_def[v] = JAMZ_IR_NONE;
+        for (size_t i = 0; i < function->count; i++)
+        {
+            if (folded[i])
+                view.folded_def[function->code[i].dst] = (int32_t)i;
+        }
+    }
+    Interval *intervals = safe_malloc(alloc * sizeof(Interval));
+    build_intervals(&view, intervals);
+    if (profile)
+        weigh_intervals(&view, profile, intervals);
+    free(view.folded_def);
+
+    // Orden por inicio con un conteo por posición: los inicios son índices
+    // de instrucción, así que no hace falta una ordenación por comparación
+    size_t *bucket = calloc(function->count + 1, sizeof(size_t));
+    if (!bucket)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for register allocation\n");
+        exit(EXIT_FAILURE);
+    }
+    size_t live_count = 0;
+    for (size_t v = 0; v < vregs; v++)
+    {
+        if (intervals[v].start != SIZE_MAX)
+        {
+            bucket[intervals[v].start + 1]++;
+            live_count++;
+        }
+    }
+    for (size_t i = 0; i < function->count; i++)
+        bucket[i + 1] += bucket[i];
+    Interval **order = safe_malloc((live_count ? live_count : 1) * sizeof(Interval *));
+    for (size_t v = 0; v < vregs; v++)
+    {
+        if (intervals[v].start != SIZE_MAX)
+            order[bucket[intervals[v].start]++] = &intervals[v];
+    }
+
+    // Activos ordenados por final; como mucho uno por registro
+    Interval *active[JAMZ_REG_COUNT];
+    size_t active_count = 0;
+    bool busy[JAMZ_REG_COUNT] = {false};
+
+    for (size_t n = 0; n < live_count; n++)
+    {
+        Interval *current = order[n];
+
+        // Los que terminan donde empieza este ya no hacen falta: la
+        // instrucción lee sus operandos antes de escribir el resultado
+        size_t kept = 0;
+        for (size_t k = 0; k < active_count; k++)
+        {
+            if (active[k]->end <= current->start)
+                busy[allocation.reg[active[k]->vreg]] = false;
+            else
+                active[kept++] = active[k];
+        }
+        active_count = kept;
+
+        const JAMZRegister *candidates = current->crosses_call ? preserved_order : any_order;
+        size_t candidate_count = current->crosses_call ? sizeof(preserved_order) / sizeof(preserved_order[0])
+                                                       : sizeof(any_order) / sizeof(any_order[0]);
+        int32_t chosen = JAMZ_IR_NONE;
+        for (size_t k = 0; k < candidate_count && chosen == JAMZ_IR_NONE; k++)
+        {
+            if (!busy[candidates[k]])
+                chosen = candidates[k];
+        }
+
+        if (chosen == JAMZ_IR_NONE)
+        {
+            // Se derrama el que más tarde termina entre los que ocupan un
+            // registro válido para este intervalo; con perfil, el que menos
+            // pesa (a igual peso, el que más tarde termina)
+            size_t victim = active_count;
+            for (size_t k = active_count; k-- > 0;)
+            {
+                JAMZRegister reg = (JAMZRegister)allocation.reg[active[k]->vreg];
+                if (current->crosses_call && !JAMZ_REG_CALLEE_SAVED(reg))
+                    continue;
+                if (victim == active_count || active[k]->weight < active[victim]->weight)
+                    victim = k;
+                if (!profile)
+                    break;
+            }
+            bool keep = victim == active_count || active[victim]->weight > current->weight ||
+                        (active[victim]->weight == current->weight && active[victim]->end <= current->end);
+            if (keep)
+            {
+                spill(&allocation, current->vreg);
+                continue;
+            }
+            chosen = allocation.reg[active[victim]->vreg];
+            spill(&allocation, active[victim]->vreg);
+            memmove(&active[victim], &active[victim + 1], (active_count - victim - 1) * sizeof(Interval *));
+            active_count--;
+        }
+
+        allocation.reg[current->vreg] = chosen;
+        allocation.used[chosen] = true;
+        busy[chosen] = true;
+        size_t at = active_count;
+        while (at > 0 && active[at - 1]->end > current->end)
+        {
+            active[at] = active[at - 1];
+            at--;
+        }
+        active[at] = current;
+        active_count++;
+    }
+
+    log_debug("Registros de %s: %zu valores, %d derramados\n", function->name, live_count, allocation.slot_count);
+
+    free(order);
+    free(bucket);
+    free(intervals);
+    return allocation;
+}
+
+void free_register_allocation(JAMZRegisterAllocation *allocation)
+{
+    free(allocation->reg);
+    free(allocation->slot);
+    allocation->reg = NULL;
+    allocation->slot = NULL;
+}
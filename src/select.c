@@ -0,0 +1,560 @@
+#include "select.h"
+#include "strength.h"
+#include "utils.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Nodos como mucho en un árbol plegado, contando la raíz: acota las hojas
+// que el asignador tiene que alargar hasta ella (JAMZ_REGALLOC_MAX_READS)
+#define SELECT_MAX_TREE 12
+#define SELECT_INFINITE 0x7FFF
+
+// Gramática de árboles. Los nodos hijos son los operandos a y b de la
+// instrucción; una regla conmutativa también casa con ellos al revés. Los
+// costes aproximan ciclos: mov, add, lea y shl valen 1 e imul 3.
+static const JAMZRule rules[] = {
+    // Hojas
+    {JAMZ_NT_IMM, JAMZ_IR_CONST, {JAMZ_NT_COUNT, JAMZ_NT_COUNT}, 0, JAMZ_COND_NONE, false, JAMZ_EMIT_LEAF, "imm: CONST"},
+    {JAMZ_NT_IMM, JAMZ_IR_STRING, {JAMZ_NT_COUNT, JAMZ_NT_COUNT}, 0, JAMZ_COND_NONE, false, JAMZ_EMIT_LEAF, "imm: STRING"},
+    {JAMZ_NT_MEM, JAMZ_IR_PARAM, {JAMZ_NT_COUNT, JAMZ_NT_COUNT}, 0, JAMZ_COND_NONE, false, JAMZ_EMIT_LEAF, "mem: PARAM"},
+    // En cadena
+    {JAMZ_NT_REG, -1, {JAMZ_NT_IMM, JAMZ_NT_COUNT}, 1, JAMZ_COND_NONE, false, JAMZ_EMIT_CHAIN, "reg: imm"},
+    {JAMZ_NT_REG, -1, {JAMZ_NT_MEM, JAMZ_NT_COUNT}, 1, JAMZ_COND_NONE, false, JAMZ_EMIT_CHAIN, "reg: mem"},
+    {JAMZ_NT_REG, -1, {JAMZ_NT_ADDR, JAMZ_NT_COUNT}, 1, JAMZ_COND_NONE, false, JAMZ_EMIT_CHAIN, "reg: addr"},
+    {JAMZ_NT_ADDR, -1, {JAMZ_NT_INDEX, JAMZ_NT_COUNT}, 0, JAMZ_COND_NONE, false, JAMZ_EMIT_CHAIN, "addr: index"},
+    {JAMZ_NT_ADDR, -1, {JAMZ_NT_PAIR, JAMZ_NT_COUNT}, 0, JAMZ_COND_NONE, false, JAMZ_EMIT_CHAIN, "addr: pair"},
+    {JAMZ_NT_REG, -1, {JAMZ_NT_FLAGS, JAMZ_NT_COUNT}, 2, JAMZ_COND_NONE, false, JAMZ_EMIT_SET, "reg: flags"},
+    // Modos de direccionamiento
+    {JAMZ_NT_INDEX, JAMZ_IR_MUL, {JAMZ_NT_REG, JAMZ_NT_IMM}, 0, JAMZ_COND_SCALE, true, JAMZ_EMIT_ADDRESS, "index: MUL(reg, imm)"},
+    {JAMZ_NT_PAIR, JAMZ_IR_ADD, {JAMZ_NT_REG, JAMZ_NT_REG}, 0, JAMZ_COND_NONE, true, JAMZ_EMIT_ADDRESS, "pair: ADD(reg, reg)"},
+    {JAMZ_NT_PAIR, JAMZ_IR_ADD, {JAMZ_NT_REG, JAMZ_NT_INDEX}, 0, JAMZ_COND_NONE, true, JAMZ_EMIT_ADDRESS, "pair: ADD(reg, index)"},
+    {JAMZ_NT_PAIR, JAMZ_IR_MUL, {JAMZ_NT_REG, JAMZ_NT_IMM}, 0, JAMZ_COND_SCALE_PLUS, true, JAMZ_EMIT_ADDRESS, "pair: MUL(reg, imm)"},
+    {JAMZ_NT_ADDR, JAMZ_IR_ADD, {JAMZ_NT_REG, JAMZ_NT_IMM}, 0, JAMZ_COND_NONE, true, JAMZ_EMIT_ADDRESS, "addr: ADD(reg, imm)"},
+    {JAMZ_NT_ADDR, JAMZ_IR_SUB, {JAMZ_NT_REG, JAMZ_NT_IMM}, 0, JAMZ_COND_NEGATABLE, false, JAMZ_EMIT_ADDRESS, "addr: SUB(reg, imm)"},
+    {JAMZ_NT_ADDR, JAMZ_IR_ADD, {JAMZ_NT_PAIR, JAMZ_NT_IMM}, 0, JAMZ_COND_NONE, true, JAMZ_EMIT_ADDRESS, "addr: ADD(pair, imm)"},
+    {JAMZ_NT_ADDR, JAMZ_IR_SUB, {JAMZ_NT_PAIR, JAMZ_NT_IMM}, 0, JAMZ_COND_NEGATABLE, false, JAMZ_EMIT_ADDRESS, "addr: SUB(pair, imm)"},
+    {JAMZ_NT_ADDR, JAMZ_IR_ADD, {JAMZ_NT_INDEX, JAMZ_NT_IMM}, 0, JAMZ_COND_NONE, true, JAMZ_EMIT_ADDRESS, "addr: ADD(index, imm)"},
+    {JAMZ_NT_ADDR, JAMZ_IR_SUB, {JAMZ_NT_INDEX, JAMZ_NT_IMM}, 0, JAMZ_COND_NEGATABLE, false, JAMZ_EMIT_ADDRESS, "addr: SUB(index, imm)"},
+    // Aritmética de dos direcciones, con el segundo operando en registro,
+    // memoria o inmediato
+    {JAMZ_NT_REG, JAMZ_IR_ADD, {JAMZ_NT_REG, JAMZ_NT_REG}, 2, JAMZ_COND_NONE, false, JAMZ_EMIT_TWO_ADDR, "reg: ADD(reg, reg)"},
+    {JAMZ_NT_REG, JAMZ_IR_ADD, {JAMZ_NT_REG, JAMZ_NT_MEM}, 2, JAMZ_COND_NONE, true, JAMZ_EMIT_TWO_ADDR, "reg: ADD(reg, mem)"},
+    {JAMZ_NT_REG, JAMZ_IR_ADD, {JAMZ_NT_REG, JAMZ_NT_IMM}, 2, JAMZ_COND_NONE, true, JAMZ_EMIT_TWO_ADDR, "reg: ADD(reg, imm)"},
+    {JAMZ_NT_REG, JAMZ_IR_SUB, {JAMZ_NT_REG, JAMZ_NT_REG}, 2, JAMZ_COND_NONE, false, JAMZ_EMIT_TWO_ADDR, "reg: SUB(reg, reg)"},
+    {JAMZ_NT_REG, JAMZ_IR_SUB, {JAMZ_NT_REG, JAMZ_NT_MEM}, 2, JAMZ_COND_NONE, false, JAMZ_EMIT_TWO_ADDR, "reg: SUB(reg, mem)"},
+    {JAMZ_NT_REG, JAMZ_IR_SUB, {JAMZ_NT_REG, JAMZ_NT_IMM}, 2, JAMZ_COND_NONE, false, JAMZ_EMIT_TWO_ADDR, "reg: SUB(reg, imm)"},
+    {JAMZ_NT_REG, JAMZ_IR_SUB, {JAMZ_NT_IMM, JAMZ_NT_REG}, 2, JAMZ_COND_NONE, false, JAMZ_EMIT_TWO_ADDR, "reg: SUB(imm, reg)"},
+    {JAMZ_NT_REG, JAMZ_IR_MUL, {JAMZ_NT_REG, JAMZ_NT_REG}, 4, JAMZ_COND_NONE, false, JAMZ_EMIT_TWO_ADDR, "reg: MUL(reg, reg)"},
+    {JAMZ_NT_REG, JAMZ_IR_MUL, {JAMZ_NT_REG, JAMZ_NT_MEM}, 4, JAMZ_COND_NONE, true, JAMZ_EMIT_TWO_ADDR, "reg: MUL(reg, mem)"},
+    // Producto por constante: desplazamiento, cadena de lea o imul de tres
+    // operandos (cuyo origen puede estar en memoria)
+    {JAMZ_NT_REG, JAMZ_IR_MUL, {JAMZ_NT_REG, JAMZ_NT_IMM}, 1, JAMZ_COND_POWER_OF_TWO, true, JAMZ_EMIT_SHIFT, "reg: MUL(reg, 2^k)"},
+    {JAMZ_NT_REG, JAMZ_IR_MUL, {JAMZ_NT_REG, JAMZ_NT_IMM}, 2, JAMZ_COND_MUL_PLAN, true, JAMZ_EMIT_MUL_PLAN, "reg: MUL(reg, plan)"},
+    {JAMZ_NT_REG, JAMZ_IR_MUL, {JAMZ_NT_REG, JAMZ_NT_IMM}, 3, JAMZ_COND_NONE, true, JAMZ_EMIT_MUL_IMM, "reg: MUL(reg, imm)"},
+    {JAMZ_NT_REG, JAMZ_IR_MUL, {JAMZ_NT_MEM, JAMZ_NT_IMM}, 3, JAMZ_COND_NONE, true, JAMZ_EMIT_MUL_IMM, "reg: MUL(mem, imm)"},
+    // Comparaciones: cmp no admite un inmediato a la izquierda ni dos
+    // operandos de memoria; al revés se compara con la condición simétrica
+    {JAMZ_NT_FLAGS, JAMZ_RULE_COMPARE, {JAMZ_NT_REG, JAMZ_NT_REG}, 1, JAMZ_COND_NONE, false, JAMZ_EMIT_COMPARE, "flags: CMP(reg, reg)"},
+    {JAMZ_NT_FLAGS, JAMZ_RULE_COMPARE, {JAMZ_NT_REG, JAMZ_NT_IMM}, 1, JAMZ_COND_NONE, true, JAMZ_EMIT_COMPARE, "flags: CMP(reg, imm)"},
+    {JAMZ_NT_FLAGS, JAMZ_RULE_COMPARE, {JAMZ_NT_REG, JAMZ_NT_MEM}, 1, JAMZ_COND_NONE, true, JAMZ_EMIT_COMPARE, "flags: CMP(reg, mem)"},
+    {JAMZ_NT_FLAGS, JAMZ_RULE_COMPARE, {JAMZ_NT_MEM, JAMZ_NT_IMM}, 1, JAMZ_COND_NONE, true, JAMZ_EMIT_COMPARE, "flags: CMP(mem, imm)"},
+};
+
+#define RULE_COUNT (sizeof(rules) / sizeof(rules[0]))
+
+const JAMZRule *jamz_select_rule(const JAMZSelection *selection, size_t instr, JAMZNonterminal nt, bool *swapped)
+{
+    const JAMZSelectLabel *label = &selection->labels[instr];
+    if (label->rule[nt] == JAMZ_RULE_NONE)
+        return NULL;
+    if (swapped)
+        *swapped = (label->swapped >> nt) & 1;
+    return &rules[label->rule[nt]];
+}
+
+int32_t jamz_select_operand(const JAMZSelection *selection, size_t instr, int k)
+{
+    int32_t child = selection->children[2 * instr + (size_t)k];
+    return child >= 0 && selection->folded[child] ? child : -1;
+}
+
+// Valores puros que pueden formar parte del árbol de su único uso
+// Comprueba la tabla una vez: cada no terminal que aparece como hijo tiene
+// que poder derivarse, es decir, ser el lado izquierdo de alguna regla cuyos
+// hijos también se derivan. Si no, esa regla nunca casaría (su hijo tendría
+// coste infinito) y el error pasaría por una mala selección sin más aviso.
+static void check_rules(void)
+{
+    static bool checked = false;
+    if (checked)
+        return;
+
+    bool derivable[JAMZ_NT_COUNT] = {false};
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (size_t r = 0; r < RULE_COUNT; r++)
+        {
+            const JAMZRule *rule = &rules[r];
+            if (derivable[rule->lhs])
+                continue;
+            bool ready = true;
+            for (int k = 0; k < 2; k++)
+                ready = ready && (rule->kids[k] == JAMZ_NT_COUNT || derivable[rule->kids[k]]);
+            if (ready)
+                derivable[rule->lhs] = changed = true;
+        }
+    }
+
+    for (size_t r = 0; r < RULE_COUNT; r++)
+    {
+        for (int k = 0; k < 2; k++)
+        {
+            JAMZNonterminal kid = rules[r].kids[k];
+            if (kid != JAMZ_NT_COUNT && !derivable[kid])
+            {
+                fprintf(stderr, "[ERROR] La regla de selección \"%s\" usa el no terminal %d, que ninguna regla deriva\n",
+                        rules[r].name, (int)kid);
+                abort();
+            }
+        }
+    }
+    checked = true;
+}
+
+static bool is_tree_op(JAMZIROp op)
+{
+    switch (op)
+    {
+    case JAMZ_IR_CONST:
+    case JAMZ_IR_STRING:
+    case JAMZ_IR_PARAM:
+    case JAMZ_IR_ADD:
+    case JAMZ_IR_SUB:
+    case JAMZ_IR_MUL:
+        return true;
+    default:
+        return jamz_ir_is_comparison(op);
+    }
+}
+
+static int operand_count(const JAMZIRInstr *instr)
+{
+    switch (instr->op)
+    {
+    case JAMZ_IR_COPY:
+    case JAMZ_IR_ARG:
+    case JAMZ_IR_RET:
+    case JAMZ_IR_BRANCH:
+    case JAMZ_IR_LOAD:
+        return instr->a != JAMZ_IR_NONE;
+    case JAMZ_IR_STORE:
+    case JAMZ_IR_VLOOP:
+    case JAMZ_IR_ADD:
+    case JAMZ_IR_SUB:
+    case JAMZ_IR_MUL:
+    case JAMZ_IR_DIV:
+    case JAMZ_IR_UDIV:
+    case JAMZ_IR_MOD:
+    case JAMZ_IR_UMOD:
+    case JAMZ_IR_EQ:
+    case JAMZ_IR_NE:
+    case JAMZ_IR_LT:
+    case JAMZ_IR_LE:
+    case JAMZ_IR_GT:
+    case JAMZ_IR_GE:
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+static int32_t operand(const JAMZIRInstr *instr, int k)
+{
+    return k == 0 ? instr->a : instr->b;
+}
+
+// Ningún registro que lee el árbol de node se vuelve a definir antes de la
+// raíz: last_def tiene la última definición previa a ella
+static bool tree_is_stable(const JAMZSelection *selection, const JAMZIRFunction *function, size_t node,
+                           const int32_t *last_def)
+{
+    const JAMZIRInstr *instr = &function->code[node];
+    for (int k = 0; k < operand_count(instr); k++)
+    {
+        int32_t child = selection->children[2 * node + (size_t)k];
+        if (child >= 0)
+        {
+            if (!tree_is_stable(selection, function, (size_t)child, last_def))
+                return false;
+        }
+        else if (last_def[operand(instr, k)] >= (int32_t)node)
+            return false;
+    }
+    return true;
+}
+
+// Un operando es plegable si lo define una sola instrucción pura del mismo
+// bloque, anterior, cuyo valor solo se usa aquí y cuyas hojas siguen intactas
+static void find_children(JAMZSelection *selection, const JAMZIRFunction *function)
+{
+    size_t vregs = function->vreg_count ? (size_t)function->vreg_count : 1;
+    int32_t *uses = safe_malloc(vregs * sizeof(int32_t));
+    int32_t *defs = safe_malloc(vregs * sizeof(int32_t));
+    int32_t *def_at = safe_malloc(vregs * sizeof(int32_t));
+    int32_t *last_def = safe_malloc(vregs * sizeof(int32_t));
+    uint8_t *size = safe_malloc((function->count ? function->count : 1) * sizeof(uint8_t));
+    for (size_t v = 0; v < vregs; v++)
+    {
+        uses[v] = defs[v] = 0;
+        def_at[v] = last_def[v] = JAMZ_IR_NONE;
+    }
+    for (size_t i = 0; i < function->count; i++)
+    {
+        const JAMZIRInstr *instr = &function->code[i];
+        for (int k = 0; k < operand_count(instr); k++)
+            uses[operand(instr, k)]++;
+        if (instr->dst != JAMZ_IR_NONE)
+        {
+            defs[instr->dst]++;
+            def_at[instr->dst] = (int32_t)i;
+        }
+    }
+
+    size_t block_start = 0;
+    for (size_t i = 0; i < function->count; i++)
+    {
+        const JAMZIRInstr *instr = &function->code[i];
+        if (instr->op == JAMZ_IR_LABEL)
+            block_start = i;
+        size[i] = 1;
+        for (int k = 0; k < operand_count(instr); k++)
+        {
+            int32_t vreg = operand(instr, k);
+            int32_t def = def_at[vreg];
+            selection->children[2 * i + (size_t)k] = -1;
+            // Una constante con una sola definición vale lo mismo en todos
+            // sus usos: aunque se comparta, puede ir como inmediato
+            if (defs[vreg] == 1 && def >= 0 && function->code[def].op == JAMZ_IR_CONST)
+                selection->constants[2 * i + (size_t)k] = def;
+            if (defs[vreg] != 1 || uses[vreg] != 1 || def < (int32_t)block_start || def >= (int32_t)i ||
+                !is_tree_op(function->code[def].op) || size[i] + size[def] > SELECT_MAX_TREE ||
+                !tree_is_stable(selection, function, (size_t)def, last_def))
+                continue;
+            selection->children[2 * i + (size_t)k] = def;
+            size[i] = (uint8_t)(size[i] + size[def]);
+        }
+        if (instr->dst != JAMZ_IR_NONE)
+            last_def[instr->dst] = (int32_t)i;
+        if (instr->op == JAMZ_IR_JUMP || instr->op == JAMZ_IR_BRANCH || instr->op == JAMZ_IR_RET)
+            block_start = i + 1;
+    }
+    free(uses);
+    free(defs);
+    free(def_at);
+    free(last_def);
+    free(size);
+}
+
+static bool condition_holds(JAMZRuleCondition condition, const JAMZIRInstr *imm)
+{
+    if (condition == JAMZ_COND_NONE)
+        return true;
+    // Las escalas y los desplazamientos negados necesitan una constante
+    if (imm->op != JAMZ_IR_CONST)
+        return false;
+    JAMZMulPlan plan;
+    switch (condition)
+    {
+    case JAMZ_COND_SCALE:
+        return imm->imm == 1 || imm->imm == 2 || imm->imm == 4 || imm->imm == 8;
+    case JAMZ_COND_SCALE_PLUS:
+        return imm->imm == 3 || imm->imm == 5 || imm->imm == 9;
+    case JAMZ_COND_NEGATABLE:
+        return imm->imm != INT32_MIN;
+    case JAMZ_COND_POWER_OF_TWO:
+        return jamz_is_power_of_two(imm->imm);
+    case JAMZ_COND_MUL_PLAN:
+        return jamz_mul_plan(imm->imm, &plan);
+    default:
+        return true;
+    }
+}
+
+int32_t jamz_select_constant(const JAMZSelection *selection, size_t instr, int k)
+{
+    return selection->constants[2 * instr + (size_t)k];
+}
+
+bool jamz_select_immediate(const JAMZSelection *selection, size_t instr, int k)
+{
+    return selection->immediate[2 * instr + (size_t)k];
+}
+
+// Instrucción que da el inmediato de un operando: el hijo plegable o la
+// constante compartida
+static int32_t immediate_source(const JAMZSelection *selection, size_t instr, int k)
+{
+    int32_t child = selection->children[2 * instr + (size_t)k];
+    return child >= 0 ? child : selection->constants[2 * instr + (size_t)k];
+}
+
+// Coste de reducir a nt el valor que llega por el operando k: un hijo
+// plegable ya está etiquetado; cualquier otro valor está en un registro, y
+// si es una constante compartida también sirve como inmediato. Leerla del
+// registro cuesta 1: obliga a tenerla cargada y ocupando uno.
+static int kid_cost(const JAMZSelection *selection, size_t instr, int k, JAMZNonterminal nt)
+{
+    int32_t child = selection->children[2 * instr + (size_t)k];
+    if (child >= 0)
+        return selection->labels[child].cost[nt];
+    bool constant = selection->constants[2 * instr + (size_t)k] >= 0;
+    if (nt == JAMZ_NT_REG)
+        return constant ? 1 : 0;
+    if (nt == JAMZ_NT_IMM && constant)
+        return 0;
+    return SELECT_INFINITE;
+}
+
+static void record(JAMZSelectLabel *label, JAMZNonterminal nt, int cost, size_t rule, bool swapped)
+{
+    if (cost >= label->cost[nt])
+        return;
+    label->cost[nt] = (uint16_t)cost;
+    label->rule[nt] = (uint8_t)rule;
+    if (swapped)
+        label->swapped = (uint8_t)(label->swapped | (1u << nt));
+    else
+        label->swapped = (uint8_t)(label->swapped & ~(1u << nt));
+}
+
+// Programación dinámica de abajo arriba: los hijos preceden a su padre en
+// la función, así que una pasada hacia delante basta
+static void label_node(JAMZSelection *selection, const JAMZIRFunction *function, size_t i)
+{
+    const JAMZIRInstr *instr = &function->code[i];
+    JAMZSelectLabel *label = &selection->labels[i];
+    for (int nt = 0; nt < JAMZ_NT_COUNT; nt++)
+    {
+        label->cost[nt] = SELECT_INFINITE;
+        label->rule[nt] = JAMZ_RULE_NONE;
+    }
+    label->swapped = 0;
+    if (!is_tree_op(instr->op))
+        return;
+
+    for (size_t r = 0; r < RULE_COUNT; r++)
+    {
+        const JAMZRule *rule = &rules[r];
+        bool matches = rule->op == JAMZ_RULE_COMPARE ? jamz_ir_is_comparison(instr->op) : rule->op == (int)instr->op;
+        if (!matches)
+            continue;
+        if (operand_count(instr) == 0)
+        {
+            record(label, rule->lhs, rule->cost, r, false);
+            continue;
+        }
+        for (int swap = 0; swap <= (rule->commutative ? 1 : 0); swap++)
+        {
+            // El inmediato de las condiciones es siempre el segundo hijo
+            int32_t imm = immediate_source(selection, i, 1 - swap);
+            if (rule->condition != JAMZ_COND_NONE &&
+                (imm < 0 || !condition_holds(rule->condition, &function->code[imm])))
+                continue;
+            int cost = rule->cost + kid_cost(selection, i, swap, rule->kids[0]) + kid_cost(selection, i, 1 - swap, rule->kids[1]);
+            if (cost < SELECT_INFINITE)
+                record(label, rule->lhs, cost, r, swap != 0);
+        }
+    }
+
+    // Cierre de las reglas en cadena hasta que ningún coste mejore
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (size_t r = 0; r < RULE_COUNT; r++)
+        {
+            const JAMZRule *rule = &rules[r];
+            if (rule->op != -1)
+                continue;
+            int cost = label->cost[rule->kids[0]] + rule->cost;
+            if (cost < label->cost[rule->lhs])
+            {
+                record(label, rule->lhs, cost, r, false);
+                changed = true;
+            }
+        }
+    }
+}
+
+// Baja por la cobertura elegida: los hijos que la regla reduce a algo que
+// no es un registro quedan plegados; los que van a registro se evalúan en
+// su propia posición
+static void reduce(JAMZSelection *selection, const JAMZIRFunction *function, size_t i, JAMZNonterminal nt)
+{
+    bool swapped = false;
+    const JAMZRule *rule = jamz_select_rule(selection, i, nt, &swapped);
+    while (rule && rule->op == -1)
+        rule = jamz_select_rule(selection, i, rule->kids[0], &swapped);
+    if (!rule)
+        return;
+    for (int k = 0; k < operand_count(&function->code[i]); k++)
+    {
+        size_t slot = 2 * i + (size_t)(swapped ? 1 - k : k);
+        int32_t child = selection->children[slot];
+        if (child < 0 && rule->kids[k] == JAMZ_NT_IMM)
+            selection->immediate[slot] = true;
+        if (child < 0 || rule->kids[k] == JAMZ_NT_REG)
+            continue;
+        selection->folded[child] = true;
+        selection->goal[child] = (uint8_t)rule->kids[k];
+        selection->folded_count++;
+        reduce(selection, function, (size_t)child, rule->kids[k]);
+    }
+}
+
+// No terminales que acepta cada operando de las instrucciones que no son
+// árboles: el emisor sabe escribirlos directamente
+static bool operand_accepts(const JAMZIRInstr *instr, int k, JAMZNonterminal nt)
+{
+    switch (instr->op)
+    {
+    case JAMZ_IR_COPY:
+    case JAMZ_IR_RET:
+        return nt == JAMZ_NT_REG || nt == JAMZ_NT_IMM || nt == JAMZ_NT_MEM || nt == JAMZ_NT_ADDR;
+    case JAMZ_IR_ARG:
+        return nt == JAMZ_NT_REG || nt == JAMZ_NT_IMM || nt == JAMZ_NT_MEM;
+    case JAMZ_IR_BRANCH:
+        // cmp y el salto condicional, sin pasar el 0 o 1 por un registro
+        return nt == JAMZ_NT_REG || nt == JAMZ_NT_FLAGS;
+    case JAMZ_IR_DIV:
+    case JAMZ_IR_UDIV:
+    case JAMZ_IR_MOD:
+    case JAMZ_IR_UMOD:
+        // El dividendo se calcula en eax; el divisor se lleva a ecx
+        if (k == 0)
+            return nt == JAMZ_NT_REG || nt == JAMZ_NT_IMM || nt == JAMZ_NT_MEM || nt == JAMZ_NT_ADDR;
+        return nt == JAMZ_NT_REG || nt == JAMZ_NT_IMM || nt == JAMZ_NT_MEM;
+    default:
+        return nt == JAMZ_NT_REG;
+    }
+}
+
+// Una constante compartida que todos sus usos escriben como inmediato no se
+// carga en ningún registro: queda como plegada. Las hojas de los árboles
+// plegados cuentan, porque se leen en su raíz.
+static void drop_immediate_constants(JAMZSelection *selection, const JAMZIRFunction *function)
+{
+    size_t vregs = function->vreg_count ? (size_t)function->vreg_count : 1;
+    int32_t *registers = safe_malloc(vregs * sizeof(int32_t));
+    int32_t *immediates = safe_malloc(vregs * sizeof(int32_t));
+    for (size_t v = 0; v < vregs; v++)
+        registers[v] = immediates[v] = 0;
+    for (size_t i = 0; i < function->count; i++)
+    {
+        const JAMZIRInstr *instr = &function->code[i];
+        for (int k = 0; k < operand_count(instr); k++)
+        {
+            if (selection->immediate[2 * i + (size_t)k])
+                immediates[operand(instr, k)]++;
+            else if (jamz_select_operand(selection, i, k) < 0)
+                registers[operand(instr, k)]++;
+        }
+    }
+    for (size_t i = 0; i < function->count; i++)
+    {
+        const JAMZIRInstr *instr = &function->code[i];
+        if (instr->op != JAMZ_IR_CONST || selection->folded[i] || registers[instr->dst] > 0 ||
+            immediates[instr->dst] == 0)
+            continue;
+        selection->folded[i] = true;
+        selection->goal[i] = JAMZ_NT_IMM;
+        selection->folded_count++;
+    }
+    free(registers);
+    free(immediates);
+}
+
+JAMZSelection select_instructions(const JAMZIRFunction *function)
+{
+    check_rules();
+
+    JAMZSelection selection;
+    size_t count = function->count ? function->count : 1;
+    selection.labels = safe_malloc(count * sizeof(JAMZSelectLabel));
+    selection.children = safe_malloc(2 * count * sizeof(int32_t));
+    selection.constants = safe_malloc(2 * count * sizeof(int32_t));
+    selection.immediate = safe_malloc(2 * count * sizeof(bool));
+    selection.folded = safe_malloc(count * sizeof(bool));
+    selection.goal = safe_malloc(count * sizeof(uint8_t));
+    selection.folded_count = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        selection.children[2 * i] = selection.children[2 * i + 1] = -1;
+        selection.constants[2 * i] = selection.constants[2 * i + 1] = -1;
+        selection.immediate[2 * i] = selection.immediate[2 * i + 1] = false;
+        selection.folded[i] = false;
+        selection.goal[i] = JAMZ_NT_REG;
+    }
+
+    find_children(&selection, function);
+    for (size_t i = 0; i < function->count; i++)
+        label_node(&selection, function, i);
+
+    // Las raíces se recorren de atrás hacia delante: cuando se llega a una
+    // instrucción ya se sabe si quedó plegada en un árbol posterior
+    for (size_t i = function->count; i-- > 0;)
+    {
+        const JAMZIRInstr *instr = &function->code[i];
+        if (selection.folded[i])
+            continue;
+        if (is_tree_op(instr->op))
+        {
+            reduce(&selection, function, i, JAMZ_NT_REG);
+            continue;
+        }
+        for (int k = 0; k < operand_count(instr); k++)
+        {
+            int32_t child = selection.children[2 * i + (size_t)k];
+            // Una constante compartida va como inmediato donde se admita uno
+            if (child < 0 && selection.constants[2 * i + (size_t)k] >= 0 && operand_accepts(instr, k, JAMZ_NT_IMM))
+                selection.immediate[2 * i + (size_t)k] = true;
+            if (child < 0)
+                continue;
+            JAMZNonterminal best = JAMZ_NT_REG;
+            for (int nt = 0; nt < JAMZ_NT_COUNT; nt++)
+            {
+                if (operand_accepts(instr, k, (JAMZNonterminal)nt) &&
+                    selection.labels[child].cost[nt] < selection.labels[child].cost[best])
+                    best = (JAMZNonterminal)nt;
+            }
+            if (best == JAMZ_NT_REG)
+                continue;
+            selection.folded[child] = true;
+            selection.goal[child] = (uint8_t)best;
+            selection.folded_count++;
+            reduce(&selection, function, (size_t)child, best);
+        }
+    }
+    drop_immediate_constants(&selection, function);
+    return selection;
+}
+
+void free_selection(JAMZSelection *selection)
+{
+    free(selection->labels);
+    free(selection->children);
+    free(selection->constants);
+    free(selection->immediate);
+    free(selection->folded);
+    free(selection->goal);
+    selection->labels = NULL;
+    selection->children = NULL;
+    selection->constants = NULL;
+    selection->immediate = NULL;
+    selection->folded = NULL;
+    selection->goal = NULL;
+}
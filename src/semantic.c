@@ -1,3 +1,4 @@
+#define _POSIX_C_SOURCE 200809L // pthreads
 #include <string.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -5,259 +6,882 @@
 #include <stdio.h>
 #include <locale.h>
 #include <stdarg.h>
+#include <stdint.h>
+#include <pthread.h>
 #include <windows.h> // Para manejar colores en la consola
 #include "semantic.h"
 #include "parser.h"
 #include "utils.h"
 
-static Symbol *find_symbol(SymbolTable *table, const char *name)
+#define SYMBOL_TABLE_INITIAL_CAPACITY 64
+#define SCOPE_STACK_INITIAL_CAPACITY 16
+
+static SymbolTable *create_symbol_table(const SymbolTable *parent)
+{
+    SymbolTable *table = safe_malloc(sizeof(SymbolTable));
+    table->capacity = SYMBOL_TABLE_INITIAL_CAPACITY;
+    table->count = 0;
+    table->slots = calloc(table->capacity, sizeof(SymbolSlot));
+    if (!table->slots)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for symbol table\n");
+        exit(EXIT_FAILURE);
+    }
+
+    table->undo_capacity = SYMBOL_TABLE_INITIAL_CAPACITY;
+    table->undo_count = 0;
+    table->undo_log = safe_malloc(table->undo_capacity * sizeof(Symbol *));
+
+    table->scope_capacity = SCOPE_STACK_INITIAL_CAPACITY;
+    table->depth = 0;
+    table->scope_marks = safe_malloc(table->scope_capacity * sizeof(size_t));
+
+    table->chunks = NULL;
+    table->symbol_count = 0;
+    table->parent = parent;
+    table->function_tables = NULL;
+    table->function_table_count = 0;
+    return table;
+}
+
+// Devuelve la ranura del nombre o la primera ranura vacía de su secuencia de sondeo
+static SymbolSlot *probe_slot(const SymbolTable *table, const char *name, unsigned int hash)
+{
+    size_t mask = table->capacity - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask)
+    {
+        SymbolSlot *slot = &table->slots[i];
+        if (!slot->name || (slot->hash == hash && strcmp(slot->name, name) == 0))
+            return slot;
+    }
+}
+
+static void grow_symbol_table(SymbolTable *table)
 {
+    SymbolSlot *old_slots = table->slots;
+    size_t old_capacity = table->capacity;
+
+    table->capacity = old_capacity * 2;
+    table->slots = calloc(table->capacity, sizeof(SymbolSlot));
+    if (!table->slots)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for symbol table\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Reinsertar usando el hash guardado, sin volver a comparar cadenas
+    size_t mask = table->capacity - 1;
+    for (size_t i = 0; i < old_capacity; i++)
+    {
+        if (!old_slots[i].name)
+            continue;
+        size_t j = old_slots[i].hash & mask;
+        while (table->slots[j].name)
+            j = (j + 1) & mask;
+        table->slots[j] = old_slots[i];
+    }
+    free(old_slots);
+}
+
+// Busca en el ámbito local y, si no está, en el global congelado (solo lectura)
+static Symbol *find_symbol(const SymbolTable *table, const char *name)
+{
+    unsigned int hash = jamz_hash_string(name);
     for (; table; table = table->parent)
     {
-        for (Symbol *sym = table->symbols; sym; sym = sym->next)
-        {
-            if (strcmp(sym->name, name) == 0)
-                return sym;
-        }
+        SymbolSlot *slot = probe_slot(table, name, hash);
+        if (slot->name && slot->binding)
+            return slot->binding;
     }
     return NULL;
 }
 
+static Symbol *alloc_symbol(SymbolTable *table)
+{
+    if (!table->chunks || table->chunks->used == SYMBOL_CHUNK_SIZE)
+    {
+        SymbolChunk *chunk = safe_malloc(sizeof(SymbolChunk));
+        chunk->used = 0;
+        chunk->next = table->chunks;
+        table->chunks = chunk;
+    }
+    return &table->chunks->symbols[table->chunks->used++];
+}
+
 // Cambiar asignaciones de sym->type para usar SymbolType en lugar de char *
-static void add_symbol(SymbolTable *table, const char *name, SymbolType type)
+static Symbol *add_symbol(SymbolTable *table, const char *name, SymbolType type, JAMZTypeId type_id)
 {
-    Symbol *sym = safe_malloc(sizeof(Symbol));
-    sym->name = strdup(name);
+    // Factor de carga máximo de 3/4
+    if ((table->count + 1) * 4 > table->capacity * 3)
+        grow_symbol_table(table);
+
+    unsigned int hash = jamz_hash_string(name);
+    SymbolSlot *slot = probe_slot(table, name, hash);
+    if (!slot->name)
+    {
+        slot->name = strdup(name);
+        slot->hash = hash;
+        slot->binding = NULL;
+        table->count++;
+    }
+
+    // Redeclaración en el mismo ámbito: se actualiza el símbolo existente
+    if (slot->binding && slot->binding->depth == table->depth)
+    {
+        slot->binding->type = type;
+        slot->binding->type_id = type_id;
+        return slot->binding;
+    }
+
+    Symbol *sym = alloc_symbol(table);
+    sym->name = slot->name;
     sym->type = type; // Usar directamente el enum SymbolType
-    sym->next = table->symbols;
-    table->symbols = sym;
+    sym->type_id = type_id;
+    sym->depth = table->depth;
+    sym->id = table->symbol_count++;
+    sym->shadowed = slot->binding;
+    slot->binding = sym;
+
+    if (table->undo_count >= table->undo_capacity)
+    {
+        table->undo_capacity *= 2;
+        table->undo_log = safe_realloc(table->undo_log, table->undo_capacity * sizeof(Symbol *));
+    }
+    table->undo_log[table->undo_count++] = sym;
+    return sym;
+}
+
+static void enter_scope(SymbolTable *table)
+{
+    if (table->depth >= table->scope_capacity)
+    {
+        table->scope_capacity *= 2;
+        table->scope_marks = safe_realloc(table->scope_marks, table->scope_capacity * sizeof(size_t));
+    }
+    table->scope_marks[table->depth++] = table->undo_count;
 }
 
-// Ajustar free_symbol_table para verificar el campo is_freed antes de liberar la tabla y marcarla como liberada después de la operación
+// Deshace las declaraciones del ámbito actual en orden inverso
+static void exit_scope(SymbolTable *table)
+{
+    size_t mark = table->scope_marks[--table->depth];
+    while (table->undo_count > mark)
+    {
+        Symbol *sym = table->undo_log[--table->undo_count];
+        SymbolSlot *slot = probe_slot(table, sym->name, jamz_hash_string(sym->name));
+        slot->binding = sym->shadowed;
+    }
+}
+
+// Libera la tabla junto con todos los símbolos que referencian los nodos del AST
 void free_symbol_table(SymbolTable *table)
 {
-    if (table == NULL || table->is_freed)
+    if (table == NULL)
     {
-        log_debug("[LOG] Intento de liberar una tabla ya liberada o nula.\n");
+        log_debug("[LOG] Intento de liberar una tabla nula.\n");
         return;
     }
 
-    Symbol *sym = table->symbols;
-    while (sym != NULL)
+    while (table->chunks)
+    {
+        SymbolChunk *next = table->chunks->next;
+        free(table->chunks);
+        table->chunks = next;
+    }
+    free(table->undo_log);
+    free(table->scope_marks);
+
+    for (size_t i = 0; i < table->capacity; i++)
     {
-        Symbol *next = sym->next;
-        if (sym->name != NULL)
+        if (table->slots[i].name != NULL)
         {
-            log_debug("[LOG] Liberando símbolo: %s\n", sym->name);
-            free(sym->name);
+            log_debug("[LOG] Liberando símbolo: %s\n", table->slots[i].name);
+            free(table->slots[i].name);
         }
-        free(sym);
-        sym = next;
     }
+    free(table->slots);
+
+    for (size_t i = 0; i < table->function_table_count; i++)
+        free_symbol_table(table->function_tables[i]);
+    free(table->function_tables);
 
-    table->is_freed = true; // Marcar la tabla como liberada
     log_debug("[LOG] Tabla de símbolos liberada correctamente.\n");
+    free(table);
 }
 
-static bool is_keyword_of_category(const char *name, const char *category, Keyword *keywords, int count)
+static unsigned int parse_keyword_category(const char *category)
 {
-    for (int i = 0; i < count; i++)
+    if (strcmp(category, "type") == 0)
+        return KEYWORD_CATEGORY_TYPE;
+    if (strcmp(category, "control") == 0)
+        return KEYWORD_CATEGORY_CONTROL;
+    if (strcmp(category, "function") == 0)
+        return KEYWORD_CATEGORY_FUNCTION;
+    return KEYWORD_CATEGORY_NONE;
+}
+
+static KeywordEntry *probe_keyword(const KeywordIndex *index, const char *name, unsigned int hash)
+{
+    size_t mask = index->capacity - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask)
     {
-        if (strcmp(keywords[i].name, name) == 0 && strcmp(keywords[i].category, category) == 0)
-        {
-            return true;
-        }
+        KeywordEntry *entry = &index->entries[i];
+        if (!entry->name || (entry->hash == hash && strcmp(entry->name, name) == 0))
+            return entry;
     }
-    return false;
 }
 
-static bool is_valid_type(const char *name, Keyword *keywords, int count)
+KeywordIndex *build_keyword_index(const Keyword *keywords, int keyword_count)
 {
-    for (int i = 0; i < count; i++)
+    KeywordIndex *index = safe_malloc(sizeof(KeywordIndex));
+
+    // Capacidad potencia de dos con factor de carga máximo de 1/2
+    index->capacity = 16;
+    while (index->capacity < (size_t)keyword_count * 2)
+        index->capacity *= 2;
+    index->count = 0;
+    index->entries = calloc(index->capacity, sizeof(KeywordEntry));
+    if (!index->entries)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for keyword index\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < keyword_count; i++)
     {
-        if (strcmp(keywords[i].name, name) == 0 && strcmp(keywords[i].category, "type") == 0)
+        unsigned int hash = jamz_hash_string(keywords[i].name);
+        KeywordEntry *entry = probe_keyword(index, keywords[i].name, hash);
+        if (!entry->name)
         {
-            return true;
+            entry->name = strdup(keywords[i].name);
+            entry->hash = hash;
+            entry->categories = KEYWORD_CATEGORY_NONE;
+            index->count++;
         }
+        entry->categories |= parse_keyword_category(keywords[i].category);
     }
-    return false;
+
+    log_debug("[LOG] Índice de keywords construido: %zu entradas en %zu ranuras\n", index->count, index->capacity);
+    return index;
 }
 
-static bool is_control_keyword(const char *name, Keyword *keywords, int count)
+unsigned int keyword_categories(const KeywordIndex *index, const char *name)
 {
-    return is_keyword_of_category(name, "control", keywords, count);
+    const KeywordEntry *entry = probe_keyword(index, name, jamz_hash_string(name));
+    return entry->name ? entry->categories : KEYWORD_CATEGORY_NONE;
 }
 
-// Ajustar comparaciones en analyze_node_with_symbols para usar SymbolType
-static void analyze_node_with_symbols(JAMZASTNode *ast, Keyword *keywords, int keyword_count, SymbolTable *table)
+void free_keyword_index(KeywordIndex *index)
 {
-    if (!ast)
+    if (!index)
+        return;
+
+    for (size_t i = 0; i < index->capacity; i++)
+        free(index->entries[i].name);
+    free(index->entries);
+    free(index);
+}
+
+static bool is_keyword_of_category(const char *name, unsigned int category, const KeywordIndex *index)
+{
+    return (keyword_categories(index, name) & category) != 0;
+}
+
+static bool is_valid_type(const char *name, const KeywordIndex *index)
+{
+    return is_keyword_of_category(name, KEYWORD_CATEGORY_TYPE, index);
+}
+
+static bool is_control_keyword(const char *name, const KeywordIndex *index)
+{
+    return is_keyword_of_category(name, KEYWORD_CATEGORY_CONTROL, index);
+}
+
+// La ubicación se guarda aparte del texto y se añade al volcar los
+// diagnósticos, así los de una función reutilizada se pueden desplazar
+typedef struct
+{
+    int line;
+    int column;
+    bool has_location;
+    char message[MAX_ERROR_LEN];
+} SemanticDiagnostic;
+
+// Estado de análisis de una función: su propia pila de ámbitos y su propio
+// búfer de diagnósticos, de modo que cada hilo trabaja sin compartir nada
+// mutable. El ámbito global y la tabla de tipos solo se leen.
+typedef struct
+{
+    SymbolTable *table;
+    const KeywordIndex *index;
+    JAMZTypeId return_type; // Tipo de retorno de la función en análisis
+    JAMZTypeId string_type; // char*, internado antes de la fase paralela
+    SemanticDiagnostic *diagnostics;
+    size_t diagnostic_count;
+    size_t diagnostic_capacity;
+    // Llamadas a funciones globales y la firma que resolvieron: son las
+    // únicas lecturas de la función que dependen de otras declaraciones
+    JAMZASTNode **calls;
+    JAMZTypeId *call_signatures;
+    size_t call_count;
+    size_t call_capacity;
+    int loop_depth; // Bucles que rodean la sentencia en análisis (break/continue)
+} SemanticContext;
+
+// node puede ser NULL para errores sin ubicación en el fuente
+static void report_error(SemanticContext *ctx, const JAMZASTNode *node, const char *format, ...)
+{
+    if (ctx->diagnostic_count >= ctx->diagnostic_capacity)
     {
-        log_debug("Nodo AST nulo\n");
+        ctx->diagnostic_capacity = ctx->diagnostic_capacity ? ctx->diagnostic_capacity * 2 : 8;
+        ctx->diagnostics = safe_realloc(ctx->diagnostics, ctx->diagnostic_capacity * sizeof(SemanticDiagnostic));
+    }
+
+    SemanticDiagnostic *diag = &ctx->diagnostics[ctx->diagnostic_count];
+    diag->line = node ? node->line : 0;
+    diag->column = node ? node->column : 0;
+    diag->has_location = node != NULL;
+    ctx->diagnostic_count++;
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(diag->message, sizeof(diag->message), format, args);
+    va_end(args);
+}
+
+static JAMZTypeId literal_type(const SemanticContext *ctx, JAMZTokenType token_type)
+{
+    switch (token_type)
+    {
+    case JAMZ_TOKEN_NUMBER:
+        return JAMZ_TYPE_INT;
+    case JAMZ_TOKEN_STRING:
+        return ctx->string_type;
+    default:
+        return JAMZ_TYPE_INVALID;
+    }
+}
+
+static Symbol *resolve_variable(SemanticContext *ctx, JAMZASTNode *ast, const char *name)
+{
+    Symbol *sym = find_symbol(ctx->table, name);
+    if (!sym || sym->type != SYMBOL_VARIABLE)
+    {
+        report_error(ctx, ast, "Variable '%s' no declarada", name);
+        return NULL;
+    }
+    ast->symbol = sym;
+    return sym;
+}
+
+static void infer_expression(SemanticContext *ctx, JAMZASTNode *ast);
+
+// nombre[index] sobre el símbolo ya resuelto: devuelve el tipo del elemento,
+// o JAMZ_TYPE_INVALID si el nombre no es un arreglo o el índice no es int
+static JAMZTypeId analyze_subscript(SemanticContext *ctx, JAMZASTNode *ast, const Symbol *sym, JAMZASTNode *index)
+{
+    infer_expression(ctx, index);
+    const JAMZTypeInfo *info = jamz_type_info(sym->type_id);
+    if (!info || info->kind != JAMZ_TYPE_KIND_ARRAY)
+    {
+        report_error(ctx, ast, "'%s' no es un arreglo", sym->name);
+        return JAMZ_TYPE_INVALID;
+    }
+    if (index->inferred_type != JAMZ_TYPE_INVALID && index->inferred_type != JAMZ_TYPE_INT)
+    {
+        report_error(ctx, index, "El índice de '%s' debe ser de tipo 'int' y es '%s'", sym->name,
+                     jamz_type_name(index->inferred_type));
+        return JAMZ_TYPE_INVALID;
+    }
+    return info->base;
+}
+
+static void analyze_assignment(SemanticContext *ctx, JAMZASTNode *ast)
+{
+    Symbol *sym = find_symbol(ctx->table, ast->assignment.var_name);
+    if (!sym || sym->type != SYMBOL_VARIABLE)
+    {
+        report_error(ctx, ast, "Variable '%s' no declarada", ast->assignment.var_name);
+        return;
+    }
+    ast->symbol = sym;
+    ast->inferred_type = sym->type_id;
+
+    // Un arreglo solo se asigna elemento a elemento
+    JAMZTypeId target = sym->type_id;
+    if (ast->assignment.index)
+    {
+        target = analyze_subscript(ctx, ast, sym, ast->assignment.index);
+        ast->inferred_type = target;
+        if (target == JAMZ_TYPE_INVALID)
+            return;
+    }
+    else if (jamz_type_is_array(sym->type_id))
+    {
+        report_error(ctx, ast, "No se puede asignar el arreglo '%s' entero; se asigna elemento a elemento",
+                     ast->assignment.var_name);
         return;
     }
-    log_debug("Analizando nodo AST de tipo %d\n", ast->type);
+
+    if (!ast->assignment.value)
+        return;
+    infer_expression(ctx, ast->assignment.value);
+
+    JAMZTypeId rhs_type = ast->assignment.value->inferred_type;
+    if (rhs_type != JAMZ_TYPE_INVALID && !jamz_type_is_assignable(target, rhs_type))
+    {
+        report_error(ctx, ast, "Incompatibilidad de tipos: no se puede asignar '%s' a la variable '%s' de tipo '%s'",
+                     jamz_type_name(rhs_type), ast->assignment.var_name, jamz_type_name(target));
+    }
+}
+
+static void record_call(SemanticContext *ctx, JAMZASTNode *call, JAMZTypeId signature)
+{
+    if (ctx->call_count == ctx->call_capacity)
+    {
+        ctx->call_capacity = ctx->call_capacity ? ctx->call_capacity * 2 : 8;
+        ctx->calls = safe_realloc(ctx->calls, ctx->call_capacity * sizeof(JAMZASTNode *));
+        ctx->call_signatures = safe_realloc(ctx->call_signatures, ctx->call_capacity * sizeof(JAMZTypeId));
+    }
+    ctx->calls[ctx->call_count] = call;
+    ctx->call_signatures[ctx->call_count] = signature;
+    ctx->call_count++;
+}
+
+static void analyze_call(SemanticContext *ctx, JAMZASTNode *ast)
+{
+    Symbol *sym = find_symbol(ctx->table, ast->call.name);
+    const JAMZTypeInfo *signature = sym && sym->type == SYMBOL_FUNCTION ? jamz_type_info(sym->type_id) : NULL;
+
+    for (size_t i = 0; i < ast->call.arg_count; i++)
+        infer_expression(ctx, ast->call.args[i]);
+
+    if (!sym || sym->type != SYMBOL_VARIABLE)
+        record_call(ctx, ast, sym ? sym->type_id : JAMZ_TYPE_INVALID);
+
+    if (!signature)
+    {
+        report_error(ctx, ast, "Función '%s' no declarada", ast->call.name);
+        return;
+    }
+    ast->symbol = sym;
+    ast->inferred_type = signature->base;
+
+    if (ast->call.arg_count != signature->param_count)
+    {
+        report_error(ctx, ast, "La función '%s' espera %zu argumentos pero recibe %zu",
+                     ast->call.name, signature->param_count, ast->call.arg_count);
+        return;
+    }
+    for (size_t i = 0; i < ast->call.arg_count; i++)
+    {
+        JAMZTypeId arg_type = ast->call.args[i]->inferred_type;
+        if (arg_type != JAMZ_TYPE_INVALID && !jamz_type_is_assignable(signature->params[i], arg_type))
+        {
+            report_error(ctx, ast->call.args[i], "Argumento %zu de '%s': se esperaba '%s' y se recibe '%s'",
+                         i + 1, ast->call.name, jamz_type_name(signature->params[i]), jamz_type_name(arg_type));
+        }
+    }
+}
+
+// Pasada de abajo hacia arriba: cada nodo de expresión guarda su tipo (y su
+// símbolo si es una variable) y los padres leen ese resultado de sus hijos.
+// Si hay un error el tipo queda en JAMZ_TYPE_INVALID y no se vuelve a reportar.
+static void infer_expression(SemanticContext *ctx, JAMZASTNode *ast)
+{
+    if (!ast)
+        return;
+
     switch (ast->type)
     {
     case JAMZ_AST_LITERAL:
-        if (ast->literal.value)
+        ast->inferred_type = literal_type(ctx, ast->literal.token_type);
+        if (ast->inferred_type == JAMZ_TYPE_INVALID)
         {
-            log_debug("Literal encontrado: %s\n", ast->literal.value);
-            JAMZTokenType ttype = ast->literal.token_type;
-            if (ttype != JAMZ_TOKEN_NUMBER && ttype != JAMZ_TOKEN_STRING && ttype != JAMZ_TOKEN_CHAR)
-            {
-                print_error("Unknown literal: '%s' (line %d, col %d)\n",
-                            ast->literal.value, ast->line, ast->column);
-            }
+            report_error(ctx, ast, "Literal desconocido: '%s'", ast->literal.value);
         }
         break;
     case JAMZ_AST_VARIABLE:
-        if (!find_symbol(table, ast->variable.var_name))
-        {
-            push_error("Variable '%s' not declared (line %d, col %d)\n", ast->variable.var_name, ast->line, ast->column);
-        }
+    {
+        Symbol *sym = resolve_variable(ctx, ast, ast->variable.var_name);
+        if (sym && jamz_type_is_array(sym->type_id))
+            report_error(ctx, ast, "El arreglo '%s' solo se puede usar con un índice", ast->variable.var_name);
+        else if (sym)
+            ast->inferred_type = sym->type_id;
         break;
-    case JAMZ_AST_DECLARATION:
-        log_debug("Declaración de variable: %s de tipo %s\n", ast->declaration.var_name, ast->declaration.type_name);
-        SymbolType type;
-        if (strcmp(ast->declaration.type_name, "int") == 0)
-            type = SYMBOL_INT;
-        else if (strcmp(ast->declaration.type_name, "float") == 0)
-            type = SYMBOL_FLOAT;
-        else if (strcmp(ast->declaration.type_name, "string") == 0)
-            type = SYMBOL_STRING;
-        else if (strcmp(ast->declaration.type_name, "char") == 0)
-            type = SYMBOL_STRING;
-        else
-        {
-            push_error("Tipo '%s' no válido para la variable '%s' (línea %d, col %d)\n",
-                       ast->declaration.type_name, ast->declaration.var_name, ast->line, ast->column);
-            return;
-        }
-        add_symbol(table, ast->declaration.var_name, type);
-        if (ast->declaration.initializer)
-            analyze_node_with_symbols(ast->declaration.initializer, keywords, keyword_count, table);
+    }
+    case JAMZ_AST_INDEX:
+    {
+        Symbol *sym = resolve_variable(ctx, ast, ast->index.var_name);
+        if (sym)
+            ast->inferred_type = analyze_subscript(ctx, ast, sym, ast->index.index);
         break;
+    }
     case JAMZ_AST_ASSIGNMENT:
+        analyze_assignment(ctx, ast);
+        break;
+    case JAMZ_AST_CALL:
+        analyze_call(ctx, ast);
+        break;
+    case JAMZ_AST_BINARY:
     {
-        log_debug("Asignación a la variable: %s\n", ast->assignment.var_name);
-        Symbol *sym = find_symbol(table, ast->assignment.var_name);
-        if (!sym)
+        infer_expression(ctx, ast->binary.left);
+        infer_expression(ctx, ast->binary.right);
+
+        JAMZTypeId left_type = ast->binary.left ? ast->binary.left->inferred_type : JAMZ_TYPE_INVALID;
+        JAMZTypeId right_type = ast->binary.right ? ast->binary.right->inferred_type : JAMZ_TYPE_INVALID;
+        if (left_type != JAMZ_TYPE_INVALID && right_type != JAMZ_TYPE_INVALID && left_type != right_type)
         {
-            push_error("Variable '%s' no declarada (línea %d, col %d)\n", ast->assignment.var_name, ast->line, ast->column);
-            return;
+            report_error(ctx, ast, "Incompatibilidad de tipos en operación binaria: '%s' vs '%s'",
+                         jamz_type_name(left_type), jamz_type_name(right_type));
         }
-        SymbolType rhs_type;
-        if (ast->assignment.value->type == JAMZ_AST_LITERAL)
+        else if (left_type != JAMZ_TYPE_INVALID && left_type != JAMZ_TYPE_INT)
         {
-            if (ast->assignment.value->literal.token_type == JAMZ_TOKEN_NUMBER)
-                rhs_type = SYMBOL_INT;
-            else if (ast->assignment.value->literal.token_type == JAMZ_TOKEN_STRING)
-                rhs_type = SYMBOL_STRING;
-            else
-            {
-                push_error("Tipo de literal no soportado (línea %d, col %d)\n", ast->line, ast->column);
-                return;
-            }
+            report_error(ctx, ast, "Solo se admite el tipo 'int' en operaciones binarias");
         }
-        else
+        else if (left_type != JAMZ_TYPE_INVALID && right_type != JAMZ_TYPE_INVALID)
         {
-            push_error("Tipo de asignación no soportado (línea %d, col %d)\n", ast->line, ast->column);
-            return;
+            ast->inferred_type = JAMZ_TYPE_INT;
         }
-        if (sym->type != rhs_type)
+        break;
+    }
+    default:
+        report_error(ctx, ast, "Expresión no soportada");
+        break;
+    }
+}
+
+static void analyze_declaration(SemanticContext *ctx, JAMZASTNode *ast)
+{
+    if (is_valid_type(ast->declaration.var_name, ctx->index) || is_control_keyword(ast->declaration.var_name, ctx->index))
+    {
+        report_error(ctx, ast, "No se puede usar la palabra reservada '%s' como nombre de variable",
+                     ast->declaration.var_name);
+        return;
+    }
+    if (ast->declaration.type_id == JAMZ_TYPE_INVALID || ast->declaration.type_id == JAMZ_TYPE_VOID)
+    {
+        report_error(ctx, ast, "Tipo '%s' no válido para la variable '%s'",
+                     jamz_type_name(ast->declaration.type_id), ast->declaration.var_name);
+        return;
+    }
+    ast->symbol = add_symbol(ctx->table, ast->declaration.var_name, SYMBOL_VARIABLE, ast->declaration.type_id);
+    ast->inferred_type = ast->declaration.type_id;
+    if (jamz_type_is_array(ast->declaration.type_id))
+    {
+        // Los backends reservan 4 bytes por elemento: solo hay arreglos de int
+        if (jamz_type_info(ast->declaration.type_id)->base != JAMZ_TYPE_INT)
+            report_error(ctx, ast, "Solo se admiten arreglos de 'int' ('%s' es '%s')", ast->declaration.var_name,
+                         jamz_type_name(ast->declaration.type_id));
+        if (ast->declaration.initializer)
+            report_error(ctx, ast, "El arreglo '%s' no admite inicializador", ast->declaration.var_name);
+        return;
+    }
+
+    JAMZASTNode *init = ast->declaration.initializer;
+    if (init)
+    {
+        infer_expression(ctx, init);
+        if (init->inferred_type != JAMZ_TYPE_INVALID &&
+            !jamz_type_is_assignable(ast->declaration.type_id, init->inferred_type))
         {
-            push_error("Incompatibilidad de tipos: no se puede asignar '%d' a la variable '%s' de tipo '%d' (línea %d, col %d)\n",
-                       rhs_type, ast->assignment.var_name, sym->type, ast->line, ast->column);
+            report_error(ctx, ast, "Incompatibilidad de tipos: no se puede inicializar la variable '%s' de tipo '%s' con '%s'",
+                         ast->declaration.var_name, jamz_type_name(ast->declaration.type_id),
+                         jamz_type_name(init->inferred_type));
         }
-        analyze_node_with_symbols(ast->assignment.value, keywords, keyword_count, table);
-        break;
     }
+}
+
+static void analyze_return(SemanticContext *ctx, JAMZASTNode *ast)
+{
+    JAMZASTNode *value = ast->return_stmt.value;
+    if (!value)
+    {
+        if (ctx->return_type != JAMZ_TYPE_VOID)
+        {
+            report_error(ctx, ast, "Se esperaba un valor de retorno de tipo '%s'",
+                         jamz_type_name(ctx->return_type));
+        }
+        return;
+    }
+
+    infer_expression(ctx, value);
+    if (ctx->return_type == JAMZ_TYPE_VOID)
+    {
+        report_error(ctx, ast, "Una función 'void' no puede devolver un valor");
+    }
+    else if (value->inferred_type != JAMZ_TYPE_INVALID && !jamz_type_is_assignable(ctx->return_type, value->inferred_type))
+    {
+        report_error(ctx, ast, "Incompatibilidad de tipos: se devuelve '%s' en una función de tipo '%s'",
+                     jamz_type_name(value->inferred_type), jamz_type_name(ctx->return_type));
+    }
+}
+
+static void analyze_node_with_symbols(SemanticContext *ctx, JAMZASTNode *ast)
+{
+    if (!ast)
+    {
+        log_debug("Nodo AST nulo\n");
+        return;
+    }
+    switch (ast->type)
+    {
+    case JAMZ_AST_DECLARATION:
+        analyze_declaration(ctx, ast);
+        break;
+    case JAMZ_AST_ASSIGNMENT:
+        analyze_assignment(ctx, ast);
+        break;
     case JAMZ_AST_BLOCK:
-    case JAMZ_AST_PROGRAM:
     {
-        log_debug("Creando tabla de símbolos local\n");
-        SymbolTable *local = safe_malloc(sizeof(SymbolTable));
-        local->symbols = NULL;
-        local->parent = table;
-        log_debug("Creando tabla de símbolos local en %p\n", (void *)local);
+        enter_scope(ctx->table);
         for (size_t i = 0; i < ast->block.count; i++)
         {
-            analyze_node_with_symbols(ast->block.statements[i], keywords, keyword_count, local);
+            analyze_node_with_symbols(ctx, ast->block.statements[i]);
         }
-        // free_symbol_table(local);
+        exit_scope(ctx->table);
         break;
     }
     case JAMZ_AST_IF:
         if (ast->if_stmt.condition)
-            analyze_node_with_symbols(ast->if_stmt.condition, keywords, keyword_count, table);
+            infer_expression(ctx, ast->if_stmt.condition);
         if (ast->if_stmt.then_branch)
-            analyze_node_with_symbols(ast->if_stmt.then_branch, keywords, keyword_count, table);
+            analyze_node_with_symbols(ctx, ast->if_stmt.then_branch);
         if (ast->if_stmt.else_branch)
-            analyze_node_with_symbols(ast->if_stmt.else_branch, keywords, keyword_count, table);
+            analyze_node_with_symbols(ctx, ast->if_stmt.else_branch);
+        break;
+    case JAMZ_AST_WHILE:
+        if (ast->while_stmt.condition)
+            infer_expression(ctx, ast->while_stmt.condition);
+        ctx->loop_depth++;
+        analyze_node_with_symbols(ctx, ast->while_stmt.body);
+        // El paso corre en el ámbito del for, fuera del cuerpo
+        if (ast->while_stmt.step)
+            analyze_node_with_symbols(ctx, ast->while_stmt.step);
+        ctx->loop_depth--;
+        break;
+    case JAMZ_AST_BREAK:
+    case JAMZ_AST_CONTINUE:
+        if (ctx->loop_depth == 0)
+            report_error(ctx, ast, "'%s' fuera de un bucle", ast->type == JAMZ_AST_BREAK ? "break" : "continue");
         break;
     case JAMZ_AST_RETURN:
-        if (ast->return_stmt.value)
-            analyze_node_with_symbols(ast->return_stmt.value, keywords, keyword_count, table);
+        analyze_return(ctx, ast);
         break;
+    case JAMZ_AST_LITERAL:
+    case JAMZ_AST_VARIABLE:
+    case JAMZ_AST_INDEX:
     case JAMZ_AST_BINARY:
+    case JAMZ_AST_CALL:
+        infer_expression(ctx, ast);
+        break;
+    default:
+        log_debug("Nodo AST no manejado: tipo %d\n", ast->type);
+        break;
+    }
+}
+
+// Parámetros y cuerpo comparten el ámbito más externo de la función
+static void analyze_function(SemanticContext *ctx, JAMZASTNode *function)
+{
+    ctx->return_type = function->function.return_type;
+
+    enter_scope(ctx->table);
+    for (size_t i = 0; i < function->function.param_count; i++)
+        analyze_declaration(ctx, function->function.params[i]);
+
+    JAMZASTNode *body = function->function.body;
+    for (size_t i = 0; i < body->block.count; i++)
+        analyze_node_with_symbols(ctx, body->block.statements[i]);
+    exit_scope(ctx->table);
+}
+
+// Fase secuencial: registra todas las funciones en el ámbito global
+static void declare_functions(SemanticContext *ctx, JAMZASTNode *program)
+{
+    bool has_main = false;
+
+    for (size_t i = 0; i < program->block.count; i++)
     {
-        const char *left_type = NULL;
-        const char *right_type = NULL;
-        if (ast->binary.left)
+        JAMZASTNode *function = program->block.statements[i];
+        const char *name = function->function.name;
+
+        Symbol *existing = find_symbol(ctx->table, name);
+        if (existing && existing->type == SYMBOL_FUNCTION)
         {
-            analyze_node_with_symbols(ast->binary.left, keywords, keyword_count, table);
-            if (ast->binary.left->type == JAMZ_AST_LITERAL)
-            {
-                JAMZTokenType ttype = ast->binary.left->literal.token_type;
-                if (ttype == JAMZ_TOKEN_NUMBER)
-                    left_type = "int";
-                else if (ttype == JAMZ_TOKEN_STRING)
-                    left_type = "char*";
-            }
-            else if (ast->binary.left->type == JAMZ_AST_VARIABLE)
-            {
-                Symbol *sym = find_symbol(table, ast->binary.left->variable.var_name);
-                if (sym)
-                    left_type = sym->type == SYMBOL_INT ? "int" : "char*";
-            }
+            report_error(ctx, function, "Función '%s' redefinida", name);
+            continue;
+        }
+
+        size_t param_count = function->function.param_count;
+        JAMZTypeId *params = safe_malloc((param_count ? param_count : 1) * sizeof(JAMZTypeId));
+        for (size_t p = 0; p < param_count; p++)
+            params[p] = function->function.params[p]->declaration.type_id;
+        JAMZTypeId signature = jamz_type_function(function->function.return_type, params, param_count);
+        free(params);
+
+        function->symbol = add_symbol(ctx->table, name, SYMBOL_FUNCTION, signature);
+        function->inferred_type = signature;
+
+        if (strcmp(name, "main") == 0)
+            has_main = true;
+    }
+
+    if (!has_main)
+        report_error(ctx, NULL, "No se encontró la función 'main'");
+}
+
+typedef struct
+{
+    JAMZASTNode *program;
+    SemanticContext *contexts; // Uno por función, en el orden del programa
+    const size_t *pending;     // Índices de las funciones a analizar
+    size_t pending_count;
+    size_t next;
+    double cpu_ms;     // CPU de todos los hilos en la fase
+    double busiest_ms; // CPU del hilo más cargado: con un núcleo por hilo, la fase no dura menos
+    pthread_mutex_t lock;
+} FunctionQueue;
+
+static void *function_worker(void *arg)
+{
+    FunctionQueue *queue = arg;
+    double start = jamz_thread_cpu_ms();
+
+    for (;;)
+    {
+        pthread_mutex_lock(&queue->lock);
+        size_t i = queue->next++;
+        pthread_mutex_unlock(&queue->lock);
+
+        if (i >= queue->pending_count)
+            break;
+        size_t f = queue->pending[i];
+        analyze_function(&queue->contexts[f], queue->program->block.statements[f]);
+    }
+
+    double spent = jamz_thread_cpu_ms() - start;
+    pthread_mutex_lock(&queue->lock);
+    queue->cpu_ms += spent;
+    if (spent > queue->busiest_ms)
+        queue->busiest_ms = spent;
+    pthread_mutex_unlock(&queue->lock);
+    return NULL;
+}
+
+// Fase paralela: analiza las funciones indicadas, cada una en su contexto
+static void run_function_workers(JAMZASTNode *program, SemanticContext *contexts,
+                                 const size_t *pending, size_t pending_count)
+{
+    size_t workers = jamz_worker_count();
+    if (workers > pending_count)
+        workers = pending_count;
+
+    FunctionQueue queue = {program, contexts, pending, pending_count, 0, 0.0, 0.0, PTHREAD_MUTEX_INITIALIZER};
+    if (workers <= 1)
+    {
+        function_worker(&queue);
+    }
+    else
+    {
+        // Los hilos solo registran lo anómalo, pero el log se abre antes de
+        // lanzarlos: abrirlo entre ellos sería una carrera
+        log_open();
+        log_debug("[LOG] Analizando %zu funciones con %zu hilos\n", pending_count, workers);
+        pthread_t *threads = safe_malloc(workers * sizeof(pthread_t));
+        size_t started = 0;
+        for (; started < workers; started++)
+        {
+            if (pthread_create(&threads[started], NULL, function_worker, &queue) != 0)
+                break;
         }
-        if (ast->binary.right)
+        if (started == 0)
+            function_worker(&queue); // Sin hilos disponibles: se analiza aquí
+        for (size_t i = 0; i < started; i++)
+            pthread_join(threads[i], NULL);
+        free(threads);
+    }
+    // Reparto del trabajo, medido en CPU y no en tiempo de pared para que
+    // valga también con menos núcleos que hilos (bench/parallel)
+    log_debug("[LOG] Fase paralela: %zu funciones, %.3f ms de CPU, %.3f ms el hilo más cargado\n",
+              pending_count, queue.cpu_ms, queue.busiest_ms);
+    pthread_mutex_destroy(&queue.lock);
+}
+
+// Ámbito global con los tipos y palabras de función del índice de keywords
+static SymbolTable *create_global_table(const KeywordIndex *index)
+{
+    SymbolTable *global = create_symbol_table(NULL);
+
+    for (size_t i = 0; i < index->capacity; i++)
+    {
+        const KeywordEntry *entry = &index->entries[i];
+        if (!entry->name)
+            continue;
+        if (entry->categories & KEYWORD_CATEGORY_TYPE)
         {
-            analyze_node_with_symbols(ast->binary.right, keywords, keyword_count, table);
-            if (ast->binary.right->type == JAMZ_AST_LITERAL)
-            {
-                JAMZTokenType ttype = ast->binary.right->literal.token_type;
-                if (ttype == JAMZ_TOKEN_NUMBER)
-                    right_type = "int";
-                else if (ttype == JAMZ_TOKEN_STRING)
-                    right_type = "char*";
-            }
-            else if (ast->binary.right->type == JAMZ_AST_VARIABLE)
-            {
-                Symbol *sym = find_symbol(table, ast->binary.right->variable.var_name);
-                if (sym)
-                    right_type = sym->type == SYMBOL_INT ? "int" : "char*";
-            }
+            add_symbol(global, entry->name, SYMBOL_TYPE, jamz_type_from_name(entry->name));
         }
-        if (left_type && right_type && strcmp(left_type, right_type) != 0)
+        else if (entry->categories & KEYWORD_CATEGORY_FUNCTION)
         {
-            push_error("Type mismatch in binary operation: '%s' vs '%s' (line %d, col %d)\n",
-                       left_type, right_type, ast->line, ast->column);
+            add_symbol(global, entry->name, SYMBOL_FUNCTION, JAMZ_TYPE_INVALID);
         }
-        else if (left_type && strcmp(left_type, "int") != 0)
+    }
+    return global;
+}
+
+static int compare_diagnostics(const void *a, const void *b)
+{
+    const SemanticDiagnostic *left = *(const SemanticDiagnostic *const *)a;
+    const SemanticDiagnostic *right = *(const SemanticDiagnostic *const *)b;
+
+    if (left->line != right->line)
+        return left->line < right->line ? -1 : 1;
+    if (left->column != right->column)
+        return left->column < right->column ? -1 : 1;
+    if (left != right)
+        return left < right ? -1 : 1; // Los búferes se recorren en orden de programa
+    return 0;
+}
+
+// Ordena todos los diagnósticos por posición en el fuente y los vuelca en la
+// pila de errores; el resultado no depende del reparto entre hilos.
+static void merge_diagnostics(SemanticContext *contexts, size_t count)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++)
+        total += contexts[i].diagnostic_count;
+    if (total == 0)
+        return;
+
+    // Todos los búferes se copian a un único bloque para que el desempate por
+    // dirección respete el orden de función y de emisión
+    SemanticDiagnostic *all = safe_malloc(total * sizeof(SemanticDiagnostic));
+    const SemanticDiagnostic **sorted = safe_malloc(total * sizeof(SemanticDiagnostic *));
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        for (size_t d = 0; d < contexts[i].diagnostic_count; d++, n++)
         {
-            push_error("Only 'int' type supported in binary operations (line %d, col %d)\n", ast->line, ast->column);
+            all[n] = contexts[i].diagnostics[d];
+            sorted[n] = &all[n];
         }
-        break;
     }
-    default:
-        log_debug("Nodo AST no manejado: tipo %d\n", ast->type);
-        break;
+
+    qsort(sorted, total, sizeof(SemanticDiagnostic *), compare_diagnostics);
+    for (size_t i = 0; i < total; i++)
+    {
+        if (sorted[i]->has_location)
+            push_error("%s (línea %d, col %d)\n", sorted[i]->message, sorted[i]->line, sorted[i]->column);
+        else
+            push_error("%s\n", sorted[i]->message);
     }
+
+    free(sorted);
+    free(all);
 }
 
-// Imprime la tabla de símbolos como un árbol (solo la tabla actual, no los padres)
+// Imprime los símbolos visibles en la tabla (tras el análisis, solo el ámbito global)
 void print_symbol_table_ast(const SymbolTable *table, int indent)
 {
     if (!table)
@@ -271,53 +895,383 @@ void print_symbol_table_ast(const SymbolTable *table, int indent)
     printf("\nSymbol Table:\n");
 
     set_console_color(FOREGROUND_GREEN | FOREGROUND_INTENSITY); // Símbolos en verde brillante
-    for (const Symbol *sym = table->symbols; sym; sym = sym->next)
+    for (size_t s = 0; s < table->capacity; s++)
     {
+        const Symbol *sym = table->slots[s].binding;
+        if (!table->slots[s].name || !sym)
+            continue;
         for (int i = 0; i < indent; ++i)
             printf("  ");
-        printf("|- %s : %d\n", sym->name, sym->type);
+        if (sym->type_id != JAMZ_TYPE_INVALID)
+            printf("|- %s : %s\n", sym->name, jamz_type_name(sym->type_id));
+        else
+            printf("|- %s : %s\n", sym->name, sym->type == SYMBOL_FUNCTION ? "function" : "type");
     }
 
     set_console_color(FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE); // Restaurar color predeterminado
 }
 
-// Agregar un indicador para rastrear si la tabla ya fue liberada
-static bool is_table_freed(SymbolTable *table)
+// Modificar analyze_semantics para evitar llamadas redundantes
+SymbolTable *analyze_semantics(JAMZASTNode *ast, const KeywordIndex *index)
 {
-    return table == NULL || (table->symbols == NULL && table->parent == NULL);
+    SymbolTable *global = create_global_table(index);
+
+    size_t function_count = ast->block.count;
+    // El contexto extra (último) recoge los errores de la fase global
+    SemanticContext *contexts = calloc(function_count + 1, sizeof(SemanticContext));
+    if (!contexts)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for semantic contexts\n");
+        exit(EXIT_FAILURE);
+    }
+
+    SemanticContext *global_ctx = &contexts[function_count];
+    global_ctx->table = global;
+    global_ctx->index = index;
+    global_ctx->string_type = jamz_type_pointer_to(JAMZ_TYPE_CHAR);
+    declare_functions(global_ctx, ast);
+
+    // A partir de aquí el ámbito global y la tabla de tipos quedan congelados
+    for (size_t i = 0; i < function_count; i++)
+    {
+        contexts[i].table = create_symbol_table(global);
+        contexts[i].index = index;
+        contexts[i].string_type = global_ctx->string_type;
+    }
+
+    size_t *pending = safe_malloc((function_count ? function_count : 1) * sizeof(size_t));
+    for (size_t i = 0; i < function_count; i++)
+        pending[i] = i;
+    run_function_workers(ast, contexts, pending, function_count);
+    free(pending);
+
+    // Errores globales primero dentro de la misma posición
+    SemanticContext *ordered = safe_malloc((function_count + 1) * sizeof(SemanticContext));
+    ordered[0] = *global_ctx;
+    memcpy(ordered + 1, contexts, function_count * sizeof(SemanticContext));
+    merge_diagnostics(ordered, function_count + 1);
+    free(ordered);
+
+    // Las tablas locales se conservan: los nodos apuntan a sus símbolos
+    global->function_tables = safe_malloc((function_count ? function_count : 1) * sizeof(SymbolTable *));
+    global->function_table_count = function_count;
+    for (size_t i = 0; i <= function_count; i++)
+    {
+        if (i < function_count)
+            global->function_tables[i] = contexts[i].table;
+        free(contexts[i].diagnostics);
+        free(contexts[i].calls);
+        free(contexts[i].call_signatures);
+    }
+    free(contexts);
+
+    print_symbol_table_ast(global, 0);
+
+    return global;
 }
 
-// Modificar analyze_semantics para evitar llamadas redundantes
-void analyze_semantics(JAMZASTNode *ast, Keyword *keywords, int keyword_count)
+// --- Análisis incremental ---
+
+typedef struct
 {
-    SymbolTable *global = safe_malloc(sizeof(SymbolTable));
-    global->symbols = NULL;
-    global->parent = NULL;
+    JAMZASTNode *function; // Nodo ya anotado
+    SymbolTable *table;    // Tabla local a la que apuntan sus nodos
+    SemanticDiagnostic *diagnostics;
+    size_t diagnostic_count;
+    JAMZASTNode **calls;
+    JAMZTypeId *call_signatures;
+    size_t call_count;
+    bool reused;
+} CachedFunction;
 
-    for (int i = 0; i < keyword_count; i++)
+struct SemanticSession
+{
+    const KeywordIndex *index;
+    JAMZTypeId string_type;
+    SymbolTable *global;
+    JAMZASTNode *program;
+    CachedFunction *functions; // Una por función de program, en el mismo orden
+    size_t function_count;
+    // Nodos nuevos sustituidos por su versión reutilizada; se liberan fuera
+    // del camino crítico con semantic_session_collect
+    JAMZASTNode **discarded;
+    size_t discarded_count;
+    size_t discarded_capacity;
+};
+
+SemanticSession *create_semantic_session(const KeywordIndex *index)
+{
+    SemanticSession *session = safe_malloc(sizeof(SemanticSession));
+    session->index = index;
+    session->string_type = jamz_type_pointer_to(JAMZ_TYPE_CHAR);
+    session->global = NULL;
+    session->program = NULL;
+    session->functions = NULL;
+    session->function_count = 0;
+    session->discarded = NULL;
+    session->discarded_count = 0;
+    session->discarded_capacity = 0;
+    return session;
+}
+
+static void shift_lines(JAMZASTNode *node, int delta)
+{
+    if (!node)
+        return;
+    node->line += delta;
+
+    switch (node->type)
     {
-        if (strcmp(keywords[i].category, "type") == 0)
+    case JAMZ_AST_BLOCK:
+        for (size_t i = 0; i < node->block.count; i++)
+            shift_lines(node->block.statements[i], delta);
+        break;
+    case JAMZ_AST_DECLARATION:
+        shift_lines(node->declaration.initializer, delta);
+        break;
+    case JAMZ_AST_ASSIGNMENT:
+        shift_lines(node->assignment.index, delta);
+        shift_lines(node->assignment.value, delta);
+        break;
+    case JAMZ_AST_INDEX:
+        shift_lines(node->index.index, delta);
+        break;
+    case JAMZ_AST_RETURN:
+        shift_lines(node->return_stmt.value, delta);
+        break;
+    case JAMZ_AST_IF:
+        shift_lines(node->if_stmt.condition, delta);
+        shift_lines(node->if_stmt.then_branch, delta);
+        shift_lines(node->if_stmt.else_branch, delta);
+        break;
+    case JAMZ_AST_WHILE:
+        shift_lines(node->while_stmt.condition, delta);
+        shift_lines(node->while_stmt.body, delta);
+        shift_lines(node->while_stmt.step, delta);
+        break;
+    case JAMZ_AST_BINARY:
+        shift_lines(node->binary.left, delta);
+        shift_lines(node->binary.right, delta);
+        break;
+    case JAMZ_AST_FUNCTION:
+        for (size_t i = 0; i < node->function.param_count; i++)
+            shift_lines(node->function.params[i], delta);
+        shift_lines(node->function.body, delta);
+        break;
+    case JAMZ_AST_CALL:
+        for (size_t i = 0; i < node->call.arg_count; i++)
+            shift_lines(node->call.args[i], delta);
+        break;
+    default:
+        break;
+    }
+}
+
+// Una función anterior sirve si sus tokens son idénticos (salvo el
+// desplazamiento de líneas) y cada llamada resuelve a la misma firma
+static bool can_reuse(const CachedFunction *cached, const JAMZASTNode *fresh, const SymbolTable *global)
+{
+    if (cached->reused || cached->function->function.fingerprint != fresh->function.fingerprint)
+        return false;
+
+    for (size_t i = 0; i < cached->call_count; i++)
+    {
+        Symbol *sym = find_symbol(global, cached->calls[i]->call.name);
+        if ((sym ? sym->type_id : JAMZ_TYPE_INVALID) != cached->call_signatures[i])
+            return false;
+    }
+    return true;
+}
+
+// Pasa una función de la versión anterior al nuevo programa: corrige sus
+// líneas y enlaza sus llamadas y su tabla con el nuevo ámbito global
+static void adopt_function(CachedFunction *cached, JAMZASTNode *fresh, SymbolTable *global)
+{
+    int delta = fresh->line - cached->function->line;
+    if (delta != 0)
+    {
+        shift_lines(cached->function, delta);
+        for (size_t d = 0; d < cached->diagnostic_count; d++)
+            cached->diagnostics[d].line += delta;
+    }
+
+    for (size_t i = 0; i < cached->call_count; i++)
+    {
+        JAMZASTNode *call = cached->calls[i];
+        Symbol *sym = find_symbol(global, call->call.name);
+        call->symbol = sym && sym->type == SYMBOL_FUNCTION && jamz_type_info(sym->type_id) ? sym : NULL;
+    }
+
+    cached->table->parent = global;
+    cached->function->symbol = fresh->symbol;
+    cached->function->inferred_type = fresh->inferred_type;
+    cached->reused = true;
+}
+
+static void free_cached_function(CachedFunction *cached)
+{
+    free_symbol_table(cached->table);
+    free(cached->diagnostics);
+    free(cached->calls);
+    free(cached->call_signatures);
+}
+
+void semantic_session_collect(SemanticSession *session)
+{
+    for (size_t i = 0; i < session->discarded_count; i++)
+        free_ast(session->discarded[i]);
+    session->discarded_count = 0;
+}
+
+SemanticUpdateStats semantic_session_update(SemanticSession *session, JAMZASTNode *program)
+{
+    SemanticUpdateStats stats = {0, 0};
+    semantic_session_collect(session);
+    size_t count = program->block.count;
+
+    SymbolTable *global = create_global_table(session->index);
+    SemanticContext global_ctx = {0};
+    global_ctx.table = global;
+    global_ctx.index = session->index;
+    global_ctx.string_type = session->string_type;
+    declare_functions(&global_ctx, program);
+
+    // Índice por nombre de las funciones anteriores (potencia de dos)
+    size_t capacity = 16;
+    while (capacity < session->function_count * 2)
+        capacity *= 2;
+    size_t *lookup = safe_malloc(capacity * sizeof(size_t));
+    for (size_t i = 0; i < capacity; i++)
+        lookup[i] = SIZE_MAX;
+    for (size_t i = 0; i < session->function_count; i++)
+    {
+        size_t slot = jamz_hash_string(session->functions[i].function->function.name) & (capacity - 1);
+        while (lookup[slot] != SIZE_MAX)
+            slot = (slot + 1) & (capacity - 1);
+        lookup[slot] = i;
+    }
+
+    CachedFunction *functions = calloc(count ? count : 1, sizeof(CachedFunction));
+    SemanticContext *contexts = calloc(count ? count : 1, sizeof(SemanticContext));
+    size_t *pending = safe_malloc((count ? count : 1) * sizeof(size_t));
+    if (!functions || !contexts)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for semantic session\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t pending_count = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        JAMZASTNode *fresh = program->block.statements[i];
+        CachedFunction *match = NULL;
+
+        size_t slot = jamz_hash_string(fresh->function.name) & (capacity - 1);
+        for (; lookup[slot] != SIZE_MAX; slot = (slot + 1) & (capacity - 1))
         {
-            add_symbol(global, keywords[i].name, SYMBOL_TYPE);
+            CachedFunction *candidate = &session->functions[lookup[slot]];
+            if (strcmp(candidate->function->function.name, fresh->function.name) == 0 &&
+                can_reuse(candidate, fresh, global))
+            {
+                match = candidate;
+                break;
+            }
         }
-        else if (strcmp(keywords[i].category, "function") == 0)
+
+        if (match)
         {
-            add_symbol(global, keywords[i].name, SYMBOL_FUNCTION);
+            adopt_function(match, fresh, global);
+            functions[i] = *match;
+            functions[i].reused = false;
+            program->block.statements[i] = match->function;
+            if (session->discarded_count == session->discarded_capacity)
+            {
+                session->discarded_capacity = session->discarded_capacity ? session->discarded_capacity * 2 : 64;
+                session->discarded = safe_realloc(session->discarded, session->discarded_capacity * sizeof(JAMZASTNode *));
+            }
+            session->discarded[session->discarded_count++] = fresh;
+            stats.reused++;
+            continue;
         }
+
+        contexts[i].table = create_symbol_table(global);
+        contexts[i].index = session->index;
+        contexts[i].string_type = session->string_type;
+        pending[pending_count++] = i;
     }
+    free(lookup);
 
-    analyze_node_with_symbols(ast, keywords, keyword_count, global);
-    print_symbol_table_ast(global, 0);
+    run_function_workers(program, contexts, pending, pending_count);
+    for (size_t p = 0; p < pending_count; p++)
+    {
+        size_t i = pending[p];
+        functions[i].function = program->block.statements[i];
+        functions[i].table = contexts[i].table;
+        functions[i].diagnostics = contexts[i].diagnostics;
+        functions[i].diagnostic_count = contexts[i].diagnostic_count;
+        functions[i].calls = contexts[i].calls;
+        functions[i].call_signatures = contexts[i].call_signatures;
+        functions[i].call_count = contexts[i].call_count;
+    }
+    stats.analyzed = pending_count;
+    free(pending);
+    free(contexts);
 
-    // Verificar si la tabla ya fue liberada antes de intentar liberarla
-    if (!is_table_freed(global))
+    // La versión anterior se libera salvo las funciones adoptadas
+    for (size_t i = 0; i < session->function_count; i++)
     {
-        free_symbol_table(global);
+        if (session->functions[i].reused)
+            continue;
+        free_cached_function(&session->functions[i]);
+        free_ast(session->functions[i].function);
     }
-    else
+    free(session->functions);
+    if (session->program)
     {
-        log_debug("[TRACE] Intento de liberar tabla global ya liberada o nula\n");
+        free(session->program->block.statements);
+        free(session->program);
     }
+    free_symbol_table(session->global);
+
+    session->global = global;
+    session->program = program;
+    session->functions = functions;
+    session->function_count = count;
+
+    // Errores globales primero dentro de la misma posición
+    SemanticContext *ordered = calloc(count + 1, sizeof(SemanticContext));
+    if (!ordered)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for semantic session\n");
+        exit(EXIT_FAILURE);
+    }
+    ordered[0] = global_ctx;
+    for (size_t i = 0; i < count; i++)
+    {
+        ordered[i + 1].diagnostics = functions[i].diagnostics;
+        ordered[i + 1].diagnostic_count = functions[i].diagnostic_count;
+    }
+    merge_diagnostics(ordered, count + 1);
+    free(ordered);
+    free(global_ctx.diagnostics);
+
+    log_debug("[LOG] Análisis incremental: %zu funciones analizadas, %zu reutilizadas\n", stats.analyzed, stats.reused);
+    return stats;
+}
+
+void free_semantic_session(SemanticSession *session)
+{
+    if (!session)
+        return;
+
+    semantic_session_collect(session);
+    free(session->discarded);
+    for (size_t i = 0; i < session->function_count; i++)
+        free_cached_function(&session->functions[i]);
+    free(session->functions);
+    free_ast(session->program);
+    free_symbol_table(session->global);
+    free(session);
 }
 
 // Colorear las keywords y el AST de las keywords usando la función print_color
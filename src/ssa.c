@@ -0,0 +1,1779 @@
+#include "ssa.h"
+#include "dataflow.h"
+#include "loop.h"
+#include "profile.h"
+#include "utils.h"
+#include "vectorize.h"
+#include <stdlib.h>
+#include <string.h>
+
+bool ssa_is_reachable(const JAMZSSAFunction *ssa, size_t block)
+{
+    return ssa->graph.rpo_index[block] != SIZE_MAX;
+}
+
+void ssa_block_append(JAMZSSABlock *block, const JAMZIRInstr *instr)
+{
+    if (block->count == block->capacity)
+    {
+        block->capacity = block->capacity ? block->capacity * 2 : 8;
+        block->code = safe_realloc(block->code, block->capacity * sizeof(JAMZIRInstr));
+    }
+    block->code[block->count++] = *instr;
+}
+
+size_t ssa_add_block(JAMZSSAFunction *ssa, size_t *capacity)
+{
+    if (ssa->block_count == *capacity)
+    {
+        *capacity = *capacity ? *capacity * 2 : 16;
+        ssa->blocks = safe_realloc(ssa->blocks, *capacity * sizeof(JAMZSSABlock));
+    }
+    JAMZSSABlock *block = &ssa->blocks[ssa->block_count];
+    memset(block, 0, sizeof(JAMZSSABlock));
+    block->condition = JAMZ_IR_NONE;
+    block->before = SIZE_MAX;
+    return ssa->block_count++;
+}
+
+// Registros que lee la instrucción; devuelve cuántos
+int ssa_instr_reads(JAMZIRInstr *instr, int32_t **regs)
+{
+    switch (instr->op)
+    {
+    case JAMZ_IR_COPY:
+    case JAMZ_IR_ARG:
+    case JAMZ_IR_RET:
+    case JAMZ_IR_LOAD:
+        regs[0] = &instr->a;
+        return instr->a != JAMZ_IR_NONE;
+    case JAMZ_IR_STORE:
+    case JAMZ_IR_VLOOP:
+    case JAMZ_IR_ADD:
+    case JAMZ_IR_SUB:
+    case JAMZ_IR_MUL:
+    case JAMZ_IR_DIV:
+    case JAMZ_IR_UDIV:
+    case JAMZ_IR_MOD:
+    case JAMZ_IR_UMOD:
+    case JAMZ_IR_EQ:
+    case JAMZ_IR_NE:
+    case JAMZ_IR_LT:
+    case JAMZ_IR_LE:
+    case JAMZ_IR_GT:
+    case JAMZ_IR_GE:
+        regs[0] = &instr->a;
+        regs[1] = &instr->b;
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+// Parte la IR lineal en bloques: empiezan en cada etiqueta y tras cada salto o return
+static void build_blocks(JAMZSSAFunction *ssa)
+{
+    JAMZIRFunction *function = ssa->function;
+    size_t capacity = 0;
+    size_t labels = function->label_count ? (size_t)function->label_count : 1;
+    size_t *label_block = safe_malloc(labels * sizeof(size_t));
+    // Etiqueta destino del salto final de cada bloque (JUMP o BRANCH)
+    int32_t *targets = NULL;
+    JAMZIROp *ends = NULL;
+    size_t end_capacity = 0;
+
+    size_t current = ssa_add_block(ssa, &capacity);
+    bool closed = false; // El bloque actual ya terminó en salto o return
+    for (size_t i = 0; i < function->count + 1; i++)
+    {
+        if (ssa->block_count > end_capacity)
+        {
+            end_capacity = capacity;
+            targets = safe_realloc(targets, end_capacity * sizeof(int32_t));
+            ends = safe_realloc(ends, end_capacity * sizeof(JAMZIROp));
+        }
+        if (!closed)
+        {
+            targets[current] = JAMZ_IR_NONE;
+            ends[current] = JAMZ_IR_LABEL; // Cae en el siguiente bloque
+        }
+        if (i == function->count)
+            break;
+
+        const JAMZIRInstr *instr = &function->code[i];
+        if (closed || (instr->op == JAMZ_IR_LABEL && ssa->blocks[current].count > 0))
+        {
+            current = ssa_add_block(ssa, &capacity);
+            closed = false;
+            i--; // Vuelve a procesar la instrucción en el bloque nuevo
+            continue;
+        }
+
+        switch (instr->op)
+        {
+        case JAMZ_IR_LABEL:
+            label_block[instr->imm] = current;
+            break;
+        case JAMZ_IR_JUMP:
+        case JAMZ_IR_BRANCH:
+            ends[current] = instr->op;
+            targets[current] = instr->imm;
+            ssa->blocks[current].condition = instr->op == JAMZ_IR_BRANCH ? instr->a : JAMZ_IR_NONE;
+            ssa->blocks[current].line = instr->line;
+            closed = true;
+            break;
+        case JAMZ_IR_RET:
+            ssa_block_append(&ssa->blocks[current], instr);
+            ends[current] = JAMZ_IR_RET;
+            closed = true;
+            break;
+        default:
+            ssa_block_append(&ssa->blocks[current], instr);
+            break;
+        }
+    }
+
+    for (size_t b = 0; b < ssa->block_count; b++)
+    {
+        JAMZSSABlock *block = &ssa->blocks[b];
+        size_t next = b + 1;
+        switch (ends[b])
+        {
+        case JAMZ_IR_JUMP:
+            block->succs[0] = label_block[targets[b]];
+            block->succ_count = 1;
+            break;
+        case JAMZ_IR_BRANCH:
+            block->succs[0] = next;
+            block->succs[1] = label_block[targets[b]];
+            block->succ_count = 2;
+            if (block->succs[1] == next)
+            {
+                // Ambas ramas llevan al mismo bloque: la condición sobra
+                block->condition = JAMZ_IR_NONE;
+                block->succ_count = 1;
+            }
+            break;
+        case JAMZ_IR_RET:
+            block->succ_count = 0;
+            break;
+        default:
+            block->succs[0] = next;
+            block->succ_count = next < ssa->block_count ? 1 : 0;
+            break;
+        }
+    }
+
+    free(ends);
+    free(targets);
+    free(label_block);
+}
+
+static void build_graph(JAMZSSAFunction *ssa)
+{
+    JAMZFlowEdge *edges = safe_malloc((ssa->block_count * 2 + 1) * sizeof(JAMZFlowEdge));
+    size_t edge_count = 0;
+    for (size_t b = 0; b < ssa->block_count; b++)
+    {
+        for (size_t s = 0; s < ssa->blocks[b].succ_count; s++)
+        {
+            edges[edge_count].from = b;
+            edges[edge_count].to = ssa->blocks[b].succs[s];
+            edge_count++;
+        }
+    }
+    jamz_flow_graph_init(&ssa->graph, ssa->block_count, 0, edges, edge_count);
+    free(edges);
+}
+
+size_t ssa_pred_index(const JAMZFlowGraph *graph, size_t block, size_t pred)
+{
+    for (size_t e = graph->pred_start[block]; e < graph->pred_start[block + 1]; e++)
+    {
+        if (graph->preds[e] == pred)
+            return e - graph->pred_start[block];
+    }
+    return SIZE_MAX;
+}
+
+size_t ssa_pred_count(const JAMZFlowGraph *graph, size_t block)
+{
+    return graph->pred_start[block + 1] - graph->pred_start[block];
+}
+
+// Índice de la arista p -> block entre los sucesores de p
+size_t ssa_succ_slot(const JAMZSSABlock *pred, size_t block)
+{
+    return pred->succs[0] == block ? 0 : 1;
+}
+
+// Recalcula el grafo tras quitar aristas o redirigir saltos. Cada fase
+// conserva los argumentos de los predecesores que sigue teniendo.
+void ssa_rebuild_graph(JAMZSSAFunction *ssa)
+{
+    JAMZFlowGraph old = ssa->graph;
+    build_graph(ssa);
+
+    for (size_t b = 0; b < ssa->block_count; b++)
+    {
+        JAMZSSABlock *block = &ssa->blocks[b];
+        size_t count = ssa_pred_count(&ssa->graph, b);
+        for (size_t i = 0; i < block->phi_count; i++)
+        {
+            JAMZSSAPhi *phi = &block->phis[i];
+            int32_t *args = safe_malloc((count ? count : 1) * sizeof(int32_t));
+            for (size_t k = 0; k < count; k++)
+            {
+                size_t old_k = ssa_pred_index(&old, b, ssa->graph.preds[ssa->graph.pred_start[b] + k]);
+                args[k] = old_k == SIZE_MAX ? JAMZ_IR_NONE : phi->args[old_k];
+            }
+            free(phi->args);
+            phi->args = args;
+        }
+    }
+
+    jamz_flow_graph_free(&old);
+    free(ssa->idom);
+    ssa->idom = jamz_flow_graph_dominators(&ssa->graph);
+}
+
+bool ssa_dominates(const JAMZSSAFunction *ssa, size_t a, size_t b)
+{
+    if (ssa->idom[b] == SIZE_MAX)
+        return false;
+    while (b != a)
+    {
+        if (ssa->idom[b] == b)
+            return false;
+        b = ssa->idom[b];
+    }
+    return true;
+}
+
+// Hijos de cada nodo en el árbol de dominadores, en CSR
+static void dominator_children(const JAMZSSAFunction *ssa, size_t **out_start, size_t **out_list)
+{
+    size_t nodes = ssa->block_count;
+    size_t *start = calloc(nodes + 1, sizeof(size_t));
+    size_t *list = safe_malloc((nodes ? nodes : 1) * sizeof(size_t));
+    if (!start)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for dominator tree\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t n = 0; n < nodes; n++)
+    {
+        if (ssa->idom[n] != SIZE_MAX && ssa->idom[n] != n)
+            start[ssa->idom[n] + 1]++;
+    }
+    for (size_t n = 0; n < nodes; n++)
+        start[n + 1] += start[n];
+    size_t *fill = safe_malloc((nodes ? nodes : 1) * sizeof(size_t));
+    memcpy(fill, start, nodes * sizeof(size_t));
+    // En orden de recorrido para que los hijos salgan en postorden inverso
+    for (size_t i = 0; i < ssa->graph.rpo_count; i++)
+    {
+        size_t n = ssa->graph.rpo[i];
+        if (ssa->idom[n] != n)
+            list[fill[ssa->idom[n]]++] = n;
+    }
+    free(fill);
+    *out_start = start;
+    *out_list = list;
+}
+
+void ssa_add_phi(JAMZSSABlock *block, int32_t var, size_t args, int line)
+{
+    if (block->phi_count == block->phi_capacity)
+    {
+        block->phi_capacity = block->phi_capacity ? block->phi_capacity * 2 : 4;
+        block->phis = safe_realloc(block->phis, block->phi_capacity * sizeof(JAMZSSAPhi));
+    }
+    JAMZSSAPhi *phi = &block->phis[block->phi_count++];
+    phi->dst = JAMZ_IR_NONE;
+    phi->var = var;
+    phi->args = safe_malloc((args ? args : 1) * sizeof(int32_t));
+    for (size_t k = 0; k < args; k++)
+        phi->args[k] = JAMZ_IR_NONE;
+    phi->line = line;
+    phi->live = true;
+}
+
+// Coloca las funciones phi solo para los nombres que se leen en algún
+// bloque antes de definirse en él (SSA semipodada)
+static void place_phis(JAMZSSAFunction *ssa, int32_t vars)
+{
+    size_t *df_start;
+    size_t *df_list;
+    jamz_dominance_frontier(&ssa->graph, ssa->idom, &df_start, &df_list);
+
+    size_t count = vars ? (size_t)vars : 1;
+    bool *global = calloc(count, sizeof(bool));
+    size_t *stamp = safe_malloc(count * sizeof(size_t));
+    size_t *def_start = calloc(count + 1, sizeof(size_t));
+    if (!global || !def_start)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for SSA construction\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Dos pasadas sobre los bloques alcanzables: cuenta y rellena los
+    // bloques que definen cada registro
+    size_t *def_blocks = NULL;
+    size_t *fill = NULL;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (int32_t v = 0; v < vars; v++)
+            stamp[v] = SIZE_MAX;
+        for (size_t r = 0; r < ssa->graph.rpo_count; r++)
+        {
+            size_t b = ssa->graph.rpo[r];
+            JAMZSSABlock *block = &ssa->blocks[b];
+            for (size_t i = 0; i < block->count; i++)
+            {
+                int32_t *regs[2];
+                int reads = ssa_instr_reads(&block->code[i], regs);
+                for (int k = 0; k < reads; k++)
+                {
+                    if (*regs[k] != JAMZ_IR_NONE && stamp[*regs[k]] != b)
+                        global[*regs[k]] = true;
+                }
+                int32_t dst = block->code[i].dst;
+                if (dst == JAMZ_IR_NONE || stamp[dst] == b)
+                    continue;
+                stamp[dst] = b;
+                if (pass == 0)
+                    def_start[dst + 1]++;
+                else
+                    def_blocks[fill[dst]++] = b;
+            }
+            if (block->condition != JAMZ_IR_NONE && stamp[block->condition] != b)
+                global[block->condition] = true;
+        }
+        if (pass == 0)
+        {
+            for (int32_t v = 0; v < vars; v++)
+                def_start[v + 1] += def_start[v];
+            def_blocks = safe_malloc((def_start[vars] ? def_start[vars] : 1) * sizeof(size_t));
+            fill = safe_malloc(count * sizeof(size_t));
+            memcpy(fill, def_start, vars * sizeof(size_t));
+        }
+    }
+
+    // Frontera de dominancia iterada de los bloques que definen cada nombre
+    size_t nodes = ssa->block_count ? ssa->block_count : 1;
+    size_t *has_phi = safe_malloc(nodes * sizeof(size_t));
+    size_t *queued = safe_malloc(nodes * sizeof(size_t));
+    size_t *work = safe_malloc(nodes * sizeof(size_t));
+    for (size_t b = 0; b < ssa->block_count; b++)
+        has_phi[b] = queued[b] = SIZE_MAX;
+
+    for (int32_t v = 0; v < vars; v++)
+    {
+        if (!global[v])
+            continue;
+        size_t work_count = 0;
+        for (size_t k = def_start[v]; k < def_start[v + 1]; k++)
+        {
+            queued[def_blocks[k]] = (size_t)v;
+            work[work_count++] = def_blocks[k];
+        }
+        while (work_count > 0)
+        {
+            size_t x = work[--work_count];
+            for (size_t k = df_start[x]; k < df_start[x + 1]; k++)
+            {
+                size_t y = df_list[k];
+                if (has_phi[y] == (size_t)v)
+                    continue;
+                has_phi[y] = (size_t)v;
+                ssa_add_phi(&ssa->blocks[y], v, ssa_pred_count(&ssa->graph, y),
+                            ssa->blocks[y].count ? ssa->blocks[y].code[0].line : 0);
+                if (queued[y] != (size_t)v)
+                {
+                    queued[y] = (size_t)v;
+                    work[work_count++] = y;
+                }
+            }
+        }
+    }
+
+    free(work);
+    free(queued);
+    free(has_phi);
+    free(fill);
+    free(def_blocks);
+    free(def_start);
+    free(stamp);
+    free(global);
+    free(df_list);
+    free(df_start);
+}
+
+typedef struct
+{
+    int32_t var;
+    int32_t previous;
+} RenameUndo;
+
+typedef struct
+{
+    JAMZIRFunction *function;
+    int32_t *current; // Versión vigente de cada registro original
+    RenameUndo *log;
+    size_t log_count;
+    size_t log_capacity;
+    int32_t undef; // Valor de las lecturas sin definición previa
+} Renamer;
+
+static int32_t current_version(Renamer *renamer, int32_t var)
+{
+    if (renamer->current[var] != JAMZ_IR_NONE)
+        return renamer->current[var];
+    if (renamer->undef == JAMZ_IR_NONE)
+        renamer->undef = ir_new_vreg(renamer->function, NULL);
+    return renamer->undef;
+}
+
+static int32_t new_version(Renamer *renamer, int32_t var)
+{
+    if (renamer->log_count == renamer->log_capacity)
+    {
+        renamer->log_capacity = renamer->log_capacity ? renamer->log_capacity * 2 : 64;
+        renamer->log = safe_realloc(renamer->log, renamer->log_capacity * sizeof(RenameUndo));
+    }
+    renamer->log[renamer->log_count].var = var;
+    renamer->log[renamer->log_count].previous = renamer->current[var];
+    renamer->log_count++;
+
+    int32_t version = ir_new_vreg(renamer->function, renamer->function->vreg_names[var]);
+    renamer->current[var] = version;
+    return version;
+}
+
+static void rename_block(JAMZSSAFunction *ssa, Renamer *renamer, size_t b)
+{
+    JAMZSSABlock *block = &ssa->blocks[b];
+    for (size_t i = 0; i < block->phi_count; i++)
+        block->phis[i].dst = new_version(renamer, block->phis[i].var);
+
+    for (size_t i = 0; i < block->count; i++)
+    {
+        JAMZIRInstr *instr = &block->code[i];
+        int32_t *regs[2];
+        int reads = ssa_instr_reads(instr, regs);
+        for (int k = 0; k < reads; k++)
+        {
+            if (*regs[k] != JAMZ_IR_NONE)
+                *regs[k] = current_version(renamer, *regs[k]);
+        }
+        if (instr->dst != JAMZ_IR_NONE)
+            instr->dst = new_version(renamer, instr->dst);
+    }
+    if (block->condition != JAMZ_IR_NONE)
+        block->condition = current_version(renamer, block->condition);
+
+    for (size_t s = 0; s < block->succ_count; s++)
+    {
+        JAMZSSABlock *succ = &ssa->blocks[block->succs[s]];
+        size_t k = ssa_pred_index(&ssa->graph, block->succs[s], b);
+        for (size_t i = 0; i < succ->phi_count; i++)
+            succ->phis[i].args[k] = current_version(renamer, succ->phis[i].var);
+    }
+}
+
+// Renombra en preorden del árbol de dominadores; al salir de un subárbol
+// se deshacen sus versiones con el registro de cambios
+static void rename_variables(JAMZSSAFunction *ssa, int32_t vars)
+{
+    Renamer renamer = {ssa->function, NULL, NULL, 0, 0, JAMZ_IR_NONE};
+    renamer.current = safe_malloc((vars ? (size_t)vars : 1) * sizeof(int32_t));
+    for (int32_t v = 0; v < vars; v++)
+        renamer.current[v] = JAMZ_IR_NONE;
+
+    size_t *child_start;
+    size_t *children;
+    dominator_children(ssa, &child_start, &children);
+
+    // Cada entrada de la pila es un bloque por visitar o, con exit, la
+    // marca del registro de cambios a la que volver
+    typedef struct
+    {
+        size_t block;
+        size_t mark;
+        bool exit;
+    } Frame;
+    Frame *stack = safe_malloc((ssa->block_count * 2 + 1) * sizeof(Frame));
+    size_t depth = 0;
+    stack[depth++] = (Frame){ssa->graph.entry, 0, false};
+    while (depth > 0)
+    {
+        Frame frame = stack[--depth];
+        if (frame.exit)
+        {
+            while (renamer.log_count > frame.mark)
+            {
+                renamer.log_count--;
+                renamer.current[renamer.log[renamer.log_count].var] = renamer.log[renamer.log_count].previous;
+            }
+            continue;
+        }
+        size_t mark = renamer.log_count;
+        rename_block(ssa, &renamer, frame.block);
+        stack[depth++] = (Frame){frame.block, mark, true};
+        for (size_t k = child_start[frame.block + 1]; k-- > child_start[frame.block];)
+            stack[depth++] = (Frame){children[k], 0, false};
+    }
+
+    // Lecturas sin definición: un cero definido al entrar en la función
+    if (renamer.undef != JAMZ_IR_NONE)
+    {
+        JAMZSSABlock *entry = &ssa->blocks[ssa->graph.entry];
+        JAMZIRInstr zero = {JAMZ_IR_CONST, renamer.undef, JAMZ_IR_NONE, JAMZ_IR_NONE, 0, entry->line};
+        ssa_block_append(entry, &zero);
+        memmove(entry->code + 1, entry->code, (entry->count - 1) * sizeof(JAMZIRInstr));
+        entry->code[0] = zero;
+    }
+
+    free(stack);
+    free(children);
+    free(child_start);
+    free(renamer.log);
+    free(renamer.current);
+}
+
+// Usos de cada registro en CSR, para las fases dispersas
+static void build_uses(const JAMZSSAFunction *ssa, size_t **out_start, JAMZSSAUse **out_sites)
+{
+    size_t vregs = (size_t)ssa->function->vreg_count;
+    size_t *start = calloc(vregs + 1, sizeof(size_t));
+    if (!start)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for SSA uses\n");
+        exit(EXIT_FAILURE);
+    }
+
+    JAMZSSAUse *sites = NULL;
+    size_t *fill = NULL;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (size_t b = 0; b < ssa->block_count; b++)
+        {
+            JAMZSSABlock *block = &ssa->blocks[b];
+            size_t slot = 0;
+            // Fases, instrucciones y condición comparten la numeración de slot
+            for (size_t i = 0; i < block->phi_count; i++, slot++)
+            {
+                for (size_t k = 0; k < ssa_pred_count(&ssa->graph, b); k++)
+                {
+                    int32_t v = block->phis[i].args[k];
+                    if (v == JAMZ_IR_NONE)
+                        continue;
+                    if (pass == 0)
+                        start[v + 1]++;
+                    else
+                        sites[fill[v]++] = (JAMZSSAUse){b, slot};
+                }
+            }
+            for (size_t i = 0; i < block->count; i++, slot++)
+            {
+                int32_t *regs[2];
+                int reads = ssa_instr_reads(&block->code[i], regs);
+                for (int k = 0; k < reads; k++)
+                {
+                    int32_t v = *regs[k];
+                    if (v == JAMZ_IR_NONE)
+                        continue;
+                    if (pass == 0)
+                        start[v + 1]++;
+                    else
+                        sites[fill[v]++] = (JAMZSSAUse){b, slot};
+                }
+            }
+            if (block->condition != JAMZ_IR_NONE)
+            {
+                if (pass == 0)
+                    start[block->condition + 1]++;
+                else
+                    sites[fill[block->condition]++] = (JAMZSSAUse){b, slot};
+            }
+        }
+        if (pass == 0)
+        {
+            for (size_t v = 0; v < vregs; v++)
+                start[v + 1] += start[v];
+            sites = safe_malloc((start[vregs] ? start[vregs] : 1) * sizeof(JAMZSSAUse));
+            fill = safe_malloc((vregs ? vregs : 1) * sizeof(size_t));
+            memcpy(fill, start, vregs * sizeof(size_t));
+        }
+    }
+    free(fill);
+    *out_start = start;
+    *out_sites = sites;
+}
+
+void ssa_locate_definitions(const JAMZSSAFunction *ssa, JAMZSSADefSites *defs)
+{
+    defs->count = (size_t)ssa->function->vreg_count;
+    size_t alloc = defs->count ? defs->count : 1;
+    defs->block = safe_realloc(defs->block, alloc * sizeof(size_t));
+    defs->slot = safe_realloc(defs->slot, alloc * sizeof(size_t));
+    for (size_t v = 0; v < defs->count; v++)
+        defs->block[v] = SIZE_MAX;
+    for (size_t b = 0; b < ssa->block_count; b++)
+    {
+        const JAMZSSABlock *block = &ssa->blocks[b];
+        for (size_t i = 0; i < block->phi_count; i++)
+        {
+            defs->block[block->phis[i].dst] = b;
+            defs->slot[block->phis[i].dst] = i;
+        }
+        for (size_t i = 0; i < block->count; i++)
+        {
+            if (block->code[i].dst == JAMZ_IR_NONE)
+                continue;
+            defs->block[block->code[i].dst] = b;
+            defs->slot[block->code[i].dst] = block->phi_count + i;
+        }
+    }
+}
+
+// Instrucción que define v, o NULL si es una fase o no la define nadie
+const JAMZIRInstr *ssa_defining_instr(const JAMZSSAFunction *ssa, const JAMZSSADefSites *defs, int32_t v)
+{
+    if (v == JAMZ_IR_NONE || (size_t)v >= defs->count || defs->block[v] == SIZE_MAX)
+        return NULL;
+    const JAMZSSABlock *block = &ssa->blocks[defs->block[v]];
+    size_t slot = defs->slot[v];
+    return slot < block->phi_count ? NULL : &block->code[slot - block->phi_count];
+}
+
+bool ssa_constant_value(const JAMZSSAFunction *ssa, const JAMZSSADefSites *defs, int32_t v, int32_t *value)
+{
+    const JAMZIRInstr *instr = ssa_defining_instr(ssa, defs, v);
+    if (!instr || instr->op != JAMZ_IR_CONST)
+        return false;
+    *value = instr->imm;
+    return true;
+}
+
+// Retículo de la propagación de constantes: sin valor aún, constante o variable
+typedef enum
+{
+    LATTICE_TOP,
+    LATTICE_CONST,
+    LATTICE_BOTTOM,
+} LatticeKind;
+
+typedef struct
+{
+    LatticeKind kind;
+    int32_t value;
+} LatticeValue;
+
+typedef struct
+{
+    JAMZSSAFunction *ssa;
+    LatticeValue *values;
+    bool *visited;      // Bloques con alguna arista de entrada ejecutable
+    bool *executable;   // Aristas: block * 2 + slot
+    size_t *edge_work;  // Pares bloque, slot
+    size_t edge_count;
+    size_t edge_capacity;
+    int32_t *ssa_work;
+    size_t ssa_count;
+    size_t ssa_capacity;
+} Propagation;
+
+static LatticeValue lattice_meet(LatticeValue a, LatticeValue b)
+{
+    if (a.kind == LATTICE_TOP)
+        return b;
+    if (b.kind == LATTICE_TOP)
+        return a;
+    if (a.kind == LATTICE_CONST && b.kind == LATTICE_CONST && a.value == b.value)
+        return a;
+    return (LatticeValue){LATTICE_BOTTOM, 0};
+}
+
+// Misma aritmética de 32 bits con vuelta que el código generado
+static bool fold_binary(JAMZIROp op, int32_t left, int32_t right, int32_t *result)
+{
+    uint32_t l = (uint32_t)left;
+    uint32_t r = (uint32_t)right;
+    switch (op)
+    {
+    case JAMZ_IR_ADD:
+        *result = (int32_t)(l + r);
+        return true;
+    case JAMZ_IR_SUB:
+        *result = (int32_t)(l - r);
+        return true;
+    case JAMZ_IR_MUL:
+        *result = (int32_t)(l * r);
+        return true;
+    case JAMZ_IR_DIV:
+        if (right == 0 || (left == INT32_MIN && right == -1))
+            return false;
+        *result = left / right;
+        return true;
+    case JAMZ_IR_UDIV:
+        if (right == 0)
+            return false;
+        *result = (int32_t)(l / r);
+        return true;
+    case JAMZ_IR_MOD:
+        if (right == 0 || (left == INT32_MIN && right == -1))
+            return false;
+        *result = left % right;
+        return true;
+    case JAMZ_IR_UMOD:
+        if (right == 0)
+            return false;
+        *result = (int32_t)(l % r);
+        return true;
+    case JAMZ_IR_EQ:
+        *result = left == right;
+        return true;
+    case JAMZ_IR_NE:
+        *result = left != right;
+        return true;
+    case JAMZ_IR_LT:
+        *result = left < right;
+        return true;
+    case JAMZ_IR_LE:
+        *result = left <= right;
+        return true;
+    case JAMZ_IR_GT:
+        *result = left > right;
+        return true;
+    case JAMZ_IR_GE:
+        *result = left >= right;
+        return true;
+    default:
+        return false;
+    }
+}
+
+static void push_edge(Propagation *prop, size_t block, size_t slot)
+{
+    if (prop->executable[block * 2 + slot])
+        return;
+    if (prop->edge_count + 2 > prop->edge_capacity)
+    {
+        prop->edge_capacity = prop->edge_capacity ? prop->edge_capacity * 2 : 32;
+        prop->edge_work = safe_realloc(prop->edge_work, prop->edge_capacity * sizeof(size_t));
+    }
+    prop->edge_work[prop->edge_count++] = block;
+    prop->edge_work[prop->edge_count++] = slot;
+}
+
+static void set_value(Propagation *prop, int32_t vreg, LatticeValue value)
+{
+    LatticeValue old = prop->values[vreg];
+    LatticeValue met = lattice_meet(old, value);
+    if (met.kind == old.kind && met.value == old.value)
+        return;
+    prop->values[vreg] = met;
+    if (prop->ssa_count == prop->ssa_capacity)
+    {
+        prop->ssa_capacity = prop->ssa_capacity ? prop->ssa_capacity * 2 : 64;
+        prop->ssa_work = safe_realloc(prop->ssa_work, prop->ssa_capacity * sizeof(int32_t));
+    }
+    prop->ssa_work[prop->ssa_count++] = vreg;
+}
+
+static LatticeValue operand_value(const Propagation *prop, int32_t vreg)
+{
+    if (vreg == JAMZ_IR_NONE)
+        return (LatticeValue){LATTICE_BOTTOM, 0};
+    return prop->values[vreg];
+}
+
+static void evaluate_slot(Propagation *prop, size_t b, size_t slot)
+{
+    JAMZSSAFunction *ssa = prop->ssa;
+    JAMZSSABlock *block = &ssa->blocks[b];
+
+    if (slot < block->phi_count)
+    {
+        JAMZSSAPhi *phi = &block->phis[slot];
+        LatticeValue value = {LATTICE_TOP, 0};
+        for (size_t k = 0; k < ssa_pred_count(&ssa->graph, b); k++)
+        {
+            size_t p = ssa->graph.preds[ssa->graph.pred_start[b] + k];
+            if (prop->executable[p * 2 + ssa_succ_slot(&ssa->blocks[p], b)])
+                value = lattice_meet(value, operand_value(prop, phi->args[k]));
+        }
+        set_value(prop, phi->dst, value);
+        return;
+    }
+
+    slot -= block->phi_count;
+    if (slot == block->count)
+    {
+        // Salto final: una condición conocida solo activa una de las ramas
+        if (block->condition == JAMZ_IR_NONE)
+        {
+            for (size_t s = 0; s < block->succ_count; s++)
+                push_edge(prop, b, s);
+            return;
+        }
+        LatticeValue condition = prop->values[block->condition];
+        if (condition.kind == LATTICE_CONST)
+            push_edge(prop, b, condition.value != 0 ? 0 : 1);
+        else if (condition.kind == LATTICE_BOTTOM)
+        {
+            push_edge(prop, b, 0);
+            push_edge(prop, b, 1);
+        }
+        return;
+    }
+
+    JAMZIRInstr *instr = &block->code[slot];
+    if (instr->dst == JAMZ_IR_NONE)
+        return;
+
+    LatticeValue value = {LATTICE_BOTTOM, 0};
+    switch (instr->op)
+    {
+    case JAMZ_IR_CONST:
+        value = (LatticeValue){LATTICE_CONST, instr->imm};
+        break;
+    case JAMZ_IR_COPY:
+        value = operand_value(prop, instr->a);
+        break;
+    case JAMZ_IR_ADD:
+    case JAMZ_IR_SUB:
+    case JAMZ_IR_MUL:
+    case JAMZ_IR_DIV:
+    case JAMZ_IR_UDIV:
+    case JAMZ_IR_MOD:
+    case JAMZ_IR_UMOD:
+    case JAMZ_IR_EQ:
+    case JAMZ_IR_NE:
+    case JAMZ_IR_LT:
+    case JAMZ_IR_LE:
+    case JAMZ_IR_GT:
+    case JAMZ_IR_GE:
+    {
+        LatticeValue left = operand_value(prop, instr->a);
+        LatticeValue right = operand_value(prop, instr->b);
+        int32_t result;
+        if (left.kind == LATTICE_BOTTOM || right.kind == LATTICE_BOTTOM)
+            value.kind = LATTICE_BOTTOM;
+        else if (left.kind == LATTICE_TOP || right.kind == LATTICE_TOP)
+            value.kind = LATTICE_TOP;
+        else if (fold_binary(instr->op, left.value, right.value, &result))
+            value = (LatticeValue){LATTICE_CONST, result};
+        break;
+    }
+    default:
+        break; // Parámetros, cadenas y llamadas no se conocen en compilación
+    }
+    set_value(prop, instr->dst, value);
+}
+
+static void visit_block(Propagation *prop, size_t b)
+{
+    JAMZSSABlock *block = &prop->ssa->blocks[b];
+    prop->visited[b] = true;
+    for (size_t slot = 0; slot <= block->phi_count + block->count; slot++)
+        evaluate_slot(prop, b, slot);
+}
+
+// Propagación de constantes condicional dispersa (Wegman y Zadeck): solo se
+// evalúa lo alcanzable por aristas ejecutables y cada valor baja como mucho
+// dos veces en el retículo
+static void propagate_constants(JAMZSSAFunction *ssa)
+{
+    size_t vregs = (size_t)ssa->function->vreg_count;
+    size_t blocks = ssa->block_count ? ssa->block_count : 1;
+    Propagation prop = {ssa, NULL, NULL, NULL, NULL, 0, 0, NULL, 0, 0};
+    prop.values = calloc(vregs ? vregs : 1, sizeof(LatticeValue));
+    prop.visited = calloc(blocks, sizeof(bool));
+    prop.executable = calloc(blocks * 2, sizeof(bool));
+    if (!prop.values || !prop.visited || !prop.executable)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for constant propagation\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t *use_start;
+    JAMZSSAUse *uses;
+    build_uses(ssa, &use_start, &uses);
+
+    visit_block(&prop, ssa->graph.entry);
+    while (prop.edge_count > 0 || prop.ssa_count > 0)
+    {
+        if (prop.edge_count > 0)
+        {
+            size_t slot = prop.edge_work[--prop.edge_count];
+            size_t from = prop.edge_work[--prop.edge_count];
+            if (prop.executable[from * 2 + slot])
+                continue;
+            prop.executable[from * 2 + slot] = true;
+
+            size_t to = ssa->blocks[from].succs[slot];
+            if (prop.visited[to])
+            {
+                for (size_t i = 0; i < ssa->blocks[to].phi_count; i++)
+                    evaluate_slot(&prop, to, i);
+            }
+            else
+                visit_block(&prop, to);
+            continue;
+        }
+
+        int32_t v = prop.ssa_work[--prop.ssa_count];
+        for (size_t k = use_start[v]; k < use_start[v + 1]; k++)
+        {
+            if (prop.visited[uses[k].block])
+                evaluate_slot(&prop, uses[k].block, uses[k].slot);
+        }
+    }
+
+    // Aplica el resultado: valores constantes, ramas decididas y bloques muertos
+    for (size_t b = 0; b < ssa->block_count; b++)
+    {
+        JAMZSSABlock *block = &ssa->blocks[b];
+        if (!prop.visited[b])
+        {
+            for (size_t i = 0; i < block->phi_count; i++)
+                free(block->phis[i].args);
+            block->phi_count = 0;
+            block->count = 0;
+            block->condition = JAMZ_IR_NONE;
+            block->succ_count = 0;
+            continue;
+        }
+
+        size_t kept = 0;
+        size_t constants = 0;
+        for (size_t i = 0; i < block->phi_count; i++)
+        {
+            JAMZSSAPhi *phi = &block->phis[i];
+            if (prop.values[phi->dst].kind == LATTICE_CONST)
+            {
+                JAMZIRInstr instr = {JAMZ_IR_CONST, phi->dst, JAMZ_IR_NONE, JAMZ_IR_NONE,
+                                     prop.values[phi->dst].value, phi->line};
+                ssa_block_append(block, &instr);
+                constants++;
+                free(phi->args);
+            }
+            else
+                block->phis[kept++] = *phi;
+        }
+        block->phi_count = kept;
+        if (constants > 0)
+        {
+            // Las constantes de las fases eliminadas van al principio del bloque
+            JAMZIRInstr *moved = safe_malloc(constants * sizeof(JAMZIRInstr));
+            memcpy(moved, block->code + block->count - constants, constants * sizeof(JAMZIRInstr));
+            memmove(block->code + constants, block->code, (block->count - constants) * sizeof(JAMZIRInstr));
+            memcpy(block->code, moved, constants * sizeof(JAMZIRInstr));
+            free(moved);
+            ssa->stats.constants += constants;
+        }
+
+        for (size_t i = 0; i < block->count; i++)
+        {
+            JAMZIRInstr *instr = &block->code[i];
+            if (instr->dst == JAMZ_IR_NONE || instr->op == JAMZ_IR_CONST || instr->op == JAMZ_IR_CALL ||
+                prop.values[instr->dst].kind != LATTICE_CONST)
+                continue;
+            instr->op = JAMZ_IR_CONST;
+            instr->a = JAMZ_IR_NONE;
+            instr->b = JAMZ_IR_NONE;
+            instr->imm = prop.values[instr->dst].value;
+            ssa->stats.constants++;
+        }
+
+        if (block->condition != JAMZ_IR_NONE)
+        {
+            bool fall = prop.executable[b * 2];
+            bool taken = prop.executable[b * 2 + 1];
+            if (fall != taken)
+            {
+                block->succs[0] = block->succs[taken ? 1 : 0];
+                block->succ_count = 1;
+                block->condition = JAMZ_IR_NONE;
+            }
+        }
+    }
+
+    free(uses);
+    free(use_start);
+    free(prop.ssa_work);
+    free(prop.edge_work);
+    free(prop.executable);
+    free(prop.visited);
+    free(prop.values);
+    ssa_rebuild_graph(ssa);
+}
+
+// Entrada de la tabla de valores: la expresión y el registro que ya la calcula
+typedef struct
+{
+    JAMZIROp op;
+    int32_t a;
+    int32_t b;
+    int32_t imm;
+    int32_t value; // JAMZ_IR_NONE marca una ranura libre
+} ValueEntry;
+
+static size_t value_hash(const ValueEntry *entry)
+{
+    uint64_t hash = JAMZ_HASH64_SEED;
+    int32_t key[4] = {(int32_t)entry->op, entry->a, entry->b, entry->imm};
+    return (size_t)jamz_hash64(hash, key, sizeof(key));
+}
+
+static bool is_value_op(JAMZIROp op)
+{
+    switch (op)
+    {
+    case JAMZ_IR_CONST:
+    case JAMZ_IR_STRING:
+    case JAMZ_IR_PARAM:
+    case JAMZ_IR_ADD:
+    case JAMZ_IR_SUB:
+    case JAMZ_IR_MUL:
+    case JAMZ_IR_DIV:
+    case JAMZ_IR_UDIV:
+    case JAMZ_IR_MOD:
+    case JAMZ_IR_UMOD:
+    case JAMZ_IR_EQ:
+    case JAMZ_IR_NE:
+    case JAMZ_IR_LT:
+    case JAMZ_IR_LE:
+    case JAMZ_IR_GT:
+    case JAMZ_IR_GE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Numeración de valores sobre el árbol de dominadores (Briggs, Cooper y
+// Simpson): una expresión ya calculada en un dominador se reutiliza. La
+// tabla es de direccionamiento abierto y se vacía en orden inverso al salir
+// de cada subárbol, así que los borrados no rompen las cadenas de sondeo.
+static void number_values(JAMZSSAFunction *ssa)
+{
+    size_t vregs = (size_t)ssa->function->vreg_count;
+    int32_t *leader = safe_malloc((vregs ? vregs : 1) * sizeof(int32_t));
+    for (size_t v = 0; v < vregs; v++)
+        leader[v] = (int32_t)v;
+
+    size_t total = 0;
+    for (size_t b = 0; b < ssa->block_count; b++)
+        total += ssa->blocks[b].count;
+    size_t capacity = 16;
+    while (capacity < total * 2)
+        capacity *= 2;
+    ValueEntry *table = safe_malloc(capacity * sizeof(ValueEntry));
+    for (size_t i = 0; i < capacity; i++)
+        table[i].value = JAMZ_IR_NONE;
+    size_t *undo = safe_malloc((total ? total : 1) * sizeof(size_t));
+    size_t undo_count = 0;
+
+    size_t *child_start;
+    size_t *children;
+    dominator_children(ssa, &child_start, &children);
+
+    typedef struct
+    {
+        size_t block;
+        size_t mark;
+        bool exit;
+    } Frame;
+    Frame *stack = safe_malloc((ssa->block_count * 2 + 1) * sizeof(Frame));
+    size_t depth = 0;
+    if (ssa->graph.rpo_count > 0)
+        stack[depth++] = (Frame){ssa->graph.entry, 0, false};
+
+    while (depth > 0)
+    {
+        Frame frame = stack[--depth];
+        if (frame.exit)
+        {
+            while (undo_count > frame.mark)
+                table[undo[--undo_count]].value = JAMZ_IR_NONE;
+            continue;
+        }
+
+        size_t b = frame.block;
+        JAMZSSABlock *block = &ssa->blocks[b];
+        size_t args = ssa_pred_count(&ssa->graph, b);
+        size_t mark = undo_count;
+
+        // Una fase cuyos argumentos son todos el mismo valor (o ella misma) sobra
+        for (size_t i = 0; i < block->phi_count; i++)
+        {
+            JAMZSSAPhi *phi = &block->phis[i];
+            int32_t same = JAMZ_IR_NONE;
+            bool redundant = true;
+            for (size_t k = 0; k < args && redundant; k++)
+            {
+                int32_t arg = phi->args[k] == JAMZ_IR_NONE ? JAMZ_IR_NONE : leader[phi->args[k]];
+                if (arg == phi->dst)
+                    continue;
+                if (same == JAMZ_IR_NONE)
+                    same = arg;
+                else if (arg != same)
+                    redundant = false;
+            }
+            if (redundant && same != JAMZ_IR_NONE)
+            {
+                leader[phi->dst] = same;
+                ssa->stats.redundant++;
+            }
+        }
+
+        for (size_t i = 0; i < block->count; i++)
+        {
+            JAMZIRInstr *instr = &block->code[i];
+            int32_t *regs[2];
+            int reads = ssa_instr_reads(instr, regs);
+            for (int k = 0; k < reads; k++)
+            {
+                if (*regs[k] != JAMZ_IR_NONE)
+                    *regs[k] = leader[*regs[k]];
+            }
+
+            if (instr->op == JAMZ_IR_COPY)
+            {
+                leader[instr->dst] = instr->a;
+                continue;
+            }
+            if (!is_value_op(instr->op))
+                continue;
+
+            // Las operaciones binarias no usan imm: solo cuenta en las hojas
+            bool leaf = instr->op == JAMZ_IR_CONST || instr->op == JAMZ_IR_STRING || instr->op == JAMZ_IR_PARAM;
+            ValueEntry key = {instr->op, instr->a, instr->b, leaf ? instr->imm : 0, instr->dst};
+            bool commutative = key.op == JAMZ_IR_ADD || key.op == JAMZ_IR_MUL || key.op == JAMZ_IR_EQ || key.op == JAMZ_IR_NE;
+            if (commutative && key.a > key.b)
+            {
+                int32_t swap = key.a;
+                key.a = key.b;
+                key.b = swap;
+            }
+
+            size_t slot = value_hash(&key) & (capacity - 1);
+            for (; table[slot].value != JAMZ_IR_NONE; slot = (slot + 1) & (capacity - 1))
+            {
+                const ValueEntry *entry = &table[slot];
+                if (entry->op == key.op && entry->a == key.a && entry->b == key.b && entry->imm == key.imm)
+                    break;
+            }
+            if (table[slot].value != JAMZ_IR_NONE)
+            {
+                leader[instr->dst] = table[slot].value;
+                ssa->stats.redundant++;
+                continue;
+            }
+            table[slot] = key;
+            undo[undo_count++] = slot;
+        }
+        if (block->condition != JAMZ_IR_NONE)
+            block->condition = leader[block->condition];
+
+        stack[depth++] = (Frame){b, mark, true};
+        for (size_t k = child_start[b + 1]; k-- > child_start[b];)
+            stack[depth++] = (Frame){children[k], 0, false};
+    }
+
+    // Los argumentos de las fases pueden venir de bloques visitados después
+    for (size_t b = 0; b < ssa->block_count; b++)
+    {
+        JAMZSSABlock *block = &ssa->blocks[b];
+        for (size_t i = 0; i < block->phi_count; i++)
+        {
+            for (size_t k = 0; k < ssa_pred_count(&ssa->graph, b); k++)
+            {
+                if (block->phis[i].args[k] != JAMZ_IR_NONE)
+                    block->phis[i].args[k] = leader[block->phis[i].args[k]];
+            }
+        }
+    }
+
+    free(stack);
+    free(children);
+    free(child_start);
+    free(undo);
+    free(table);
+    free(leader);
+}
+
+typedef struct
+{
+    JAMZSSAFunction *ssa;
+    int32_t *def_block; // Bloque y slot que define cada registro
+    size_t *def_slot;
+    bool *value_live;
+    bool *useful;       // Bloques con algo vivo: sus dependencias de control viven
+    bool *branch_live;
+    size_t *rdf_start;  // Frontera de postdominancia (dependencias de control)
+    size_t *rdf;
+    int32_t *values;    // Pila de registros por marcar
+    size_t value_count;
+    size_t *blocks;     // Pila de bloques recién marcados como útiles
+    size_t block_count;
+} Liveness;
+
+static void mark_value(Liveness *live, int32_t vreg)
+{
+    if (vreg == JAMZ_IR_NONE || live->value_live[vreg])
+        return;
+    live->value_live[vreg] = true;
+    live->values[live->value_count++] = vreg;
+}
+
+static void mark_useful(Liveness *live, size_t block)
+{
+    if (live->useful[block])
+        return;
+    live->useful[block] = true;
+    live->blocks[live->block_count++] = block;
+}
+
+static void mark_branch(Liveness *live, size_t block)
+{
+    if (live->branch_live[block] || live->ssa->blocks[block].condition == JAMZ_IR_NONE)
+        return;
+    live->branch_live[block] = true;
+    mark_value(live, live->ssa->blocks[block].condition);
+    mark_useful(live, block);
+}
+
+static void mark_reads(Liveness *live, JAMZIRInstr *instr)
+{
+    int32_t *regs[2];
+    int reads = ssa_instr_reads(instr, regs);
+    for (int k = 0; k < reads; k++)
+        mark_value(live, *regs[k]);
+}
+
+// Eliminación agresiva de código muerto (Cytron et al.): todo es muerto
+// salvo lo que se demuestre necesario partiendo de returns, llamadas y sus
+// argumentos y escrituras en arreglos. Un salto solo vive si de él depende algo vivo; los demás se
+// sustituyen por un salto directo a su postdominador inmediato.
+static void eliminate_dead_code(JAMZSSAFunction *ssa)
+{
+    size_t nodes = ssa->block_count;
+    size_t sink = nodes; // Nodo virtual al que llegan todos los returns
+
+    JAMZFlowEdge *edges = safe_malloc((nodes * 3 + 1) * sizeof(JAMZFlowEdge));
+    size_t edge_count = 0;
+    for (size_t b = 0; b < nodes; b++)
+    {
+        if (!ssa_is_reachable(ssa, b))
+            continue;
+        for (size_t s = 0; s < ssa->blocks[b].succ_count; s++)
+            edges[edge_count++] = (JAMZFlowEdge){ssa->blocks[b].succs[s], b};
+        if (ssa->blocks[b].succ_count == 0)
+            edges[edge_count++] = (JAMZFlowEdge){sink, b};
+    }
+    JAMZFlowGraph reverse;
+    jamz_flow_graph_init(&reverse, nodes + 1, sink, edges, edge_count);
+    free(edges);
+    size_t *ipdom = jamz_flow_graph_dominators(&reverse);
+
+    size_t vregs = (size_t)ssa->function->vreg_count;
+    size_t alloc = vregs ? vregs : 1;
+    Liveness live = {0};
+    live.ssa = ssa;
+    live.def_block = safe_malloc(alloc * sizeof(int32_t));
+    live.def_slot = safe_malloc(alloc * sizeof(size_t));
+    live.value_live = calloc(alloc, sizeof(bool));
+    live.useful = calloc(nodes + 1, sizeof(bool));
+    live.branch_live = calloc(nodes + 1, sizeof(bool));
+    live.values = safe_malloc(alloc * sizeof(int32_t));
+    live.blocks = safe_malloc((nodes + 1) * sizeof(size_t));
+    if (!live.value_live || !live.useful || !live.branch_live)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for dead code elimination\n");
+        exit(EXIT_FAILURE);
+    }
+    jamz_dominance_frontier(&reverse, ipdom, &live.rdf_start, &live.rdf);
+
+    for (size_t v = 0; v < vregs; v++)
+        live.def_block[v] = JAMZ_IR_NONE;
+    for (size_t b = 0; b < nodes; b++)
+    {
+        JAMZSSABlock *block = &ssa->blocks[b];
+        for (size_t i = 0; i < block->phi_count; i++)
+        {
+            block->phis[i].live = false;
+            live.def_block[block->phis[i].dst] = (int32_t)b;
+            live.def_slot[block->phis[i].dst] = i;
+        }
+        for (size_t i = 0; i < block->count; i++)
+        {
+            if (block->code[i].dst == JAMZ_IR_NONE)
+                continue;
+            live.def_block[block->code[i].dst] = (int32_t)b;
+            live.def_slot[block->code[i].dst] = block->phi_count + i;
+        }
+    }
+
+    // Raíces: efectos visibles. Un bucle sin salida no tiene postdominador
+    // y su salto se conserva.
+    bool *instr_live = NULL;
+    size_t *instr_start = safe_malloc((nodes + 1) * sizeof(size_t));
+    size_t total = 0;
+    for (size_t b = 0; b < nodes; b++)
+    {
+        instr_start[b] = total;
+        total += ssa->blocks[b].count;
+    }
+    instr_start[nodes] = total;
+    instr_live = calloc(total ? total : 1, sizeof(bool));
+    for (size_t b = 0; b < nodes; b++)
+    {
+        if (!ssa_is_reachable(ssa, b))
+            continue;
+        JAMZSSABlock *block = &ssa->blocks[b];
+        for (size_t i = 0; i < block->count; i++)
+        {
+            JAMZIROp op = block->code[i].op;
+            if (op == JAMZ_IR_RET || op == JAMZ_IR_CALL || op == JAMZ_IR_ARG || op == JAMZ_IR_STORE ||
+                op == JAMZ_IR_VLOOP)
+            {
+                instr_live[instr_start[b] + i] = true;
+                mark_reads(&live, &block->code[i]);
+                mark_useful(&live, b);
+            }
+            else if (op == JAMZ_IR_COUNT)
+            {
+                // Sigue diciendo de qué bloque del perfil viene el código;
+                // solo un contador que se incrementa obliga a pasar por él
+                instr_live[instr_start[b] + i] = true;
+                if (ssa->counting)
+                    mark_useful(&live, b);
+            }
+        }
+        if (ipdom[b] == SIZE_MAX)
+            mark_branch(&live, b);
+    }
+
+    while (live.value_count > 0 || live.block_count > 0)
+    {
+        if (live.block_count > 0)
+        {
+            size_t b = live.blocks[--live.block_count];
+            for (size_t k = live.rdf_start[b]; k < live.rdf_start[b + 1]; k++)
+            {
+                if (live.rdf[k] != sink)
+                    mark_branch(&live, live.rdf[k]);
+            }
+            continue;
+        }
+
+        int32_t v = live.values[--live.value_count];
+        if (live.def_block[v] == JAMZ_IR_NONE)
+            continue;
+        size_t b = (size_t)live.def_block[v];
+        JAMZSSABlock *block = &ssa->blocks[b];
+        size_t slot = live.def_slot[v];
+        if (slot < block->phi_count)
+        {
+            // El valor depende de por qué predecesor se llegó
+            JAMZSSAPhi *phi = &block->phis[slot];
+            phi->live = true;
+            for (size_t k = 0; k < ssa_pred_count(&ssa->graph, b); k++)
+            {
+                size_t p = ssa->graph.preds[ssa->graph.pred_start[b] + k];
+                mark_value(&live, phi->args[k]);
+                mark_useful(&live, p);
+                mark_branch(&live, p);
+            }
+            continue;
+        }
+        instr_live[instr_start[b] + slot - block->phi_count] = true;
+        mark_reads(&live, &block->code[slot - block->phi_count]);
+        mark_useful(&live, b);
+    }
+
+    for (size_t b = 0; b < nodes; b++)
+    {
+        JAMZSSABlock *block = &ssa->blocks[b];
+        size_t kept = 0;
+        for (size_t i = 0; i < block->count; i++)
+        {
+            if (instr_live[instr_start[b] + i])
+                block->code[kept++] = block->code[i];
+            else
+                ssa->stats.removed++;
+        }
+        block->count = kept;
+
+        kept = 0;
+        for (size_t i = 0; i < block->phi_count; i++)
+        {
+            if (block->phis[i].live)
+                block->phis[kept++] = block->phis[i];
+            else
+                free(block->phis[i].args);
+        }
+        block->phi_count = kept;
+
+        if (block->condition != JAMZ_IR_NONE && !live.branch_live[b] && ipdom[b] != SIZE_MAX && ipdom[b] != sink)
+        {
+            block->succs[0] = ipdom[b];
+            block->succ_count = 1;
+            block->condition = JAMZ_IR_NONE;
+            ssa->stats.removed++;
+        }
+    }
+
+    free(instr_live);
+    free(instr_start);
+    free(live.rdf);
+    free(live.rdf_start);
+    free(live.blocks);
+    free(live.values);
+    free(live.branch_live);
+    free(live.useful);
+    free(live.value_live);
+    free(live.def_slot);
+    free(live.def_block);
+    free(ipdom);
+    jamz_flow_graph_free(&reverse);
+    ssa_rebuild_graph(ssa);
+}
+
+// Copias en paralelo de una arista, en un orden que no pisa ningún origen
+// pendiente; los ciclos se rompen con un registro temporal
+static void emit_parallel_copies(JAMZIRFunction *function, int32_t *dsts, int32_t *srcs, size_t count, int line)
+{
+    while (count > 0)
+    {
+        bool progress = false;
+        for (size_t i = 0; i < count; i++)
+        {
+            bool blocked = false;
+            for (size_t j = 0; j < count && !blocked; j++)
+                blocked = j != i && srcs[j] == dsts[i];
+            if (blocked)
+                continue;
+            ir_emit(function, JAMZ_IR_COPY, dsts[i], srcs[i], JAMZ_IR_NONE, 0, line);
+            dsts[i] = dsts[count - 1];
+            srcs[i] = srcs[count - 1];
+            count--;
+            progress = true;
+            break;
+        }
+        if (progress)
+            continue;
+
+        int32_t saved = ir_new_vreg(function, NULL);
+        ir_emit(function, JAMZ_IR_COPY, saved, dsts[0], JAMZ_IR_NONE, 0, line);
+        for (size_t j = 0; j < count; j++)
+        {
+            if (srcs[j] == dsts[0])
+                srcs[j] = saved;
+        }
+    }
+}
+
+static void emit_edge_copies(JAMZSSAFunction *ssa, size_t from, size_t to, int line)
+{
+    JAMZSSABlock *target = &ssa->blocks[to];
+    if (target->phi_count == 0)
+        return;
+
+    size_t k = ssa_pred_index(&ssa->graph, to, from);
+    int32_t *dsts = safe_malloc(target->phi_count * sizeof(int32_t));
+    int32_t *srcs = safe_malloc(target->phi_count * sizeof(int32_t));
+    size_t count = 0;
+    for (size_t i = 0; i < target->phi_count; i++)
+    {
+        int32_t src = target->phis[i].args[k];
+        if (src == JAMZ_IR_NONE || src == target->phis[i].dst)
+            continue;
+        dsts[count] = target->phis[i].dst;
+        srcs[count] = src;
+        count++;
+    }
+    emit_parallel_copies(ssa->function, dsts, srcs, count, line);
+    free(srcs);
+    free(dsts);
+}
+
+// Orden en que se emiten los bloques: el de creación, salvo los que piden
+// ir justo antes de otro (los preheaders, ante la cabecera de su bucle)
+size_t *ssa_block_layout(const JAMZSSAFunction *ssa)
+{
+    size_t nodes = ssa->block_count;
+    size_t *order = safe_malloc((nodes ? nodes : 1) * sizeof(size_t));
+    size_t *first = safe_malloc((nodes ? nodes : 1) * sizeof(size_t));
+    size_t *chain = safe_malloc((nodes ? nodes : 1) * sizeof(size_t));
+    for (size_t b = 0; b < nodes; b++)
+        first[b] = SIZE_MAX;
+    for (size_t b = nodes; b-- > 0;)
+    {
+        size_t target = ssa->blocks[b].before;
+        if (target == SIZE_MAX)
+            continue;
+        chain[b] = first[target];
+        first[target] = b;
+    }
+    size_t count = 0;
+    for (size_t b = 0; b < nodes; b++)
+    {
+        if (ssa->blocks[b].before != SIZE_MAX)
+            continue;
+        for (size_t x = first[b]; x != SIZE_MAX; x = chain[x])
+            order[count++] = x;
+        order[count++] = b;
+    }
+    free(chain);
+    free(first);
+    return order;
+}
+
+// Las copias de la arista de retroceso que toma un BRANCH pueden ir antes
+// del salto, en el propio bloque, si en la salida (la caída) nadie lee los
+// valores que pisan: todos sus usos están dentro del bucle y la caída sale
+// de él. Así la vuelta del bucle es un único salto condicional.
+static bool copies_before_branch(const JAMZSSAFunction *ssa, size_t b, const JAMZLoop *loop, const size_t *use_start,
+                                 const JAMZSSAUse *uses)
+{
+    const JAMZSSABlock *block = &ssa->blocks[b];
+    if (!loop || !loop->body[b] || loop->body[block->succs[0]])
+        return false;
+    const JAMZSSABlock *target = &ssa->blocks[block->succs[1]];
+    for (size_t i = 0; i < target->phi_count; i++)
+    {
+        int32_t dst = target->phis[i].dst;
+        if (dst == block->condition)
+            return false;
+        for (size_t k = use_start[dst]; k < use_start[dst + 1]; k++)
+        {
+            if (!loop->body[uses[k].block])
+                return false;
+        }
+    }
+    return true;
+}
+
+// Vuelve a la IR lineal en el orden de ssa_block_layout, o en el de
+// profile_layout si hay perfil. Las copias de una
+// arista crítica tomada por un BRANCH van antes del salto si es la vuelta de
+// un bucle y se puede (copies_before_branch) y si no a un bloque propio al
+// final.
+static void leave_ssa(JAMZSSAFunction *ssa)
+{
+    JAMZIRFunction *function = ssa->function;
+    size_t *use_start;
+    JAMZSSAUse *uses;
+    build_uses(ssa, &use_start, &uses);
+    size_t loop_count;
+    JAMZLoop *loops = find_loops(ssa, &loop_count);
+    const JAMZLoop **header_loop = calloc(ssa->block_count ? ssa->block_count : 1, sizeof(JAMZLoop *));
+    if (!header_loop)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for SSA destruction\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t l = 0; l < loop_count; l++)
+        header_loop[loops[l].header] = &loops[l];
+
+    function->count = 0;
+    function->label_count = (int32_t)ssa->block_count;
+
+    uint64_t *weight = ssa->weights ? profile_block_weights(ssa) : NULL;
+    if (weight)
+        profile_invert_branches(ssa, weight, use_start);
+    size_t *order = weight ? profile_layout(ssa, weight) : ssa_block_layout(ssa);
+    free(weight);
+    size_t *next = safe_malloc((ssa->block_count + 1) * sizeof(size_t));
+    size_t following = SIZE_MAX;
+    for (size_t r = ssa->block_count; r-- > 0;)
+    {
+        next[order[r]] = following;
+        if (ssa_is_reachable(ssa, order[r]))
+            following = order[r];
+    }
+
+    size_t *split_from = safe_malloc((ssa->block_count + 1) * sizeof(size_t));
+    size_t split_count = 0;
+    for (size_t r = 0; r < ssa->block_count; r++)
+    {
+        size_t b = order[r];
+        if (!ssa_is_reachable(ssa, b))
+            continue;
+        JAMZSSABlock *block = &ssa->blocks[b];
+        ir_emit(function, JAMZ_IR_LABEL, JAMZ_IR_NONE, JAMZ_IR_NONE, JAMZ_IR_NONE, (int32_t)b, block->line);
+        for (size_t i = 0; i < block->count; i++)
+            ir_emit(function, block->code[i].op, block->code[i].dst, block->code[i].a, block->code[i].b,
+                    block->code[i].imm, block->code[i].line);
+        if (block->succ_count == 0)
+            continue;
+
+        size_t fall = block->succs[0];
+        if (block->condition != JAMZ_IR_NONE)
+        {
+            size_t taken = block->succs[1];
+            int32_t label = (int32_t)taken;
+            if (ssa->blocks[taken].phi_count > 0)
+            {
+                if (copies_before_branch(ssa, b, header_loop[taken], use_start, uses))
+                    emit_edge_copies(ssa, b, taken, block->line);
+                else
+                {
+                    label = function->label_count++;
+                    split_from[split_count++] = b;
+                }
+            }
+            ir_emit(function, JAMZ_IR_BRANCH, JAMZ_IR_NONE, block->condition, JAMZ_IR_NONE, label, block->line);
+        }
+        emit_edge_copies(ssa, b, fall, block->line);
+        if (fall != next[b])
+            ir_emit(function, JAMZ_IR_JUMP, JAMZ_IR_NONE, JAMZ_IR_NONE, JAMZ_IR_NONE, (int32_t)fall, block->line);
+    }
+
+    for (size_t i = 0; i < split_count; i++)
+    {
+        JAMZSSABlock *block = &ssa->blocks[split_from[i]];
+        size_t taken = block->succs[1];
+        ir_emit(function, JAMZ_IR_LABEL, JAMZ_IR_NONE, JAMZ_IR_NONE, JAMZ_IR_NONE,
+                (int32_t)ssa->block_count + (int32_t)i, block->line);
+        emit_edge_copies(ssa, split_from[i], taken, block->line);
+        ir_emit(function, JAMZ_IR_JUMP, JAMZ_IR_NONE, JAMZ_IR_NONE, JAMZ_IR_NONE, (int32_t)taken, block->line);
+    }
+
+    // Quita las etiquetas a las que ya no salta nadie
+    bool *used = calloc(function->label_count ? function->label_count : 1, sizeof(bool));
+    if (!used)
+    {
+        fprintf(stderr, "[ERROR] Memory allocation failed for IR labels\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < function->count; i++)
+    {
+        if (function->code[i].op == JAMZ_IR_JUMP || function->code[i].op == JAMZ_IR_BRANCH)
+            used[function->code[i].imm] = true;
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < function->count; i++)
+    {
+        if (function->code[i].op != JAMZ_IR_LABEL || used[function->code[i].imm])
+            function->code[kept++] = function->code[i];
+    }
+    function->count = kept;
+
+    free(used);
+    free(split_from);
+    free(next);
+    free(order);
+    free(header_loop);
+    free_loops(loops, loop_count);
+    free(uses);
+    free(use_start);
+}
+
+// Renumera los registros que siguen en uso para que el marco de pila no
+// crezca con las versiones que la SSA ha ido creando
+static void compact_vregs(JAMZIRFunction *function)
+{
+    size_t vregs = (size_t)function->vreg_count;
+    int32_t *map = safe_malloc((vregs ? vregs : 1) * sizeof(int32_t));
+    for (size_t v = 0; v < vregs; v++)
+        map[v] = JAMZ_IR_NONE;
+
+    int32_t count = 0;
+    for (size_t i = 0; i < function->count; i++)
+    {
+        JAMZIRInstr *instr = &function->code[i];
+        int32_t *regs[3] = {&instr->dst, &instr->a, &instr->b};
+        for (int k = 0; k < 3; k++)
+        {
+            if (*regs[k] == JAMZ_IR_NONE)
+                continue;
+            if (map[*regs[k]] == JAMZ_IR_NONE)
+                map[*regs[k]] = count++;
+            *regs[k] = map[*regs[k]];
+        }
+    }
+
+    char **names = safe_malloc((count ? (size_t)count : 1) * sizeof(char *));
+    for (size_t v = 0; v < vregs; v++)
+    {
+        if (map[v] == JAMZ_IR_NONE)
+            free(function->vreg_names[v]);
+        else
+            names[map[v]] = function->vreg_names[v];
+    }
+    free(function->vreg_names);
+    function->vreg_names = names;
+    function->vreg_count = count;
+    free(map);
+}
+
+static void free_ssa_function(JAMZSSAFunction *ssa)
+{
+    for (size_t b = 0; b < ssa->block_count; b++)
+    {
+        for (size_t i = 0; i < ssa->blocks[b].phi_count; i++)
+            free(ssa->blocks[b].phis[i].args);
+        free(ssa->blocks[b].phis);
+        free(ssa->blocks[b].code);
+    }
+    free(ssa->blocks);
+    free(ssa->idom);
+    jamz_flow_graph_free(&ssa->graph);
+}
+
+JAMZSSAStats optimize_ir(JAMZIRProgram *program)
+{
+    JAMZSSAStats total = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    // Los contadores del programa instrumentado describen el bucle escalar
+    bool counting = program->profile && program->profile->instrumented;
+    bool vectorize = jamz_vector_isa(false) != JAMZ_VECTOR_OFF && !counting;
+    const uint64_t *weights = profile_weights(program);
+    for (size_t f = 0; f < program->function_count; f++)
+    {
+        JAMZIRFunction *function = &program->functions[f];
+        JAMZSSAFunction ssa = {function, NULL, 0, {0}, NULL, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, weights, counting};
+        ssa.stats.instructions_before = function->count;
+
+        build_blocks(&ssa);
+        build_graph(&ssa);
+        ssa.idom = jamz_flow_graph_dominators(&ssa.graph);
+
+        int32_t vars = function->vreg_count;
+        place_phis(&ssa, vars);
+        rename_variables(&ssa, vars);
+
+        propagate_constants(&ssa);
+        number_values(&ssa);
+        optimize_loops(&ssa);
+        if (vectorize)
+            vectorize_loops(&ssa);
+        eliminate_dead_code(&ssa);
+        leave_ssa(&ssa);
+        compact_vregs(function);
+        ssa.stats.instructions_after = function->count;
+
+        log_debug("SSA de %s: %zu constantes, %zu redundantes, %zu sacadas de bucles, %zu reducidas, "
+                  "%zu vectorizados, %zu eliminadas, %zu -> %zu instrucciones\n",
+                  function->name, ssa.stats.constants, ssa.stats.redundant, ssa.stats.hoisted, ssa.stats.reduced,
+                  ssa.stats.vectorized, ssa.stats.removed, ssa.stats.instructions_before, ssa.stats.instructions_after);
+        total.constants += ssa.stats.constants;
+        total.redundant += ssa.stats.redundant;
+        total.hoisted += ssa.stats.hoisted;
+        total.reduced += ssa.stats.reduced;
+        total.vectorized += ssa.stats.vectorized;
+        total.removed += ssa.stats.removed;
+        total.inverted += ssa.stats.inverted;
+        total.moved += ssa.stats.moved;
+        total.instructions_before += ssa.stats.instructions_before;
+        total.instructions_after += ssa.stats.instructions_after;
+        free_ssa_function(&ssa);
+    }
+    return total;
+}
@@ -0,0 +1,106 @@
+#include "strength.h"
+
+bool jamz_is_power_of_two(int32_t value)
+{
+    return value > 1 && (value & (value - 1)) == 0;
+}
+
+int jamz_log2(uint32_t value)
+{
+    int exponent = 0;
+    while (value > 1)
+    {
+        value >>= 1;
+        exponent++;
+    }
+    return exponent;
+}
+
+bool jamz_mul_plan(int32_t value, JAMZMulPlan *plan)
+{
+    static const int32_t scales[] = {3, 5, 9};
+    plan->count = 0;
+    if (value <= 1 || jamz_is_power_of_two(value))
+        return false;
+    for (int s = 0; s < 3; s++)
+    {
+        int32_t rest = value / scales[s];
+        if (value % scales[s] != 0)
+            continue;
+        // c = s * 2^k
+        if (jamz_is_power_of_two(rest))
+        {
+            plan->steps[0] = (JAMZMulStep){JAMZ_MUL_LEA, scales[s]};
+            plan->steps[1] = (JAMZMulStep){JAMZ_MUL_SHIFT, jamz_log2(rest)};
+            plan->count = 2;
+            return true;
+        }
+        // c = s1 * s2
+        for (int t = 0; t < 3; t++)
+        {
+            if (rest == scales[t])
+            {
+                plan->steps[0] = (JAMZMulStep){JAMZ_MUL_LEA, scales[s]};
+                plan->steps[1] = (JAMZMulStep){JAMZ_MUL_LEA, scales[t]};
+                plan->count = 2;
+                return true;
+            }
+        }
+    }
+    // c = 2^k + 1 o 2^k - 1
+    if (jamz_is_power_of_two(value - 1))
+    {
+        plan->steps[0] = (JAMZMulStep){JAMZ_MUL_SHIFT, jamz_log2(value - 1)};
+        plan->steps[1] = (JAMZMulStep){JAMZ_MUL_ADD_SOURCE, 0};
+        plan->count = 2;
+        return true;
+    }
+    if (value < INT32_MAX && jamz_is_power_of_two(value + 1))
+    {
+        plan->steps[0] = (JAMZMulStep){JAMZ_MUL_SHIFT, jamz_log2(value + 1)};
+        plan->steps[1] = (JAMZMulStep){JAMZ_MUL_SUB_SOURCE, 0};
+        plan->count = 2;
+        return true;
+    }
+    return false;
+}
+
+JAMZDivMagic jamz_div_magic(int32_t divisor)
+{
+    const uint32_t two31 = 0x80000000u;
+    uint32_t ad = divisor < 0 ? 0u - (uint32_t)divisor : (uint32_t)divisor;
+    uint32_t t = two31 + ((uint32_t)divisor >> 31);
+    uint32_t anc = t - 1 - t % ad; // |nc|: mayor dividendo con resto ad-1
+    uint32_t q1 = two31 / anc, r1 = two31 - q1 * anc;
+    uint32_t q2 = two31 / ad, r2 = two31 - q2 * ad;
+    uint32_t delta;
+    int p = 31;
+    // Se busca el menor p con 2^p > nc * (ad - 2^p mod ad)
+    do
+    {
+        p++;
+        q1 *= 2;
+        r1 *= 2;
+        if (r1 >= anc)
+        {
+            q1++;
+            r1 -= anc;
+        }
+        q2 *= 2;
+        r2 *= 2;
+        if (r2 >= ad)
+        {
+            q2++;
+            r2 -= ad;
+        }
+        delta = ad - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+
+    uint32_t magic = q2 + 1;
+    JAMZDivMagic result;
+    result.multiplier = (int32_t)(divisor < 0 ? 0u - magic : magic);
+    result.shift = p - 32;
+    result.add_dividend = divisor > 0 && result.multiplier < 0;
+    result.subtract_dividend = divisor < 0 && result.multiplier > 0;
+    return result;
+}
@@ -0,0 +1,338 @@
+#include "templates.h"
+#include "cJSON.h"
+#include "utils.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEMPLATE_MAX_LINES 8
+
+// Clave en el diccionario y número de huecos que espera el generador
+static const struct
+{
+    const char *key;
+    int arguments;
+} template_keys[JAMZ_TEMPLATE_COUNT] = {
+    [JAMZ_TEMPLATE_PROLOGUE] = {"prologue", 0},
+    [JAMZ_TEMPLATE_EPILOGUE] = {"epilogue", 0},
+    [JAMZ_TEMPLATE_RESERVE_STACK] = {"reserve_stack", 1},
+    [JAMZ_TEMPLATE_SAVE_REGISTER] = {"save_register", 1},
+    [JAMZ_TEMPLATE_RESTORE_REGISTER] = {"restore_register", 1},
+    [JAMZ_TEMPLATE_MOVE] = {"move", 2},
+    [JAMZ_TEMPLATE_BINARY_ADD] = {"binary_add", 2},
+    [JAMZ_TEMPLATE_BINARY_SUB] = {"binary_sub", 2},
+    [JAMZ_TEMPLATE_BINARY_MUL] = {"binary_mul", 2},
+    [JAMZ_TEMPLATE_MULTIPLY_IMMEDIATE] = {"multiply_immediate", 3},
+    [JAMZ_TEMPLATE_LOAD_ADDRESS] = {"load_address", 2},
+    [JAMZ_TEMPLATE_SHIFT_LEFT] = {"shift_left", 2},
+    [JAMZ_TEMPLATE_SHIFT_RIGHT] = {"shift_right", 2},
+    [JAMZ_TEMPLATE_SHIFT_RIGHT_ARITHMETIC] = {"shift_right_arithmetic", 2},
+    [JAMZ_TEMPLATE_MULTIPLY_WIDE] = {"multiply_wide", 1},
+    [JAMZ_TEMPLATE_SIGN_EXTEND] = {"sign_extend", 0},
+    [JAMZ_TEMPLATE_NEGATE] = {"negate", 1},
+    [JAMZ_TEMPLATE_MASK] = {"mask", 2},
+    [JAMZ_TEMPLATE_BINARY_DIV] = {"binary_div", 1},
+    [JAMZ_TEMPLATE_BINARY_IDIV] = {"binary_idiv", 1},
+    [JAMZ_TEMPLATE_BRANCH_ZERO] = {"branch_zero", 3},
+    [JAMZ_TEMPLATE_COMPARE] = {"compare", 2},
+    [JAMZ_TEMPLATE_SET_CONDITION] = {"set_condition", 1},
+    [JAMZ_TEMPLATE_BRANCH_CONDITION] = {"branch_condition", 2},
+    [JAMZ_TEMPLATE_JUMP] = {"jump", 1},
+    [JAMZ_TEMPLATE_PUSH_ARG] = {"push_arg", 1},
+    [JAMZ_TEMPLATE_CALL] = {"call", 1},
+    [JAMZ_TEMPLATE_DROP_ARGS] = {"drop_args", 1},
+    [JAMZ_TEMPLATE_ZERO_FRAME] = {"zero_frame", 2},
+    [JAMZ_TEMPLATE_BRANCH_ALIGNED] = {"branch_aligned", 3},
+    [JAMZ_TEMPLATE_COUNT_BLOCK] = {"count_block", 2},
+    [JAMZ_TEMPLATE_COUNTER_DATA] = {"counter_data", 2},
+    [JAMZ_TEMPLATE_VECTOR_MOVE] = {"vector_move", 2},
+    [JAMZ_TEMPLATE_VECTOR_MOVE_UNALIGNED] = {"vector_move_unaligned", 2},
+    [JAMZ_TEMPLATE_VECTOR_MOVE_SCALAR] = {"vector_move_scalar", 2},
+    [JAMZ_TEMPLATE_VECTOR_BROADCAST] = {"vector_broadcast", 4},
+    [JAMZ_TEMPLATE_VECTOR_ADD] = {"vector_add", 2},
+    [JAMZ_TEMPLATE_VECTOR_SUB] = {"vector_sub", 2},
+    [JAMZ_TEMPLATE_VECTOR_MUL] = {"vector_mul", 14},
+    [JAMZ_TEMPLATE_VECTOR_MOVE_AVX] = {"vector_move_avx", 2},
+    [JAMZ_TEMPLATE_VECTOR_MOVE_UNALIGNED_AVX] = {"vector_move_unaligned_avx", 2},
+    [JAMZ_TEMPLATE_VECTOR_MOVE_SCALAR_AVX] = {"vector_move_scalar_avx", 2},
+    [JAMZ_TEMPLATE_VECTOR_BROADCAST_AVX] = {"vector_broadcast_avx", 4},
+    [JAMZ_TEMPLATE_VECTOR_ADD_AVX] = {"vector_add_avx", 3},
+    [JAMZ_TEMPLATE_VECTOR_SUB_AVX] = {"vector_sub_avx", 3},
+    [JAMZ_TEMPLATE_VECTOR_MUL_AVX] = {"vector_mul_avx", 3},
+    [JAMZ_TEMPLATE_VECTOR_CLEAR_UPPER] = {"vector_clear_upper", 0},
+    [JAMZ_TEMPLATE_STRING_DATA] = {"string_data", 2},
+};
+
+// Trozo de plantilla: texto fijo text[start .. start + length) o el hueco
+// número argument
+typedef struct
+{
+    uint32_t start;
+    uint32_t length;
+    int argument; // -1 si es texto fijo
+} Segment;
+
+// Campo de una línea (mnemónico u operando): segments[first .. first + count)
+typedef struct
+{
+    uint32_t first;
+    uint32_t count;
+} Field;
+
+typedef struct
+{
+    JAMZAsmKind kind;
+    Field mnemonic;
+    Field operands[JAMZ_ASM_MAX_OPERANDS];
+    int operand_count;
+} TemplateLine;
+
+typedef struct
+{
+    char *text;
+    Segment *segments;
+    size_t segment_count;
+    size_t flat_count; // Los primeros segmentos cubren el texto entero, para escribirlo tal cual
+    TemplateLine lines[TEMPLATE_MAX_LINES];
+    int line_count;
+} Template;
+
+static Template template_table[JAMZ_TEMPLATE_COUNT];
+static bool templates_loaded = false;
+
+static void add_segment(Template *template, size_t *capacity, uint32_t start, uint32_t length, int argument)
+{
+    if (argument < 0 && length == 0)
+        return;
+    if (template->segment_count == *capacity)
+    {
+        *capacity = *capacity ? *capacity * 2 : 8;
+        template->segments = safe_realloc(template->segments, *capacity * sizeof(Segment));
+    }
+    template->segments[template->segment_count++] = (Segment){start, length, argument};
+}
+
+// Parte text[start .. end) en texto fijo y huecos; devuelve el siguiente
+// número de hueco o -1 si encuentra una directiva distinta de %s, %d o %%
+static int split_segments(Template *template, size_t *capacity, size_t start, size_t end, int next_argument)
+{
+    size_t literal = start;
+    for (size_t i = start; i < end; i++)
+    {
+        if (template->text[i] != '%')
+            continue;
+        if (i + 1 >= end)
+            return -1;
+        char directive = template->text[i + 1];
+        if (directive == '%')
+        {
+            // "%%" es un '%' literal: se corta el texto tras el primero
+            add_segment(template, capacity, (uint32_t)literal, (uint32_t)(i + 1 - literal), -1);
+            literal = i + 2;
+            i++;
+            continue;
+        }
+        if (directive != 's' && directive != 'd')
+            return -1;
+        add_segment(template, capacity, (uint32_t)literal, (uint32_t)(i - literal), -1);
+        add_segment(template, capacity, 0, 0, next_argument++);
+        literal = i + 2;
+        i++;
+    }
+    add_segment(template, capacity, (uint32_t)literal, (uint32_t)(end - literal), -1);
+    return next_argument;
+}
+
+static void trim(const char *text, size_t *start, size_t *end)
+{
+    while (*start < *end && isspace((unsigned char)text[*start]))
+        (*start)++;
+    while (*end > *start && isspace((unsigned char)text[*end - 1]))
+        (*end)--;
+}
+
+static Field split_field(Template *template, size_t *capacity, size_t start, size_t end, int *next_argument)
+{
+    Field field = {(uint32_t)template->segment_count, 0};
+    if (*next_argument >= 0)
+        *next_argument = split_segments(template, capacity, start, end, *next_argument);
+    field.count = (uint32_t)(template->segment_count - field.first);
+    return field;
+}
+
+// "    mov %s, %s" -> mov | %s | %s, igual que se leería el texto emitido
+static bool compile_line(Template *template, size_t *capacity, size_t start, size_t end, int *next_argument)
+{
+    const char *text = template->text;
+    trim(text, &start, &end);
+    if (start == end)
+        return true;
+    if (template->line_count == TEMPLATE_MAX_LINES)
+        return false;
+
+    TemplateLine *line = &template->lines[template->line_count++];
+    line->operand_count = 0;
+    if (text[start] == ';')
+    {
+        start++;
+        trim(text, &start, &end);
+        line->kind = JAMZ_ASM_COMMENT;
+        line->mnemonic = split_field(template, capacity, start, end, next_argument);
+        return true;
+    }
+    if (text[end - 1] == ':')
+    {
+        line->kind = JAMZ_ASM_LABEL;
+        line->mnemonic = split_field(template, capacity, start, end - 1, next_argument);
+        return true;
+    }
+
+    line->kind = JAMZ_ASM_INSTRUCTION;
+    size_t cursor = start;
+    while (cursor < end && !isspace((unsigned char)text[cursor]))
+        cursor++;
+    line->mnemonic = split_field(template, capacity, start, cursor, next_argument);
+
+    // Los operandos de memoria no llevan comas, así que basta con partir por ellas
+    while (cursor < end)
+    {
+        if (line->operand_count == JAMZ_ASM_MAX_OPERANDS)
+            return false;
+        size_t operand_end = cursor;
+        while (operand_end < end && text[operand_end] != ',')
+            operand_end++;
+        size_t operand_start = cursor;
+        size_t trimmed_end = operand_end;
+        trim(text, &operand_start, &trimmed_end);
+        line->operands[line->operand_count++] = split_field(template, capacity, operand_start, trimmed_end, next_argument);
+        cursor = operand_end < end ? operand_end + 1 : end;
+    }
+    return true;
+}
+
+static bool compile_template(Template *template, const char *source, int expected_arguments)
+{
+    size_t capacity = 0;
+    size_t length = strlen(source);
+    template->text = strdup(source);
+    template->segments = NULL;
+    template->segment_count = 0;
+    template->line_count = 0;
+
+    if (split_segments(template, &capacity, 0, length, 0) != expected_arguments)
+        return false;
+    template->flat_count = template->segment_count;
+
+    int next_argument = 0;
+    size_t line_start = 0;
+    while (line_start < length)
+    {
+        size_t line_end = line_start;
+        while (line_end < length && source[line_end] != '\n')
+            line_end++;
+        if (!compile_line(template, &capacity, line_start, line_end, &next_argument))
+            return false;
+        line_start = line_end + 1;
+    }
+    return next_argument == expected_arguments;
+}
+
+// Los avisos siguen el formato de los demás errores del generador
+static bool load_template_table(const char *path)
+{
+    char *content = read_file(path); // read_file ya apila el error
+    if (!content)
+        return false;
+    cJSON *dictionary = cJSON_Parse(content);
+    free(content);
+    if (!dictionary)
+    {
+        fprintf(stderr, "Error: No se pudo parsear el archivo %s\n", path);
+        return false;
+    }
+
+    bool ok = true;
+    for (int kind = 0; kind < JAMZ_TEMPLATE_COUNT && ok; kind++)
+    {
+        const char *source = cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(dictionary, template_keys[kind].key));
+        if (!source)
+        {
+            fprintf(stderr, "[ERROR] No se encontró la instrucción para '%s' en el diccionario.\n", template_keys[kind].key);
+            ok = false;
+        }
+        else if (!compile_template(&template_table[kind], source, template_keys[kind].arguments))
+        {
+            fprintf(stderr, "[ERROR] La plantilla '%s' del diccionario no tiene la forma esperada (%d hueco(s)).\n",
+                    template_keys[kind].key, template_keys[kind].arguments);
+            ok = false;
+        }
+    }
+    cJSON_Delete(dictionary);
+
+    if (!ok)
+        free_template_table();
+    return ok;
+}
+
+bool jamz_templates_ready(void)
+{
+    if (!templates_loaded)
+    {
+        templates_loaded = load_template_table("data/dictionary.json");
+        if (templates_loaded)
+            log_debug("Diccionario de plantillas precompilado (%d plantillas)\n", JAMZ_TEMPLATE_COUNT);
+    }
+    return templates_loaded;
+}
+
+static uint32_t emit_field(JAMZAsmBuffer *buffer, const Template *template, Field field, const char *const *arguments)
+{
+    uint32_t start = asm_text_start(buffer);
+    for (uint32_t i = field.first; i < field.first + field.count; i++)
+    {
+        const Segment *segment = &template->segments[i];
+        if (segment->argument < 0)
+            asm_text_append(buffer, template->text + segment->start, segment->length);
+        else
+            asm_text_append(buffer, arguments[segment->argument], strlen(arguments[segment->argument]));
+    }
+    return asm_text_end(buffer, start);
+}
+
+void jamz_template_emit(JAMZAsmBuffer *buffer, JAMZTemplateKind kind, const char *const *arguments)
+{
+    const Template *template = &template_table[kind];
+    for (int i = 0; i < template->line_count; i++)
+    {
+        const TemplateLine *source = &template->lines[i];
+        JAMZAsmLine line = {source->kind, 0, {0}, source->operand_count};
+        line.mnemonic = emit_field(buffer, template, source->mnemonic, arguments);
+        for (int k = 0; k < source->operand_count; k++)
+            line.operands[k] = emit_field(buffer, template, source->operands[k], arguments);
+        asm_append_line(buffer, &line);
+    }
+}
+
+void jamz_template_render(JAMZOutputBuffer *output, JAMZTemplateKind kind, const char *const *arguments)
+{
+    const Template *template = &template_table[kind];
+    for (size_t i = 0; i < template->flat_count; i++)
+    {
+        const Segment *segment = &template->segments[i];
+        if (segment->argument < 0)
+            output_append(output, template->text + segment->start, segment->length);
+        else
+            output_string(output, arguments[segment->argument]);
+    }
+}
+
+void free_template_table(void)
+{
+    for (int kind = 0; kind < JAMZ_TEMPLATE_COUNT; kind++)
+    {
+        free(template_table[kind].text);
+        free(template_table[kind].segments);
+        memset(&template_table[kind], 0, sizeof(Template));
+    }
+    templates_loaded = false;
+}
@@ -0,0 +1,188 @@
+#include "types.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#define TYPE_TABLE_INITIAL_CAPACITY 16
+
+static JAMZTypeInfo *type_table = NULL;
+static size_t type_count = 0;
+static size_t type_capacity = 0;
+
+static const char *primitive_names[JAMZ_TYPE_PRIMITIVE_COUNT] = {"void", "int", "float", "char"};
+
+static JAMZTypeId add_type(JAMZTypeKind kind, JAMZTypeId base, char *name)
+{
+    if (type_count >= type_capacity)
+    {
+        type_capacity = type_capacity ? type_capacity * 2 : TYPE_TABLE_INITIAL_CAPACITY;
+        type_table = safe_realloc(type_table, type_capacity * sizeof(JAMZTypeInfo));
+    }
+
+    JAMZTypeInfo *info = &type_table[type_count];
+    info->kind = kind;
+    info->base = base;
+    info->pointer_to = JAMZ_TYPE_INVALID;
+    info->params = NULL;
+    info->param_count = 0;
+    info->length = 0;
+    info->name = name;
+    return (JAMZTypeId)type_count++;
+}
+
+// La tabla se crea en el primer uso con los primitivos en su posición fija
+static void ensure_type_table(void)
+{
+    if (type_count > 0)
+        return;
+
+    for (int i = 0; i < JAMZ_TYPE_PRIMITIVE_COUNT; i++)
+        add_type(JAMZ_TYPE_KIND_PRIMITIVE, JAMZ_TYPE_INVALID, strdup(primitive_names[i]));
+}
+
+JAMZTypeId jamz_type_from_name(const char *name)
+{
+    for (int i = 0; i < JAMZ_TYPE_PRIMITIVE_COUNT; i++)
+    {
+        if (strcmp(primitive_names[i], name) == 0)
+            return i;
+    }
+    return JAMZ_TYPE_INVALID;
+}
+
+JAMZTypeId jamz_type_pointer_to(JAMZTypeId base)
+{
+    ensure_type_table();
+    if (base < 0 || (size_t)base >= type_count)
+        return JAMZ_TYPE_INVALID;
+
+    if (type_table[base].pointer_to != JAMZ_TYPE_INVALID)
+        return type_table[base].pointer_to;
+
+    const char *base_name = type_table[base].name;
+    size_t length = strlen(base_name);
+    char *name = safe_malloc(length + 2);
+    memcpy(name, base_name, length);
+    name[length] = '*';
+    name[length + 1] = '\0';
+
+    JAMZTypeId id = add_type(JAMZ_TYPE_KIND_POINTER, base, name);
+    type_table[base].pointer_to = id; // add_type puede haber movido la tabla
+    return id;
+}
+
+// Las firmas se internan comparando retorno y parámetros; hay pocas por programa
+JAMZTypeId jamz_type_function(JAMZTypeId return_type, const JAMZTypeId *params, size_t param_count)
+{
+    ensure_type_table();
+
+    for (size_t i = JAMZ_TYPE_PRIMITIVE_COUNT; i < type_count; i++)
+    {
+        const JAMZTypeInfo *info = &type_table[i];
+        if (info->kind == JAMZ_TYPE_KIND_FUNCTION && info->base == return_type &&
+            info->param_count == param_count &&
+            (param_count == 0 || memcmp(info->params, params, param_count * sizeof(JAMZTypeId)) == 0))
+            return (JAMZTypeId)i;
+    }
+
+    // Nombre legible: "retorno(param, param)"
+    size_t length = strlen(jamz_type_name(return_type)) + 3;
+    for (size_t i = 0; i < param_count; i++)
+        length += strlen(jamz_type_name(params[i])) + 2;
+
+    char *name = safe_malloc(length);
+    char *cursor = name + sprintf(name, "%s(", jamz_type_name(return_type));
+    for (size_t i = 0; i < param_count; i++)
+        cursor += sprintf(cursor, i ? ", %s" : "%s", jamz_type_name(params[i]));
+    strcpy(cursor, ")");
+
+    JAMZTypeId id = add_type(JAMZ_TYPE_KIND_FUNCTION, return_type, name);
+    if (param_count > 0)
+    {
+        type_table[id].params = safe_malloc(param_count * sizeof(JAMZTypeId));
+        memcpy(type_table[id].params, params, param_count * sizeof(JAMZTypeId));
+        type_table[id].param_count = param_count;
+    }
+    return id;
+}
+
+// Los arreglos se internan por tipo de elemento y longitud, como las firmas
+JAMZTypeId jamz_type_array_of(JAMZTypeId base, size_t length)
+{
+    ensure_type_table();
+
+    for (size_t i = JAMZ_TYPE_PRIMITIVE_COUNT; i < type_count; i++)
+    {
+        const JAMZTypeInfo *info = &type_table[i];
+        if (info->kind == JAMZ_TYPE_KIND_ARRAY && info->base == base && info->length == length)
+            return (JAMZTypeId)i;
+    }
+
+    // Nombre legible: "int[8]"
+    const char *base_name = jamz_type_name(base);
+    char *name = safe_malloc(strlen(base_name) + 24);
+    sprintf(name, "%s[%zu]", base_name, length);
+
+    JAMZTypeId id = add_type(JAMZ_TYPE_KIND_ARRAY, base, name);
+    type_table[id].length = length;
+    return id;
+}
+
+const JAMZTypeInfo *jamz_type_info(JAMZTypeId id)
+{
+    ensure_type_table();
+    if (id < 0 || (size_t)id >= type_count)
+        return NULL;
+    return &type_table[id];
+}
+
+const char *jamz_type_name(JAMZTypeId id)
+{
+    const JAMZTypeInfo *info = jamz_type_info(id);
+    return info ? info->name : "<invalid>";
+}
+
+bool jamz_type_is_pointer(JAMZTypeId id)
+{
+    const JAMZTypeInfo *info = jamz_type_info(id);
+    return info && info->kind == JAMZ_TYPE_KIND_POINTER;
+}
+
+bool jamz_type_is_function(JAMZTypeId id)
+{
+    const JAMZTypeInfo *info = jamz_type_info(id);
+    return info && info->kind == JAMZ_TYPE_KIND_FUNCTION;
+}
+
+bool jamz_type_is_array(JAMZTypeId id)
+{
+    const JAMZTypeInfo *info = jamz_type_info(id);
+    return info && info->kind == JAMZ_TYPE_KIND_ARRAY;
+}
+
+bool jamz_type_is_arithmetic(JAMZTypeId id)
+{
+    return id == JAMZ_TYPE_INT || id == JAMZ_TYPE_FLOAT || id == JAMZ_TYPE_CHAR;
+}
+
+// Como en C, los tipos aritméticos se convierten entre sí implícitamente
+bool jamz_type_is_assignable(JAMZTypeId target, JAMZTypeId value)
+{
+    if (target == value)
+        return true;
+    return jamz_type_is_arithmetic(target) && jamz_type_is_arithmetic(value);
+}
+
+void free_type_table(void)
+{
+    for (size_t i = 0; i < type_count; i++)
+    {
+        free(type_table[i].name);
+        free(type_table[i].params);
+    }
+    free(type_table);
+    type_table = NULL;
+    type_count = 0;
+    type_capacity = 0;
+}
@@ -1,3 +1,4 @@
+#define _POSIX_C_SOURCE 200809L // clock_gettime, sysconf, flockfile, localtime_r, nanosleep
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,6 +8,7 @@
 #include "cJSON.h"
 #include <stdarg.h>
 #include <time.h>
+#include <sys/stat.h>
 
 static char error_stack[MAX_ERRORS][MAX_ERROR_LEN];
 static size_t error_count;
@@ -14,6 +16,8 @@ static FILE *log_file = NULL;
 
 #ifdef _WIN32
 #include <windows.h>
+#else
+#include <unistd.h>
 #endif
 
 void init_error_stack(void)
@@ -173,6 +177,31 @@ void print_error(const char *format, ...)
     va_end(args);
 }
 
+void print_warning(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+
+#ifdef _WIN32
+    HANDLE console = GetStdHandle(STD_ERROR_HANDLE);
+    CONSOLE_SCREEN_BUFFER_INFO consoleInfo;
+    WORD saved_attributes;
+
+    GetConsoleScreenBufferInfo(console, &consoleInfo);
+    saved_attributes = consoleInfo.wAttributes;
+
+    SetConsoleTextAttribute(console, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY);
+    vfprintf(stderr, format, args);
+    SetConsoleTextAttribute(console, saved_attributes);
+#else
+    fprintf(stderr, "\x1b[33m");
+    vfprintf(stderr, format, args);
+    fprintf(stderr, "\x1b[0m");
+#endif
+
+    va_end(args);
+}
+
 void set_console_color(WORD color)
 {
     HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
@@ -192,6 +221,30 @@ const char *get_filename_ext(const char *filename)
     return dot + 1;
 }
 
+unsigned int jamz_hash_string(const char *text)
+{
+    unsigned int hash = 2166136261u;
+
+    for (const unsigned char *c = (const unsigned char *)text; *c; c++)
+    {
+        hash ^= *c;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+uint64_t jamz_hash64(uint64_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
 const char *jamz_token_type_to_string(JAMZTokenType type)
 {
     switch (type)
@@ -212,10 +265,28 @@ const char *jamz_token_type_to_string(JAMZTokenType type)
         return "LPAREN";
     case JAMZ_TOKEN_RPAREN:
         return "RPAREN";
+    case JAMZ_TOKEN_COMMA:
+        return "COMMA";
+    case JAMZ_TOKEN_IF:
+        return "IF";
+    case JAMZ_TOKEN_ELSE:
+        return "ELSE";
+    case JAMZ_TOKEN_WHILE:
+        return "WHILE";
+    case JAMZ_TOKEN_FOR:
+        return "FOR";
+    case JAMZ_TOKEN_BREAK:
+        return "BREAK";
+    case JAMZ_TOKEN_CONTINUE:
+        return "CONTINUE";
     case JAMZ_TOKEN_LBRACE:
         return "LBRACE";
     case JAMZ_TOKEN_RBRACE:
         return "RBRACE";
+    case JAMZ_TOKEN_LBRACKET:
+        return "LBRACKET";
+    case JAMZ_TOKEN_RBRACKET:
+        return "RBRACKET";
     case JAMZ_TOKEN_STRING:
         return "STRING";
     case JAMZ_TOKEN_CHAR:
@@ -298,7 +369,7 @@ void print_ast_node(const JAMZASTNode *node, int indent)
     case JAMZ_AST_DECLARATION:
         print_color("`-- Declaration", JAMZ_COLOR_YELLOW, false);
         printf(": %s of type %s (line: %d, col: %d)\n",
-               node->declaration.var_name, node->declaration.type_name, node->line, node->column);
+               node->declaration.var_name, jamz_type_name(node->declaration.type_id), node->line, node->column);
         if (node->declaration.initializer)
             print_ast_node(node->declaration.initializer, indent + 1);
         break;
@@ -316,6 +387,48 @@ void print_ast_node(const JAMZASTNode *node, int indent)
         print_color("`-- Variable", JAMZ_COLOR_RED, false);
         printf(": %s (line: %d, col: %d)\n", node->variable.var_name, node->line, node->column);
         break;
+    case JAMZ_AST_INDEX:
+        print_color("`-- Index", JAMZ_COLOR_RED, false);
+        printf(": %s (line: %d, col: %d)\n", node->index.var_name, node->line, node->column);
+        print_ast_node(node->index.index, indent + 1);
+        break;
+    case JAMZ_AST_IF:
+        print_color("`-- If", JAMZ_COLOR_GREEN, false);
+        printf(" (line: %d, col: %d)\n", node->line, node->column);
+        print_ast_node(node->if_stmt.condition, indent + 1);
+        print_ast_node(node->if_stmt.then_branch, indent + 1);
+        if (node->if_stmt.else_branch)
+            print_ast_node(node->if_stmt.else_branch, indent + 1);
+        break;
+    case JAMZ_AST_WHILE:
+        print_color("`-- While", JAMZ_COLOR_GREEN, false);
+        printf(" (line: %d, col: %d)\n", node->line, node->column);
+        print_ast_node(node->while_stmt.condition, indent + 1);
+        print_ast_node(node->while_stmt.body, indent + 1);
+        print_ast_node(node->while_stmt.step, indent + 1);
+        break;
+    case JAMZ_AST_BREAK:
+        print_color("`-- Break", JAMZ_COLOR_GREEN, false);
+        printf(" (line: %d, col: %d)\n", node->line, node->column);
+        break;
+    case JAMZ_AST_CONTINUE:
+        print_color("`-- Continue", JAMZ_COLOR_GREEN, false);
+        printf(" (line: %d, col: %d)\n", node->line, node->column);
+        break;
+    case JAMZ_AST_FUNCTION:
+        print_color("`-- Function", JAMZ_COLOR_GREEN, false);
+        printf(": %s returns %s (line: %d, col: %d)\n",
+               node->function.name, jamz_type_name(node->function.return_type), node->line, node->column);
+        for (size_t i = 0; i < node->function.param_count; i++)
+            print_ast_node(node->function.params[i], indent + 1);
+        print_ast_node(node->function.body, indent + 1);
+        break;
+    case JAMZ_AST_CALL:
+        print_color("`-- Call", JAMZ_COLOR_YELLOW, false);
+        printf(": %s (line: %d, col: %d)\n", node->call.name, node->line, node->column);
+        for (size_t i = 0; i < node->call.arg_count; i++)
+            print_ast_node(node->call.args[i], indent + 1);
+        break;
     case JAMZ_AST_BINARY:
         print_color("`-- Binary Operation", JAMZ_COLOR_CYAN, false);
         printf(": %s (line: %d, col: %d)\n", node->binary.op, node->line, node->column);
@@ -329,6 +442,12 @@ void print_ast_node(const JAMZASTNode *node, int indent)
     }
 }
 
+bool jamz_is_comparison(const char *op)
+{
+    return strcmp(op, "<") == 0 || strcmp(op, "<=") == 0 || strcmp(op, ">") == 0 || strcmp(op, ">=") == 0 ||
+           strcmp(op, "==") == 0 || strcmp(op, "!=") == 0;
+}
+
 void print_ast(const JAMZASTNode *root, int indent)
 {
     print_ast_node(root, 0);
@@ -359,14 +478,23 @@ void free_ast(JAMZASTNode *node)
             free_ast(node->if_stmt.else_branch);
         break;
 
+    case JAMZ_AST_WHILE:
+        free_ast(node->while_stmt.condition);
+        free_ast(node->while_stmt.body);
+        free_ast(node->while_stmt.step);
+        break;
+
+    case JAMZ_AST_BREAK:
+    case JAMZ_AST_CONTINUE:
+        break;
+
     case JAMZ_AST_BINARY:
         free_ast(node->binary.left);
         free_ast(node->binary.right);
+        free(node->binary.op);
         break;
 
     case JAMZ_AST_DECLARATION:
-        if (node->declaration.type_name)
-            free(node->declaration.type_name);
         if (node->declaration.var_name)
             free(node->declaration.var_name);
         if (node->declaration.initializer)
@@ -376,13 +504,37 @@ void free_ast(JAMZASTNode *node)
     case JAMZ_AST_ASSIGNMENT:
         if (node->assignment.var_name)
             free(node->assignment.var_name);
+        free_ast(node->assignment.index);
         if (node->assignment.value)
             free_ast(node->assignment.value);
         break;
 
+    case JAMZ_AST_FUNCTION:
+        free(node->function.name);
+        for (size_t i = 0; i < node->function.param_count; ++i)
+            free_ast(node->function.params[i]);
+        free(node->function.params);
+        free_ast(node->function.body);
+        break;
+
+    case JAMZ_AST_CALL:
+        free(node->call.name);
+        for (size_t i = 0; i < node->call.arg_count; ++i)
+            free_ast(node->call.args[i]);
+        free(node->call.args);
+        break;
+
     case JAMZ_AST_LITERAL:
+        free(node->literal.value);
+        break;
+
     case JAMZ_AST_VARIABLE:
-        // Nada que liberar manualmente
+        free(node->variable.var_name);
+        break;
+
+    case JAMZ_AST_INDEX:
+        free(node->index.var_name);
+        free_ast(node->index.index);
         break;
 
     case JAMZ_AST_EXPRESSION:
@@ -486,7 +638,102 @@ void print_color(const char *text, Color color, bool newline)
 #endif
 }
 
-void log_debug(const char *format, ...)
+double jamz_now_ms(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1000.0 / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1000.0 + (double)now.tv_nsec / 1e6;
+#endif
+}
+
+double jamz_thread_cpu_ms(void)
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+        return 0.0;
+    ULARGE_INTEGER k = {{kernel.dwLowDateTime, kernel.dwHighDateTime}};
+    ULARGE_INTEGER u = {{user.dwLowDateTime, user.dwHighDateTime}};
+    return (double)(k.QuadPart + u.QuadPart) / 1e4; // Unidades de 100 ns
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return (double)now.tv_sec * 1000.0 + (double)now.tv_nsec / 1e6;
+#endif
+}
+
+size_t jamz_worker_count(void)
+{
+    const char *jobs = getenv("JAMZ_JOBS");
+    if (jobs && atoi(jobs) > 0)
+        return (size_t)atoi(jobs);
+
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+#else
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (size_t)cpus : 1;
+#endif
+}
+
+JAMZVectorISA jamz_vector_isa(bool host)
+{
+    bool avx2 = false;
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    avx2 = host && __builtin_cpu_supports("avx2");
+#endif
+    const char *choice = getenv("JAMZ_VECTOR");
+    if (choice && strcmp(choice, "off") == 0)
+        return JAMZ_VECTOR_OFF;
+    if (choice && strcmp(choice, "sse2") == 0)
+        return JAMZ_VECTOR_SSE2;
+    if (choice && strcmp(choice, "avx2") == 0)
+        return !host || avx2 ? JAMZ_VECTOR_AVX2 : JAMZ_VECTOR_SSE2;
+    return avx2 ? JAMZ_VECTOR_AVX2 : JAMZ_VECTOR_SSE2;
+}
+
+size_t jamz_inline_threshold(size_t fallback)
+{
+    const char *choice = getenv("JAMZ_INLINE");
+    if (!choice || !*choice)
+        return fallback;
+    if (strcmp(choice, "off") == 0)
+        return 0;
+    return atoi(choice) > 0 ? (size_t)atoi(choice) : 0;
+}
+
+long long jamz_file_mtime(const char *filename)
+{
+    struct stat info;
+    if (stat(filename, &info) != 0)
+        return -1;
+#ifdef _WIN32
+    return (long long)info.st_mtime;
+#else
+    // Resolución de nanosegundos: dos guardados en el mismo segundo se distinguen
+    return (long long)info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+#endif
+}
+
+void jamz_sleep_ms(unsigned int milliseconds)
+{
+#ifdef _WIN32
+    Sleep(milliseconds);
+#else
+    struct timespec delay = {milliseconds / 1000, (long)(milliseconds % 1000) * 1000000L};
+    nanosleep(&delay, NULL);
+#endif
+}
+
+bool log_open(void)
 {
     if (!log_file)
     {
@@ -494,20 +741,39 @@ void log_debug(const char *format, ...)
         if (!log_file)
         {
             perror("Error opening log file");
-            return;
+            return false;
         }
     }
+    return true;
+}
+
+void log_debug(const char *format, ...)
+{
+    if (!log_open())
+        return;
 
     // Obtener la fecha y hora actual
     time_t now = time(NULL);
-    struct tm *t = localtime(&now);
+    struct tm t;
+#ifdef _WIN32
+    localtime_s(&t, &now);
+    _lock_file(log_file);
+#else
+    localtime_r(&now, &t);
+    flockfile(log_file); // La fecha y el mensaje no se mezclan entre hilos
+#endif
     fprintf(log_file, "[%04d-%02d-%02d %02d:%02d:%02d] ",
-            t->tm_year + 1900, t->tm_mon + 1, t->tm_mday,
-            t->tm_hour, t->tm_min, t->tm_sec);
+            t.tm_year + 1900, t.tm_mon + 1, t.tm_mday,
+            t.tm_hour, t.tm_min, t.tm_sec);
 
     va_list args;
     va_start(args, format);
     vfprintf(log_file, format, args);
     va_end(args);
     fflush(log_file);
+#ifdef _WIN32
+    _unlock_file(log_file);
+#else
+    funlockfile(log_file);
+#endif
 }
@@ -0,0 +1,322 @@
+#include "vectorize.h"
+#include "loop.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Estado de vectorize_loop para un bucle
+typedef struct
+{
+    JAMZSSAFunction *ssa;
+    const JAMZLoop *loop;
+    const JAMZSSADefSites *defs;
+    int32_t *value;  // Instrucción del cuerpo que da cada registro, o JAMZ_IR_NONE
+    int32_t *offset; // c si el registro vale i + c; INT32_MIN si no es un índice
+    JAMZVectorInstr body[JAMZ_VECTOR_MAX_KERNEL];
+    size_t body_count;
+    JAMZVectorInstr invariants[JAMZ_VECTOR_MAX_KERNEL];
+    int32_t invariant_vregs[JAMZ_VECTOR_MAX_KERNEL]; // Escalar de cada SPLAT, o JAMZ_IR_NONE
+    size_t invariant_count;
+} Vectorizer;
+
+// Los operandos del cuerpo numeran los invariantes como -2, -3... (-1 es
+// JAMZ_IR_NONE)
+#define INVARIANT_OPERAND(k) (-(int32_t)(k) - 2)
+
+// Operando del núcleo que da el registro v, o false si no se puede
+// vectorizar: un escalar de fuera del bucle se repite en todos los carriles
+static bool vector_operand(Vectorizer *vec, int32_t v, int32_t *operand)
+{
+    if (vec->value[v] != JAMZ_IR_NONE)
+    {
+        *operand = vec->value[v];
+        return true;
+    }
+
+    JAMZVectorInstr splat = {JAMZ_VEC_SPLAT, JAMZ_IR_NONE, JAMZ_IR_NONE, JAMZ_IR_NONE, 0, JAMZ_IR_NONE};
+    int32_t vreg = v;
+    int32_t constant;
+    if (ssa_constant_value(vec->ssa, vec->defs, v, &constant))
+    {
+        splat.op = JAMZ_VEC_CONST;
+        splat.imm = constant;
+        vreg = JAMZ_IR_NONE;
+    }
+    else if (vec->defs->block[v] != SIZE_MAX && vec->loop->body[vec->defs->block[v]])
+        return false;
+
+    for (size_t k = 0; k < vec->invariant_count; k++)
+    {
+        bool same = vreg != JAMZ_IR_NONE ? vec->invariant_vregs[k] == vreg
+                                         : vec->invariant_vregs[k] == JAMZ_IR_NONE && vec->invariants[k].imm == constant;
+        if (same)
+        {
+            *operand = INVARIANT_OPERAND(k);
+            return true;
+        }
+    }
+    if (vec->invariant_count == JAMZ_VECTOR_MAX_KERNEL)
+        return false;
+    vec->invariants[vec->invariant_count] = splat;
+    vec->invariant_vregs[vec->invariant_count] = vreg;
+    *operand = INVARIANT_OPERAND(vec->invariant_count++);
+    return true;
+}
+
+static bool add_vector_instr(Vectorizer *vec, JAMZVectorOp op, int32_t a, int32_t b, int32_t array, int32_t imm)
+{
+    if (vec->body_count == JAMZ_VECTOR_MAX_KERNEL)
+        return false;
+    vec->body[vec->body_count++] = (JAMZVectorInstr){op, a, b, array, imm, JAMZ_IR_NONE};
+    return true;
+}
+
+// Traduce una instrucción del cuerpo; false si no tiene forma vectorial
+static bool vectorize_instr(Vectorizer *vec, const JAMZIRInstr *instr, int32_t phi)
+{
+    int32_t constant, a, b;
+    switch (instr->op)
+    {
+    case JAMZ_IR_CONST:
+        return true; // Se leen como invariantes donde hagan falta
+    case JAMZ_IR_COUNT:
+        return true; // Sin instrumentar no hace nada (y el programa instrumentado no se vectoriza)
+    case JAMZ_IR_COPY:
+        vec->value[instr->dst] = vec->value[instr->a];
+        vec->offset[instr->dst] = vec->offset[instr->a];
+        return vec->value[instr->dst] != JAMZ_IR_NONE || vec->offset[instr->dst] != INT32_MIN;
+    case JAMZ_IR_LOAD:
+        if (vec->offset[instr->a] == INT32_MIN)
+            return false;
+        vec->value[instr->dst] = (int32_t)vec->body_count;
+        return add_vector_instr(vec, JAMZ_VEC_LOAD, JAMZ_IR_NONE, JAMZ_IR_NONE, instr->imm, vec->offset[instr->a]);
+    case JAMZ_IR_STORE:
+        if (vec->offset[instr->a] == INT32_MIN || !vector_operand(vec, instr->b, &b))
+            return false;
+        return add_vector_instr(vec, JAMZ_VEC_STORE, b, JAMZ_IR_NONE, instr->imm, vec->offset[instr->a]);
+    case JAMZ_IR_ADD:
+        // i + c solo sirve de índice
+        if ((instr->a == phi && ssa_constant_value(vec->ssa, vec->defs, instr->b, &constant)) ||
+            (instr->b == phi && ssa_constant_value(vec->ssa, vec->defs, instr->a, &constant)))
+        {
+            vec->offset[instr->dst] = constant;
+            return true;
+        }
+        // fallthrough
+    case JAMZ_IR_SUB:
+    case JAMZ_IR_MUL:
+        if (!vector_operand(vec, instr->a, &a) || !vector_operand(vec, instr->b, &b))
+            return false;
+        vec->value[instr->dst] = (int32_t)vec->body_count;
+        return add_vector_instr(vec, instr->op == JAMZ_IR_ADD ? JAMZ_VEC_ADD : instr->op == JAMZ_IR_SUB ? JAMZ_VEC_SUB : JAMZ_VEC_MUL,
+                                a, b, JAMZ_IR_NONE, 0);
+    default:
+        return false;
+    }
+}
+
+// Hay alguna escritura y cada arreglo escrito se toca en una sola posición
+static bool independent_iterations(const Vectorizer *vec)
+{
+    bool stores = false;
+    for (size_t k = 0; k < vec->body_count; k++)
+    {
+        const JAMZVectorInstr *store = &vec->body[k];
+        if (store->op != JAMZ_VEC_STORE)
+            continue;
+        stores = true;
+        for (size_t j = 0; j < vec->body_count; j++)
+        {
+            const JAMZVectorInstr *access = &vec->body[j];
+            bool memory = access->op == JAMZ_VEC_LOAD || access->op == JAMZ_VEC_STORE;
+            if (memory && access->array == store->array && access->imm != store->imm)
+                return false;
+        }
+    }
+    return stores;
+}
+
+// Junta invariantes y cuerpo en el núcleo y reparte los registros: los
+// invariantes tienen el suyo todo el bucle y los demás lo sueltan tras su
+// último uso. Falla si no alcanzan.
+static bool build_kernel(const Vectorizer *vec, JAMZVectorKernel *kernel)
+{
+    size_t invariants = vec->invariant_count;
+    size_t count = invariants + vec->body_count;
+    if (count > JAMZ_VECTOR_MAX_KERNEL)
+        return false;
+    kernel->code = safe_malloc(count * sizeof(JAMZVectorInstr));
+    kernel->count = count;
+    kernel->invariant_count = invariants;
+    kernel->reference = JAMZ_IR_NONE;
+    memcpy(kernel->code, vec->invariants, invariants * sizeof(JAMZVectorInstr));
+    for (size_t k = 0; k < vec->body_count; k++)
+    {
+        JAMZVectorInstr instr = vec->body[k];
+        if (instr.a != JAMZ_IR_NONE)
+            instr.a = instr.a < 0 ? -instr.a - 2 : instr.a + (int32_t)invariants;
+        if (instr.b != JAMZ_IR_NONE)
+            instr.b = instr.b < 0 ? -instr.b - 2 : instr.b + (int32_t)invariants;
+        if (instr.op == JAMZ_VEC_STORE && kernel->reference == JAMZ_IR_NONE)
+            kernel->reference = instr.array;
+        kernel->code[invariants + k] = instr;
+    }
+
+    size_t last_use[JAMZ_VECTOR_MAX_KERNEL];
+    for (size_t k = 0; k < count; k++)
+    {
+        last_use[k] = k;
+        if (kernel->code[k].a != JAMZ_IR_NONE)
+            last_use[kernel->code[k].a] = k;
+        if (kernel->code[k].b != JAMZ_IR_NONE)
+            last_use[kernel->code[k].b] = k;
+    }
+    bool busy[JAMZ_VECTOR_REGISTERS] = {false};
+    for (size_t k = 0; k < count; k++)
+    {
+        JAMZVectorInstr *instr = &kernel->code[k];
+        int32_t operands[2] = {instr->a, instr->b};
+        for (int o = 0; o < 2; o++)
+        {
+            if (operands[o] != JAMZ_IR_NONE && (size_t)operands[o] >= invariants && last_use[operands[o]] == k)
+                busy[kernel->code[operands[o]].reg] = false;
+        }
+        if (instr->op == JAMZ_VEC_STORE)
+            continue;
+        int reg = 0;
+        while (reg < JAMZ_VECTOR_REGISTERS && busy[reg])
+            reg++;
+        if (reg == JAMZ_VECTOR_REGISTERS)
+            return false;
+        instr->reg = reg;
+        busy[reg] = k < invariants || last_use[k] > k;
+    }
+    return true;
+}
+
+static bool vectorize_loop(JAMZSSAFunction *ssa, const JAMZLoop *loop, const JAMZSSADefSites *defs)
+{
+    size_t h = loop->header;
+    const JAMZSSABlock *header = &ssa->blocks[h];
+    if (header->phi_count != 1 || ssa_pred_count(&ssa->graph, h) != 2)
+        return false;
+
+    // Cadena de bloques hasta el salto de vuelta
+    size_t length = 1;
+    size_t b = h;
+    while (ssa->blocks[b].condition == JAMZ_IR_NONE)
+    {
+        const JAMZSSABlock *block = &ssa->blocks[b];
+        if (block->succ_count != 1 || block->succs[0] == h || !loop->body[block->succs[0]])
+            return false;
+        b = block->succs[0];
+        if (ssa->blocks[b].phi_count > 0 || ssa_pred_count(&ssa->graph, b) != 1 || length == loop->size)
+            return false;
+        length++;
+    }
+    const JAMZSSABlock *latch = &ssa->blocks[b];
+    if (length != loop->size || latch->succ_count != 2 || latch->succs[1] != h || loop->body[latch->succs[0]])
+        return false;
+
+    JAMZInduction iv;
+    if (!find_basic_induction(ssa, loop, defs, &header->phis[0], &iv) || iv.step != 1)
+        return false;
+    const JAMZIRInstr *exit = ssa_defining_instr(ssa, defs, latch->condition);
+    int32_t limit;
+    if (exit && exit->op == JAMZ_IR_GE && exit->a == iv.next)
+        limit = exit->b;
+    else if (exit && exit->op == JAMZ_IR_LE && exit->b == iv.next)
+        limit = exit->a;
+    else
+        return false;
+    if (defs->block[limit] != SIZE_MAX && loop->body[defs->block[limit]])
+        return false;
+
+    Vectorizer *vec = safe_malloc(sizeof(Vectorizer));
+    vec->ssa = ssa;
+    vec->loop = loop;
+    vec->defs = defs;
+    vec->value = safe_malloc(defs->count * sizeof(int32_t));
+    vec->offset = safe_malloc(defs->count * sizeof(int32_t));
+    vec->body_count = 0;
+    vec->invariant_count = 0;
+    for (size_t v = 0; v < defs->count; v++)
+    {
+        vec->value[v] = JAMZ_IR_NONE;
+        vec->offset[v] = INT32_MIN;
+    }
+    vec->offset[iv.phi] = 0;
+    vec->offset[iv.next] = 1;
+
+    bool ok = true;
+    for (size_t c = 0, block = h; c < length && ok; c++, block = ssa->blocks[block].succs[0])
+    {
+        for (size_t i = 0; i < ssa->blocks[block].count && ok; i++)
+        {
+            const JAMZIRInstr *instr = &ssa->blocks[block].code[i];
+            if (instr->dst != iv.next && instr->dst != latch->condition)
+                ok = vectorize_instr(vec, instr, iv.phi);
+        }
+    }
+
+    JAMZVectorKernel kernel = {NULL, 0, 0, JAMZ_IR_NONE};
+    ok = ok && independent_iterations(vec) && build_kernel(vec, &kernel);
+    if (ok)
+    {
+        JAMZIRFunction *function = ssa->function;
+        JAMZSSABlock *pre = &ssa->blocks[loop->preheader];
+        int line = header->line;
+
+        // Los escalares invariantes llegan al núcleo por un arreglo de un
+        // elemento: VLOOP solo lleva en registros el inicio y el límite
+        int32_t zero = JAMZ_IR_NONE;
+        for (size_t k = 0; k < kernel.invariant_count; k++)
+        {
+            if (vec->invariant_vregs[k] == JAMZ_IR_NONE)
+                continue;
+            if (zero == JAMZ_IR_NONE)
+            {
+                JAMZIRInstr constant = {JAMZ_IR_CONST, ir_new_vreg(function, NULL), JAMZ_IR_NONE, JAMZ_IR_NONE, 0, line};
+                ssa_block_append(pre, &constant);
+                zero = constant.dst;
+            }
+            kernel.code[k].array = ir_new_array(function, 1);
+            JAMZIRInstr store = {JAMZ_IR_STORE, JAMZ_IR_NONE, zero, vec->invariant_vregs[k], kernel.code[k].array, line};
+            ssa_block_append(pre, &store);
+        }
+
+        function->kernels = safe_realloc(function->kernels, (function->kernel_count + 1) * sizeof(JAMZVectorKernel));
+        function->kernels[function->kernel_count] = kernel;
+        JAMZIRInstr run = {JAMZ_IR_VLOOP, ir_new_vreg(function, NULL), iv.init, limit,
+                           (int32_t)function->kernel_count++, line};
+        ssa_block_append(pre, &run);
+        ssa->blocks[h].phis[0].args[ssa_pred_index(&ssa->graph, h, loop->preheader)] = run.dst;
+    }
+    else
+        free(kernel.code);
+
+    free(vec->value);
+    free(vec->offset);
+    free(vec);
+    return ok;
+}
+
+// Solo los bucles internos pasan la forma que pide vectorize_loop: uno con
+// otro dentro no es una cadena de bloques
+void vectorize_loops(JAMZSSAFunction *ssa)
+{
+    size_t loop_count;
+    JAMZLoop *loops = find_loops(ssa, &loop_count);
+    JAMZSSADefSites defs = {NULL, NULL, 0};
+    for (size_t l = 0; l < loop_count; l++)
+    {
+        if (loops[l].preheader == SIZE_MAX)
+            continue;
+        ssa_locate_definitions(ssa, &defs);
+        if (vectorize_loop(ssa, &loops[l], &defs))
+            ssa->stats.vectorized++;
+    }
+    free(defs.block);
+    free(defs.slot);
+    free_loops(loops, loop_count);
+}
@@ -0,0 +1,750 @@
+#include "vm.h"
+#include "utils.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Con GCC y Clang cada manejador salta directamente al siguiente (etiquetas
+// como valores); en otro compilador queda el switch de siempre
+#if defined(__GNUC__) && !defined(JAMZ_VM_NO_COMPUTED_GOTO)
+#define VM_COMPUTED_GOTO
+#endif
+
+#define VM_INITIAL_REGISTERS 1024
+#define VM_INITIAL_FRAMES 64
+
+static JAMZVMOpcode arithmetic_opcode(JAMZIROp op)
+{
+    switch (op)
+    {
+    case JAMZ_IR_ADD:
+        return JAMZ_VM_ADD;
+    case JAMZ_IR_SUB:
+        return JAMZ_VM_SUB;
+    case JAMZ_IR_MUL:
+        return JAMZ_VM_MUL;
+    case JAMZ_IR_UDIV:
+        return JAMZ_VM_UDIV;
+    case JAMZ_IR_MOD:
+        return JAMZ_VM_MOD;
+    case JAMZ_IR_UMOD:
+        return JAMZ_VM_UMOD;
+    default:
+        return JAMZ_VM_DIV;
+    }
+}
+
+// Operando que no es la constante c en "CONST c; op d, x, c", o
+// JAMZ_IR_NONE si el par no se puede fusionar (la resta solo por la derecha)
+static int32_t fusable_operand(const JAMZIRInstr *constant, const JAMZIRInstr *next)
+{
+    int32_t value = constant->dst;
+    if (next->op != JAMZ_IR_ADD && next->op != JAMZ_IR_SUB && next->op != JAMZ_IR_MUL)
+        return JAMZ_IR_NONE;
+    if (next->b == value && next->a != value)
+        return next->a;
+    if (next->op != JAMZ_IR_SUB && next->a == value && next->b != value)
+        return next->b;
+    return JAMZ_IR_NONE;
+}
+
+// Las comparaciones y sus saltos fusionados siguen el orden de la IR
+static JAMZVMOpcode comparison_opcode(JAMZIROp op, JAMZVMOpcode first)
+{
+    return (JAMZVMOpcode)(first + (op - JAMZ_IR_EQ));
+}
+
+static void count_uses(const JAMZIRFunction *function, uint32_t *uses)
+{
+    for (size_t i = 0; i < function->count; i++)
+    {
+        const JAMZIRInstr *instr = &function->code[i];
+        switch (instr->op)
+        {
+        case JAMZ_IR_ADD:
+        case JAMZ_IR_SUB:
+        case JAMZ_IR_MUL:
+        case JAMZ_IR_DIV:
+        case JAMZ_IR_UDIV:
+        case JAMZ_IR_MOD:
+        case JAMZ_IR_UMOD:
+        case JAMZ_IR_EQ:
+        case JAMZ_IR_NE:
+        case JAMZ_IR_LT:
+        case JAMZ_IR_LE:
+        case JAMZ_IR_GT:
+        case JAMZ_IR_GE:
+            uses[instr->b]++;
+            uses[instr->a]++;
+            break;
+        case JAMZ_IR_STORE:
+        case JAMZ_IR_VLOOP:
+            uses[instr->b]++;
+            uses[instr->a]++;
+            break;
+        case JAMZ_IR_COPY:
+        case JAMZ_IR_ARG:
+        case JAMZ_IR_BRANCH:
+        case JAMZ_IR_RET:
+        case JAMZ_IR_LOAD:
+            if (instr->a != JAMZ_IR_NONE)
+                uses[instr->a]++;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+static void compile_function(JAMZVMProgram *program, const JAMZIRFunction *function, JAMZVMFunction *out)
+{
+    size_t labels = function->label_count > 0 ? (size_t)function->label_count : 1;
+    size_t *label_pc = safe_malloc(labels * sizeof(size_t));
+    uint32_t *uses = calloc(function->vreg_count > 0 ? (size_t)function->vreg_count : 1, sizeof(uint32_t));
+    count_uses(function, uses);
+
+    // Ninguna instrucción de la IR da más de una de bytecode
+    size_t capacity = function->count ? function->count : 1;
+    out->name = function->name;
+    out->code = safe_malloc(capacity * sizeof(JAMZVMInstr));
+    out->lines = safe_malloc(capacity * sizeof(int));
+    out->count = 0;
+    out->first_param = function->vreg_count;
+    out->first_array = function->vreg_count + (int32_t)function->param_count;
+    out->register_count = out->first_array;
+    out->array_base = safe_malloc((function->array_count ? function->array_count : 1) * sizeof(int32_t));
+    for (size_t k = 0; k < function->array_count; k++)
+    {
+        out->array_base[k] = out->register_count;
+        out->register_count += function->array_lengths[k];
+    }
+    out->ir = function;
+
+    int32_t pending_args = 0;
+    for (size_t i = 0; i < function->count; i++)
+    {
+        const JAMZIRInstr *instr = &function->code[i];
+        const JAMZIRInstr *next = i + 1 < function->count ? &function->code[i + 1] : NULL;
+        JAMZVMInstr op;
+
+        switch (instr->op)
+        {
+        case JAMZ_IR_CONST:
+        {
+            if (instr->dst == JAMZ_IR_NONE)
+                continue;
+            // Constante usada solo por la instrucción siguiente: va como inmediato
+            int32_t other = next && uses[instr->dst] == 1 ? fusable_operand(instr, next) : JAMZ_IR_NONE;
+            if (other != JAMZ_IR_NONE)
+            {
+                JAMZVMOpcode fused = next->op == JAMZ_IR_ADD   ? JAMZ_VM_ADD_CONST
+                                     : next->op == JAMZ_IR_SUB ? JAMZ_VM_SUB_CONST
+                                                               : JAMZ_VM_MUL_CONST;
+                op = (JAMZVMInstr){fused, next->dst, other, 0, instr->imm};
+                program->fused++;
+                i++;
+                break;
+            }
+            op = (JAMZVMInstr){JAMZ_VM_CONST, instr->dst, 0, 0, instr->imm};
+            break;
+        }
+        case JAMZ_IR_STRING:
+            op = (JAMZVMInstr){JAMZ_VM_STRING, instr->dst, 0, 0, instr->imm};
+            break;
+        case JAMZ_IR_PARAM:
+            op = (JAMZVMInstr){JAMZ_VM_MOVE, instr->dst, out->first_param + instr->imm, 0, 0};
+            break;
+        case JAMZ_IR_COPY:
+            if (next && next->op == JAMZ_IR_JUMP)
+            {
+                op = (JAMZVMInstr){JAMZ_VM_MOVE_JUMP, instr->dst, instr->a, 0, next->imm};
+                program->fused++;
+                i++;
+                break;
+            }
+            op = (JAMZVMInstr){JAMZ_VM_MOVE, instr->dst, instr->a, 0, 0};
+            break;
+        case JAMZ_IR_ADD:
+        case JAMZ_IR_SUB:
+        case JAMZ_IR_MUL:
+        case JAMZ_IR_DIV:
+        case JAMZ_IR_UDIV:
+        case JAMZ_IR_MOD:
+        case JAMZ_IR_UMOD:
+            op = (JAMZVMInstr){arithmetic_opcode(instr->op), instr->dst, instr->a, instr->b, 0};
+            break;
+        case JAMZ_IR_EQ:
+        case JAMZ_IR_NE:
+        case JAMZ_IR_LT:
+        case JAMZ_IR_LE:
+        case JAMZ_IR_GT:
+        case JAMZ_IR_GE:
+            // Comparación que solo decide el salto siguiente: salta con la
+            // condición contraria sin materializar el 0 o 1
+            if (next && next->op == JAMZ_IR_BRANCH && next->a == instr->dst && uses[instr->dst] == 1)
+            {
+                JAMZVMOpcode jump = comparison_opcode(jamz_ir_negate_comparison(instr->op), JAMZ_VM_JUMP_EQ);
+                op = (JAMZVMInstr){jump, instr->a, instr->b, 0, next->imm};
+                program->fused++;
+                i++;
+                break;
+            }
+            op = (JAMZVMInstr){comparison_opcode(instr->op, JAMZ_VM_EQ), instr->dst, instr->a, instr->b, 0};
+            break;
+        case JAMZ_IR_ARG:
+            op = (JAMZVMInstr){JAMZ_VM_ARG, instr->a, 0, 0, 0};
+            pending_args++;
+            break;
+        case JAMZ_IR_CALL:
+            op = (JAMZVMInstr){JAMZ_VM_CALL, instr->dst, 0, pending_args, instr->imm};
+            pending_args = 0;
+            break;
+        case JAMZ_IR_LABEL:
+            label_pc[instr->imm] = out->count;
+            continue;
+        case JAMZ_IR_JUMP:
+            op = (JAMZVMInstr){JAMZ_VM_JUMP, 0, 0, 0, instr->imm};
+            break;
+        case JAMZ_IR_BRANCH:
+            op = (JAMZVMInstr){JAMZ_VM_JUMP_ZERO, instr->a, 0, 0, instr->imm};
+            break;
+        case JAMZ_IR_RET:
+            op = (JAMZVMInstr){instr->a == JAMZ_IR_NONE ? JAMZ_VM_RET_VOID : JAMZ_VM_RET, instr->a, 0, 0, 0};
+            break;
+        case JAMZ_IR_LOAD:
+            op = (JAMZVMInstr){JAMZ_VM_LOAD, instr->dst, instr->a, out->array_base[instr->imm],
+                               function->array_lengths[instr->imm]};
+            break;
+        case JAMZ_IR_STORE:
+            op = (JAMZVMInstr){JAMZ_VM_STORE, instr->a, instr->b, out->array_base[instr->imm],
+                               function->array_lengths[instr->imm]};
+            break;
+        case JAMZ_IR_VLOOP:
+            op = (JAMZVMInstr){JAMZ_VM_VLOOP, instr->dst, instr->a, instr->b, instr->imm};
+            break;
+        case JAMZ_IR_COUNT:
+            if (!program->ir->profile->instrumented)
+                continue;
+            op = (JAMZVMInstr){JAMZ_VM_COUNT, 0, 0, 0, instr->imm};
+            break;
+        }
+        out->lines[out->count] = instr->line;
+        out->code[out->count++] = op;
+    }
+
+    // Las etiquetas pasan a ser posiciones en el bytecode
+    for (size_t i = 0; i < out->count; i++)
+    {
+        JAMZVMInstr *op = &out->code[i];
+        if (op->op == JAMZ_VM_JUMP || op->op == JAMZ_VM_JUMP_ZERO || op->op == JAMZ_VM_MOVE_JUMP ||
+            (op->op >= JAMZ_VM_JUMP_EQ && op->op <= JAMZ_VM_JUMP_GE))
+            op->imm = (int32_t)label_pc[op->imm];
+    }
+    program->instructions += out->count;
+
+    free(uses);
+    free(label_pc);
+}
+
+JAMZVMProgram *compile_bytecode(const JAMZIRProgram *ir)
+{
+    JAMZVMProgram *program = safe_malloc(sizeof(JAMZVMProgram));
+    program->function_count = ir->function_count;
+    program->functions = safe_malloc((ir->function_count ? ir->function_count : 1) * sizeof(JAMZVMFunction));
+    program->ir = ir;
+    program->fused = 0;
+    program->instructions = 0;
+    for (size_t i = 0; i < ir->function_count; i++)
+        compile_function(program, &ir->functions[i], &program->functions[i]);
+    log_debug("Bytecode: %zu instrucciones, %zu superinstrucciones\n", program->instructions, program->fused);
+    return program;
+}
+
+void free_bytecode(JAMZVMProgram *program)
+{
+    if (!program)
+        return;
+    for (size_t i = 0; i < program->function_count; i++)
+    {
+        free(program->functions[i].code);
+        free(program->functions[i].lines);
+        free(program->functions[i].array_base);
+    }
+    free(program->functions);
+    free(program);
+}
+
+// Marco del llamador, guardado mientras se ejecuta la función llamada
+typedef struct
+{
+    const JAMZVMFunction *function;
+    const JAMZVMInstr *return_pc;
+    size_t base;
+    int32_t result; // Registro que recibe el valor devuelto, o JAMZ_IR_NONE
+} Frame;
+
+// Aritmética de int de 32 bits sin comportamiento indefinido en el desborde
+#define WRAP(value) ((int64_t)(int32_t)(uint32_t)(value))
+#define ADD32(x, y) WRAP((uint32_t)(x) + (uint32_t)(y))
+#define SUB32(x, y) WRAP((uint32_t)(x) - (uint32_t)(y))
+#define MUL32(x, y) WRAP((uint32_t)(x) * (uint32_t)(y))
+#define CMP32(x, cmp, y) ((int32_t)(x) cmp (int32_t)(y))
+
+// Elementos de cada bloque del intérprete de núcleos vectoriales: cada
+// operación recorre el bloque entero antes de pasar a la siguiente
+#define VM_VECTOR_BLOCK 64
+
+// Ejecuta el núcleo para i en [from, to); falla si un acceso se sale de su
+// arreglo. Sin dependencias entre vueltas, el orden por bloques da lo mismo
+// que el bucle escalar.
+static bool run_kernel(const JAMZVMFunction *function, const JAMZVectorKernel *kernel, int64_t *r, int32_t from,
+                       int32_t to)
+{
+    int32_t lanes[JAMZ_VECTOR_MAX_KERNEL][VM_VECTOR_BLOCK];
+    for (size_t k = 0; k < kernel->invariant_count; k++)
+    {
+        const JAMZVectorInstr *v = &kernel->code[k];
+        int32_t value = v->op == JAMZ_VEC_CONST ? v->imm : (int32_t)r[function->array_base[v->array]];
+        for (int lane = 0; lane < VM_VECTOR_BLOCK; lane++)
+            lanes[k][lane] = value;
+    }
+
+    for (int64_t start = from; start < to; start += VM_VECTOR_BLOCK)
+    {
+        int count = to - start < VM_VECTOR_BLOCK ? (int)(to - start) : VM_VECTOR_BLOCK;
+        for (size_t k = kernel->invariant_count; k < kernel->count; k++)
+        {
+            const JAMZVectorInstr *v = &kernel->code[k];
+            int32_t *dst = lanes[k];
+            if (v->op == JAMZ_VEC_LOAD || v->op == JAMZ_VEC_STORE)
+            {
+                int64_t first = start + v->imm;
+                if (first < 0 || first + count > function->ir->array_lengths[v->array])
+                    return false;
+                int64_t *element = r + function->array_base[v->array] + first;
+                for (int lane = 0; lane < count; lane++)
+                {
+                    if (v->op == JAMZ_VEC_LOAD)
+                        dst[lane] = (int32_t)element[lane];
+                    else
+                        element[lane] = lanes[v->a][lane];
+                }
+                continue;
+            }
+            const int32_t *a = lanes[v->a];
+            const int32_t *b = lanes[v->b];
+            for (int lane = 0; lane < count; lane++)
+            {
+                if (v->op == JAMZ_VEC_ADD)
+                    dst[lane] = (int32_t)ADD32(a[lane], b[lane]);
+                else if (v->op == JAMZ_VEC_SUB)
+                    dst[lane] = (int32_t)SUB32(a[lane], b[lane]);
+                else
+                    dst[lane] = (int32_t)MUL32(a[lane], b[lane]);
+            }
+        }
+    }
+    return true;
+}
+
+static bool ensure_registers(int64_t **registers, size_t *capacity, size_t needed)
+{
+    if (needed <= *capacity)
+        return false;
+    while (*capacity < needed)
+        *capacity *= 2;
+    *registers = safe_realloc(*registers, *capacity * sizeof(int64_t));
+    return true;
+}
+
+bool vm_run_main(const JAMZVMProgram *program, int *result)
+{
+    const JAMZVMFunction *function = NULL;
+    for (size_t i = 0; i < program->function_count && !function; i++)
+    {
+        if (strcmp(program->functions[i].name, "main") == 0)
+            function = &program->functions[i];
+    }
+    if (!function)
+    {
+        fprintf(stderr, "[ERROR] El programa no define main\n");
+        return false;
+    }
+
+    size_t register_capacity = VM_INITIAL_REGISTERS;
+    int64_t *registers = safe_malloc(register_capacity * sizeof(int64_t));
+    size_t frame_capacity = VM_INITIAL_FRAMES, frame_count = 0;
+    Frame *frames = safe_malloc(frame_capacity * sizeof(Frame));
+    size_t arg_capacity = VM_INITIAL_FRAMES, arg_count = 0;
+    int64_t *args = safe_malloc(arg_capacity * sizeof(int64_t));
+
+    size_t base = 0;
+    ensure_registers(&registers, &register_capacity, (size_t)function->register_count);
+    memset(registers, 0, (size_t)function->register_count * sizeof(int64_t));
+    int64_t *r = registers;
+    const JAMZVMInstr *pc = function->code;
+    int64_t value = 0;
+    bool ok = true;
+
+#ifdef VM_COMPUTED_GOTO
+    static const void *dispatch[JAMZ_VM_OPCODE_COUNT] = {
+        [JAMZ_VM_CONST] = &&op_const,
+        [JAMZ_VM_STRING] = &&op_string,
+        [JAMZ_VM_MOVE] = &&op_move,
+        [JAMZ_VM_ADD] = &&op_add,
+        [JAMZ_VM_SUB] = &&op_sub,
+        [JAMZ_VM_MUL] = &&op_mul,
+        [JAMZ_VM_DIV] = &&op_div,
+        [JAMZ_VM_UDIV] = &&op_udiv,
+        [JAMZ_VM_MOD] = &&op_mod,
+        [JAMZ_VM_UMOD] = &&op_umod,
+        [JAMZ_VM_EQ] = &&op_eq,
+        [JAMZ_VM_NE] = &&op_ne,
+        [JAMZ_VM_LT] = &&op_lt,
+        [JAMZ_VM_LE] = &&op_le,
+        [JAMZ_VM_GT] = &&op_gt,
+        [JAMZ_VM_GE] = &&op_ge,
+        [JAMZ_VM_ARG] = &&op_arg,
+        [JAMZ_VM_CALL] = &&op_call,
+        [JAMZ_VM_JUMP] = &&op_jump,
+        [JAMZ_VM_JUMP_ZERO] = &&op_jump_zero,
+        [JAMZ_VM_RET] = &&op_ret,
+        [JAMZ_VM_RET_VOID] = &&op_ret_void,
+        [JAMZ_VM_LOAD] = &&op_load,
+        [JAMZ_VM_STORE] = &&op_store,
+        [JAMZ_VM_VLOOP] = &&op_vloop,
+        [JAMZ_VM_COUNT] = &&op_count,
+        [JAMZ_VM_ADD_CONST] = &&op_add_const,
+        [JAMZ_VM_SUB_CONST] = &&op_sub_const,
+        [JAMZ_VM_MUL_CONST] = &&op_mul_const,
+        [JAMZ_VM_MOVE_JUMP] = &&op_move_jump,
+        [JAMZ_VM_JUMP_EQ] = &&op_jump_eq,
+        [JAMZ_VM_JUMP_NE] = &&op_jump_ne,
+        [JAMZ_VM_JUMP_LT] = &&op_jump_lt,
+        [JAMZ_VM_JUMP_LE] = &&op_jump_le,
+        [JAMZ_VM_JUMP_GT] = &&op_jump_gt,
+        [JAMZ_VM_JUMP_GE] = &&op_jump_ge,
+    };
+#define CASE(label, opcode) label:
+#define NEXT() goto *dispatch[pc->op]
+    NEXT();
+#else
+#define CASE(label, opcode) case opcode:
+#define NEXT() continue
+resume:
+    for (;;)
+    {
+        switch (pc->op)
+        {
+#endif
+
+    CASE(op_const, JAMZ_VM_CONST)
+    {
+        r[pc->a] = pc->imm;
+        pc++;
+        NEXT();
+    }
+    CASE(op_string, JAMZ_VM_STRING)
+    {
+        r[pc->a] = (int64_t)(intptr_t)program->ir->strings[pc->imm];
+        pc++;
+        NEXT();
+    }
+    CASE(op_move, JAMZ_VM_MOVE)
+    {
+        r[pc->a] = r[pc->b];
+        pc++;
+        NEXT();
+    }
+    CASE(op_add, JAMZ_VM_ADD)
+    {
+        r[pc->a] = ADD32(r[pc->b], r[pc->c]);
+        pc++;
+        NEXT();
+    }
+    CASE(op_sub, JAMZ_VM_SUB)
+    {
+        r[pc->a] = SUB32(r[pc->b], r[pc->c]);
+        pc++;
+        NEXT();
+    }
+    CASE(op_mul, JAMZ_VM_MUL)
+    {
+        r[pc->a] = MUL32(r[pc->b], r[pc->c]);
+        pc++;
+        NEXT();
+    }
+    CASE(op_div, JAMZ_VM_DIV)
+    {
+        int32_t dividend = (int32_t)r[pc->b], divisor = (int32_t)r[pc->c];
+        // Los mismos casos en que idiv lanza #DE en la máquina real
+        if (divisor == 0 || (dividend == INT_MIN && divisor == -1))
+            goto division_error;
+        r[pc->a] = dividend / divisor;
+        pc++;
+        NEXT();
+    }
+    CASE(op_udiv, JAMZ_VM_UDIV)
+    {
+        uint32_t divisor = (uint32_t)r[pc->c];
+        if (divisor == 0)
+            goto division_error;
+        r[pc->a] = WRAP((uint32_t)r[pc->b] / divisor);
+        pc++;
+        NEXT();
+    }
+    CASE(op_mod, JAMZ_VM_MOD)
+    {
+        int32_t dividend = (int32_t)r[pc->b], divisor = (int32_t)r[pc->c];
+        if (divisor == 0 || (dividend == INT_MIN && divisor == -1))
+            goto division_error;
+        r[pc->a] = dividend % divisor;
+        pc++;
+        NEXT();
+    }
+    CASE(op_umod, JAMZ_VM_UMOD)
+    {
+        uint32_t divisor = (uint32_t)r[pc->c];
+        if (divisor == 0)
+            goto division_error;
+        r[pc->a] = WRAP((uint32_t)r[pc->b] % divisor);
+        pc++;
+        NEXT();
+    }
+    CASE(op_eq, JAMZ_VM_EQ)
+    {
+        r[pc->a] = CMP32(r[pc->b], ==, r[pc->c]);
+        pc++;
+        NEXT();
+    }
+    CASE(op_ne, JAMZ_VM_NE)
+    {
+        r[pc->a] = CMP32(r[pc->b], !=, r[pc->c]);
+        pc++;
+        NEXT();
+    }
+    CASE(op_lt, JAMZ_VM_LT)
+    {
+        r[pc->a] = CMP32(r[pc->b], <, r[pc->c]);
+        pc++;
+        NEXT();
+    }
+    CASE(op_le, JAMZ_VM_LE)
+    {
+        r[pc->a] = CMP32(r[pc->b], <=, r[pc->c]);
+        pc++;
+        NEXT();
+    }
+    CASE(op_gt, JAMZ_VM_GT)
+    {
+        r[pc->a] = CMP32(r[pc->b], >, r[pc->c]);
+        pc++;
+        NEXT();
+    }
+    CASE(op_ge, JAMZ_VM_GE)
+    {
+        r[pc->a] = CMP32(r[pc->b], >=, r[pc->c]);
+        pc++;
+        NEXT();
+    }
+    CASE(op_arg, JAMZ_VM_ARG)
+    {
+        if (arg_count == arg_capacity)
+        {
+            arg_capacity *= 2;
+            args = safe_realloc(args, arg_capacity * sizeof(int64_t));
+        }
+        args[arg_count++] = r[pc->a];
+        pc++;
+        NEXT();
+    }
+    CASE(op_call, JAMZ_VM_CALL)
+    {
+        if (pc->imm == JAMZ_IR_NONE)
+        {
+            fprintf(stderr, "[ERROR] Llamada a una función desconocida en %s, línea %d\n", function->name,
+                    function->lines[pc - function->code]);
+            ok = false;
+            goto done;
+        }
+        const JAMZVMFunction *callee = &program->functions[pc->imm];
+        if (frame_count == frame_capacity)
+        {
+            frame_capacity *= 2;
+            frames = safe_realloc(frames, frame_capacity * sizeof(Frame));
+        }
+        frames[frame_count++] = (Frame){function, pc + 1, base, pc->a};
+
+        base += (size_t)function->register_count;
+        ensure_registers(&registers, &register_capacity, base + (size_t)callee->register_count);
+        r = registers + base;
+        // Los ARG van de derecha a izquierda: el primer parámetro es el último
+        int32_t params = callee->first_array - callee->first_param;
+        for (int32_t k = 0; k < params; k++)
+            r[callee->first_param + k] = k < pc->c ? args[arg_count - 1 - (size_t)k] : 0;
+        memset(r + callee->first_array, 0, (size_t)(callee->register_count - callee->first_array) * sizeof(int64_t));
+        arg_count -= (size_t)pc->c;
+
+        function = callee;
+        pc = callee->code;
+        NEXT();
+    }
+    CASE(op_jump, JAMZ_VM_JUMP)
+    {
+        pc = function->code + pc->imm;
+        NEXT();
+    }
+    CASE(op_jump_zero, JAMZ_VM_JUMP_ZERO)
+    {
+        pc = (int32_t)r[pc->a] == 0 ? function->code + pc->imm : pc + 1;
+        NEXT();
+    }
+    CASE(op_ret, JAMZ_VM_RET)
+    {
+        value = r[pc->a];
+        goto leave;
+    }
+    CASE(op_ret_void, JAMZ_VM_RET_VOID)
+    {
+        value = 0;
+        goto leave;
+    }
+    CASE(op_load, JAMZ_VM_LOAD)
+    {
+        uint32_t index = (uint32_t)r[pc->b];
+        if (index >= (uint32_t)pc->imm)
+            goto index_error;
+        r[pc->a] = r[pc->c + index];
+        pc++;
+        NEXT();
+    }
+    CASE(op_store, JAMZ_VM_STORE)
+    {
+        uint32_t index = (uint32_t)r[pc->a];
+        if (index >= (uint32_t)pc->imm)
+            goto index_error;
+        r[pc->c + index] = r[pc->b];
+        pc++;
+        NEXT();
+    }
+    CASE(op_vloop, JAMZ_VM_VLOOP)
+    {
+        // Todas las vueltas menos la última, que queda para el bucle escalar
+        int32_t from = (int32_t)r[pc->b];
+        int64_t last = (int64_t)(int32_t)r[pc->c] - 1;
+        int32_t to = last > from ? (int32_t)last : from;
+        if (!run_kernel(function, &function->ir->kernels[pc->imm], r, from, to))
+            goto index_error;
+        r[pc->a] = to;
+        pc++;
+        NEXT();
+    }
+    CASE(op_count, JAMZ_VM_COUNT)
+    {
+        program->ir->profile->counts[pc->imm]++;
+        pc++;
+        NEXT();
+    }
+    CASE(op_add_const, JAMZ_VM_ADD_CONST)
+    {
+        r[pc->a] = ADD32(r[pc->b], pc->imm);
+        pc++;
+        NEXT();
+    }
+    CASE(op_sub_const, JAMZ_VM_SUB_CONST)
+    {
+        r[pc->a] = SUB32(r[pc->b], pc->imm);
+        pc++;
+        NEXT();
+    }
+    CASE(op_mul_const, JAMZ_VM_MUL_CONST)
+    {
+        r[pc->a] = MUL32(r[pc->b], pc->imm);
+        pc++;
+        NEXT();
+    }
+    CASE(op_move_jump, JAMZ_VM_MOVE_JUMP)
+    {
+        r[pc->a] = r[pc->b];
+        pc = function->code + pc->imm;
+        NEXT();
+    }
+    CASE(op_jump_eq, JAMZ_VM_JUMP_EQ)
+    {
+        pc = CMP32(r[pc->a], ==, r[pc->b]) ? function->code + pc->imm : pc + 1;
+        NEXT();
+    }
+    CASE(op_jump_ne, JAMZ_VM_JUMP_NE)
+    {
+        pc = CMP32(r[pc->a], !=, r[pc->b]) ? function->code + pc->imm : pc + 1;
+        NEXT();
+    }
+    CASE(op_jump_lt, JAMZ_VM_JUMP_LT)
+    {
+        pc = CMP32(r[pc->a], <, r[pc->b]) ? function->code + pc->imm : pc + 1;
+        NEXT();
+    }
+    CASE(op_jump_le, JAMZ_VM_JUMP_LE)
+    {
+        pc = CMP32(r[pc->a], <=, r[pc->b]) ? function->code + pc->imm : pc + 1;
+        NEXT();
+    }
+    CASE(op_jump_gt, JAMZ_VM_JUMP_GT)
+    {
+        pc = CMP32(r[pc->a], >, r[pc->b]) ? function->code + pc->imm : pc + 1;
+        NEXT();
+    }
+    CASE(op_jump_ge, JAMZ_VM_JUMP_GE)
+    {
+        pc = CMP32(r[pc->a], >=, r[pc->b]) ? function->code + pc->imm : pc + 1;
+        NEXT();
+    }
+
+#ifndef VM_COMPUTED_GOTO
+        default:
+            fprintf(stderr, "[ERROR] Código de operación desconocido %u\n", pc->op);
+            ok = false;
+            goto done;
+        }
+    }
+#endif
+#undef CASE
+#undef NEXT
+
+leave:
+    if (frame_count == 0)
+        goto done;
+    {
+        const Frame *caller = &frames[--frame_count];
+        function = caller->function;
+        base = caller->base;
+        r = registers + base;
+        pc = caller->return_pc;
+        if (caller->result != JAMZ_IR_NONE)
+            r[caller->result] = value;
+    }
+#ifdef VM_COMPUTED_GOTO
+    goto *dispatch[pc->op];
+#else
+    goto resume;
+#endif
+
+division_error:
+    fprintf(stderr, "[ERROR] División por cero o desbordamiento en %s, línea %d\n", function->name,
+            function->lines[pc - function->code]);
+    ok = false;
+    goto done;
+
+index_error:
+    fprintf(stderr, "[ERROR] Índice fuera de rango en %s, línea %d\n", function->name,
+            function->lines[pc - function->code]);
+    ok = false;
+
+done:
+    if (ok)
+        *result = (int)value;
+    free(registers);
+    free(frames);
+    free(args);
+    return ok;
+}
@@ -0,0 +1,320 @@
+#include "x64.h"
+
+// Los desplazamientos de [rbp + disp] caben casi siempre en un byte
+#define FITS_INT8(value) ((value) >= -128 && (value) <= 127)
+
+static void emit_u8(JAMZOutputBuffer *out, uint8_t byte)
+{
+    output_char(out, (char)byte);
+}
+
+static void emit_u32(JAMZOutputBuffer *out, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+        emit_u8(out, (uint8_t)(value >> (8 * i)));
+}
+
+JAMZX64Operand x64_register(JAMZX64Register reg)
+{
+    return (JAMZX64Operand){false, reg, 0, 0};
+}
+
+JAMZX64Operand x64_frame(int32_t disp)
+{
+    return (JAMZX64Operand){true, JAMZ_X64_RBP, disp, 0};
+}
+
+JAMZX64Operand x64_indexed(int32_t disp, int scale)
+{
+    return (JAMZX64Operand){true, JAMZ_X64_RBP, disp, scale};
+}
+
+// ModRM con reg en el campo reg y rm como registro, [rbp + disp] o
+// [rbp + rax*scale + disp]
+static void emit_modrm(JAMZOutputBuffer *out, unsigned reg, JAMZX64Operand rm)
+{
+    if (!rm.memory)
+    {
+        emit_u8(out, (uint8_t)(0xC0 | (reg & 7) << 3 | (rm.reg & 7)));
+        return;
+    }
+    // rm = 101 con mod 01/10 es [rbp + disp8/disp32], sin SIB; rm = 100 pide
+    // un SIB con base 101 (rbp) e índice 000 (rax)
+    uint8_t mod = FITS_INT8(rm.disp) ? 0x40 : 0x80;
+    if (rm.scale == 0)
+        emit_u8(out, (uint8_t)(mod | (reg & 7) << 3 | 5));
+    else
+    {
+        uint8_t scale_bits = rm.scale == 8 ? 3 : rm.scale == 4 ? 2 : rm.scale == 2 ? 1 : 0;
+        emit_u8(out, (uint8_t)(mod | (reg & 7) << 3 | 4));
+        emit_u8(out, (uint8_t)(scale_bits << 6 | 5));
+    }
+    if (mod == 0x40)
+        emit_u8(out, (uint8_t)rm.disp);
+    else
+        emit_u32(out, (uint32_t)rm.disp);
+}
+
+// Prefijo REX (solo si hace falta), código de operación y ModRM
+static void emit_instruction(JAMZOutputBuffer *out, bool wide, unsigned opcode, unsigned reg, JAMZX64Operand rm)
+{
+    uint8_t rex = 0x40 | (wide ? 0x08 : 0) | ((reg & 8) ? 0x04 : 0) | ((rm.reg & 8) ? 0x01 : 0);
+    if (rex != 0x40)
+        emit_u8(out, rex);
+    if (opcode > 0xFF)
+        emit_u8(out, (uint8_t)(opcode >> 8));
+    emit_u8(out, (uint8_t)opcode);
+    emit_modrm(out, reg, rm);
+}
+
+void x64_mov(JAMZOutputBuffer *out, JAMZX64Operand dst, JAMZX64Operand src, bool wide)
+{
+    if (!dst.memory && !src.memory && dst.reg == src.reg)
+        return;
+    if (dst.memory)
+        emit_instruction(out, wide, 0x89, src.reg, dst);
+    else
+        emit_instruction(out, wide, 0x8B, dst.reg, src);
+}
+
+void x64_mov_imm(JAMZOutputBuffer *out, JAMZX64Operand dst, int32_t imm)
+{
+    if (dst.memory)
+    {
+        // La ranura entera queda definida: imm se extiende con signo a 64 bits
+        emit_instruction(out, true, 0xC7, 0, dst);
+    }
+    else
+    {
+        if (dst.reg & 8)
+            emit_u8(out, 0x41);
+        emit_u8(out, (uint8_t)(0xB8 + (dst.reg & 7)));
+    }
+    emit_u32(out, (uint32_t)imm);
+}
+
+void x64_arith(JAMZOutputBuffer *out, JAMZX64Arith op, JAMZX64Register dst, JAMZX64Operand src)
+{
+    emit_instruction(out, false, op, dst, src);
+}
+
+// and dst, imm (/4) con imm8 si cabe
+void x64_and_imm(JAMZOutputBuffer *out, JAMZX64Register dst, int32_t imm)
+{
+    emit_instruction(out, false, FITS_INT8(imm) ? 0x83 : 0x81, 4, x64_register(dst));
+    if (FITS_INT8(imm))
+        emit_u8(out, (uint8_t)imm);
+    else
+        emit_u32(out, (uint32_t)imm);
+}
+
+// add dst, imm (/0) con imm8 si cabe
+void x64_add_imm(JAMZOutputBuffer *out, JAMZX64Register dst, int32_t imm, bool wide)
+{
+    emit_instruction(out, wide, FITS_INT8(imm) ? 0x83 : 0x81, 0, x64_register(dst));
+    if (FITS_INT8(imm))
+        emit_u8(out, (uint8_t)imm);
+    else
+        emit_u32(out, (uint32_t)imm);
+}
+
+void x64_lea_scaled(JAMZOutputBuffer *out, JAMZX64Register dst, JAMZX64Register base, JAMZX64Register index, int scale)
+{
+    uint8_t rex = 0x40 | ((dst & 8) ? 0x04 : 0) | ((index & 8) ? 0x02 : 0) | ((base & 8) ? 0x01 : 0);
+    if (rex != 0x40)
+        emit_u8(out, rex);
+    emit_u8(out, 0x8D);
+    // rm = 100 pide SIB; con rbp o r13 de base mod 00 significaría "sin
+    // base", así que esos llevan un disp8 nulo
+    bool needs_disp = (base & 7) == 5;
+    uint8_t scale_bits = scale == 8 ? 3 : scale == 4 ? 2 : scale == 2 ? 1 : 0;
+    emit_u8(out, (uint8_t)((needs_disp ? 0x40 : 0) | (dst & 7) << 3 | 4));
+    emit_u8(out, (uint8_t)(scale_bits << 6 | (index & 7) << 3 | (base & 7)));
+    if (needs_disp)
+        emit_u8(out, 0);
+}
+
+void x64_test_imm(JAMZOutputBuffer *out, JAMZX64Register dst, int32_t imm)
+{
+    emit_instruction(out, false, 0xF7, 0, x64_register(dst));
+    emit_u32(out, (uint32_t)imm);
+}
+
+void x64_movsxd(JAMZOutputBuffer *out, JAMZX64Register dst, JAMZX64Operand src)
+{
+    emit_instruction(out, true, 0x63, dst, src);
+}
+
+void x64_lea(JAMZOutputBuffer *out, JAMZX64Register dst, JAMZX64Operand src)
+{
+    emit_instruction(out, true, 0x8D, dst, src);
+}
+
+void x64_divide(JAMZOutputBuffer *out, JAMZX64Operand src, bool is_signed)
+{
+    emit_instruction(out, false, 0xF7, is_signed ? 7 : 6, src);
+}
+
+void x64_cdq(JAMZOutputBuffer *out)
+{
+    emit_u8(out, 0x99);
+}
+
+void x64_multiply_wide(JAMZOutputBuffer *out, JAMZX64Operand src)
+{
+    emit_instruction(out, false, 0xF7, 5, src);
+}
+
+void x64_multiply_imm(JAMZOutputBuffer *out, JAMZX64Register dst, JAMZX64Operand src, int32_t imm)
+{
+    emit_instruction(out, false, 0x69, dst, src);
+    emit_u32(out, (uint32_t)imm);
+}
+
+void x64_shift(JAMZOutputBuffer *out, JAMZX64Shift kind, JAMZX64Register dst, int amount)
+{
+    emit_instruction(out, false, 0xC1, kind, x64_register(dst));
+    emit_u8(out, (uint8_t)amount);
+}
+
+void x64_negate(JAMZOutputBuffer *out, JAMZX64Register dst)
+{
+    emit_instruction(out, false, 0xF7, 3, x64_register(dst));
+}
+
+void x64_set_condition(JAMZOutputBuffer *out, JAMZX64Condition condition)
+{
+    emit_instruction(out, false, 0x0F90 | condition, 0, x64_register(JAMZ_X64_RAX));
+    emit_instruction(out, false, 0x0FB6, JAMZ_X64_RAX, x64_register(JAMZ_X64_RAX));
+}
+
+void x64_push(JAMZOutputBuffer *out, JAMZX64Operand src)
+{
+    if (src.memory)
+    {
+        emit_instruction(out, false, 0xFF, 6, src);
+        return;
+    }
+    if (src.reg & 8)
+        emit_u8(out, 0x41);
+    emit_u8(out, (uint8_t)(0x50 + (src.reg & 7)));
+}
+
+void x64_pop(JAMZOutputBuffer *out, JAMZX64Register dst)
+{
+    if (dst & 8)
+        emit_u8(out, 0x41);
+    emit_u8(out, (uint8_t)(0x58 + (dst & 7)));
+}
+
+void x64_adjust_stack(JAMZOutputBuffer *out, int32_t delta)
+{
+    if (delta == 0)
+        return;
+    // add rsp, imm (/0) o sub rsp, imm (/5)
+    unsigned extension = delta > 0 ? 0 : 5;
+    int32_t amount = delta > 0 ? delta : -delta;
+    emit_instruction(out, true, FITS_INT8(amount) ? 0x83 : 0x81, extension, x64_register(JAMZ_X64_RSP));
+    if (FITS_INT8(amount))
+        emit_u8(out, (uint8_t)amount);
+    else
+        emit_u32(out, (uint32_t)amount);
+}
+
+void x64_leave(JAMZOutputBuffer *out)
+{
+    emit_u8(out, 0xC9);
+}
+
+// El prefijo obligatorio va antes del REX
+void x64_sse(JAMZOutputBuffer *out, JAMZX64VectorOp op, unsigned reg, JAMZX64Operand rm, uint8_t imm)
+{
+    emit_u8(out, (uint8_t)(op >> 16));
+    emit_instruction(out, false, 0x0F00 | (op & 0xFF), reg, rm);
+    if (op == JAMZ_X64_PSHUFD)
+        emit_u8(out, imm);
+}
+
+// VEX de tres bytes: C4, R̄X̄B̄ y el mapa, W vvvv L pp con vvvv invertido
+void x64_vex(JAMZOutputBuffer *out, JAMZX64VectorOp op, bool wide, unsigned reg, unsigned source, JAMZX64Operand rm)
+{
+    unsigned prefix = op >> 16;
+    unsigned pp = prefix == 0x66 ? 1 : prefix == 0xF3 ? 2 : 0;
+    emit_u8(out, 0xC4);
+    emit_u8(out, (uint8_t)(((reg & 8) ? 0 : 0x80) | 0x40 | ((rm.reg & 8) && !rm.memory ? 0 : 0x20) | ((op >> 8) & 0x1F)));
+    emit_u8(out, (uint8_t)((~source & 15) << 3 | (wide ? 0x04 : 0) | pp));
+    emit_u8(out, (uint8_t)op);
+    emit_modrm(out, reg, rm);
+}
+
+void x64_vzeroupper(JAMZOutputBuffer *out)
+{
+    emit_u8(out, 0xC5);
+    emit_u8(out, 0xF8);
+    emit_u8(out, 0x77);
+}
+
+void x64_ret(JAMZOutputBuffer *out)
+{
+    emit_u8(out, 0xC3);
+}
+
+size_t x64_lea_rip(JAMZOutputBuffer *out, JAMZX64Register dst)
+{
+    // mod 00 y rm 101 es [rip + disp32] en modo de 64 bits
+    emit_u8(out, (uint8_t)(0x48 | ((dst & 8) ? 0x04 : 0)));
+    emit_u8(out, 0x8D);
+    emit_u8(out, (uint8_t)((dst & 7) << 3 | 5));
+    size_t at = out->size;
+    emit_u32(out, 0);
+    return at;
+}
+
+size_t x64_inc_rip(JAMZOutputBuffer *out)
+{
+    emit_u8(out, 0x48);
+    emit_u8(out, 0xFF);
+    emit_u8(out, 0 << 3 | 5); // /0 es inc
+    size_t at = out->size;
+    emit_u32(out, 0);
+    return at;
+}
+
+// Todos los saltos usan rel32: sin relajación, una sola pasada basta
+static size_t emit_rel32(JAMZOutputBuffer *out)
+{
+    size_t at = out->size;
+    emit_u32(out, 0);
+    return at;
+}
+
+size_t x64_jmp(JAMZOutputBuffer *out)
+{
+    emit_u8(out, 0xE9);
+    return emit_rel32(out);
+}
+
+size_t x64_jz(JAMZOutputBuffer *out)
+{
+    return x64_jcc(out, JAMZ_X64_CC_E);
+}
+
+size_t x64_jcc(JAMZOutputBuffer *out, JAMZX64Condition condition)
+{
+    emit_u8(out, 0x0F);
+    emit_u8(out, (uint8_t)(0x80 | condition));
+    return emit_rel32(out);
+}
+
+size_t x64_call(JAMZOutputBuffer *out)
+{
+    emit_u8(out, 0xE8);
+    return emit_rel32(out);
+}
+
+void x64_patch_rel32(JAMZOutputBuffer *out, size_t at, size_t target)
+{
+    uint32_t value = (uint32_t)((int64_t)target - (int64_t)(at + 4));
+    for (int i = 0; i < 4; i++)
+        out->data[at + i] = (char)(uint8_t)(value >> (8 * i));
+}